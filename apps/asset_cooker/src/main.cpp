@@ -0,0 +1,75 @@
+// Imports the resources of a directory without the editor, to cook the assets on a build machine.
+// Only the resources whose content, importer version or importer settings changed since the last cook are imported.
+// usage: asset_cooker [directory] [--hash-all]  (defaults to ASSET_PATH, the stat cache is trusted by default)
+#include "assets/asset_manager.h"
+#include "cross/jobmanager.h"
+#include "exo/profile.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+using Clock = std::chrono::high_resolution_clock;
+
+static double to_mib(usize size) { return double(size) / double(1_MiB); }
+
+int main(int argc, char *argv[])
+{
+	EXO_PROFILE_SCOPE
+	const char          *directory     = ASSET_PATH;
+	ResourceTrackingMode tracking_mode = ResourceTrackingMode::StatOnly;
+	for (int i_arg = 1; i_arg < argc; ++i_arg) {
+		if (std::strcmp(argv[i_arg], "--hash-all") == 0) {
+			tracking_mode = ResourceTrackingMode::HashAll;
+		} else {
+			directory = argv[i_arg];
+		}
+	}
+
+	auto jobmanager = cross::JobManager::create();
+
+	const auto start         = Clock::now();
+	auto       asset_manager = AssetManager::create(jobmanager, tracking_mode, directory);
+	const auto seconds       = std::chrono::duration<double>(Clock::now() - start).count();
+
+	u32 resource_count = 0;
+	asset_manager.database.for_each_resource([&](const DatabaseIndexResource &) { resource_count += 1; });
+
+	ImporterStats total = {};
+	printf("%-8s %-10s %-9s %-11s %-12s %-11s %-10s\n",
+		"importer",
+		"resources",
+		"products",
+		"create (s)",
+		"process (s)",
+		"assets MiB",
+		"blobs MiB");
+	for (u32 i_importer = 0; i_importer < asset_manager.importers.len(); ++i_importer) {
+		const auto &stats = asset_manager.import_stats[i_importer];
+		printf("%-8s %-10u %-9u %-11.3f %-12.3f %-11.2f %-10.2f\n",
+			asset_manager.importers[i_importer]->get_name(),
+			stats.resource_count,
+			stats.product_count,
+			stats.create_seconds,
+			stats.process_seconds,
+			to_mib(stats.asset_size),
+			to_mib(stats.blob_size));
+
+		total.resource_count += stats.resource_count;
+		total.product_count += stats.product_count;
+		total.asset_size += stats.asset_size;
+		total.blob_size += stats.blob_size;
+	}
+
+	printf("Cooked %u of %u resources from %s in %.3f s (%u assets, %.2f MiB), %u were up to date.\n",
+		total.resource_count,
+		resource_count,
+		directory,
+		seconds,
+		total.product_count,
+		to_mib(total.asset_size + total.blob_size),
+		resource_count - total.resource_count);
+
+	jobmanager.destroy();
+	return 0;
+}
@@ -0,0 +1,136 @@
+// Measures the compression ratio and decoding throughput of compressed blobs on the compiled assets.
+// usage: blob_benchmark [directory]  (defaults to COMPILED_ASSET_PATH)
+#include "assets/blob_compression.h"
+#include "assets/blob_store.h"
+#include "cross/jobmanager.h"
+#include "cross/mapped_file.h"
+#include "exo/collections/vector.h"
+#include "exo/profile.h"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+
+using Clock = std::chrono::high_resolution_clock;
+
+struct BenchmarkResult
+{
+	usize  raw_size                = 0;
+	usize  compressed_size         = 0;
+	double encode_seconds          = 0.0;
+	double decode_seconds          = 0.0; // all blocks decoded on the calling thread
+	double parallel_decode_seconds = 0.0;
+};
+
+static double seconds_since(Clock::time_point start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static void run_benchmark(const cross::JobManager &jobmanager,
+	const Vec<Vec<u8>>                           &blobs,
+	const assets::BlobCompressionSettings        &settings,
+	BenchmarkResult                              &result)
+{
+	EXO_PROFILE_SCOPE
+	Vec<u8> output;
+
+	for (const auto &blob : blobs) {
+		auto encode_start = Clock::now();
+		auto compressed   = assets::compress_blob(blob, settings);
+		result.encode_seconds += seconds_since(encode_start);
+
+		result.raw_size += blob.len();
+		result.compressed_size += compressed.len();
+		output.resize(blob.len());
+
+		auto decode_start = Clock::now();
+		for (u32 i_block = 0; i_block < assets::get_compressed_blob_header(compressed).block_count; i_block += 1) {
+			const usize block_start = usize(i_block) * settings.block_size;
+			assets::decompress_blob_block(compressed,
+				i_block,
+				exo::Span(output.data() + block_start, output.len() - block_start));
+		}
+		result.decode_seconds += seconds_since(decode_start);
+
+		auto parallel_decode_start = Clock::now();
+		assets::decompress_blob(&jobmanager, compressed, output);
+		result.parallel_decode_seconds += seconds_since(parallel_decode_start);
+
+		ASSERT(std::memcmp(output.data(), blob.data(), blob.len()) == 0);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	EXO_PROFILE_SCOPE
+	const char *directory = argc > 1 ? argv[1] : COMPILED_ASSET_PATH;
+
+	// Load every blob in memory, already compressed blobs are decoded first to benchmark on the raw content
+	auto jobmanager = cross::JobManager::create();
+
+	Vec<Vec<u8>> blobs;
+	auto load_blob = [&](exo::Span<const u8> content) {
+		auto &blob = blobs.push();
+		if (assets::is_compressed_blob(content)) {
+			blob.resize(assets::get_compressed_blob_header(content).uncompressed_size);
+			assets::decompress_blob(&jobmanager, content, blob);
+		} else {
+			blob.resize(content.len());
+			std::memcpy(blob.data(), content.data(), content.len());
+		}
+	};
+
+	// Blobs from the pack files
+	auto blob_store = BlobStore::open(exo::Path::from_string(directory));
+	for (const auto &slot : blob_store.index_slots) {
+		if (slot.location.i_pack != u32_invalid) {
+			load_blob(blob_store.get(exo::u128_from_u64(slot.hash1, slot.hash0)));
+		}
+	}
+
+	// Loose blobs
+	for (const auto &file_entry : std::filesystem::directory_iterator{directory}) {
+		if (!file_entry.is_regular_file() || file_entry.path().extension() != ".bin") {
+			continue;
+		}
+
+		auto path_string = file_entry.path().string();
+		auto file        = cross::MappedFile::open(exo::StringView{path_string.c_str(), path_string.size()}).value();
+		load_blob(file.content());
+	}
+
+	usize total_size = 0;
+	for (const auto &blob : blobs) {
+		total_size += blob.len();
+	}
+	printf("Loaded %zu blobs (%.2f MiB) from %s\n", blobs.len(), double(total_size) / double(1_MiB), directory);
+
+	const int    levels[]      = {1, 6, 9};
+	const u32    block_sizes[] = {64_KiB, 256_KiB, 1_MiB};
+	const double gib           = double(1_GiB);
+
+	printf("%-6s %-10s %-8s %-14s %-14s %-14s\n", "level", "block", "ratio", "encode GB/s", "decode GB/s", "par. decode");
+	for (int level : levels) {
+		for (u32 block_size : block_sizes) {
+			assets::BlobCompressionSettings settings = {};
+			settings.codec                           = assets::BlobCodec::Zlib;
+			settings.block_size                      = block_size;
+			settings.level                           = level;
+
+			BenchmarkResult result = {};
+			run_benchmark(jobmanager, blobs, settings, result);
+
+			printf("%-6d %-10u %-8.3f %-14.3f %-14.3f %-14.3f\n",
+				level,
+				block_size,
+				double(result.raw_size) / double(result.compressed_size),
+				double(result.raw_size) / gib / result.encode_seconds,
+				double(result.raw_size) / gib / result.decode_seconds,
+				double(result.raw_size) / gib / result.parallel_decode_seconds);
+		}
+	}
+
+	jobmanager.destroy();
+	return 0;
+}
@@ -12,12 +12,22 @@ struct SubmeshDescriptor
 	u32 index_count;
 };
 
+// Matches PositionFormat and UvFormat in assets/mesh.h
+#define POSITION_FORMAT_FLOAT32X4 0
+#define POSITION_FORMAT_SNORM16X4 1
+#define UV_FORMAT_FLOAT32X2 0
+#define UV_FORMAT_FLOAT16X2 1
+
 struct MeshDescriptor
 {
 	u32 index_buffer_descriptor;
 	u32 positions_buffer_descriptor;
 	u32 uvs_buffer_descriptor;
 	u32 submesh_buffer_descriptor;
+	float3 positions_decode_scale;
+	u32 positions_format;
+	float3 positions_decode_offset;
+	u32 uvs_format;
 };
 
 struct InstanceDescriptor
@@ -29,6 +39,9 @@ struct InstanceDescriptor
 	u32      padding2;
 };
 
+// MaterialDescriptor flags
+#define MATERIAL_NORMAL_TEXTURE_XY 1 // the normal texture only stores X and Y, Z is reconstructed
+
 struct MaterialDescriptor
 {
 	float4 base_color_factor;
@@ -41,17 +54,39 @@ struct MaterialDescriptor
 	float rotation;
 	float2 offset;
 	float2 scale;
-	float2 pad00;
+	u32 flags;
+	u32 pad00;
 };
 
 #define BINDLESS_BUFFER layout(set = GLOBAL_BINDLESS_SET, binding = GLOBAL_BUFFER_BINDING) buffer
 
 BINDLESS_BUFFER PositionsBuffer { float4 positions[]; } global_buffers_positions[];
+BINDLESS_BUFFER PositionsSnormBuffer { uint2 positions[]; } global_buffers_positions_snorm[];
 BINDLESS_BUFFER UvsBuffer { float2 uvs[]; } global_buffers_uvs[];
+BINDLESS_BUFFER UvsHalfBuffer { u32 uvs[]; } global_buffers_uvs_half[];
 BINDLESS_BUFFER IndexBuffers { u32 indices[]; } global_buffers_indices[];
 BINDLESS_BUFFER SubmeshBuffer { SubmeshDescriptor submeshes[]; } global_buffers_submeshes[];
 BINDLESS_BUFFER MeshBuffer { MeshDescriptor meshes[]; } global_buffers_meshes[];
 BINDLESS_BUFFER InstanceBuffer { InstanceDescriptor instances[]; } global_buffers_instances[];
 BINDLESS_BUFFER MaterialBuffer { MaterialDescriptor materials[]; } global_buffers_materials[];
 
+float4 load_position(MeshDescriptor mesh, u32 i_vertex)
+{
+	if (mesh.positions_format == POSITION_FORMAT_SNORM16X4) {
+		u32 i_buffer = mesh.positions_buffer_descriptor;
+		uint2 packed = global_buffers_positions_snorm[nonuniformEXT(i_buffer)].positions[i_vertex];
+		float3 snorm = float3(unpackSnorm2x16(packed.x), unpackSnorm2x16(packed.y).x);
+		return float4(snorm * mesh.positions_decode_scale + mesh.positions_decode_offset, 1.0);
+	}
+	return global_buffers_positions[nonuniformEXT(mesh.positions_buffer_descriptor)].positions[i_vertex];
+}
+
+float2 load_uv(MeshDescriptor mesh, u32 i_vertex)
+{
+	if (mesh.uvs_format == UV_FORMAT_FLOAT16X2) {
+		return unpackHalf2x16(global_buffers_uvs_half[nonuniformEXT(mesh.uvs_buffer_descriptor)].uvs[i_vertex]);
+	}
+	return global_buffers_uvs[nonuniformEXT(mesh.uvs_buffer_descriptor)].uvs[i_vertex];
+}
+
 #endif
@@ -57,7 +57,12 @@ void main()
 	float4 normal = float4(0, 0, 1, 1);
 	if (TEXTURE_BOUND(material.normal_texture)) {
 		if (TEXTURE_VALID(material.normal_texture)) {
-			normal = texture(global_textures[nonuniformEXT(material.normal_texture)], i_uvs);
+			const float3 texel = texture(global_textures[nonuniformEXT(material.normal_texture)], i_uvs).xyz;
+			normal.xyz = 2.0 * texel - 1.0;
+			// Compressed normal maps only store X and Y (BC5)
+			if ((material.flags & MATERIAL_NORMAL_TEXTURE_XY) != 0) {
+				normal.z = sqrt(max(0.0, 1.0 - dot(normal.xy, normal.xy)));
+			}
 		}
 		else {
 			ERROR
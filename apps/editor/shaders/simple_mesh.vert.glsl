@@ -26,8 +26,8 @@ void main()
     SubmeshDescriptor submesh = global_buffers_submeshes[nonuniformEXT(mesh.submesh_buffer_descriptor)].submeshes[i_submesh];
     MaterialDescriptor material = global_buffers_materials[materials_descriptor].materials[submesh.i_material];
 
-    float4 vertex = global_buffers_positions[nonuniformEXT(mesh.positions_buffer_descriptor)].positions[gl_VertexIndex];
-    float2 uvs = global_buffers_uvs[nonuniformEXT(mesh.uvs_buffer_descriptor)].uvs[gl_VertexIndex];
+    float4 vertex = load_position(mesh, u32(gl_VertexIndex));
+    float2 uvs = load_uv(mesh, u32(gl_VertexIndex));
     uvs = uvs * material.scale + material.offset;
 
     o_world_pos = instance.transform * vertex;
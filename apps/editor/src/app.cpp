@@ -2,6 +2,7 @@
 #include "assets/asset_manager.h"
 #include "assets/subscene.h"
 #include "cross/file_watcher.h"
+#include "cross/jobs/custom.h"
 #include "cross/platform.h"
 #include "cross/window.h"
 #include "engine/camera.h"
@@ -31,7 +32,7 @@ App::App(exo::ScopeStack &scope)
 	this->jobmanager = cross::JobManager::create();
 
 	this->window = cross::Window::create({DEFAULT_WIDTH, DEFAULT_HEIGHT}, "Editor");
-	this->asset_manager = AssetManager::create(this->jobmanager);
+	this->asset_manager = AssetManager::open(this->jobmanager);
 
 	this->inputs.bind(Action::QuitApp, {.keys = {exo::VirtualKey::Escape}});
 	this->inputs.bind(Action::CameraModifier, {.keys = {exo::VirtualKey::LAlt}});
@@ -39,6 +40,7 @@ App::App(exo::ScopeStack &scope)
 	this->inputs.bind(Action::CameraOrbit, {.mouse_buttons = {exo::MouseButton::Right}});
 
 	this->watcher = cross::FileWatcher::create();
+	this->watcher.add_watch(ASSET_PATH);
 	this->renderer = Renderer::create(this->window->get_win32_hwnd(), &this->asset_manager);
 
 	const int font_size_pt = 18;
@@ -57,7 +59,13 @@ App::App(exo::ScopeStack &scope)
 
 	this->is_minimized = false;
 
-	this->scene.init(&this->asset_manager, &this->inputs);
+	// The first frames are displayed while the resources are imported, their time does not depend on the assets
+	this->startup_job = cross::custom_job<App>(this->jobmanager, this, [](App *app) {
+		EXO_PROFILE_SCOPE_NAMED("Editor startup")
+		app->asset_manager.import_outdated_resources(
+			ResourceTrackingMode::StatOnly, ASSET_PATH, &app->startup_progress);
+		app->scene.init(&app->asset_manager, &app->inputs);
+	});
 
 #if 0
 	auto  scene_id    = AssetId::create<SubScene>("NewSponza_Main_Blender_glTF.gltf");
@@ -70,10 +78,50 @@ App::App(exo::ScopeStack &scope)
 
 App::~App()
 {
+	if (this->startup_job) {
+		this->startup_job->wait();
+	}
 	scene.destroy();
 	cross::platform::destroy();
 }
 
+void App::display_startup_progress(const Rect &fullscreen_rect)
+{
+	exo::ScopeStack scope;
+
+	const u32 imported_count = this->startup_progress.imported_count.load();
+	const u32 resource_count = this->startup_progress.resource_count.load();
+
+	exo::StringView label;
+	float progress = 0.0f;
+	switch (this->startup_progress.phase.load()) {
+	case ImportPhase::TrackingResources:
+		label = "Scanning resources...";
+		break;
+	case ImportPhase::Importing:
+		label = exo::formatf(scope, "Importing resources %u / %u", imported_count, resource_count);
+		progress = resource_count != 0 ? float(imported_count) / float(resource_count) : 0.0f;
+		break;
+	case ImportPhase::SavingDatabase:
+		label = "Saving the database...";
+		progress = 1.0f;
+		break;
+	case ImportPhase::Done:
+		label = "Loading the scene...";
+		progress = 1.0f;
+		break;
+	}
+
+	const auto em = this->ui.theme.font_size;
+	const auto size = float2(25.0f * em, 2.0f * em);
+	custom_ui::progress_bar(this->ui,
+		custom_ui::ProgressWidget{
+			.rect = fullscreen_rect.center(size),
+			.label = label,
+			.progress = progress,
+		});
+}
+
 void App::display_ui(double dt)
 {
 	EXO_PROFILE_SCOPE;
@@ -109,7 +157,7 @@ void App::display_ui(double dt)
 		this->ui.pop_clip_rect();
 	}
 
-	if (auto view_rect = docking::tabview(this->ui, this->docking, "Outliner"); view_rect) {
+	if (auto view_rect = docking::tabview(this->ui, this->docking, "Outliner"); view_rect && this->is_started) {
 		EXO_PROFILE_SCOPE_NAMED("Scene treeview");
 
 		static auto scene_scroll_offset = float2();
@@ -122,7 +170,7 @@ void App::display_ui(double dt)
 		this->ui.pop_clip_rect();
 	}
 
-	if (auto view_rect = docking::tabview(this->ui, this->docking, "Inspector"); view_rect) {
+	if (auto view_rect = docking::tabview(this->ui, this->docking, "Inspector"); view_rect && this->is_started) {
 		EXO_PROFILE_SCOPE_NAMED("Scene inspector");
 
 		static auto scene_inspector_scroll_offset = float2();
@@ -168,7 +216,7 @@ void App::display_ui(double dt)
 		this->ui.pop_clip_rect();
 	}
 
-	if (auto view_rect = docking::tabview(this->ui, this->docking, "Asset Manager"); view_rect) {
+	if (auto view_rect = docking::tabview(this->ui, this->docking, "Asset Manager"); view_rect && this->is_started) {
 		EXO_PROFILE_SCOPE_NAMED("Asset Manager");
 
 		auto content_rect = view_rect.value().inset(float2(1.0f * em));
@@ -184,24 +232,23 @@ void App::display_ui(double dt)
 		auto &scrollarea_rect = content_rect;
 		auto inner_content_rect = ui::begin_scroll_area(this->ui, scrollarea_rect, scroll_offset);
 		auto scroll_rectsplit = RectSplit{inner_content_rect, SplitDirection::Top};
-		for (auto [handle, p_resource] : this->asset_manager.database.resource_records) {
-
+		this->asset_manager.database.for_each_resource([&](const DatabaseIndexResource &resource) {
 			exo::StringView label;
-			if (p_resource->asset_id.is_valid()) {
+			if (resource.asset.name_hash != 0) {
 				label = exo::formatf(scope,
 					"name: \"%.*s\"",
-					p_resource->asset_id.name.len(),
-					p_resource->asset_id.name.data());
+					int(resource.asset.name.len()),
+					resource.asset.name.data());
 			} else {
 				label = exo::formatf(scope, "INVALID");
 			}
 			ui::label_split(this->ui, scroll_rectsplit, label);
 
-			label = exo::formatf(scope, "path: \"%s\"", p_resource->resource_path.view().data());
+			label = exo::formatf(scope, "path: \"%.*s\"", int(resource.path.len()), resource.path.data());
 			ui::label_split(this->ui, scroll_rectsplit, label);
 
 			scroll_rectsplit.split(1.0f * em);
-		}
+		});
 		ui::end_scroll_area(this->ui, inner_content_rect);
 
 		this->ui.pop_clip_rect();
@@ -221,6 +268,10 @@ void App::display_ui(double dt)
 
 	docking::end_docking(this->docking, this->ui);
 
+	if (!this->is_started) {
+		this->display_startup_progress(fullscreen_rect);
+	}
+
 	histogram.push_time(float(dt));
 	auto histogram_rect = Rect{
 		.pos =
@@ -279,6 +330,12 @@ void App::run()
 			break;
 		}
 
+		// The assets and the scene belong to the startup job until it is done
+		if (!this->is_started && this->startup_job->is_done()) {
+			this->startup_job = nullptr;
+			this->is_started = true;
+		}
+
 		if (!is_minimized) {
 			const u64 now = stm_now();
 			const u64 diff = stm_diff(now, last);
@@ -289,32 +346,42 @@ void App::run()
 			// UI
 			this->display_ui(dt);
 
-			// Assets streaming
-			this->asset_manager.update_async();
-
-			// Gameplay
-			this->scene.update(inputs);
-			this->render_world = std::move(
-				this->scene.entity_world.get_system_registry().get_system<PrepareRenderWorld>()->render_world);
-
-			// Render
-			this->render_world.main_camera_projection = camera::infinite_perspective(this->render_world.main_camera_fov,
-				this->viewport_size.x / this->viewport_size.y,
-				0.1f);
-
 			DrawInput draw_input = {};
-			draw_input.world_viewport_size = this->viewport_size;
-			draw_input.world = &this->render_world;
 			draw_input.painter = &this->painter;
+
+			if (this->is_started) {
+				// Assets streaming
+				this->asset_manager.update_async();
+
+				// Gameplay
+				this->scene.entity_world.get_system_registry().get_system<PrepareRenderWorld>()->viewport_height =
+					this->viewport_size.y;
+				this->scene.update(inputs);
+				this->render_world = std::move(
+					this->scene.entity_world.get_system_registry().get_system<PrepareRenderWorld>()->render_world);
+
+				// Render
+				this->render_world.main_camera_projection =
+					camera::infinite_perspective(this->render_world.main_camera_fov,
+						this->viewport_size.x / this->viewport_size.y,
+						0.1f);
+
+				draw_input.world_viewport_size = this->viewport_size;
+				draw_input.world = &this->render_world;
+			}
+
 			auto draw_result = this->renderer.draw(draw_input);
 
 			this->painter.glyph_atlas_gpu_idx = draw_result.glyph_atlas_index;
-			this->viewport_texture_index = draw_result.scene_viewport_index;
+			this->viewport_texture_index = this->is_started ? draw_result.scene_viewport_index : u32_invalid;
 		}
 
-		watcher.update([&](const cross::Watch & /*watch*/, const cross::WatchEvent & /*event*/) {
-			// this->asset_manager->on_file_change(watch, event);
-		});
+		// The events are kept by the watcher until the startup import is done
+		if (this->is_started) {
+			watcher.update([&](const cross::Watch &watch, const cross::WatchEvent &event) {
+				this->asset_manager.on_file_change(watch, event);
+			});
+		}
 
 		EXO_PROFILE_FRAMEMARK;
 	}
@@ -2,6 +2,7 @@
 #include "assets/asset_manager.h"
 #include "cross/file_watcher.h"
 #include "cross/jobmanager.h"
+#include "cross/jobs/waitable.h"
 #include "cross/window.h"
 #include "custom_ui.h"
 #include "engine/render_world.h"
@@ -32,12 +33,19 @@ public:
 
 private:
 	void display_ui(double dt);
+	void display_startup_progress(const Rect &fullscreen_rect);
 
 	cross::JobManager              jobmanager;
 	std::unique_ptr<cross::Window> window;
 	AssetManager                   asset_manager;
 	Renderer                       renderer;
 
+	// The resources are imported and the scene is loaded on a job, the assets and the scene are only used by the main
+	// thread once it is done
+	std::unique_ptr<cross::Waitable> startup_job;
+	ImportProgress                   startup_progress;
+	bool                             is_started = false;
+
 	// -- UI
 	Font                    ui_font;
 	Painter                 painter;
@@ -70,6 +70,17 @@ void histogram(ui::Ui &ui, FpsHistogramWidget widget)
 	ui.painter->draw_label(widget.rect, u32_invalid, *ui.theme.main_font, exo::formatf(scope, "%f", fps));
 }
 
+void progress_bar(ui::Ui &ui, ProgressWidget widget)
+{
+	ui.painter->draw_color_rect(widget.rect, u32_invalid, ColorU32::from_floats(0.0, 0.0, 0.0, 0.5));
+
+	auto filled_rect = widget.rect;
+	filled_rect.size.x *= std::clamp(widget.progress, 0.0f, 1.0f);
+	ui.painter->draw_color_rect(filled_rect, u32_invalid, ColorU32::from_floats(0.2f, 0.4f, 0.8f, 1.0f));
+
+	ui::label_in_rect(ui, widget.rect, widget.label);
+}
+
 void FpsHistogram::push_time(float dt)
 {
 	for (u32 i_time = 1; i_time < exo::Array::len(this->frame_times); ++i_time) {
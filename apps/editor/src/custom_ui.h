@@ -1,4 +1,5 @@
 #pragma once
+#include "exo/string_view.h"
 #include "painter/rect.h"
 
 namespace ui
@@ -20,4 +21,13 @@ struct FpsHistogramWidget
 };
 
 void histogram(ui::Ui &ui, FpsHistogramWidget widget);
+
+struct ProgressWidget
+{
+	Rect            rect;
+	exo::StringView label;
+	float           progress; // in [0, 1]
+};
+
+void progress_bar(ui::Ui &ui, ProgressWidget widget);
 } // namespace custom_ui
@@ -13,6 +13,7 @@
 #include "render/simple_renderer.h" // for FRAME_QUEUE_LENGTH...
 #include "render/vulkan/device.h"
 #include "render/vulkan/image.h"
+#include <algorithm>
 #include <bit>
 
 struct SubmeshDescriptor
@@ -26,12 +27,16 @@ static_assert(sizeof(SubmeshDescriptor) == sizeof(float4));
 
 struct MeshDescriptor
 {
-	u32 index_buffer_descriptor     = u32_invalid;
-	u32 positions_buffer_descriptor = u32_invalid;
-	u32 uvs_buffer_descriptor       = u32_invalid;
-	u32 submesh_buffer_descriptor   = u32_invalid;
+	u32    index_buffer_descriptor     = u32_invalid;
+	u32    positions_buffer_descriptor = u32_invalid;
+	u32    uvs_buffer_descriptor       = u32_invalid;
+	u32    submesh_buffer_descriptor   = u32_invalid;
+	float3 positions_decode_scale      = float3(1.0f);
+	u32    positions_format            = 0;
+	float3 positions_decode_offset     = float3(0.0f);
+	u32    uvs_format                  = 0;
 };
-static_assert(sizeof(MeshDescriptor) == sizeof(float4));
+static_assert(sizeof(MeshDescriptor) == 3 * sizeof(float4));
 
 PACKED(struct InstanceDescriptor {
 	float4x4 transform;
@@ -53,16 +58,23 @@ PACKED(struct MaterialDescriptor {
 	float  rotation                   = 0.0f;
 	float2 offset                     = float2(0.0f);
 	float2 scale                      = float2(1.0f);
-	float2 pad00;
+	u32    flags                      = 0;
+	u32    pad00                      = 0;
 })
 static_assert(sizeof(MaterialDescriptor) == 5 * sizeof(float4));
 
+// Matches MaterialDescriptor flags in editor/mesh.h
+inline constexpr u32 MATERIAL_NORMAL_TEXTURE_XY = 1;
+
+// Meshes that are not drawn for this many frames are destroyed, the assets they use can then be evicted
+inline constexpr u64 UNUSED_MESH_FRAMES = 120;
+
 MeshRenderer MeshRenderer::create(vulkan::Device &device)
 {
 	MeshRenderer renderer      = {};
-	renderer.mesh_uuid_map     = exo::Map<AssetId, Handle<RenderMesh>>::with_capacity(64);
-	renderer.material_uuid_map = exo::Map<AssetId, Handle<RenderMaterial>>::with_capacity(64);
-	renderer.texture_uuid_map  = exo::Map<AssetId, Handle<RenderTexture>>::with_capacity(64);
+	renderer.mesh_uuid_map     = exo::Map<AssetHandle, Handle<RenderMesh>>::with_capacity(64);
+	renderer.material_uuid_map = exo::Map<AssetHandle, Handle<RenderMaterial>>::with_capacity(64);
+	renderer.texture_uuid_map  = exo::Map<AssetHandle, Handle<RenderTexture>>::with_capacity(64);
 	renderer.instances_buffer  = RingBuffer::create(device,
 		 {
 			 .name               = "Instances buffer",
@@ -98,92 +110,249 @@ MeshRenderer MeshRenderer::create(vulkan::Device &device)
 	return renderer;
 }
 
-static Handle<RenderTexture> get_or_create_texture(
-	MeshRenderer &renderer, AssetManager *asset_manager, vulkan::Device &device, const AssetId &texture_uuid)
+static VkFormat to_vk_format(PixelFormat format)
 {
-	auto texture = asset_manager->load_asset_t<Texture>(texture_uuid);
-
-	auto *render_texture_handle = renderer.texture_uuid_map.at(texture_uuid);
-	if (render_texture_handle) {
-		return *render_texture_handle;
-	}
-
-	RenderTexture render_texture = {};
-	render_texture.texture_asset = texture_uuid;
-
 	VkFormat vk_format = VK_FORMAT_R8G8B8A8_UNORM;
-	switch (texture->format) {
+	switch (format) {
+	case PixelFormat::R8_UNORM: {
+		vk_format = VK_FORMAT_R8_UNORM;
+		break;
+	}
+	case PixelFormat::R8G8_UNORM: {
+		vk_format = VK_FORMAT_R8G8_UNORM;
+		break;
+	}
 	case PixelFormat::R8G8B8A8_UNORM: {
 		vk_format = VK_FORMAT_R8G8B8A8_UNORM;
 		break;
 	}
+	case PixelFormat::BC1_UNORM: {
+		vk_format = VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+		break;
+	}
+	case PixelFormat::BC3_UNORM: {
+		vk_format = VK_FORMAT_BC3_UNORM_BLOCK;
+		break;
+	}
+	case PixelFormat::BC4_UNORM: {
+		vk_format = VK_FORMAT_BC4_UNORM_BLOCK;
+		break;
+	}
+	case PixelFormat::BC5_UNORM: {
+		vk_format = VK_FORMAT_BC5_UNORM_BLOCK;
+		break;
+	}
+	case PixelFormat::BC7_UNORM: {
+		vk_format = VK_FORMAT_BC7_UNORM_BLOCK;
+		break;
+	}
+	case PixelFormat::R8G8B8A8_SRGB: {
+		vk_format = VK_FORMAT_R8G8B8A8_SRGB;
+		break;
+	}
+	case PixelFormat::BC1_SRGB: {
+		vk_format = VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+		break;
+	}
+	case PixelFormat::BC3_SRGB: {
+		vk_format = VK_FORMAT_BC3_SRGB_BLOCK;
+		break;
+	}
+	case PixelFormat::BC7_SRGB: {
+		vk_format = VK_FORMAT_BC7_SRGB_BLOCK;
+		break;
+	}
 	default: {
 		ASSERT(false);
 	}
 	}
 
-	ASSERT(texture->mip_offsets.len() == 1);
-	ASSERT(texture->levels == 1);
-	ASSERT(texture->depth == 1);
+	return vk_format;
+}
 
-	render_texture.image = device.create_image({
-		.name = texture->name,
-		.size =
-			{
-				texture->width,
-				texture->height,
-				texture->depth,
-			},
-		.format = vk_format,
-	});
+// The render resources are found from the asset handles, the asset ids are only used to create them
+
+static StreamedTextureDesc get_streamed_desc(const Texture &texture)
+{
+	ASSERT(texture.mip_offsets.len() == usize(texture.levels));
+	ASSERT(texture.depth == 1);
+
+	StreamedTextureDesc streamed_desc = {
+		.width  = u32(texture.width),
+		.height = u32(texture.height),
+	};
+	for (i32 i_level = 0; i_level < texture.levels; i_level += 1) {
+		const usize level_offset = texture.mip_offsets[usize(i_level)];
+		usize       level_end    = texture.pixels_data_size;
+		if (i_level + 1 < texture.levels) {
+			level_end = texture.mip_offsets[usize(i_level + 1)];
+		}
+		streamed_desc.level_sizes.push(level_end - level_offset);
+	}
+	return streamed_desc;
+}
+
+// Each call adds a user to the texture, `release_texture` removes it
+static Handle<RenderTexture> get_or_create_texture(
+	MeshRenderer &renderer, AssetManager *asset_manager, const AssetId &texture_uuid)
+{
+	const auto texture_handle = asset_manager->asset_names.intern(texture_uuid);
+
+	auto *render_texture_handle = renderer.texture_uuid_map.at(texture_handle);
+	if (render_texture_handle) {
+		renderer.render_textures.get(*render_texture_handle).user_count += 1;
+		return *render_texture_handle;
+	}
+
+	auto texture = asset_manager->load_asset_t<Texture>(texture_uuid);
+
+	// The image is created by the streamer when the first levels are uploaded
+	auto streamed_desc = get_streamed_desc(*texture);
+
+	// The texture asset is read again when its levels are streamed, keep it loaded
+	asset_manager->acquire_asset(texture_uuid);
+
+	RenderTexture render_texture = {};
+	render_texture.texture_asset = texture_handle;
+	render_texture.i_streamed    = renderer.texture_streamer.add_texture(std::move(streamed_desc));
+	render_texture.user_count    = 1;
+	const u32 i_streamed         = render_texture.i_streamed;
 
 	// Add the texture to the map
 	auto handle = renderer.render_textures.add(std::move(render_texture));
-	renderer.texture_uuid_map.insert(texture_uuid, handle);
+	renderer.texture_uuid_map.insert(texture_handle, handle);
+	if (i_streamed == renderer.streamed_textures.len()) {
+		renderer.streamed_textures.push(handle);
+	} else {
+		renderer.streamed_textures[i_streamed] = handle;
+	}
 	return handle;
 }
 
-static Handle<RenderMaterial> get_or_create_material(
-	MeshRenderer &renderer, AssetManager *asset_manager, vulkan::Device &device, const AssetId &material_uuid)
+// The last user destroys the texture and releases its asset, frames in flight can still sample its images
+static void release_texture(
+	MeshRenderer &renderer, AssetManager *asset_manager, Handle<RenderTexture> handle, u64 i_frame)
 {
-	auto material = asset_manager->load_asset_t<Material>(material_uuid);
+	auto &render_texture = renderer.render_textures.get(handle);
+	ASSERT(render_texture.user_count > 0);
+	render_texture.user_count -= 1;
+	if (render_texture.user_count > 0) {
+		return;
+	}
 
-	auto *render_material_handle = renderer.material_uuid_map.at(material_uuid);
-	if (render_material_handle) {
-		return *render_material_handle;
+	for (auto image : {render_texture.image, render_texture.previous_image}) {
+		if (image.is_valid()) {
+			renderer.retired_images.push(RetiredImage{
+				.image           = image,
+				.frame_destroyed = i_frame + FRAME_QUEUE_LENGTH,
+			});
+		}
 	}
+	renderer.texture_streamer.remove_texture(render_texture.i_streamed);
+	renderer.streamed_textures[render_texture.i_streamed] = {};
 
-	RenderMaterial render_material = {};
-	render_material.material_asset = material_uuid;
-	if (material->base_color_texture.is_valid()) {
+	asset_manager->release_asset(asset_manager->asset_names.get_id(render_texture.texture_asset));
+	renderer.texture_uuid_map.remove(render_texture.texture_asset);
+	renderer.render_textures.remove(handle);
+}
+
+// The replaced textures are kept until the material is uploaded again, its current descriptor still uses them
+static void set_material_textures(
+	MeshRenderer &renderer, AssetManager *asset_manager, const Material &material, RenderMaterial &render_material)
+{
+	for (auto texture_handle : {render_material.base_color_texture,
+			 render_material.normal_texture,
+			 render_material.metallic_roughness_texture}) {
+		if (texture_handle.is_valid()) {
+			render_material.previous_textures.push(texture_handle);
+		}
+	}
+
+	render_material.base_color_texture         = {};
+	render_material.normal_texture             = {};
+	render_material.metallic_roughness_texture = {};
+	if (material.base_color_texture.is_valid()) {
 		render_material.base_color_texture =
-			get_or_create_texture(renderer, asset_manager, device, material->base_color_texture);
+			get_or_create_texture(renderer, asset_manager, material.base_color_texture);
 	}
-	if (material->normal_texture.is_valid()) {
-		render_material.normal_texture =
-			get_or_create_texture(renderer, asset_manager, device, material->normal_texture);
+	if (material.normal_texture.is_valid()) {
+		render_material.normal_texture = get_or_create_texture(renderer, asset_manager, material.normal_texture);
 	}
-	if (material->metallic_roughness_texture.is_valid()) {
+	if (material.metallic_roughness_texture.is_valid()) {
 		render_material.metallic_roughness_texture =
-			get_or_create_texture(renderer, asset_manager, device, material->metallic_roughness_texture);
+			get_or_create_texture(renderer, asset_manager, material.metallic_roughness_texture);
+	}
+}
+
+static void release_previous_textures(
+	MeshRenderer &renderer, AssetManager *asset_manager, RenderMaterial &render_material, u64 i_frame)
+{
+	for (auto texture_handle : render_material.previous_textures) {
+		release_texture(renderer, asset_manager, texture_handle, i_frame);
+	}
+	render_material.previous_textures.clear();
+}
+
+// Each call adds a user to the material, `release_material` removes it
+static Handle<RenderMaterial> get_or_create_material(
+	MeshRenderer &renderer, AssetManager *asset_manager, const AssetId &material_uuid)
+{
+	const auto material_handle = asset_manager->asset_names.intern(material_uuid);
+
+	auto *render_material_handle = renderer.material_uuid_map.at(material_handle);
+	if (render_material_handle) {
+		renderer.render_materials.get(*render_material_handle).user_count += 1;
+		return *render_material_handle;
 	}
 
+	auto material = asset_manager->load_asset_t<Material>(material_uuid);
+
+	asset_manager->acquire_asset(material_uuid);
+
+	RenderMaterial render_material = {};
+	render_material.material_asset = material_handle;
+	render_material.user_count     = 1;
+	set_material_textures(renderer, asset_manager, *material, render_material);
+
 	// Add the material to the map
 	auto handle = renderer.render_materials.add(std::move(render_material));
-	renderer.material_uuid_map.insert(material_uuid, handle);
+	renderer.material_uuid_map.insert(material_handle, handle);
 	return handle;
 }
 
-static Handle<RenderMesh> get_or_create_mesh(
-	MeshRenderer &renderer, AssetManager *asset_manager, vulkan::Device &device, const AssetId &mesh_uuid)
+// The last user destroys the material and releases its textures and its asset
+static void release_material(
+	MeshRenderer &renderer, AssetManager *asset_manager, Handle<RenderMaterial> handle, u64 i_frame)
 {
-	ASSERT(asset_manager->is_loaded(mesh_uuid));
-	auto mesh = asset_manager->load_asset_t<Mesh>(mesh_uuid);
+	auto &render_material = renderer.render_materials.get(handle);
+	ASSERT(render_material.user_count > 0);
+	render_material.user_count -= 1;
+	if (render_material.user_count > 0) {
+		return;
+	}
 
-	auto *render_mesh_handle = renderer.mesh_uuid_map.at(mesh_uuid);
-	if (render_mesh_handle) {
-		return *render_mesh_handle;
+	for (auto texture_handle : {render_material.base_color_texture,
+			 render_material.normal_texture,
+			 render_material.metallic_roughness_texture}) {
+		if (texture_handle.is_valid()) {
+			release_texture(renderer, asset_manager, texture_handle, i_frame);
+		}
 	}
+	release_previous_textures(renderer, asset_manager, render_material, i_frame);
+
+	asset_manager->release_asset(asset_manager->asset_names.get_id(render_material.material_asset));
+	renderer.material_uuid_map.remove(render_material.material_asset);
+	renderer.render_materials.remove(handle);
+}
+
+static RenderMesh create_render_mesh(
+	MeshRenderer &renderer, AssetManager *asset_manager, vulkan::Device &device, AssetHandle mesh_handle)
+{
+	const auto &mesh_uuid = asset_manager->asset_names.get_id(mesh_handle);
+	auto        mesh      = asset_manager->load_asset_t<Mesh>(mesh_uuid);
+
+	// Released by `destroy_render_mesh`
+	asset_manager->acquire_asset(mesh_uuid);
 
 	RenderMesh render_mesh   = {};
 	render_mesh.index_buffer = device.create_buffer({
@@ -210,10 +379,11 @@ static Handle<RenderMesh> get_or_create_mesh(
 		.usage = vulkan::storage_buffer_usage,
 	});
 
-	render_mesh.mesh_asset = mesh_uuid;
+	render_mesh.mesh_asset = mesh_handle;
+	render_mesh.index_type = mesh->indices_format == IndexFormat::U16 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
 
 	for (const auto &submesh : mesh->submeshes) {
-		auto render_material_handle = get_or_create_material(renderer, asset_manager, device, submesh.material);
+		auto render_material_handle = get_or_create_material(renderer, asset_manager, submesh.material);
 
 		render_mesh.render_submeshes.push(RenderSubmesh{
 			.material    = render_material_handle,
@@ -222,11 +392,211 @@ static Handle<RenderMesh> get_or_create_mesh(
 		});
 	}
 
-	auto handle = renderer.render_meshes.add(std::move(render_mesh));
-	renderer.mesh_uuid_map.insert(mesh_uuid, handle);
+	render_mesh.lod_count = mesh->get_lod_count();
+	for (const auto &lod : mesh->lods) {
+		render_mesh.submesh_lods.push(RenderSubmeshLod{
+			.index_count = lod.index_count,
+			.first_index = lod.first_index,
+		});
+	}
+
+	return render_mesh;
+}
+
+static Handle<RenderMesh> get_or_create_mesh(
+	MeshRenderer &renderer, AssetManager *asset_manager, vulkan::Device &device, AssetHandle mesh_handle)
+{
+	auto *render_mesh_handle = renderer.mesh_uuid_map.at(mesh_handle);
+	if (render_mesh_handle) {
+		return *render_mesh_handle;
+	}
+
+	ASSERT(asset_manager->is_loaded(asset_manager->asset_names.get_id(mesh_handle)));
+
+	auto handle = renderer.render_meshes.add(create_render_mesh(renderer, asset_manager, device, mesh_handle));
+	renderer.mesh_uuid_map.insert(mesh_handle, handle);
 	return handle;
 }
 
+static void destroy_render_mesh(MeshRenderer &renderer,
+	AssetManager                             *asset_manager,
+	vulkan::Device                           &device,
+	Handle<RenderMesh>                        handle,
+	u64                                       i_frame)
+{
+	const auto &render_mesh = renderer.render_meshes.get(handle);
+	device.destroy_buffer(render_mesh.index_buffer);
+	device.destroy_buffer(render_mesh.positions_buffer);
+	device.destroy_buffer(render_mesh.uvs_buffer);
+	device.destroy_buffer(render_mesh.submesh_buffer);
+	for (const auto &submesh : render_mesh.render_submeshes) {
+		if (submesh.material.is_valid()) {
+			release_material(renderer, asset_manager, submesh.material, i_frame);
+		}
+	}
+	asset_manager->release_asset(asset_manager->asset_names.get_id(render_mesh.mesh_asset));
+	renderer.render_meshes.remove(handle);
+}
+
+// The assets imported again this frame are patched without waiting for the GPU: the previous buffers and images are
+// used until their replacement is uploaded, then destroyed once the frames using them are done
+static void patch_reimported_assets(
+	MeshRenderer &renderer, AssetManager *asset_manager, vulkan::Device &device, u64 i_frame)
+{
+	for (const auto &id : asset_manager->reimported_assets) {
+		const auto handle = AssetHandle::from_id(id);
+
+		if (auto *render_texture_handle = renderer.texture_uuid_map.at(handle)) {
+			const auto &render_texture = renderer.render_textures.get(*render_texture_handle);
+			auto       *texture        = asset_manager->load_asset_t<Texture>(id);
+			renderer.texture_streamer.replace_texture(render_texture.i_streamed, get_streamed_desc(*texture));
+		}
+
+		if (auto *render_material_handle = renderer.material_uuid_map.at(handle)) {
+			auto &render_material = renderer.render_materials.get(*render_material_handle);
+			auto *material        = asset_manager->load_asset_t<Material>(id);
+			set_material_textures(renderer, asset_manager, *material, render_material);
+			render_material.is_uploaded = false;
+		}
+
+		if (auto *render_mesh_handle = renderer.mesh_uuid_map.at(handle)) {
+			// The new replacement supersedes a replacement that is not uploaded yet, it is retired like the meshes used
+			// by the frames in flight
+			for (auto [mesh_handle, p_render_mesh] : renderer.render_meshes) {
+				if (p_render_mesh->previous_mesh == *render_mesh_handle) {
+					p_render_mesh->previous_mesh = {};
+					renderer.retired_meshes.push(RetiredMesh{
+						.mesh            = mesh_handle,
+						.frame_destroyed = i_frame + FRAME_QUEUE_LENGTH,
+					});
+				}
+			}
+
+			auto replacement          = create_render_mesh(renderer, asset_manager, device, handle);
+			replacement.previous_mesh = *render_mesh_handle;
+			renderer.render_meshes.add(std::move(replacement));
+		}
+	}
+}
+
+// Applies the residency changes of the texture streamer: the image of a texture is recreated with its resident levels,
+// the levels that were already resident are copied from the previous image and only the new ones are uploaded
+struct RenderTextureUploader final : TextureResidencyUploader
+{
+	MeshRenderer   &renderer;
+	vulkan::Device &device;
+	RingBuffer     &upload_buffer;
+	AssetManager   *asset_manager;
+	u64             i_frame;
+
+	RenderTextureUploader(MeshRenderer &_renderer,
+		vulkan::Device                 &_device,
+		RingBuffer                     &_upload_buffer,
+		AssetManager                   *_asset_manager,
+		u64                             _i_frame)
+		: renderer{_renderer}, device{_device}, upload_buffer{_upload_buffer}, asset_manager{_asset_manager},
+		  i_frame{_i_frame}
+	{
+	}
+
+	bool set_resident_levels(u32 i_streamed, u32 first_level, u32 resident_first_level) override
+	{
+		const auto render_texture_handle = this->renderer.streamed_textures[i_streamed];
+		auto      &render_texture        = this->renderer.render_textures.get(render_texture_handle);
+
+		// Materials still sample the image replaced by the previous change
+		if (render_texture.previous_image.is_valid()) {
+			return false;
+		}
+
+		const auto &texture_id = this->asset_manager->asset_names.get_id(render_texture.texture_asset);
+		auto       *texture    = this->asset_manager->load_asset_t<Texture>(texture_id);
+
+		// Levels [first_level, first_kept_level) are uploaded, the others are copied from the current image
+		const u32 first_kept_level = std::max(first_level, resident_first_level);
+		ASSERT(first_kept_level == u32(texture->levels) || render_texture.image.is_valid());
+
+		const usize first_offset = texture->mip_offsets[first_level];
+		usize       kept_offset  = texture->pixels_data_size;
+		if (first_kept_level < u32(texture->levels)) {
+			kept_offset = texture->mip_offsets[first_kept_level];
+		}
+
+		usize upload_offset = 0;
+		if (first_level < first_kept_level) {
+			auto [p_upload_data, offset] = this->upload_buffer.allocate(kept_offset - first_offset);
+			if (p_upload_data.empty()) {
+				return false;
+			}
+			upload_offset = offset;
+
+			printf("[Renderer] Uploading texture asset %s levels %u-%u at offset 0x%zx frame #%u\n",
+				texture->uuid.name.c_str(),
+				first_level,
+				first_kept_level - 1,
+				upload_offset,
+				this->upload_buffer.i_frame);
+
+			this->asset_manager->read_blob_range(texture->pixels_hash, first_offset, p_upload_data);
+		}
+
+		const auto image = this->device.create_image({
+			.name = texture->name,
+			.size =
+				{
+					std::max(1, texture->width >> first_level),
+					std::max(1, texture->height >> first_level),
+					texture->depth,
+				},
+			.mip_levels = u32(texture->levels) - first_level,
+			.format     = to_vk_format(texture->format),
+		});
+
+		// The levels are contiguous in the blob, copy each one to its mip
+		for (i32 i_level = i32(first_level); i_level < texture->levels; i_level += 1) {
+			const usize level_offset = texture->mip_offsets[usize(i_level)];
+			usize       level_end    = texture->pixels_data_size;
+			if (i_level + 1 < texture->levels) {
+				level_end = texture->mip_offsets[usize(i_level + 1)];
+			}
+
+			const int3 level_extent = int3(std::max(1, texture->width >> i_level),
+				std::max(1, texture->height >> i_level),
+				std::max(1, texture->depth >> i_level));
+
+			RenderImageUpload upload = {
+				.dst_image = image,
+				.level     = u32(i_level) - first_level,
+				.extent    = level_extent,
+			};
+			if (u32(i_level) < first_kept_level) {
+				upload.upload_offset = upload_offset + (level_offset - first_offset);
+				upload.upload_size   = level_end - level_offset;
+			} else {
+				upload.src_image = render_texture.image;
+				upload.src_level = u32(i_level) - render_texture.first_level;
+			}
+			this->renderer.image_uploads.push(upload);
+		}
+
+		// The materials using the texture get the new image once it is uploaded
+		if (render_texture.image.is_valid()) {
+			render_texture.previous_image = render_texture.image;
+			for (auto [material_handle, p_render_material] : this->renderer.render_materials) {
+				if (p_render_material->base_color_texture == render_texture_handle ||
+					p_render_material->normal_texture == render_texture_handle ||
+					p_render_material->metallic_roughness_texture == render_texture_handle) {
+					p_render_material->is_uploaded = false;
+				}
+			}
+		}
+		render_texture.image          = image;
+		render_texture.first_level    = first_level;
+		render_texture.frame_uploaded = this->i_frame + 3;
+		return true;
+	}
+};
+
 void register_upload_nodes(RenderGraph &graph,
 	MeshRenderer                       &mesh_renderer,
 	vulkan::Device                     &device,
@@ -237,10 +607,30 @@ void register_upload_nodes(RenderGraph &graph,
 	mesh_renderer.instances_buffer.start_frame();
 	mesh_renderer.drawcalls.clear();
 
+	patch_reimported_assets(mesh_renderer, asset_manager, device, graph.i_frame);
+
 	// Gather instances of uploaded meshes
 	for (const auto &instance : world.drawable_instances) {
-		auto        render_mesh_handle = get_or_create_mesh(mesh_renderer, asset_manager, device, instance.mesh_asset);
-		const auto &render_mesh        = mesh_renderer.render_meshes.get(render_mesh_handle);
+		auto  render_mesh_handle    = get_or_create_mesh(mesh_renderer, asset_manager, device, instance.mesh_asset);
+		auto &render_mesh           = mesh_renderer.render_meshes.get(render_mesh_handle);
+		render_mesh.last_used_frame = graph.i_frame;
+
+		// Stream the texture levels needed at the projected size of the instance
+		for (const auto &submesh : render_mesh.render_submeshes) {
+			if (!submesh.material.is_valid()) {
+				continue;
+			}
+			const auto &render_material = mesh_renderer.render_materials.get(submesh.material);
+			for (auto texture_handle : {render_material.base_color_texture,
+					 render_material.normal_texture,
+					 render_material.metallic_roughness_texture}) {
+				if (texture_handle.is_valid()) {
+					const auto &render_texture = mesh_renderer.render_textures.get(texture_handle);
+					mesh_renderer.texture_streamer.request(render_texture.i_streamed, instance.screen_size);
+				}
+			}
+		}
+
 		if (!render_mesh.is_uploaded) {
 			continue;
 		}
@@ -254,46 +644,56 @@ void register_upload_nodes(RenderGraph &graph,
 
 		ASSERT(instance_bytes_offset % sizeof(InstanceDescriptor) == 0);
 
+		const u32 lod = std::min(instance.lod, render_mesh.lod_count - 1);
 		for (u32 i_submesh = 0; i_submesh < render_mesh.render_submeshes.len(); ++i_submesh) {
-			const auto &submesh = render_mesh.render_submeshes[i_submesh];
+			const auto &submesh     = render_mesh.render_submeshes[i_submesh];
+			u32         index_count = submesh.index_count;
+			u32         first_index = submesh.first_index;
+			if (lod > 0) {
+				const auto &submesh_lod = render_mesh.submesh_lods[i_submesh * render_mesh.lod_count + lod];
+				index_count             = submesh_lod.index_count;
+				first_index             = submesh_lod.first_index;
+			}
+
 			mesh_renderer.drawcalls.push(SimpleDraw{
 				.instance_offset = static_cast<u32>(instance_bytes_offset / sizeof(InstanceDescriptor)),
 				.instance_count  = 1,
-				.index_count     = submesh.index_count,
-				.index_offset    = submesh.first_index,
+				.index_count     = index_count,
+				.index_offset    = first_index,
 				.index_buffer    = render_mesh.index_buffer,
+				.index_type      = render_mesh.index_type,
 				.i_submesh       = i_submesh,
 			});
 		}
 	}
 
-	// Upload new textures
-	for (auto [handle, p_render_texture] : mesh_renderer.render_textures) {
-		if (p_render_texture->frame_uploaded == u64_invalid) {
-
-			auto *texture                       = asset_manager->load_asset_t<Texture>(p_render_texture->texture_asset);
-			auto [p_upload_data, upload_offset] = upload_buffer.allocate(texture->pixels_data_size);
-
-			if (p_upload_data.empty()) {
-				continue;
-			}
-
-			printf("[Renderer] Uploading texture asset %s at offset 0x%zx frame #%u\n",
-				texture->uuid.name.c_str(),
-				upload_offset,
-				upload_buffer.i_frame);
-
-			asset_manager->read_blob(texture->pixels_hash, p_upload_data);
-			mesh_renderer.image_uploads.push(RenderImageUpload{
-				.dst_image     = p_render_texture->image,
-				.upload_offset = upload_offset,
-				.upload_size   = texture->pixels_data_size,
-				.extent        = int3(texture->width, texture->height, texture->depth),
+	// Meshes that are no longer drawn are destroyed once the frames using them are done, this releases their assets
+	for (auto [handle, p_render_mesh] : mesh_renderer.render_meshes) {
+		const auto *current_handle = mesh_renderer.mesh_uuid_map.at(p_render_mesh->mesh_asset);
+		if (current_handle && *current_handle == handle &&
+			p_render_mesh->last_used_frame + UNUSED_MESH_FRAMES <= graph.i_frame) {
+			mesh_renderer.mesh_uuid_map.remove(p_render_mesh->mesh_asset);
+			mesh_renderer.retired_meshes.push(RetiredMesh{
+				.mesh            = handle,
+				.frame_destroyed = graph.i_frame + FRAME_QUEUE_LENGTH,
+			});
+		}
+	}
+	// The pending replacements of these meshes are not needed anymore
+	for (auto [handle, p_render_mesh] : mesh_renderer.render_meshes) {
+		if (p_render_mesh->previous_mesh.is_valid() && !mesh_renderer.mesh_uuid_map.at(p_render_mesh->mesh_asset)) {
+			p_render_mesh->previous_mesh = {};
+			mesh_renderer.retired_meshes.push(RetiredMesh{
+				.mesh            = handle,
+				.frame_destroyed = graph.i_frame + FRAME_QUEUE_LENGTH,
 			});
-			p_render_texture->frame_uploaded = graph.i_frame + 3;
 		}
 	}
 
+	// Upload the resident texture levels
+	RenderTextureUploader texture_uploader{mesh_renderer, device, upload_buffer, asset_manager, graph.i_frame};
+	mesh_renderer.texture_streamer.update(texture_uploader);
+
 	// Upload new materials
 	for (auto [handle, p_render_material] : mesh_renderer.render_materials) {
 		auto is_texture_uploaded = [&](MeshRenderer &mesh_renderer, Handle<RenderTexture> texture_handle) -> bool {
@@ -312,8 +712,9 @@ void register_upload_nodes(RenderGraph &graph,
 				continue;
 			}
 
-			auto *material_asset    = asset_manager->load_asset_t<Material>(p_render_material->material_asset);
-			auto  p_upload_material = exo::reinterpret_span<MaterialDescriptor>(p_upload_data);
+			const auto &material_id       = asset_manager->asset_names.get_id(p_render_material->material_asset);
+			auto       *material_asset    = asset_manager->load_asset_t<Material>(material_id);
+			auto        p_upload_material = exo::reinterpret_span<MaterialDescriptor>(p_upload_data);
 
 			printf("[Renderer] Uploading material asset %s at offset 0x%zx frame #%u\n",
 				material_asset->uuid.name.c_str(),
@@ -334,8 +735,13 @@ void register_upload_nodes(RenderGraph &graph,
 				p_upload_material[0].base_color_texture = device.get_image_sampled_index(image);
 			}
 			if (p_render_material->normal_texture.is_valid()) {
-				auto image = mesh_renderer.render_textures.get(p_render_material->normal_texture).image;
-				p_upload_material[0].normal_texture = device.get_image_sampled_index(image);
+				const auto &render_texture = mesh_renderer.render_textures.get(p_render_material->normal_texture);
+				const auto &texture_id     = asset_manager->asset_names.get_id(render_texture.texture_asset);
+				const auto  format         = asset_manager->load_asset_t<Texture>(texture_id)->format;
+				p_upload_material[0].normal_texture = device.get_image_sampled_index(render_texture.image);
+				if (format == PixelFormat::BC5_UNORM || format == PixelFormat::R8G8_UNORM) {
+					p_upload_material[0].flags |= MATERIAL_NORMAL_TEXTURE_XY;
+				}
 			}
 			if (p_render_material->metallic_roughness_texture.is_valid()) {
 				auto image = mesh_renderer.render_textures.get(p_render_material->metallic_roughness_texture).image;
@@ -350,12 +756,49 @@ void register_upload_nodes(RenderGraph &graph,
 			});
 
 			p_render_material->is_uploaded = true;
+			release_previous_textures(mesh_renderer, asset_manager, *p_render_material, graph.i_frame);
 			break;
 		}
 	}
 
-	// Upload new meshes
+	// Destroy the images replaced by the streamer once no material uses them and the GPU is done with them
+	for (auto [handle, p_render_texture] : mesh_renderer.render_textures) {
+		if (!p_render_texture->previous_image.is_valid()) {
+			continue;
+		}
+
+		bool is_used = false;
+		for (auto [material_handle, p_render_material] : mesh_renderer.render_materials) {
+			const bool uses_texture = p_render_material->base_color_texture == handle ||
+			                          p_render_material->normal_texture == handle ||
+			                          p_render_material->metallic_roughness_texture == handle;
+			is_used = is_used || (uses_texture && !p_render_material->is_uploaded);
+		}
+
+		if (!is_used) {
+			mesh_renderer.retired_images.push(RetiredImage{
+				.image           = p_render_texture->previous_image,
+				.frame_destroyed = graph.i_frame + FRAME_QUEUE_LENGTH,
+			});
+			p_render_texture->previous_image = {};
+		}
+	}
+	for (usize i_retired = 0; i_retired < mesh_renderer.retired_images.len();) {
+		if (mesh_renderer.retired_images[i_retired].frame_destroyed <= graph.i_frame) {
+			device.destroy_image(mesh_renderer.retired_images[i_retired].image);
+			mesh_renderer.retired_images.swap_remove(i_retired);
+		} else {
+			i_retired += 1;
+		}
+	}
+
+	// Upload new meshes, the retired meshes that were never uploaded are skipped
 	for (auto [handle, p_render_mesh] : mesh_renderer.render_meshes) {
+		const auto *current_handle = mesh_renderer.mesh_uuid_map.at(p_render_mesh->mesh_asset);
+		if (!p_render_mesh->previous_mesh.is_valid() && !(current_handle && *current_handle == handle)) {
+			continue;
+		}
+
 		bool materials_uploaded = true;
 		for (u32 i_submesh = 0; i_submesh < p_render_mesh->render_submeshes.len() && materials_uploaded; ++i_submesh) {
 			const auto &render_submesh = p_render_mesh->render_submeshes[i_submesh];
@@ -378,7 +821,8 @@ void register_upload_nodes(RenderGraph &graph,
 				continue;
 			}
 
-			auto *mesh_asset = asset_manager->load_asset_t<Mesh>(p_render_mesh->mesh_asset);
+			const auto &mesh_id    = asset_manager->asset_names.get_id(p_render_mesh->mesh_asset);
+			auto       *mesh_asset = asset_manager->load_asset_t<Mesh>(mesh_id);
 			printf("[Renderer] Uploading mesh asset %s at offset 0x%zx frame #%u\n",
 				mesh_asset->uuid.name.c_str(),
 				upload_offset,
@@ -434,6 +878,10 @@ void register_upload_nodes(RenderGraph &graph,
 			p_upload_descriptor[0].uvs_buffer_descriptor = device.get_buffer_storage_index(p_render_mesh->uvs_buffer);
 			p_upload_descriptor[0].submesh_buffer_descriptor =
 				device.get_buffer_storage_index(p_render_mesh->submesh_buffer);
+			p_upload_descriptor[0].positions_decode_scale  = mesh_asset->positions_decode_scale;
+			p_upload_descriptor[0].positions_format        = u32(mesh_asset->positions_format);
+			p_upload_descriptor[0].positions_decode_offset = mesh_asset->positions_decode_offset;
+			p_upload_descriptor[0].uvs_format              = u32(mesh_asset->uvs_format);
 			mesh_renderer.buffer_uploads.push(RenderUploads{
 				.dst_buffer    = mesh_renderer.meshes_buffer,
 				.dst_offset    = handle.get_index() * sizeof(MeshDescriptor),
@@ -442,39 +890,92 @@ void register_upload_nodes(RenderGraph &graph,
 			});
 
 			p_render_mesh->is_uploaded = true;
+
+			// The instances use the replacement from the next frame, the frames in flight still use the previous mesh
+			if (p_render_mesh->previous_mesh.is_valid()) {
+				*mesh_renderer.mesh_uuid_map.at(p_render_mesh->mesh_asset) = handle;
+				mesh_renderer.retired_meshes.push(RetiredMesh{
+					.mesh            = p_render_mesh->previous_mesh,
+					.frame_destroyed = graph.i_frame + FRAME_QUEUE_LENGTH,
+				});
+				p_render_mesh->previous_mesh = {};
+			}
 			break;
 		}
 	}
+	for (usize i_retired = 0; i_retired < mesh_renderer.retired_meshes.len();) {
+		const auto &retired = mesh_renderer.retired_meshes[i_retired];
+		if (retired.frame_destroyed <= graph.i_frame) {
+			destroy_render_mesh(mesh_renderer, asset_manager, device, retired.mesh, graph.i_frame);
+			mesh_renderer.retired_meshes.swap_remove(i_retired);
+		} else {
+			i_retired += 1;
+		}
+	}
 
 	// Submit upload commands
 	if (!mesh_renderer.image_uploads.is_empty()) {
 		exo::Span<RenderImageUpload> uploads_span = mesh_renderer.image_uploads;
 		graph.raw_pass([uploads_span](RenderGraph & /*graph*/, PassApi &api, vulkan::ComputeWork &cmd) {
-			for (const auto &upload : uploads_span) {
-				auto copy = VkBufferImageCopy{
-					.bufferOffset = upload.upload_offset,
-					.imageSubresource =
-						{
-							.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-							.layerCount = 1,
-						},
-					.imageOffset =
-						{
-							.x = 0,
-							.y = 0,
-							.z = 0,
-						},
-					.imageExtent =
-						{
-							.width  = u32(upload.extent.x),
-							.height = u32(upload.extent.y),
-							.depth  = u32(upload.extent.z),
-						},
-				};
-
-				cmd.barrier(upload.dst_image, vulkan::ImageUsage::TransferDst);
-				cmd.copy_buffer_to_image(api.upload_buffer.buffer, upload.dst_image, exo::Span{&copy, 1});
-				cmd.barrier(upload.dst_image, vulkan::ImageUsage::GraphicsShaderRead);
+			// Uploads of the same image are consecutive, batch their copies between a single pair of barriers
+			Vec<VkBufferImageCopy> copies;
+			Vec<VkImageCopy>       image_copies;
+			Handle<vulkan::Image>  src_image = {};
+			for (usize i_upload = 0; i_upload < uploads_span.len(); i_upload += 1) {
+				const auto &upload = uploads_span[i_upload];
+				const VkExtent3D extent = {u32(upload.extent.x), u32(upload.extent.y), u32(upload.extent.z)};
+				if (upload.src_image.is_valid()) {
+					src_image = upload.src_image;
+					image_copies.push(VkImageCopy{
+						.srcSubresource =
+							{
+								.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+								.mipLevel   = upload.src_level,
+								.layerCount = 1,
+							},
+						.dstSubresource =
+							{
+								.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+								.mipLevel   = upload.level,
+								.layerCount = 1,
+							},
+						.extent = extent,
+					});
+				} else {
+					copies.push(VkBufferImageCopy{
+						.bufferOffset = upload.upload_offset,
+						.imageSubresource =
+							{
+								.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+								.mipLevel   = upload.level,
+								.layerCount = 1,
+							},
+						.imageOffset =
+							{
+								.x = 0,
+								.y = 0,
+								.z = 0,
+							},
+						.imageExtent = extent,
+					});
+				}
+
+				const bool is_last_copy =
+					i_upload + 1 == uploads_span.len() || uploads_span[i_upload + 1].dst_image != upload.dst_image;
+				if (is_last_copy) {
+					cmd.barrier(upload.dst_image, vulkan::ImageUsage::TransferDst);
+					if (!image_copies.is_empty()) {
+						cmd.barrier(src_image, vulkan::ImageUsage::TransferSrc);
+						cmd.copy_image(src_image, upload.dst_image, image_copies);
+						cmd.barrier(src_image, vulkan::ImageUsage::GraphicsShaderRead);
+					}
+					if (!copies.is_empty()) {
+						cmd.copy_buffer_to_image(api.upload_buffer.buffer, upload.dst_image, copies);
+					}
+					cmd.barrier(upload.dst_image, vulkan::ImageUsage::GraphicsShaderRead);
+					copies.clear();
+					image_copies.clear();
+				}
 			}
 		});
 		mesh_renderer.image_uploads.clear();
@@ -547,7 +1048,7 @@ void register_graphics_nodes(RenderGraph &graph, MeshRenderer &mesh_renderer, Ha
 				cmd.bind_pipeline(simple_program, 0);
 
 				if (drawcall.index_buffer != last_index_buffer) {
-					cmd.bind_index_buffer(drawcall.index_buffer, VK_INDEX_TYPE_UINT32, 0);
+					cmd.bind_index_buffer(drawcall.index_buffer, drawcall.index_type, 0);
 					last_index_buffer = drawcall.index_buffer;
 				}
 
@@ -10,7 +10,8 @@
 #include "render/vulkan/buffer.h"
 #include "render/vulkan/pipelines.h"
 
-#include "assets/asset_id.h"
+#include "assets/asset_handle.h"
+#include "assets/texture_streaming.h"
 
 struct RenderWorld;
 struct AssetManager;
@@ -31,28 +32,46 @@ struct RenderUploads
 	usize                  upload_size   = 0;
 };
 
+// A level is either copied from the upload buffer or from a level of `src_image` when it is valid
 struct RenderImageUpload
 {
 	Handle<vulkan::Image> dst_image     = {};
+	u32                   level         = 0;
 	usize                 upload_offset = 0;
 	usize                 upload_size   = 0;
 	int3                  extent        = int3(1, 1, 1);
+	Handle<vulkan::Image> src_image     = {};
+	u32                   src_level     = 0;
 };
 
 struct RenderTexture
 {
-	AssetId               texture_asset  = {};
-	Handle<vulkan::Image> image          = {};
+	AssetHandle           texture_asset  = {};
+	Handle<vulkan::Image> image          = {}; // contains the resident levels, invalid until the tail is uploaded
+	Handle<vulkan::Image> previous_image = {}; // replaced image, kept until the materials using it are updated
 	u64                   frame_uploaded = u64_invalid;
+	u32                   i_streamed     = u32_invalid; // index of the texture in the streamer
+	u32                   first_level    = 0;           // texture level stored in the first level of `image`
+	u32                   user_count     = 0;           // materials using the texture, it is destroyed at 0
+};
+
+struct RetiredImage
+{
+	Handle<vulkan::Image> image;
+	u64                   frame_destroyed;
 };
 
 struct RenderMaterial
 {
-	AssetId               material_asset             = {};
+	AssetHandle           material_asset             = {};
 	Handle<RenderTexture> base_color_texture         = {};
 	Handle<RenderTexture> normal_texture             = {};
 	Handle<RenderTexture> metallic_roughness_texture = {};
 	bool                  is_uploaded                = false;
+	u32                   user_count                 = 0; // submeshes using the material, it is destroyed at 0
+
+	// Textures replaced by a reimport, the uploaded descriptor uses them until the material is uploaded again
+	Vec<Handle<RenderTexture>> previous_textures = {};
 };
 
 struct RenderSubmesh
@@ -62,15 +81,32 @@ struct RenderSubmesh
 	u32                    first_index = 0;
 };
 
+struct RenderSubmeshLod
+{
+	u32 index_count = 0;
+	u32 first_index = 0;
+};
+
 struct RenderMesh
 {
-	AssetId                mesh_asset       = {};
+	AssetHandle            mesh_asset       = {};
 	Handle<vulkan::Buffer> index_buffer     = {};
 	Handle<vulkan::Buffer> positions_buffer = {};
 	Handle<vulkan::Buffer> uvs_buffer       = {};
 	Handle<vulkan::Buffer> submesh_buffer   = {};
+	VkIndexType            index_type       = VK_INDEX_TYPE_UINT32;
 	Vec<RenderSubmesh>     render_submeshes = {};
+	u32                    lod_count        = 1;
+	Vec<RenderSubmeshLod>  submesh_lods     = {}; // lod_count entries per submesh, empty without LODs
 	bool                   is_uploaded      = false;
+	Handle<RenderMesh>     previous_mesh    = {}; // mesh replaced by this one once it is uploaded
+	u64                    last_used_frame  = 0;
+};
+
+struct RetiredMesh
+{
+	Handle<RenderMesh> mesh;
+	u64                frame_destroyed;
 };
 
 struct BlobReadRequest
@@ -88,23 +124,28 @@ struct SimpleDraw
 	u32                    index_count;
 	u32                    index_offset;
 	Handle<vulkan::Buffer> index_buffer;
-	u32                    i_submesh = 0;
+	VkIndexType            index_type = VK_INDEX_TYPE_UINT32;
+	u32                    i_submesh  = 0;
 };
 
 struct MeshRenderer
 {
-	exo::Map<AssetId, Handle<RenderMesh>> mesh_uuid_map;
-	exo::Pool<RenderMesh>                 render_meshes;
-	Handle<vulkan::Buffer>                meshes_buffer;
-	u32                                   meshes_descriptor = u32_invalid;
-
-	exo::Map<AssetId, Handle<RenderMaterial>> material_uuid_map;
-	exo::Pool<RenderMaterial>                 render_materials;
-	Handle<vulkan::Buffer>                    materials_buffer;
-	u32                                       materials_descriptor = u32_invalid;
-
-	exo::Map<AssetId, Handle<RenderTexture>> texture_uuid_map;
-	exo::Pool<RenderTexture>                 render_textures;
+	exo::Map<AssetHandle, Handle<RenderMesh>> mesh_uuid_map;
+	exo::Pool<RenderMesh>                     render_meshes;
+	Handle<vulkan::Buffer>                    meshes_buffer;
+	u32                                       meshes_descriptor = u32_invalid;
+	Vec<RetiredMesh>                          retired_meshes;
+
+	exo::Map<AssetHandle, Handle<RenderMaterial>> material_uuid_map;
+	exo::Pool<RenderMaterial>                     render_materials;
+	Handle<vulkan::Buffer>                        materials_buffer;
+	u32                                           materials_descriptor = u32_invalid;
+
+	exo::Map<AssetHandle, Handle<RenderTexture>> texture_uuid_map;
+	exo::Pool<RenderTexture>                     render_textures;
+	TextureStreamer                              texture_streamer;
+	Vec<Handle<RenderTexture>>                   streamed_textures; // render texture of each streamed texture
+	Vec<RetiredImage>                            retired_images;
 
 	RingBuffer instances_buffer;
 	u32        instances_descriptor = u32_invalid;
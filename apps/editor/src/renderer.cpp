@@ -31,31 +31,32 @@ static void register_srgb_pass(Renderer &renderer, Handle<TextureDesc> input, Ha
 
 	auto compute_program = renderer.srgb_pass.program;
 
-	graph.raw_pass([compute_program, input, output](RenderGraph &graph, PassApi &api, vulkan::ComputeWork &cmd) {
-		PACKED(struct Options {
-			u32 linear_input_buffer_texture;
-			u32 srgb_output_buffer_image;
-			u32 pad00;
-			u32 pad01;
+	graph
+		.raw_pass([compute_program, input, output](RenderGraph &graph, PassApi &api, vulkan::ComputeWork &cmd) {
+			PACKED(struct Options {
+				u32 linear_input_buffer_texture;
+				u32 srgb_output_buffer_image;
+				u32 pad00;
+				u32 pad01;
+			})
+
+			auto input_image  = graph.resources.resolve_image(api.device, input);
+			auto output_image = graph.resources.resolve_image(api.device, output);
+
+			ASSERT(graph.image_size(input) == graph.image_size(output));
+			auto dispatch_size = exo::uint3(graph.image_size(input));
+			dispatch_size.x    = (dispatch_size.x / 16) + (dispatch_size.x % 16 != 0);
+			dispatch_size.y    = (dispatch_size.y / 16) + (dispatch_size.y % 16 != 0);
+
+			auto options = bindings::bind_option_struct<Options>(api.device, api.uniform_buffer, cmd);
+			options[0].linear_input_buffer_texture = api.device.get_image_sampled_index(input_image);
+			options[0].srgb_output_buffer_image    = api.device.get_image_storage_index(output_image);
+
+			cmd.bind_pipeline(compute_program);
+			cmd.dispatch(dispatch_size);
 		})
-
-		auto input_image  = graph.resources.resolve_image(api.device, input);
-		auto output_image = graph.resources.resolve_image(api.device, output);
-
-		ASSERT(graph.image_size(input) == graph.image_size(output));
-		auto dispatch_size = exo::uint3(graph.image_size(input));
-		dispatch_size.x    = (dispatch_size.x / 16) + (dispatch_size.x % 16 != 0);
-		dispatch_size.y    = (dispatch_size.y / 16) + (dispatch_size.y % 16 != 0);
-
-		auto options = bindings::bind_option_struct<Options>(api.device, api.uniform_buffer, cmd);
-		options[0].linear_input_buffer_texture = api.device.get_image_sampled_index(input_image);
-		options[0].srgb_output_buffer_image    = api.device.get_image_storage_index(output_image);
-
-		cmd.barrier(input_image, vulkan::ImageUsage::ComputeShaderRead);
-		cmd.barrier(output_image, vulkan::ImageUsage::ComputeShaderReadWrite);
-		cmd.bind_pipeline(compute_program);
-		cmd.dispatch(dispatch_size);
-	});
+		.read(input, vulkan::ImageUsage::ComputeShaderRead)
+		.write(output, vulkan::ImageUsage::ComputeShaderReadWrite);
 }
 
 DrawResult Renderer::draw(DrawInput input)
@@ -90,7 +91,11 @@ DrawResult Renderer::draw(DrawInput input)
 	});
 
 	if (input.painter) {
-		register_graph(this->base.render_graph, this->ui_renderer, input.painter, screen_rt);
+		auto &ui_pass = register_graph(this->base.render_graph, this->ui_renderer, input.painter, screen_rt);
+		// The world viewport is sampled by the UI, the passes drawing it are culled otherwise
+		if (scene_rt.is_valid()) {
+			ui_pass.read(scene_rt, vulkan::ImageUsage::GraphicsShaderRead);
+		}
 	}
 
 	auto srgb_screen_rt = base.render_graph.output(TextureDesc{
@@ -0,0 +1,128 @@
+// Measures the instantiation of large subscenes in an entity world, entity per entity and in bulk.
+#include "assets/mesh.h"
+#include "assets/subscene.h"
+#include "exo/collections/vector.h"
+#include "exo/profile.h"
+#include "gameplay/component.h"
+#include "gameplay/components/mesh_component.h"
+#include "gameplay/entity.h"
+#include "gameplay/entity_world.h"
+
+#include <chrono>
+#include <cstdio>
+
+using Clock = std::chrono::high_resolution_clock;
+
+static double seconds_since(Clock::time_point start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Each node has `branching_factor` children in breadth first order, every other node has a mesh
+static void fill_subscene(SubScene &subscene, u32 node_count, u32 branching_factor)
+{
+	const auto mesh_asset = AssetId::create<Mesh>("benchmark_mesh");
+
+	subscene.roots.push(0);
+	subscene.transforms.resize(node_count, float4x4::identity());
+	subscene.meshes.resize(node_count);
+	subscene.names.resize(node_count, "Node");
+	subscene.children.resize(node_count);
+	for (u32 i_node = 0; i_node < node_count; i_node += 1) {
+		subscene.transforms[i_node].at(0, 3) = 1.0f;
+		if (i_node % 2 == 0) {
+			subscene.meshes[i_node] = mesh_asset;
+		}
+		for (u32 i_child = i_node * branching_factor + 1;
+			i_child <= i_node * branching_factor + branching_factor && i_child < node_count;
+			i_child += 1) {
+			subscene.children[i_node].push(i_child);
+		}
+	}
+}
+
+// The instantiation done by the scene before the bulk path, kept as the baseline
+static Entity *instantiate_node(EntityWorld &world, const SubScene &subscene, u32 i_node)
+{
+	Entity *new_entity = world.create_entity(subscene.names[i_node]);
+
+	SpatialComponent *entity_root = nullptr;
+	if (subscene.meshes[i_node].is_valid()) {
+		auto *mesh_component = new_entity->create_component<MeshComponent>().as<MeshComponent>();
+		mesh_component->mesh_asset = subscene.meshes[i_node];
+		entity_root = static_cast<SpatialComponent *>(mesh_component);
+	} else {
+		entity_root = new_entity->create_component<SpatialComponent>().as<SpatialComponent>();
+	}
+
+	entity_root->set_local_transform(subscene.transforms[i_node]);
+	for (auto i_child : subscene.children[i_node]) {
+		auto *child = instantiate_node(world, subscene, i_child);
+		world.set_parent_entity(child, new_entity);
+	}
+
+	return new_entity;
+}
+
+// The components of the bulk path are allocated with their entities, they are freed by `destroy_entity`
+static void destroy_entities(EntityWorld &world, bool delete_components)
+{
+	Vec<Entity *> entities;
+	for (auto &[uuid, entity] : world.entities) {
+		entities.push(entity);
+	}
+	for (auto *entity : entities) {
+		if (delete_components) {
+			for (auto component : entity->components) {
+				delete component.get();
+			}
+		}
+		world.destroy_entity(entity);
+	}
+}
+
+int main()
+{
+	EXO_PROFILE_SCOPE
+	refl::details::call_all_registers();
+
+	const u32 node_counts[] = {10'000, 100'000, 1'000'000};
+	const u32 branching_factor = 16;
+
+	printf("%-10s %-14s %-14s %-8s\n", "nodes", "per entity ms", "bulk ms", "speedup");
+	for (u32 node_count : node_counts) {
+		SubScene subscene = {};
+		fill_subscene(subscene, node_count, branching_factor);
+
+		double per_entity_seconds = 0.0;
+		{
+			EntityWorld world;
+			auto start = Clock::now();
+			for (auto i_root : subscene.roots) {
+				instantiate_node(world, subscene, i_root);
+			}
+			per_entity_seconds = seconds_since(start);
+			ASSERT(world.entities.size == node_count);
+			destroy_entities(world, true);
+		}
+
+		double bulk_seconds = 0.0;
+		{
+			EntityWorld world;
+			Vec<Entity *> entities;
+			auto start = Clock::now();
+			world.instantiate_subscene(subscene, entities);
+			bulk_seconds = seconds_since(start);
+			ASSERT(world.entities.size == node_count && entities.len() == node_count);
+			destroy_entities(world, false);
+		}
+
+		printf("%-10u %-14.2f %-14.2f %-8.1f\n",
+			node_count,
+			per_entity_seconds * 1000.0,
+			bulk_seconds * 1000.0,
+			per_entity_seconds / bulk_seconds);
+	}
+
+	return 0;
+}
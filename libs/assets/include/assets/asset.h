@@ -2,6 +2,7 @@
 
 #include "exo/collections/enum_array.h"
 #include "exo/collections/vector.h"
+#include "exo/maths/u128.h"
 #include "exo/uuid.h"
 
 #include "reflection/reflection.h"
@@ -47,6 +48,8 @@ struct Asset
 	virtual ~Asset() {}
 
 	virtual void serialize(exo::Serializer &serializer) = 0;
+	// Appends the hashes of the blobs referenced by this asset
+	virtual void collect_blobs(Vec<exo::u128> & /*out_blobs*/) const {}
 
 	bool operator==(const Asset &other) const = default;
 
@@ -1,20 +1,19 @@
 #pragma once
 #include "assets/asset_database.h"
 #include "assets/asset_id.h"
+#include "assets/database_index.h"
+#include "cross/file_stat.h"
+#include "cross/mapped_file.h"
 #include "cross/jobs/waitable.h"
 #include "exo/collections/map.h"
 #include "exo/collections/pool.h"
-#include "exo/collections/set.h"
 #include "exo/collections/span.h"
 #include "exo/hash.h"
 #include "exo/path.h"
 #include "reflection/reflection.h"
 #include <memory>
+#include <mutex>
 
-namespace exo
-{
-struct Serializer;
-}
 namespace cross
 {
 struct JobManager;
@@ -27,8 +26,42 @@ struct Resource
 	AssetId asset_id = {};
 	exo::Path resource_path = {};
 	exo::RawHash last_imported_hash = {};
+	// Content hash, importer version and importer settings of the last import, see `get_import_key`
+	exo::RawHash import_key = {};
+	// Hash of the content when `stat` was read, the file is not hashed again as long as its stat signature is the same
+	exo::RawHash content_hash = {};
+	cross::FileStat stat = {};
+};
+
+// Location of a resource record, in the journal or in the mapped index
+struct ResourceKey
+{
+	Handle<Resource> journal = {}; // valid when the record is in the journal
+	u32 i_indexed = u32_invalid;   // index of the record in the mapped index otherwise
+
+	bool is_valid() const { return this->journal.is_valid() || this->i_indexed != u32_invalid; }
+};
+
+enum struct ResourceTrackingMode
+{
+	HashAll,            // hash every resource, ignore the stat cache
+	StatOnly,           // trust the stat cache, only resources with a different stat signature are hashed
+	VerifyInBackground, // like StatOnly, resources trusted from their stat signature are hashed later in the background
+};
+
+struct ResourceVerification
+{
+	exo::Path resource_path = {}; // the record is found again by path, the journal can be merged in the meantime
+	exo::RawHash expected_hash = {};
+	exo::RawHash hash = {};
+};
+
+// Filled by the load jobs when they are done, drained on the main thread by `AssetManager::update_async`
+struct AssetAsyncCompletions
+{
+	std::mutex mutex;
+	Vec<AssetId> asset_ids;
 };
-void serialize(exo::Serializer &serializer, Resource &data);
 
 struct AssetAsyncRequest
 {
@@ -36,36 +69,101 @@ struct AssetAsyncRequest
 	{
 		AssetId asset_id = {};
 		refl::BasePtr<Asset> result = {};
+		AssetAsyncCompletions *completions = nullptr;
 	};
 	std::unique_ptr<Data> data = {};
 	std::unique_ptr<cross::Waitable> waitable = {};
+	u32 priority = 0;
+};
+
+// Load waiting for a free slot, the highest priority is issued first and loads of the same priority in request order
+struct AssetAsyncPendingLoad
+{
+	u32 priority = 0;
+	u64 order = 0;
 };
 
 // The asset database contains information about all assets (loaded or not) of a project
 struct AssetDatabase
 {
-	// Persistent database of known resources
+	// Persistent database of known resources. The index written by the last save is used directly from its mapping,
+	// records that change are copied to the journal and shadow their indexed version until the next save merges both.
+	cross::MappedFile index_file;
+	DatabaseIndex index;
+	Vec<Handle<Resource>> indexed_journal; // journaled copy of each indexed record, empty until one is journaled
+
+	// Journal
 	exo::Pool<Resource> resource_records;
 	exo::Map<exo::Path, Handle<Resource>> resource_path_map;
 	exo::Map<exo::RawHash, Handle<Resource>> resource_content_map;
+	// Transitive dependencies of the compiled assets, an async load requests the whole closure at once
+	exo::Map<AssetId, Vec<AssetId>> asset_dependency_closures;
 
 	// Runtime map containing loaded assets
 	exo::Map<AssetId, refl::BasePtr<Asset>> asset_id_map;
 
 	// Async loading
+	exo::Map<AssetId, AssetAsyncPendingLoad> asset_async_pending;
 	exo::Map<AssetId, AssetAsyncRequest> asset_async_requests;
-	exo::Set<AssetId> asset_async_waiting_for_deps;
+	std::unique_ptr<AssetAsyncCompletions> asset_async_completions = std::make_unique<AssetAsyncCompletions>();
+	u64 asset_async_order = 0;
+	// Loaded assets waiting for their dependencies, with the number of dependencies that are not fully loaded yet
+	exo::Map<AssetId, u32> asset_async_waiting_for_deps;
+	// Assets waiting for an asset that is not fully loaded yet, they are updated when it is
+	exo::Map<AssetId, Vec<AssetId>> asset_async_dependents;
+
+	// Stat cache, stats are only trusted if the file was not modified after the last scan started
+	u64 last_scan_time = 0;
+
+	// Background verification of the resources that were trusted from their stat signature
+	Vec<ResourceVerification> pending_verifications;
+	std::unique_ptr<cross::Waitable> verification_waitable = {};
 
 	// --
+	// Maps the index written at `path`, an index written by another version is ignored and the database starts empty
+	void open_index(const exo::Path &path);
+	// Writes the indexed records and the journal to a new index and maps it, the journal is empty afterwards
+	void save_index(const exo::Path &path);
+
 	// Resources
-	void track_resource_changes(
-		cross::JobManager &jobmanager, const exo::Path &directory, Vec<Handle<Resource>> &out_outdated_resources);
+	void track_resource_changes(cross::JobManager &jobmanager,
+		const exo::Path &directory,
+		Vec<Handle<Resource>> &out_outdated_resources,
+		ResourceTrackingMode mode = ResourceTrackingMode::StatOnly);
+	// Tracks a single resource that changed on disk, only this file is hashed. Removed files are ignored.
+	void track_resource_change(
+		cross::JobManager &jobmanager, const exo::Path &path, Vec<Handle<Resource>> &out_outdated_resources);
+	// Returns true when a background verification finished, resources whose content changed are outdated
+	bool poll_resource_verification(Vec<Handle<Resource>> &out_outdated_resources);
+	// Lookups only read the journal and the mapping, they can run concurrently
+	ResourceKey find_resource_from_path(const exo::Path &path) const;
+	ResourceKey find_resource_from_content(exo::RawHash content_hash) const;
+	DatabaseIndexResource get_resource_view(const ResourceKey &key) const;
+	// Copies an indexed record to the journal, the journaled record can be modified
+	Handle<Resource> journal_resource(const ResourceKey &key);
+	bool is_journaled(u32 i_indexed) const;
 	Resource &get_resource_from_path(const exo::Path &path);
 	Resource &get_resource_from_content(exo::RawHash content_hash);
 
+	template <typename Callback>
+	void for_each_resource(Callback &&callback) const
+	{
+		for (u32 i_indexed = 0; i_indexed < this->index.get_resource_count(); ++i_indexed) {
+			if (!this->is_journaled(i_indexed)) {
+				callback(this->index.get_resource(i_indexed));
+			}
+		}
+		for (auto [handle, p_resource] : this->resource_records) {
+			callback(this->get_resource_view(ResourceKey{.journal = handle}));
+		}
+	}
+
 	// Assets
 	refl::BasePtr<Asset> get_asset(const AssetId &id);
 	void remove_asset(const AssetId &id);
 	void insert_asset(refl::BasePtr<Asset> asset);
+	// Stores the transitive dependencies of a compiled asset, its dependencies have to be in memory or have a closure
+	void update_dependency_closure(const AssetId &id);
+	// Returns false when the asset has no stored closure
+	bool get_dependency_closure(const AssetId &id, Vec<AssetId> &out_closure) const;
 };
-void serialize(exo::Serializer &serializer, AssetDatabase &db);
@@ -0,0 +1,35 @@
+#pragma once
+#include "assets/asset_id.h"
+#include "exo/collections/map.h"
+#include "exo/maths/numerics.h"
+#include "exo/string_view.h"
+
+// Trivially copyable reference to an asset for runtime maps and render extraction, `AssetId` is kept for serialization
+// and UI. The handle is the name hash of the id, so converting an id to a handle does not copy its name.
+struct AssetHandle
+{
+	u64 value = 0;
+
+	static AssetHandle from_id(const AssetId &id) { return AssetHandle{id.name_hash}; }
+	static AssetHandle invalid() { return {}; }
+
+	bool operator==(const AssetHandle &other) const = default;
+	bool is_valid() const { return this->value != 0; }
+};
+
+[[nodiscard]] inline u64 hash_value(AssetHandle handle) { return handle.value; }
+
+// Ids of the interned handles, to find an asset or its name again from a handle. The name of an id is copied the first
+// time it is interned only.
+struct AssetNameTable
+{
+	exo::Map<AssetHandle, AssetId> ids;
+
+	// --
+
+	AssetHandle     intern(const AssetId &id);
+	// The handle has to be interned
+	const AssetId  &get_id(AssetHandle handle) const;
+	// Returns an empty string when the handle is not interned
+	exo::StringView get_name(AssetHandle handle) const;
+};
@@ -1,13 +1,20 @@
 #pragma once
 #include "assets/asset.h"
 #include "assets/asset_database.h"
+#include "assets/asset_handle.h"
 #include "assets/asset_id.h"
+#include "assets/asset_residency.h"
+#include "assets/blob_compression.h"
+#include "assets/blob_store.h"
 #include "assets/importers/importer.h"
 #include "exo/collections/dynamic_array.h"
 #include "exo/maths/u128.h"
 #include "exo/path.h"
 #include "exo/profile.h"
 #include "reflection/reflection.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
 
 namespace cross
 {
@@ -26,34 +33,118 @@ enum struct AssetErrors : int
 	InvalidUUID,
 };
 
+struct AssetManager;
+
+// Accumulated over the imports of an asset manager
+struct ImporterStats
+{
+	u32    resource_count  = 0;
+	u32    product_count   = 0;
+	double create_seconds  = 0.0; // time spent in the import jobs, not the wall time
+	double process_seconds = 0.0;
+	usize  asset_size      = 0; // compiled assets written to disk
+	usize  blob_size       = 0; // new blobs, after compression
+};
+
+enum struct ImportPhase : u32
+{
+	TrackingResources,
+	Importing,
+	SavingDatabase,
+	Done,
+};
+
+// Written by an import running on a job, read by other threads to display its progress
+struct ImportProgress
+{
+	std::atomic<ImportPhase> phase          = ImportPhase::TrackingResources;
+	std::atomic<u32>         imported_count = 0;
+	std::atomic<u32>         resource_count = 0; // includes the dependencies discovered by the importers
+};
+
+// Keeps an asset loaded as long as the handle is alive
+struct AssetRef
+{
+	AssetManager *manager = nullptr;
+	AssetId       id      = {};
+
+	// --
+	AssetRef() = default;
+	AssetRef(AssetManager &manager, const AssetId &id);
+	~AssetRef();
+
+	AssetRef(const AssetRef &other);
+	AssetRef &operator=(const AssetRef &other);
+	AssetRef(AssetRef &&other) noexcept;
+	AssetRef &operator=(AssetRef &&other) noexcept;
+
+	void reset();
+	bool is_valid() const { return this->manager != nullptr; }
+};
+
 struct AssetManager
 {
 	exo::DynamicArray<Importer *, 16> importers; // import resource into assets
 	AssetDatabase                     database;
 	cross::JobManager                *jobmanager;
+	assets::BlobCompressionSettings   blob_compression; // used for new blobs, existing ones are read in any format
+	BlobStore                         blob_store;
+	u32                               max_async_loads = 16; // load jobs in flight, the other requests are pending
+	AssetResidency                    residency;
+	Vec<ImporterStats>                import_stats; // one per importer
+	AssetNameTable                    asset_names;  // ids of the runtime handles, only used on the main thread
+
+	// Hot reimport, resources that changed on disk are imported again once no change was seen for `reimport_delay`
+	Vec<exo::Path>                        changed_resources;
+	std::chrono::steady_clock::time_point last_resource_change = {};
+	double                                reimport_delay       = 0.1; // seconds, editors write files in several steps
+	// Assets replaced by the imports of the last `update_async`, consumers patch the data they derived from them
+	Vec<AssetId>                          reimported_assets;
+	// Incremented when an asset or one of the assets it depends on is imported again
+	exo::Map<AssetId, u32>                asset_versions;
 
 	// --
 
-	static exo::Path    get_asset_path(const AssetId &id);
-	static AssetManager create(cross::JobManager &jobmanager);
+	static exo::Path get_asset_path(const AssetId &id);
+	// Opens the database and the blob store, nothing is imported
+	static AssetManager open(cross::JobManager &jobmanager);
+	// Imports the resources of `resource_directory` that changed or whose importer changed since the last import
+	static AssetManager create(cross::JobManager &jobmanager,
+		ResourceTrackingMode                      tracking_mode      = ResourceTrackingMode::StatOnly,
+		exo::StringView                           resource_directory = ASSET_PATH);
+	// Same import as `create`, for a manager that was opened. It can run on a job, the manager must not be used by
+	// another thread until it returns.
+	void import_outdated_resources(ResourceTrackingMode tracking_mode,
+		exo::StringView                                 resource_directory,
+		ImportProgress                                 *progress = nullptr);
 
 	template <typename T>
-	T *load_asset_t(AssetId id)
+	T *load_asset_t(const AssetId &id)
 	{
+		this->residency.touch(id);
 		refl::BasePtr<Asset> asset  = this->database.get_asset(id);
 		auto                *casted = asset.as<T>();
 		ASSERT(casted != nullptr);
 		return casted;
 	}
 
-	refl::BasePtr<Asset> load_asset(AssetId id)
+	refl::BasePtr<Asset> load_asset(const AssetId &id)
 	{
+		this->residency.touch(id);
 		auto asset = this->database.get_asset(id);
 		return asset;
 	}
 
+	// Destroys a loaded asset and releases its dependencies
 	void unload_asset(const AssetId &id);
 
+	// -- Residency
+	// Referenced assets stay loaded, the other ones are unloaded when the loaded assets go over the memory budget
+	void acquire_asset(const AssetId &id) { this->residency.add_ref(id); }
+	void release_asset(const AssetId &id) { this->residency.release(id); }
+	// Called by `update_async`, unloads the least recently used unreferenced assets until they fit in the budget
+	void evict_unused_assets();
+
 	// -- Async loading
 	bool is_loaded(const AssetId &id)
 	{
@@ -68,26 +159,58 @@ struct AssetManager
 		return asset.is_valid() && asset->state == AssetState::FullyLoaded;
 	}
 
-	// Request an asset, needs to poll `is_loaded` or `is_fully_loaded` to check if request has been processed
-	void load_asset_async(const AssetId &id);
-	// Called one time per frame to poll for async requests status
+	// Request an asset and its stored dependency closure, needs to poll `is_loaded` or `is_fully_loaded` to check if
+	// request has been processed. Loads with a higher priority are issued first.
+	void load_asset_async(const AssetId &id, u32 priority = 0);
+	// Called one time per frame to finish the loads whose job completed and issue the pending ones
 	void update_async();
 	// Called by `update_async` when a load request has been processed
-	void finish_loading_async(refl::BasePtr<Asset> asset);
+	void finish_loading_async(refl::BasePtr<Asset> asset, u32 priority);
+
+	// -- Hot reimport
+	// Called with the events of a file watcher on the resource directory
+	void on_file_change(const cross::Watch &watch, const cross::WatchEvent &event);
+	// 0 until the asset is imported again
+	u32  get_asset_version(const AssetId &id) const;
 
 	// -- Binary blobs
 	// Binary data in assets is serialized as 'blobs' and is addresed using content hash
+	// Compressed blobs are decoded in parallel directly into `out_data`, returns the uncompressed size
+	// Waits for the decoding jobs, it can be called from the main thread and from jobs
 	usize     read_blob(exo::u128 blob_hash, exo::Span<u8> out_data);
+	// Reads `out_data.len()` bytes starting at `offset` in the uncompressed blob
+	usize     read_blob_range(exo::u128 blob_hash, usize offset, exo::Span<u8> out_data);
 	exo::u128 save_blob(exo::Span<const u8> blob_data);
+	// Removes the blobs that are not referenced by any compiled asset from the blob store
+	void compact_blobs();
 
 	static refl::BasePtr<Asset> _load_from_disk(const AssetId &id);
-	void                        _save_to_disk(refl::BasePtr<Asset> asset);
-	void                        _import_resources(exo::Span<const Handle<Resource>> records);
+	// Returns the size of the compiled asset
+	usize                       _save_to_disk(refl::BasePtr<Asset> asset);
+	void                        _request_async_load(const AssetId &id, u32 priority);
+	void                        _issue_async_loads();
+	void                        _set_fully_loaded(const AssetId &id);
+	// Accounts the memory of a fully loaded asset, its dependencies are referenced when it is inserted
+	void                        _set_resident(refl::BasePtr<Asset> asset);
+	// Imports the resources and their dependencies, independent resources are imported concurrently
+	void                        _import_resources(
+		exo::Span<const Handle<Resource>> records, ImportProgress *progress = nullptr);
+	// Appends the resources whose import key changed without their content, when an importer or its settings change
+	void                        _collect_stale_imports(Vec<Handle<Resource>> &out_resources);
+	// Tracks and imports the resources that changed on disk, the assets they produce replace the loaded ones
+	void                        _reimport_changed_resources();
+	// Releases the dependencies and the memory of an asset that is not in the database anymore
+	void                        _destroy_asset(refl::BasePtr<Asset> asset);
 };
 
 struct ImporterApi
 {
-	AssetManager &manager;
+	AssetManager             &manager;
+	// Importers run concurrently, accesses to the database and the blob store are serialized
+	std::mutex               &mutex;
+	usize                     saved_blob_size = 0;   // new blobs, after compression
+	Vec<refl::BasePtr<Asset>> replaced_assets;       // loaded assets replaced by `create_asset`
+	Vec<refl::BasePtr<Asset>> compiled_dependencies; // read from disk by `retrieve_asset`, owned by the api
 
 	// --
 
@@ -102,6 +225,13 @@ struct ImporterApi
 
 		T *new_asset    = static_cast<T *>(asset_ptr);
 		new_asset->uuid = id;
+
+		// A reimported asset replaces the loaded one, the manager releases it once the import is finished
+		std::lock_guard lock{this->mutex};
+		if (auto previous = manager.database.get_asset(id); previous.is_valid()) {
+			manager.database.remove_asset(id);
+			this->replaced_assets.push(previous);
+		}
 		manager.database.insert_asset(refl::BasePtr<Asset>(new_asset));
 		return new_asset;
 	}
@@ -110,8 +240,14 @@ struct ImporterApi
 	template <typename T>
 	T *retrieve_asset(AssetId id)
 	{
-		return manager.load_asset_t<T>(id);
+		auto *asset = this->_retrieve_asset(id).as<T>();
+		ASSERT(asset != nullptr);
+		return asset;
 	}
 
-	inline exo::u128 save_blob(exo::Span<const u8> data) { return manager.save_blob(data); }
+	// The blob is hashed and compressed outside of the lock
+	exo::u128 save_blob(exo::Span<const u8> data);
+
+	// Dependencies that were not imported again are read from their compiled asset
+	refl::BasePtr<Asset> _retrieve_asset(const AssetId &id);
 };
@@ -0,0 +1,56 @@
+#pragma once
+#include "assets/asset_id.h"
+#include "exo/collections/map.h"
+#include "exo/collections/vector.h"
+#include "exo/maths/numerics.h"
+
+struct AssetResidencySettings
+{
+	// Size of the resident assets, referenced assets are never evicted and can go over it
+	usize memory_budget = 1_GiB;
+};
+
+struct ResidentAsset
+{
+	const char *type_name       = nullptr;
+	usize       memory_size     = 0; // the asset and the blobs it references
+	u32         ref_count       = 0; // handles and resident assets depending on it
+	u64         last_used_frame = 0;
+	bool        is_resident     = false;
+};
+
+struct AssetTypeMemory
+{
+	const char *type_name   = nullptr;
+	usize       memory_size = 0;
+	u32         asset_count = 0;
+};
+
+// Tracks the references and the memory of the loaded assets, the asset manager loads and unloads them.
+// Assets can be referenced before they are loaded, an entry is removed once it is neither referenced nor resident.
+// Resident assets that are not referenced stay loaded until the budget is exceeded, the least recently used go first.
+struct AssetResidency
+{
+	AssetResidencySettings           settings;
+	exo::Map<AssetId, ResidentAsset> assets;
+	Vec<AssetTypeMemory>             memory_per_type;
+	usize                            resident_size = 0;
+	u64                              i_frame       = 1;
+
+	void add_ref(const AssetId &id);
+	void release(const AssetId &id);
+	void touch(const AssetId &id);
+
+	void set_resident(const AssetId &id, const char *type_name, usize memory_size);
+	void set_evicted(const AssetId &id);
+
+	// Appends the unreferenced assets to evict to fit in the budget, from the least recently used. Evicting them can
+	// release other assets, the caller collects again until nothing is returned.
+	void collect_evictions(Vec<AssetId> &out_evictions) const;
+
+	u32                    get_ref_count(const AssetId &id) const;
+	const AssetTypeMemory *get_type_memory(const char *type_name) const;
+
+private:
+	AssetTypeMemory &get_or_add_type_memory(const char *type_name);
+};
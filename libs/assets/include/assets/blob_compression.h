@@ -0,0 +1,75 @@
+#pragma once
+#include "exo/collections/span.h"
+#include "exo/collections/vector.h"
+#include "exo/maths/numerics.h"
+
+namespace cross
+{
+struct JobManager;
+}
+
+// Blobs can be stored compressed on disk. The uncompressed data is split in fixed-size blocks that are compressed
+// independently, and a block index is stored after the header. Any block can be decoded without touching the others,
+// which makes it possible to decode a blob in parallel or to read only a range of it.
+//
+// Layout: [CompressedBlobHeader][CompressedBlobBlock x block_count][block data...]
+namespace assets
+{
+enum struct BlobCodec : u32
+{
+	None, // blocks are stored as is
+	Zlib,
+	Count
+};
+
+inline constexpr u32 COMPRESSED_BLOB_MAGIC              = 0x5a424c42; // "BLBZ"
+inline constexpr u32 COMPRESSED_BLOB_VERSION            = 1;
+inline constexpr u32 COMPRESSED_BLOB_DEFAULT_BLOCK_SIZE = 256_KiB;
+
+struct CompressedBlobHeader
+{
+	u32       magic             = COMPRESSED_BLOB_MAGIC;
+	u32       version           = COMPRESSED_BLOB_VERSION;
+	BlobCodec codec             = BlobCodec::None;
+	u32       block_size        = COMPRESSED_BLOB_DEFAULT_BLOCK_SIZE;
+	u64       uncompressed_size = 0;
+	u32       block_count       = 0;
+	u32       padding           = 0;
+};
+static_assert(sizeof(CompressedBlobHeader) == 32);
+
+struct CompressedBlobBlock
+{
+	u64 offset            = 0; // offset of the compressed data from the start of the blob
+	u32 compressed_size   = 0; // a block is stored uncompressed when compressed_size == uncompressed_size
+	u32 uncompressed_size = 0;
+};
+static_assert(sizeof(CompressedBlobBlock) == 16);
+
+struct BlobCompressionSettings
+{
+	BlobCodec codec      = BlobCodec::Zlib;
+	u32       block_size = COMPRESSED_BLOB_DEFAULT_BLOCK_SIZE;
+	int       level      = 1;
+};
+
+// Returns true if `content` starts with a valid compressed blob header and block index
+bool is_compressed_blob(exo::Span<const u8> content);
+const CompressedBlobHeader &get_compressed_blob_header(exo::Span<const u8> content);
+exo::Span<const CompressedBlobBlock> get_compressed_blob_blocks(exo::Span<const u8> content);
+
+// Encodes `data` into a new compressed blob
+Vec<u8> compress_blob(exo::Span<const u8> data, const BlobCompressionSettings &settings = {});
+
+// Decodes block `i_block` into `out_data`, returns the number of bytes written
+usize decompress_blob_block(exo::Span<const u8> content, u32 i_block, exo::Span<u8> out_data);
+
+// Decodes the whole blob into `out_data`, returns the uncompressed size. The blocks are decoded in parallel with
+// `jobmanager`, or on the calling thread when it is null. A job can pass its manager, the waiting worker runs the
+// queued jobs until the blocks are decoded.
+usize decompress_blob(const cross::JobManager *jobmanager, exo::Span<const u8> content, exo::Span<u8> out_data);
+
+// Decodes `out_data.len()` bytes starting at `offset` in the uncompressed blob, only the blocks overlapping the range are
+// decoded. Returns the number of bytes written.
+usize decompress_blob_range(exo::Span<const u8> content, usize offset, exo::Span<u8> out_data);
+} // namespace assets
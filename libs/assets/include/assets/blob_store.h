@@ -0,0 +1,84 @@
+#pragma once
+#include "cross/mapped_file.h"
+#include "exo/collections/span.h"
+#include "exo/collections/vector.h"
+#include "exo/maths/numerics.h"
+#include "exo/maths/u128.h"
+#include "exo/option.h"
+#include "exo/path.h"
+
+#include <memory>
+#include <mutex>
+
+namespace exo
+{
+struct Serializer;
+}
+
+// Content-addressed storage for blobs.
+// Blobs are appended to a few large pack files instead of living in their own file, and an index maps each content
+// hash to its location. Each pack is mapped once and kept mapped, reading a blob is a lookup in the index and an offset
+// in the mapping.
+// The store can be read and appended from several threads. The spans returned by `get` stay valid until `compact`.
+inline constexpr u64 BLOB_STORE_DEFAULT_MAX_PACK_SIZE = 1_GiB;
+
+struct BlobLocation
+{
+	u32 i_pack = u32_invalid;
+	u32 padding = 0;
+	u64 offset = 0;
+	u64 size = 0;
+};
+
+struct BlobIndexSlot
+{
+	u64 hash0 = 0;
+	u64 hash1 = 0;
+	BlobLocation location = {}; // the slot is empty when location.i_pack == u32_invalid
+};
+
+struct BlobPack
+{
+	u32 pack_id = 0; // the pack file is named after its id
+	u64 size = 0;    // bytes appended to the pack
+	cross::MappedFile mapping = {}; // remapped lazily when the pack grew since the last read
+	Vec<cross::MappedFile> retired_mappings = {}; // previous mappings, spans returned by `get` can still point to them
+};
+
+struct BlobStore
+{
+	exo::Path directory;
+	Vec<BlobPack> packs;
+	Vec<BlobIndexSlot> index_slots; // open addressing table, the capacity is always a power of 2
+	usize blob_count = 0;
+	u32 next_pack_id = 0;
+	u64 max_pack_size = BLOB_STORE_DEFAULT_MAX_PACK_SIZE; // a new pack is started when the last one is full
+	std::unique_ptr<std::mutex> mutex = std::make_unique<std::mutex>(); // protects the index and the pack mappings
+
+	// --
+	static BlobStore open(const exo::Path &directory, u64 max_pack_size = BLOB_STORE_DEFAULT_MAX_PACK_SIZE);
+	void save_index();
+
+	bool contains(exo::u128 hash) const;
+	Option<BlobLocation> find(exo::u128 hash) const;
+
+	// Returns the content of a blob directly from the pack mapping, or an empty span if the blob is not in the store
+	exo::Span<const u8> get(exo::u128 hash);
+	// Appends a blob to the last pack, does nothing if the blob is already stored
+	void add(exo::u128 hash, exo::Span<const u8> content);
+
+	// Rewrites the packs to only contain `live_blobs` and deletes the old pack files once the new index is saved.
+	// The spans returned by `get` are invalidated, it must not run concurrently with other accesses.
+	void compact(exo::Span<const exo::u128> live_blobs);
+
+	exo::Path get_pack_path(u32 pack_id) const;
+	exo::Path get_index_path() const;
+
+private:
+	const BlobLocation *find_location(exo::u128 hash) const;
+	void insert_slot(u64 hash0, u64 hash1, BlobLocation location);
+	void grow_index();
+	u32  append_to_pack(exo::Span<const u8> content, u64 &out_offset);
+};
+
+void serialize(exo::Serializer &serializer, BlobStore &store);
@@ -0,0 +1,51 @@
+#pragma once
+#include "exo/collections/span.h"
+#include "exo/maths/numerics.h"
+
+#include "assets/texture.h"
+
+namespace cross
+{
+struct JobManager;
+}
+
+enum struct BC7Quality : u8
+{
+	Fast,   // endpoints on the principal axis of the block
+	Normal, // least squares refinement of the endpoints
+	High,   // more refinement and a local search around the quantized endpoints
+};
+
+enum struct TextureUsage : u8
+{
+	Color,  // sRGB encoded colors, stored in sRGB formats so that they are filtered in linear space
+	Linear, // data that is not a color
+	Normal, // tangent space normals, only X and Y are stored, Z is reconstructed when sampling
+};
+
+struct BlockCompressionSettings
+{
+	BC7Quality bc7_quality    = BC7Quality::Normal;
+	u32        blocks_per_job = 256;
+};
+
+// BC4 and BC5 for one and two channels textures and for normal maps, BC7 or BC1/BC3 for colors. Colors use the sRGB
+// variants.
+PixelFormat choose_block_format(TextureUsage usage, u32 channels, bool has_alpha, bool prefer_bc7);
+
+bool  is_block_compressed(PixelFormat format);
+// Size of a 4x4 block in bytes
+usize get_block_byte_size(PixelFormat format);
+usize get_compressed_size(PixelFormat format, u32 width, u32 height);
+
+// Compresses an 8 bits per channel image to `format`, `out_blocks` holds `get_compressed_size` bytes. Missing channels
+// are read as 0 and missing alpha as 255, BC4 compresses the first channel and BC5 the first two. Rows of blocks are
+// encoded on the job manager when one is provided, the calling thread waits for them.
+void compress_blocks(const cross::JobManager *jobmanager,
+	exo::Span<const u8>                       pixels,
+	u32                                       width,
+	u32                                       height,
+	u32                                       channels,
+	PixelFormat                               format,
+	exo::Span<u8>                             out_blocks,
+	const BlockCompressionSettings           &settings = {});
@@ -0,0 +1,75 @@
+#pragma once
+#include "exo/collections/span.h"
+#include "exo/collections/vector.h"
+#include "exo/maths/numerics.h"
+#include "exo/maths/vectors.h"
+
+#include <limits>
+
+namespace cross
+{
+struct JobManager;
+}
+
+// Bounding volume hierarchy over the triangles of a mesh, the nodes match the BVHNode layout of
+// libs/engine/shaders/include/engine/bvh.h.
+//
+// Nodes are stored in depth-first order: the first child of an inner node is the next node, and `next_node` is the node
+// to visit once the subtree has been traversed or missed (u32_invalid at the end of the tree). Each leaf holds a single
+// triangle, `prim_index` is the offset of its first index in the index buffer.
+struct BVHNode
+{
+	float3 bbox_min   = {};
+	u32    prim_index = u32_invalid; // u32_invalid for inner nodes
+	float3 bbox_max   = {};
+	u32    next_node  = u32_invalid;
+
+	bool is_leaf() const { return this->prim_index != u32_invalid; }
+	bool operator==(const BVHNode &other) const = default;
+};
+static_assert(sizeof(BVHNode) == 32);
+
+struct BVHBuildSettings
+{
+	u32   bins_count        = 16;   // split candidates evaluated per axis, a single bin falls back to median splits
+	u32   parallel_min_size = 4096; // triangles under which a subtree is built on a single thread
+	float traversal_cost    = 1.0f;
+	float intersection_cost = 1.0f;
+};
+
+// Builds a binned SAH BVH of the triangles in `indices`. The subtrees are built on the job manager when one is
+// provided, the calling thread waits for them.
+Vec<BVHNode> build_bvh(const cross::JobManager *jobmanager,
+	exo::Span<const float4>                     positions,
+	exo::Span<const u32>                        indices,
+	const BVHBuildSettings                     &settings = {});
+
+// Expected cost of a random ray traversing the BVH, relative to the surface of the root
+float compute_sah_cost(exo::Span<const BVHNode> nodes, const BVHBuildSettings &settings = {});
+
+// -- Ray queries, CPU reference of the shader traversal
+
+struct BVHRay
+{
+	float3 origin    = {};
+	float  t_min     = 0.0f;
+	float3 direction = {};
+	float  t_max     = std::numeric_limits<float>::infinity();
+};
+
+struct BVHHit
+{
+	float  d            = std::numeric_limits<float>::infinity();
+	u32    prim_index   = u32_invalid;
+	float3 barycentrics = {};
+};
+
+bool bvh_closest_hit(exo::Span<const BVHNode> nodes,
+	exo::Span<const float4>                   positions,
+	exo::Span<const u32>                      indices,
+	const BVHRay                             &ray,
+	BVHHit                                   &out_hit);
+
+// Tests every triangle, used to validate the BVH
+bool brute_force_closest_hit(
+	exo::Span<const float4> positions, exo::Span<const u32> indices, const BVHRay &ray, BVHHit &out_hit);
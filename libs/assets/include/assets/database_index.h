@@ -0,0 +1,142 @@
+#pragma once
+#include "assets/hash_file.h"
+#include "cross/file_stat.h"
+#include "exo/collections/span.h"
+#include "exo/collections/vector.h"
+#include "exo/maths/numerics.h"
+#include "exo/string_view.h"
+
+// On-disk index of the asset database, used directly from its mapping.
+// Records have a fixed size and their strings live in a table at the end of the file. The lookups by path, by content
+// and by asset go through open addressing tables that are built when the file is written, opening an index only
+// validates its header.
+inline constexpr u32 DATABASE_INDEX_MAGIC = 0x58444e49; // "INDX"
+
+struct DatabaseIndexString
+{
+	u32 offset = 0;
+	u32 length = 0;
+};
+
+struct IndexedAsset
+{
+	u64                 name_hash = 0; // 0 for an invalid asset id
+	DatabaseIndexString name      = {};
+};
+
+struct IndexedResource
+{
+	IndexedAsset        asset              = {};
+	DatabaseIndexString path               = {};
+	u64                 path_hash          = 0;
+	u64                 last_imported_hash = 0;
+	u64                 import_key         = 0;
+	u64                 content_hash       = 0;
+	cross::FileStat     stat               = {};
+};
+
+struct IndexedClosure
+{
+	IndexedAsset asset            = {};
+	u32          first_dependency = 0;
+	u32          dependency_count = 0;
+};
+
+struct DatabaseIndexSlot
+{
+	u64 hash    = 0;
+	u32 index   = u32_invalid; // the slot is empty when index == u32_invalid
+	u32 padding = 0;
+};
+
+// Followed by the resources, the path and content slots, the closures, the closure slots, the dependencies and the
+// strings. The slot tables have a power of 2 capacity.
+struct DatabaseIndexHeader
+{
+	u32 magic               = DATABASE_INDEX_MAGIC;
+	u32 version             = 0;
+	u64 last_scan_time      = 0;
+	u32 resource_count      = 0;
+	u32 resource_slot_count = 0;
+	u32 closure_count       = 0;
+	u32 closure_slot_count  = 0;
+	u32 dependency_count    = 0;
+	u32 hash_algorithm      = 0; // assets::HashAlgorithm of the content hashes
+	u64 strings_size        = 0;
+};
+
+// Asset id with its name resolved
+struct DatabaseIndexAsset
+{
+	exo::StringView name      = {};
+	u64             name_hash = 0;
+};
+
+// Resource record with its strings resolved
+struct DatabaseIndexResource
+{
+	DatabaseIndexAsset asset              = {};
+	exo::StringView    path               = {};
+	u64                last_imported_hash = 0;
+	u64                import_key         = 0;
+	u64                content_hash       = 0;
+	cross::FileStat    stat               = {};
+};
+
+struct DatabaseIndex
+{
+	const DatabaseIndexHeader         *header        = nullptr;
+	exo::Span<const IndexedResource>   resources     = {};
+	exo::Span<const DatabaseIndexSlot> path_slots    = {};
+	exo::Span<const DatabaseIndexSlot> content_slots = {};
+	exo::Span<const IndexedClosure>    closures      = {};
+	exo::Span<const DatabaseIndexSlot> closure_slots = {};
+	exo::Span<const IndexedAsset>      dependencies  = {};
+	exo::Span<const char>              strings       = {};
+
+	// --
+
+	// Returns an empty index when `content` is not an index written with `version` and `hash_algorithm`
+	static DatabaseIndex from_bytes(exo::Span<const u8> content, u32 version, assets::HashAlgorithm hash_algorithm);
+
+	bool is_empty() const { return this->header == nullptr; }
+	u64  get_last_scan_time() const { return this->header ? this->header->last_scan_time : 0; }
+	u32  get_resource_count() const { return u32(this->resources.len()); }
+	u32  get_closure_count() const { return u32(this->closures.len()); }
+
+	DatabaseIndexResource get_resource(u32 i_resource) const;
+	DatabaseIndexAsset    get_closure_asset(u32 i_closure) const;
+	DatabaseIndexAsset    get_closure_dependency(u32 i_closure, u32 i_dependency) const;
+	u32                   get_closure_dependency_count(u32 i_closure) const;
+
+	// Lookups return u32_invalid when nothing is found
+	u32 find_resource_by_path(exo::StringView path) const;
+	u32 find_resource_by_content(u64 content_hash) const;
+	u32 find_closure(u64 asset_name_hash) const;
+
+private:
+	exo::StringView    get_string(DatabaseIndexString string) const;
+	DatabaseIndexAsset get_asset(const IndexedAsset &asset) const;
+};
+
+// Collects the records of a database and writes them in the index format
+struct DatabaseIndexWriter
+{
+	Vec<IndexedResource> resources;
+	Vec<IndexedClosure>  closures;
+	Vec<IndexedAsset>    dependencies;
+	Vec<char>            strings;
+
+	// --
+
+	void    add_resource(const DatabaseIndexResource &resource);
+	void    add_closure(const DatabaseIndexAsset &asset, exo::Span<const DatabaseIndexAsset> closure_dependencies);
+	Vec<u8> write(u32 version, assets::HashAlgorithm hash_algorithm, u64 last_scan_time) const;
+
+private:
+	DatabaseIndexString add_string(exo::StringView string);
+	IndexedAsset        add_asset(const DatabaseIndexAsset &asset);
+};
+
+// Hash of the paths and the asset names in the index, the same as `hash_value(exo::Path)` and `AssetId::name_hash`
+u64 hash_database_string(exo::StringView string);
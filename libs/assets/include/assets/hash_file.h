@@ -0,0 +1,51 @@
+#pragma once
+#include "exo/collections/span.h"
+#include "exo/collections/vector.h"
+#include "exo/maths/numerics.h"
+#include "exo/maths/u128.h"
+#include "exo/option.h"
+#include "exo/string_view.h"
+
+// Content hashes of the resources and the blobs.
+// Files smaller than `CHUNKED_HASH_MIN_SIZE` are hashed in one pass. Larger files are split in `HASH_CHUNK_SIZE` chunks
+// that are hashed independently, the file hash is the hash of the chunk hashes: the mapped, parallel and streamed
+// variants give the same hash. MeowHash is used when the CPU supports AES-NI, XXH3 otherwise.
+namespace assets
+{
+inline constexpr usize HASH_CHUNK_SIZE       = 4_MiB;
+inline constexpr usize CHUNKED_HASH_MIN_SIZE = 16_MiB;
+
+enum struct HashAlgorithm
+{
+	Meow,
+	XXH3,
+};
+
+// The algorithm used by this CPU. It is stored in the database index, a database hashed with the other one is
+// imported again.
+HashAlgorithm get_hash_algorithm();
+// Overrides the algorithm picked for this CPU, used by the tests to hash with XXH3 on AES-NI machines. Meow requires
+// AES-NI. Must not be called while files are hashed.
+void          set_hash_algorithm(HashAlgorithm algorithm);
+
+struct HashChunk
+{
+	exo::Span<const u8> content = {};
+	exo::u128           hash    = {};
+};
+
+// Appends the chunks of a file larger than `CHUNKED_HASH_MIN_SIZE`, they can be hashed on different threads
+void      split_hash_chunks(exo::Span<const u8> content, Vec<HashChunk> &out_chunks);
+void      hash_chunk(HashChunk &chunk);
+exo::u128 combine_chunk_hashes(exo::Span<const exo::u128> chunk_hashes, usize content_size);
+
+// The 64-bit hashes are the low half of the 128-bit ones
+u64 to_hash64(exo::u128 hash);
+
+exo::u128 hash_file128(exo::Span<const u8> content);
+u64       hash_file64(exo::Span<const u8> content);
+
+// Reads the file one chunk at a time instead of mapping it, returns None when it cannot be read
+Option<exo::u128> hash_file128_streamed(exo::StringView path);
+Option<u64>       hash_file64_streamed(exo::StringView path);
+} // namespace assets
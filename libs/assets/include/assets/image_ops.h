@@ -0,0 +1,37 @@
+#pragma once
+#include "exo/collections/span.h"
+#include "exo/maths/numerics.h"
+
+// Pixel conversions used by the importers, vectorized with SSE4.1. Images are tightly packed rows of 8 bits channels
+// unless stated otherwise, float images have 4 channels.
+
+// Source channel of each destination channel
+struct ChannelSwizzle
+{
+	u8 sources[4] = {0, 1, 2, 3};
+};
+
+// Appends an `alpha` channel to every texel, `rgba` has 4 bytes per texel of `rgb`
+void expand_rgb_to_rgba(exo::Span<const u8> rgb, exo::Span<u8> rgba, u8 alpha = 255);
+
+// Reorders the channels of a 4 channels image, `src` and `dst` can be the same image
+void swizzle_rgba(exo::Span<const u8> src, exo::Span<u8> dst, ChannelSwizzle swizzle);
+
+// The color channels are decoded from sRGB with a table, alpha is linear
+void srgb_to_linear_rgba(exo::Span<const u8> rgba, exo::Span<float> linear);
+// The color channels are encoded to sRGB with a polynomial approximation, within one step of the exact conversion.
+// Alpha is linear, every value is clamped to [0, 1].
+void linear_to_srgb_rgba(exo::Span<const float> linear, exo::Span<u8> rgba);
+
+// Multiplies the color channels by alpha in place, rounded to the nearest value
+void premultiply_alpha(exo::Span<u8> rgba);
+
+// Quantizes 16 bits channels to 8 bits. With `dither`, a 4x4 ordered dither is added before truncation to hide the
+// banding of smooth gradients, the values are rounded otherwise.
+void convert_16_to_8_bits(
+	exo::Span<const u16> src, exo::Span<u8> dst, u32 width, u32 height, u32 channels, bool dither);
+
+// Resizes a float image with a triangle filter, widened to cover every source texel when downsampling. Texels outside
+// of the image are clamped to the edge.
+void resize_rgba(
+	exo::Span<const float> src, u32 src_width, u32 src_height, exo::Span<float> dst, u32 dst_width, u32 dst_height);
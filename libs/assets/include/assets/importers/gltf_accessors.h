@@ -0,0 +1,39 @@
+#pragma once
+#include "exo/maths/numerics.h"
+#include "exo/maths/vectors.h"
+
+namespace gltf
+{
+enum struct ComponentType : i32
+{
+	Byte          = 5120,
+	UnsignedByte  = 5121,
+	Short         = 5122,
+	UnsignedShort = 5123,
+	UnsignedInt   = 5125,
+	Float         = 5126,
+	Invalid
+};
+
+u32 size_of(ComponentType type);
+
+// Elements of an accessor resolved in its buffer, element `i` starts at `data + i * byte_stride`
+struct AccessorData
+{
+	const u8     *data           = nullptr;
+	usize         byte_stride    = 0;
+	u32           count          = 0;
+	ComponentType component_type = ComponentType::Invalid;
+	u32           nb_component   = 0;
+	bool          normalized     = false;
+};
+
+// Component converted to float, normalized integers are mapped to [0, 1] or [-1, 1]
+float read_component(const u8 *component, ComponentType type, bool normalized);
+
+// Decoders write `src.count` elements to `dst`. Tightly packed indices, float3 positions and float or normalized
+// unsigned short uvs are converted 4 to 16 elements at a time, other layouts one component at a time.
+void decode_indices(const AccessorData &src, u32 vertex_base, u32 *dst);
+void decode_positions(const AccessorData &src, float4 *dst); // w is set to 1
+void decode_uvs(const AccessorData &src, float2 *dst);
+} // namespace gltf
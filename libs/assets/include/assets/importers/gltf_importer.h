@@ -7,10 +7,27 @@ enum struct GLTFError
 	SecondChunkNotBIN,
 };
 
+struct MeshImportSettings
+{
+	bool  optimize           = true;  // vertex cache, overdraw and vertex fetch optimization of each submesh
+	bool  quantize_positions = true;  // snorm16 positions relative to the bounds of the mesh
+	bool  quantize_uvs       = false; // half precision uvs, too imprecise for uvs far from [0, 1]
+	bool  build_meshlets     = true;  // meshlets with culling bounds, see assets/meshlet.h
+	bool  build_bvh          = true;  // binned SAH BVH for the path tracer, see assets/bvh.h
+	u32   max_lods           = 6;     // LOD 0 included, 1 disables the simplification
+	float lod_max_error      = 0.1f;  // relative to the extent of the submesh
+};
+
 struct GLTFImporter final : Importer
 {
 	static constexpr u64 importer_id = 0x1;
 
+	MeshImportSettings mesh_settings = {};
+
+	const char *get_name() const final { return "glTF"; }
+	u32         get_version() const final { return 2; }
+	u64         get_settings_hash() const final;
+
 	bool can_import_extension(exo::Span<exo::StringView const> extensions) override;
 	bool can_import_blob(exo::Span<u8 const> data) override;
 
@@ -43,9 +43,18 @@ struct Importer
 {
 	virtual ~Importer() = default;
 
+	virtual const char *get_name() const = 0;
+	// Bumped when the output of the importer changes, resources imported by another version are imported again
+	virtual u32         get_version() const = 0;
+	// Hash of the settings that change the output of the importer
+	virtual u64         get_settings_hash() const { return 0; }
+
 	virtual bool can_import_extension(exo::Span<const exo::StringView> extensions) = 0;
 	virtual bool can_import_blob(exo::Span<const u8> data)                         = 0;
 
 	virtual Result<CreateResponse>  create_asset(const CreateRequest &request)   = 0;
 	virtual Result<ProcessResponse> process_asset(const ProcessRequest &request) = 0;
 };
+
+// Cache key of an imported resource, a resource is up to date when its key did not change since its last import
+u64 get_import_key(const Importer &importer, u64 content_hash);
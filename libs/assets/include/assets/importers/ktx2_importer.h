@@ -5,6 +5,8 @@ enum struct KTX2Errors
 {
 	CreateFailed,
 	TranscodeFailed,
+	UnsupportedLayout, // cube maps, arrays and 3D textures
+	UnsupportedFormat,
 };
 
 struct LibKtxError
@@ -16,6 +18,9 @@ struct KTX2Importer final : Importer
 {
 	static constexpr u64 importer_id = 0x3;
 
+	const char *get_name() const final { return "KTX2"; }
+	u32         get_version() const final { return 2; }
+
 	bool can_import_extension(exo::Span<exo::StringView const> extensions) final;
 	bool can_import_blob(exo::Span<u8 const> blob) final;
 
@@ -1,5 +1,7 @@
 #pragma once
+#include "assets/block_compression.h"
 #include "assets/importers/importer.h"
+#include "assets/mip_generation.h"
 
 enum struct PNGErrors
 {
@@ -7,10 +9,25 @@ enum struct PNGErrors
 	CannotDecodeSize
 };
 
+struct TextureImportSettings
+{
+	bool                     generate_mips        = true; // full mip chain down to 1x1, see assets/mip_generation.h
+	bool                     compress             = true; // block compression, see assets/block_compression.h
+	bool                     prefer_bc7           = true; // BC7 instead of BC1 and BC3 for colors
+	MipGenerationSettings    mip_settings         = {};
+	BlockCompressionSettings compression_settings = {};
+};
+
 struct PNGImporter final : Importer
 {
 	static constexpr u64 importer_id = 0x2;
 
+	TextureImportSettings texture_settings = {};
+
+	const char *get_name() const final { return "PNG"; }
+	u32         get_version() const final { return 2; }
+	u64         get_settings_hash() const final;
+
 	bool can_import_extension(exo::Span<exo::StringView const> extensions) final;
 	bool can_import_blob(exo::Span<u8 const> blob) final;
 
@@ -4,15 +4,48 @@
 #include "exo/maths/vectors.h"
 
 #include "assets/asset.h"
+#include "assets/meshlet.h"
 
 struct Material;
 
+enum struct IndexFormat : u16
+{
+	U32,
+	U16, // used when every vertex of the mesh can be addressed with 16 bits
+};
+
+enum struct PositionFormat : u16
+{
+	Float32x4,
+	Snorm16x4, // position = snorm * positions_decode_scale + positions_decode_offset
+};
+
+enum struct UvFormat : u16
+{
+	Float32x2,
+	Float16x2,
+};
+
+// Index range of a submesh at a given level of detail, the simplified levels reuse the vertices of the submesh
+struct MeshLod
+{
+	u32 first_index = 0;
+	u32 index_count = 0;
+
+	inline bool operator==(const MeshLod &other) const = default;
+};
+void serialize(exo::Serializer &serializer, MeshLod &data);
+
+inline constexpr u32 MESH_MAX_LODS = 8;
+
 struct SubMesh
 {
-	u32     first_index  = 0;
-	u32     first_vertex = 0;
-	u32     index_count  = 0;
-	AssetId material     = {};
+	u32     first_index   = 0;
+	u32     first_vertex  = 0;
+	u32     index_count   = 0;
+	u32     first_meshlet = 0;
+	u32     meshlet_count = 0;
+	AssetId material      = {};
 
 	inline bool operator==(const SubMesh &other) const = default;
 };
@@ -24,17 +57,52 @@ struct Mesh : Asset
 	using Super = Asset;
 	REFL_REGISTER_TYPE_WITH_SUPER("Mesh")
 
-	exo::u128 indices_hash;
-	usize     indices_byte_size;
+	exo::u128   indices_hash;
+	usize       indices_byte_size;
+	IndexFormat indices_format = IndexFormat::U32;
 
-	exo::u128 positions_hash;
-	usize     positions_byte_size;
+	exo::u128      positions_hash;
+	usize          positions_byte_size;
+	PositionFormat positions_format        = PositionFormat::Float32x4;
+	float3         positions_decode_scale  = float3(1.0f);
+	float3         positions_decode_offset = float3(0.0f);
 
 	exo::u128 uvs_hash;
 	usize     uvs_byte_size;
+	UvFormat  uvs_format = UvFormat::Float32x2;
 
 	Vec<SubMesh> submeshes;
 
+	// Meshlets of all submeshes, see assets/meshlet.h
+	exo::u128          meshlet_vertices_hash;
+	usize              meshlet_vertices_byte_size;
+	exo::u128          meshlet_triangles_hash;
+	usize              meshlet_triangles_byte_size;
+	Vec<Meshlet>       meshlets;
+	Vec<MeshletBounds> meshlet_bounds;
+
+	// BVH of the LOD 0 triangles for ray queries, see assets/bvh.h
+	exo::u128 bvh_nodes_hash;
+	usize     bvh_nodes_byte_size = 0;
+	float     bvh_sah_cost        = 0.0f;
+
+	// Simplified levels of detail, LOD 0 is the submesh itself. Both are empty when the mesh has no LODs.
+	Vec<float>   lod_errors; // object space error of each LOD, increasing
+	Vec<MeshLod> lods;       // lod_errors.len() entries per submesh
+
 	// --
 	void serialize(exo::Serializer &serializer) final;
+	void collect_blobs(Vec<exo::u128> &out_blobs) const final;
+
+	u32 get_lod_count() const { return this->lod_errors.is_empty() ? 1 : u32(this->lod_errors.len()); }
+	// Returns the coarsest LOD whose error is below `max_error`
+	u32     select_lod(float max_error) const;
+	MeshLod get_submesh_lod(u32 i_submesh, u32 lod) const;
 };
+
+namespace exo
+{
+void serialize(Serializer &serializer, IndexFormat &data);
+void serialize(Serializer &serializer, PositionFormat &data);
+void serialize(Serializer &serializer, UvFormat &data);
+} // namespace exo
@@ -0,0 +1,85 @@
+#pragma once
+#include "exo/collections/span.h"
+#include "exo/collections/vector.h"
+#include "exo/maths/matrices.h"
+#include "exo/maths/numerics.h"
+#include "exo/maths/vectors.h"
+
+namespace exo
+{
+struct Serializer;
+}
+
+// Meshlets are small clusters of triangles that can be culled independently.
+// Each meshlet references up to MESHLET_MAX_VERTICES vertices of the mesh through the meshlet vertices blob (u32
+// vertex indices), and its triangles are stored as 3 u8 indices into these vertices in the meshlet triangles blob.
+inline constexpr u32   MESHLET_MAX_VERTICES  = 64;
+inline constexpr u32   MESHLET_MAX_TRIANGLES = 124;
+inline constexpr float MESHLET_CONE_WEIGHT   = 0.25f;
+
+struct Meshlet
+{
+	u32 vertex_offset   = 0; // first element in the meshlet vertices
+	u32 triangle_offset = 0; // first byte in the meshlet triangles
+	u32 vertex_count    = 0;
+	u32 triangle_count  = 0;
+
+	bool operator==(const Meshlet &other) const = default;
+};
+
+struct MeshletBounds
+{
+	// Bounding sphere
+	float3 center = {};
+	float  radius = 0.0f;
+	// Normal cone, the meshlet is backfacing when seen from any point p such that
+	// dot(center - p, cone_axis) >= cone_cutoff * length(center - p) + radius
+	// A cone_cutoff of 1 means that the meshlet cannot be backface culled.
+	float3 cone_axis   = {};
+	float  cone_cutoff = 1.0f;
+
+	bool operator==(const MeshletBounds &other) const = default;
+};
+
+struct MeshletData
+{
+	Vec<Meshlet>       meshlets;
+	Vec<MeshletBounds> bounds;
+	Vec<u32>           vertices;
+	Vec<u8>            triangles; // the triangles of each meshlet are padded to 4 bytes
+};
+
+// Builds the meshlets of a list of triangles and appends them to `out_data`.
+// `indices` refer to `positions`, `vertex_base` is added to the vertex indices written in `out_data.vertices`.
+void build_meshlets(exo::Span<const float4> positions,
+	exo::Span<const u32>                    indices,
+	u32                                     vertex_base,
+	MeshletData                            &out_data);
+
+// -- Culling
+
+struct MeshletCullingView
+{
+	// Planes are in the object space of the mesh, a point p is inside when dot(plane.xyz, p) + plane.w >= 0
+	float4 frustum_planes[6] = {};
+	u32    planes_count      = 0;
+	// Position of the camera in the object space of the mesh, backface culling assumes the transform has no
+	// non-uniform scale
+	float3 camera_position   = {};
+	bool   backface_culling  = true;
+
+	static MeshletCullingView create(
+		const float4x4 &world_transform, const float4x4 &view, const float4x4 &projection, float3 camera_position);
+};
+
+bool is_meshlet_visible(const MeshletCullingView &view, const MeshletBounds &bounds);
+
+// Appends the index of the visible meshlets in [first_meshlet, first_meshlet + meshlets_count) to `out_visible`
+void cull_meshlets(const MeshletCullingView &view,
+	exo::Span<const MeshletBounds>           bounds,
+	u32                                      first_meshlet,
+	u32                                      meshlets_count,
+	Vec<u32>                                &out_visible);
+
+void serialize(exo::Serializer &serializer, Meshlet &data);
+void serialize(exo::Serializer &serializer, MeshletBounds &data);
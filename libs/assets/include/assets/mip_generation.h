@@ -0,0 +1,30 @@
+#pragma once
+#include "exo/collections/span.h"
+#include "exo/collections/vector.h"
+#include "exo/maths/numerics.h"
+
+struct MipGenerationSettings
+{
+	// Filter the color channels in linear space, the first 3 channels of 3 and 4 channel images are assumed to be sRGB
+	bool srgb = true;
+	// Scale the alpha of each level so that the fraction of texels above `alpha_cutoff` matches the first level,
+	// alpha-tested cutouts fade away in the small levels otherwise
+	bool  preserve_alpha_coverage = true;
+	float alpha_cutoff            = 0.5f;
+};
+
+// Number of levels down to 1x1
+u32 get_mip_count(u32 width, u32 height);
+
+// Generates the full mip chain of an 8 bits per channel image with a 2x2 box filter. Every level is filtered from the
+// previous one before quantization. The returned buffer starts with `pixels` and contains every level contiguously,
+// `out_mip_offsets` gets the byte offset of each level.
+Vec<u8> generate_mip_chain(exo::Span<const u8> pixels,
+	u32                                        width,
+	u32                                        height,
+	u32                                        channels,
+	const MipGenerationSettings               &settings,
+	Vec<usize>                                &out_mip_offsets);
+
+// Fraction of the texels whose alpha is above `alpha_cutoff`, `pixels` has 4 channels
+float compute_alpha_coverage(exo::Span<const u8> pixels, float alpha_cutoff);
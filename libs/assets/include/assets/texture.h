@@ -25,6 +25,10 @@ enum struct PixelFormat : u16
 	BC5_UNORM, // two channels
 	BC7_UNORM, // 4 channels
 	BC7_SRGB,  // 4 channels
+	BC1_UNORM, // 3 channels
+	BC3_UNORM, // 4 channels
+	BC1_SRGB,  // 3 channels
+	BC3_SRGB,  // 4 channels
 };
 
 struct Texture : Asset
@@ -45,6 +49,7 @@ struct Texture : Asset
 	usize     pixels_data_size;
 
 	void serialize(exo::Serializer &serializer) final;
+	void collect_blobs(Vec<exo::u128> &out_blobs) const final;
 };
 
 namespace exo
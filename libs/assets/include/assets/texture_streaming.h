@@ -0,0 +1,73 @@
+#pragma once
+#include "exo/collections/vector.h"
+#include "exo/maths/numerics.h"
+
+struct TextureStreamingSettings
+{
+	// Size of the resident levels, the tails are always resident and can go over it
+	usize memory_budget = 512_MiB;
+	// Size of the levels uploaded in a frame, the first upload of a frame can go over it. Evictions upload nothing.
+	usize frame_upload_budget = 16_MiB;
+	// Levels whose width and height are below this size are loaded together as the tail of the chain
+	u32 tail_max_dimension = 64;
+};
+
+struct StreamedTextureDesc
+{
+	u32        width;
+	u32        height;
+	Vec<usize> level_sizes; // byte size of each level, from the largest
+};
+
+struct StreamedTexture
+{
+	StreamedTextureDesc desc;
+	u32                 tail_first_level;
+	u32                 resident_first_level; // level count when nothing is resident
+	u32                 requested_level;
+	u64                 last_used_frame;
+};
+
+// Residency changes are applied by the renderer, the streamer only tracks the levels and the budgets
+struct TextureResidencyUploader
+{
+	// Makes the levels [first_level, level count) of a texture resident. The levels [resident_first_level, level count)
+	// are already resident and are kept, only the finer ones are uploaded; `resident_first_level` is the level count
+	// when nothing is resident. Returns false when the change cannot be done this frame, it will be requested again.
+	virtual bool set_resident_levels(u32 i_texture, u32 first_level, u32 resident_first_level) = 0;
+};
+
+// Decides which levels of each texture are resident. The tail of every texture is loaded first, finer levels are then
+// streamed in one at a time from the screen size requested each frame, the least recently used levels are evicted to
+// stay under the memory budget.
+struct TextureStreamer
+{
+	TextureStreamingSettings settings;
+	Vec<StreamedTexture>     textures;
+	Vec<u32>                 free_textures; // removed textures, their index is reused by `add_texture`
+	usize                    resident_size = 0;
+	u64                      i_frame       = 1; // 0 is used for textures that were never requested
+
+	u32 add_texture(StreamedTextureDesc desc);
+	// Replaces the levels of a texture that was imported again, nothing is resident until its new tail is uploaded.
+	// The renderer keeps sampling the previous levels until then.
+	void replace_texture(u32 i_texture, StreamedTextureDesc desc);
+	// The levels of a removed texture are no longer resident, the renderer destroys them
+	void remove_texture(u32 i_texture);
+	// `screen_size` is the size in pixels of the surface using the texture this frame
+	void request(u32 i_texture, float screen_size);
+	// Issues the residency changes of this frame and starts a new frame
+	void update(TextureResidencyUploader &uploader);
+
+	bool  is_resident(u32 i_texture) const;
+	usize get_resident_size(u32 i_texture) const;
+	// Size of the levels [first_level, level count)
+	usize get_levels_size(u32 i_texture, u32 first_level) const;
+
+private:
+	bool  set_resident_levels(TextureResidencyUploader &uploader, u32 i_texture, u32 first_level, usize &frame_size);
+	bool  make_room(TextureResidencyUploader &uploader, usize size, u32 i_texture_to_keep, usize &frame_size);
+};
+
+// Finest level whose texels are not smaller than a pixel when the texture covers `screen_size` pixels
+u32 compute_desired_level(u32 width, u32 height, u32 level_count, float screen_size);
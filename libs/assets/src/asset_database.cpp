@@ -1,20 +1,21 @@
 #include "assets/asset_database.h"
 #include "assets/asset.h"
+#include "assets/hash_file.h"
+#include "cross/file_stat.h"
 #include "cross/jobmanager.h"
 #include "cross/jobs/foreach.h"
 #include "cross/mapped_file.h"
+#include "exo/collections/set.h"
 #include "exo/hash.h"
-#include "exo/serialization/handle_serializer.h"
-#include "exo/serialization/map_serializer.h"
-#include "exo/serialization/path_serializer.h"
-#include "exo/serialization/pool_serializer.h"
-#include "exo/serialization/serializer.h"
-#include "exo/serialization/uuid_serializer.h"
+#include "exo/profile.h"
 #include "exo/string_view.h"
 #include "exo/uuid.h"
-#include "hash_file.h"
+#include <cstdio>
 #include <filesystem>
 
+// Also bumped when the layout of compiled assets changes, to import every resource again
+inline constexpr u32 ASSET_DATABASE_VERSION = 0x4244410c; // "ADB" + version
+
 // -- Resources
 enum struct TrackerAction
 {
@@ -27,15 +28,228 @@ enum struct TrackerAction
 struct ResourceTracker
 {
 	exo::Path resource_path;
-	exo::Handle<Resource> resource;
+	ResourceKey resource;
 	exo::RawHash hash;
+	cross::FileStat stat;
 	TrackerAction action = TrackerAction::None;
 	bool is_resource_outdated = false;
+	bool is_stat_cached = false;
+	bool is_missing = false; // the file could not be read, it is tracked again on its next change
+	bool is_hash_deferred = false; // large files are hashed once every other file is tracked
+};
+
+struct TrackerContext
+{
+	const AssetDatabase *database = nullptr;
+	bool use_stat_cache = false;
 };
 
-void AssetDatabase::track_resource_changes(
-	cross::JobManager &jobmanager, const exo::Path &directory, Vec<Handle<Resource>> &out_outdated_resources)
+// A file modified after the last scan started may have been modified again within the same timestamp tick, its stat
+// signature cannot be trusted
+static bool is_stat_trusted(const DatabaseIndexResource &record, const cross::FileStat &stat, u64 last_scan_time)
+{
+	return record.content_hash != 0 && record.stat == stat && record.stat.last_write_time < last_scan_time;
+}
+
+// A resource has to be imported again when it has no asset, or when its last import did not succeed for this content
+static bool is_import_outdated(const DatabaseIndexResource &record)
+{
+	return record.asset.name_hash == 0 || record.last_imported_hash != record.content_hash;
+}
+
+// Finds how the record of a hashed resource has to be updated
+static void resolve_tracker(ResourceTracker &tracker, const TrackerContext &ctx)
+{
+	const auto *self = ctx.database;
+	const auto path_key = self->find_resource_from_path(tracker.resource_path);
+	const auto content_key = self->find_resource_from_content(tracker.hash);
+
+	if (path_key.is_valid() && content_key.is_valid()) {
+		// The resource is known
+		tracker.resource = path_key;
+
+		if (is_import_outdated(self->get_resource_view(tracker.resource))) {
+			tracker.is_resource_outdated = true;
+		}
+	} else if (path_key.is_valid() && !content_key.is_valid()) {
+		// Only the content changed
+		tracker.resource = path_key;
+		tracker.is_resource_outdated = true;
+		tracker.action = TrackerAction::UpdateContentMap;
+	} else if (!path_key.is_valid() && content_key.is_valid()) {
+		// Only the path changed
+		tracker.action = TrackerAction::UpdatePathMap;
+		tracker.resource = content_key;
+	} else if (!path_key.is_valid() && !content_key.is_valid()) {
+		// New resource
+		tracker.action = TrackerAction::NewResource;
+	}
+}
+
+// Hashes the resource unless its stat signature can be trusted, and finds how its record has to be updated
+static void track_resource(ResourceTracker &tracker, const TrackerContext &ctx)
 {
+	const auto *self = ctx.database;
+	tracker.stat = cross::get_file_stat(tracker.resource_path.view()).value_or(cross::FileStat{});
+
+	const auto path_key = self->find_resource_from_path(tracker.resource_path);
+
+	// The content is not read when the stat signature did not change since the last scan
+	if (ctx.use_stat_cache && path_key.is_valid()) {
+		const auto record = self->get_resource_view(path_key);
+		if (is_stat_trusted(record, tracker.stat, self->last_scan_time)) {
+			tracker.resource = path_key;
+			tracker.hash = record.content_hash;
+			tracker.is_stat_cached = true;
+			tracker.is_resource_outdated = is_import_outdated(record);
+			return;
+		}
+	}
+
+	if (tracker.stat.size >= assets::CHUNKED_HASH_MIN_SIZE) {
+		tracker.is_hash_deferred = true;
+		return;
+	}
+
+	auto resource_file = cross::MappedFile::open(tracker.resource_path.view());
+	if (!resource_file) {
+		tracker.is_missing = true;
+		return;
+	}
+	tracker.hash = exo::RawHash{assets::hash_file64(resource_file->content())};
+	resource_file->close();
+
+	resolve_tracker(tracker, ctx);
+}
+
+// A job hashing a large file would be the last one to finish, the chunks of every deferred file are hashed in parallel
+// instead.
+static void hash_deferred_trackers(
+	const cross::JobManager &jobmanager, exo::Span<ResourceTracker> trackers, const TrackerContext &ctx)
+{
+	EXO_PROFILE_SCOPE
+	Vec<ResourceTracker *> deferred_trackers;
+	for (auto &tracker : trackers) {
+		if (tracker.is_hash_deferred) {
+			deferred_trackers.push(&tracker);
+		}
+	}
+	if (deferred_trackers.is_empty()) {
+		return;
+	}
+
+	Vec<cross::MappedFile> files;
+	files.reserve(deferred_trackers.len());
+	Vec<usize> first_chunks;
+	Vec<assets::HashChunk> chunks;
+	for (auto *tracker : deferred_trackers) {
+		tracker->is_hash_deferred = false;
+		auto resource_file = cross::MappedFile::open(tracker->resource_path.view());
+		if (!resource_file) {
+			tracker->is_missing = true;
+			files.push();
+			first_chunks.push(chunks.len());
+			continue;
+		}
+		first_chunks.push(chunks.len());
+		assets::split_hash_chunks(resource_file->content(), chunks);
+		files.push(std::move(*resource_file));
+	}
+
+	auto w = cross::parallel_foreach<assets::HashChunk>(jobmanager, chunks, assets::hash_chunk, 1);
+	w->wait();
+
+	Vec<exo::u128> chunk_hashes;
+	for (usize i_deferred = 0; i_deferred < deferred_trackers.len(); ++i_deferred) {
+		auto &tracker = *deferred_trackers[i_deferred];
+		if (tracker.is_missing) {
+			continue;
+		}
+
+		const usize chunks_end = i_deferred + 1 < first_chunks.len() ? first_chunks[i_deferred + 1] : chunks.len();
+		chunk_hashes.clear();
+		for (usize i_chunk = first_chunks[i_deferred]; i_chunk < chunks_end; ++i_chunk) {
+			chunk_hashes.push(chunks[i_chunk].hash);
+		}
+
+		const auto file_hash = assets::combine_chunk_hashes(chunk_hashes, files[i_deferred].content().len());
+		tracker.hash = exo::RawHash{assets::to_hash64(file_hash)};
+		files[i_deferred].close();
+		resolve_tracker(tracker, ctx);
+	}
+}
+
+// Updates the record of a tracked resource, the resources to import are appended to `out_outdated_resources`
+static void apply_tracker(
+	AssetDatabase &database, ResourceTracker &tracker, Vec<Handle<Resource>> &out_outdated_resources)
+{
+	if (tracker.is_missing) {
+		return;
+	}
+
+	switch (tracker.action) {
+	default:
+	case TrackerAction::None: {
+		break;
+	}
+	case TrackerAction::UpdateContentMap: {
+		const auto handle = database.journal_resource(tracker.resource);
+		const auto &record = database.resource_records.get(handle);
+		const auto old_file_hash = record.content_hash.value != 0 ? record.content_hash : record.last_imported_hash;
+		if (old_file_hash.value != 0 && database.resource_content_map.at(old_file_hash)) {
+			database.resource_content_map.remove(old_file_hash);
+		}
+		database.resource_content_map.insert(tracker.hash, handle);
+		tracker.resource = ResourceKey{.journal = handle};
+		break;
+	}
+	case TrackerAction::UpdatePathMap: {
+		const auto handle = database.journal_resource(tracker.resource);
+		const auto &old_path = database.resource_records.get(handle).resource_path;
+		database.resource_path_map.remove(old_path);
+		database.resource_path_map.insert(tracker.resource_path, handle);
+		database.resource_records.get(handle).resource_path = tracker.resource_path;
+		tracker.resource = ResourceKey{.journal = handle};
+		break;
+	}
+	case TrackerAction::NewResource: {
+		Resource new_record = {};
+		new_record.asset_id = AssetId::invalid();
+		new_record.resource_path = tracker.resource_path;
+		const auto handle = database.resource_records.add(std::move(new_record));
+		tracker.resource = ResourceKey{.journal = handle};
+		tracker.is_resource_outdated = true;
+		database.resource_path_map.insert(tracker.resource_path, handle);
+		database.resource_content_map.insert(tracker.hash, handle);
+		break;
+	}
+	}
+
+	// Unchanged records stay in the index, only the records that changed or that will be imported are journaled
+	const auto record_view = database.get_resource_view(tracker.resource);
+	if (!tracker.is_resource_outdated && record_view.content_hash == tracker.hash.value &&
+		record_view.stat == tracker.stat) {
+		return;
+	}
+
+	const auto handle = database.journal_resource(tracker.resource);
+	auto &record = database.resource_records.get(handle);
+	record.content_hash = tracker.hash;
+	record.stat = tracker.stat;
+
+	if (tracker.is_resource_outdated) {
+		out_outdated_resources.push(handle);
+	}
+}
+
+void AssetDatabase::track_resource_changes(cross::JobManager &jobmanager,
+	const exo::Path &directory,
+	Vec<Handle<Resource>> &out_outdated_resources,
+	ResourceTrackingMode mode)
+{
+	EXO_PROFILE_SCOPE
+	const u64 scan_time = cross::get_current_file_time();
+
 	Vec<ResourceTracker> trackers;
 
 	// Try to track moved/outdated resources from disk
@@ -50,92 +264,199 @@ void AssetDatabase::track_resource_changes(
 		tracker.resource_path = exo::Path::from_string(exo::StringView{path_string.c_str(), path_string.size()});
 	}
 
-	auto w = cross::parallel_foreach_userdata<ResourceTracker, const AssetDatabase, true>(
+	TrackerContext ctx = {
+		.database = this,
+		.use_stat_cache = mode != ResourceTrackingMode::HashAll,
+	};
+
+	auto w = cross::parallel_foreach_userdata<ResourceTracker, const TrackerContext, true>(
 		jobmanager,
 		trackers,
-		this,
-		[](ResourceTracker &tracker, const AssetDatabase *self) {
-			auto resource_file = cross::MappedFile::open(tracker.resource_path.view()).value();
-			tracker.hash = exo::RawHash{assets::hash_file64(resource_file.content())};
-			resource_file.close();
-
-			const auto *content_map_entry = self->resource_content_map.at(tracker.hash);
-			const auto *path_map_entry = self->resource_path_map.at(tracker.resource_path);
-
-			if (path_map_entry && content_map_entry) {
-				// The resource is known
-				tracker.resource = *path_map_entry;
-
-				// If the resource has no asset id in the database it is outdated
-				if (!self->resource_records.get(tracker.resource).asset_id.is_valid()) {
-					tracker.is_resource_outdated = true;
-				}
-			} else if (path_map_entry && !content_map_entry) {
-				// Only the content changed
-				tracker.resource = *path_map_entry;
-				tracker.is_resource_outdated = true;
-				tracker.action = TrackerAction::UpdateContentMap;
-			} else if (!path_map_entry && content_map_entry) {
-				// Only the path changed
-				tracker.action = TrackerAction::UpdatePathMap;
-				tracker.resource = *content_map_entry;
-			} else if (!path_map_entry && !content_map_entry) {
-				// New resource
-				tracker.action = TrackerAction::NewResource;
-			}
-		},
+		&ctx,
+		[](ResourceTracker &tracker, const TrackerContext *tracker_ctx) { track_resource(tracker, *tracker_ctx); },
 		8);
 	w->wait();
+	hash_deferred_trackers(jobmanager, trackers, ctx);
 
 	for (auto &tracker : trackers) {
-		switch (tracker.action) {
-		default:
-		case TrackerAction::None: {
-			break;
-		}
-		case TrackerAction::UpdateContentMap: {
-			const auto old_file_hash = this->resource_records.get(tracker.resource).last_imported_hash;
-			if (old_file_hash.value != 0) {
-				this->resource_content_map.remove(old_file_hash);
+		apply_tracker(*this, tracker, out_outdated_resources);
+	}
+
+	this->last_scan_time = scan_time;
+
+	if (mode == ResourceTrackingMode::VerifyInBackground && !this->verification_waitable) {
+		for (const auto &tracker : trackers) {
+			if (tracker.is_stat_cached) {
+				auto &verification = this->pending_verifications.push();
+				verification.resource_path = tracker.resource_path;
+				verification.expected_hash = tracker.hash;
 			}
-			this->resource_content_map.insert(tracker.hash, tracker.resource);
-			break;
-		}
-		case TrackerAction::UpdatePathMap: {
-			const auto &old_path = this->resource_records.get(tracker.resource).resource_path;
-			this->resource_path_map.remove(old_path);
-			this->resource_path_map.insert(tracker.resource_path, tracker.resource);
-			this->resource_records.get(tracker.resource).resource_path = tracker.resource_path;
-			break;
-		}
-		case TrackerAction::NewResource: {
-			Resource new_record = {};
-			new_record.asset_id = AssetId::invalid();
-			new_record.resource_path = tracker.resource_path;
-			tracker.resource = this->resource_records.add(std::move(new_record));
-			tracker.is_resource_outdated = true;
-			this->resource_path_map.insert(tracker.resource_path, tracker.resource);
-			this->resource_content_map.insert(tracker.hash, tracker.resource);
-			break;
 		}
+
+		if (!this->pending_verifications.is_empty()) {
+			this->verification_waitable = cross::parallel_foreach<ResourceVerification>(
+				jobmanager,
+				this->pending_verifications,
+				[](ResourceVerification &verification) {
+					EXO_PROFILE_SCOPE_NAMED("Verify resource")
+					// A file that cannot be read right now is assumed unchanged, it will be hashed on the next scan if
+					// its stat signature changes. The files are streamed, verifying in the background does not map
+					// every resource.
+					const auto hash = assets::hash_file64_streamed(verification.resource_path.view());
+					verification.hash = exo::RawHash{hash.value_or(verification.expected_hash.value)};
+				},
+				8);
+		}
+	}
+}
+
+void AssetDatabase::track_resource_change(
+	cross::JobManager &jobmanager, const exo::Path &path, Vec<Handle<Resource>> &out_outdated_resources)
+{
+	EXO_PROFILE_SCOPE
+	ResourceTracker tracker = {};
+	tracker.resource_path = path;
+	if (!cross::get_file_stat(path.view())) {
+		return;
+	}
+
+	const TrackerContext ctx = {.database = this, .use_stat_cache = true};
+	track_resource(tracker, ctx);
+	hash_deferred_trackers(jobmanager, exo::Span<ResourceTracker>(&tracker, 1), ctx);
+	apply_tracker(*this, tracker, out_outdated_resources);
+}
+
+bool AssetDatabase::poll_resource_verification(Vec<Handle<Resource>> &out_outdated_resources)
+{
+	if (!this->verification_waitable || !this->verification_waitable->is_done()) {
+		return false;
+	}
+
+	for (const auto &verification : this->pending_verifications) {
+		if (verification.hash == verification.expected_hash) {
+			continue;
+		}
+
+		// The content changed without changing the stat signature, unless the resource was tracked again since
+		const auto key = this->find_resource_from_path(verification.resource_path);
+		if (!key.is_valid() || this->get_resource_view(key).content_hash != verification.expected_hash.value) {
+			continue;
 		}
 
-		if (tracker.is_resource_outdated) {
-			out_outdated_resources.push(tracker.resource);
+		const auto handle = this->journal_resource(key);
+		auto &record = this->resource_records.get(handle);
+		if (this->resource_content_map.at(verification.expected_hash)) {
+			this->resource_content_map.remove(verification.expected_hash);
 		}
+		this->resource_content_map.insert(verification.hash, handle);
+		record.content_hash = verification.hash;
+		out_outdated_resources.push(handle);
+	}
+
+	this->pending_verifications.clear();
+	this->verification_waitable = nullptr;
+	return true;
+}
+
+ResourceKey AssetDatabase::find_resource_from_path(const exo::Path &path) const
+{
+	if (const auto *handle = this->resource_path_map.at(path)) {
+		return ResourceKey{.journal = *handle};
 	}
+
+	// Journaled records are only found in the journal, their path may have changed since the index was written
+	const u32 i_indexed = this->index.find_resource_by_path(path.view());
+	if (i_indexed == u32_invalid || this->is_journaled(i_indexed)) {
+		return {};
+	}
+	return ResourceKey{.i_indexed = i_indexed};
+}
+
+ResourceKey AssetDatabase::find_resource_from_content(exo::RawHash content_hash) const
+{
+	if (const auto *handle = this->resource_content_map.at(content_hash)) {
+		return ResourceKey{.journal = *handle};
+	}
+
+	const u32 i_indexed = this->index.find_resource_by_content(content_hash.value);
+	if (i_indexed == u32_invalid || this->is_journaled(i_indexed)) {
+		return {};
+	}
+	return ResourceKey{.i_indexed = i_indexed};
+}
+
+DatabaseIndexResource AssetDatabase::get_resource_view(const ResourceKey &key) const
+{
+	ASSERT(key.is_valid());
+	Handle<Resource> handle = key.journal;
+	if (!handle.is_valid()) {
+		if (!this->is_journaled(key.i_indexed)) {
+			return this->index.get_resource(key.i_indexed);
+		}
+		handle = this->indexed_journal[key.i_indexed];
+	}
+
+	const auto &record = this->resource_records.get(handle);
+	return DatabaseIndexResource{
+		.asset = {.name = record.asset_id.name, .name_hash = record.asset_id.name_hash},
+		.path = record.resource_path.view(),
+		.last_imported_hash = record.last_imported_hash.value,
+		.import_key = record.import_key.value,
+		.content_hash = record.content_hash.value,
+		.stat = record.stat,
+	};
+}
+
+Handle<Resource> AssetDatabase::journal_resource(const ResourceKey &key)
+{
+	ASSERT(key.is_valid());
+	if (key.journal.is_valid()) {
+		return key.journal;
+	}
+	if (this->is_journaled(key.i_indexed)) {
+		return this->indexed_journal[key.i_indexed];
+	}
+
+	const auto indexed = this->index.get_resource(key.i_indexed);
+	Resource record = {};
+	if (indexed.asset.name_hash != 0) {
+		record.asset_id = AssetId{.name = exo::String(indexed.asset.name), .name_hash = indexed.asset.name_hash};
+	}
+	record.resource_path = exo::Path::from_string(indexed.path);
+	record.last_imported_hash = exo::RawHash{indexed.last_imported_hash};
+	record.import_key = exo::RawHash{indexed.import_key};
+	record.content_hash = exo::RawHash{indexed.content_hash};
+	record.stat = indexed.stat;
+
+	const auto handle = this->resource_records.add(std::move(record));
+	const auto &journaled = this->resource_records.get(handle);
+	this->resource_path_map.insert(journaled.resource_path, handle);
+	if (journaled.content_hash.value != 0) {
+		this->resource_content_map.insert(journaled.content_hash, handle);
+	}
+
+	if (this->indexed_journal.is_empty()) {
+		this->indexed_journal.resize(this->index.get_resource_count());
+	}
+	this->indexed_journal[key.i_indexed] = handle;
+	return handle;
+}
+
+bool AssetDatabase::is_journaled(u32 i_indexed) const
+{
+	return !this->indexed_journal.is_empty() && this->indexed_journal[i_indexed].is_valid();
 }
 
 Resource &AssetDatabase::get_resource_from_path(const exo::Path &path)
 {
-	auto handle = *this->resource_path_map.at(path);
-	return this->resource_records.get(handle);
+	const auto key = this->find_resource_from_path(path);
+	return this->resource_records.get(this->journal_resource(key));
 }
 
 Resource &AssetDatabase::get_resource_from_content(exo::RawHash content_hash)
 {
-	auto handle = *this->resource_content_map.at(content_hash);
-	return this->resource_records.get(handle);
+	const auto key = this->find_resource_from_content(content_hash);
+	return this->resource_records.get(this->journal_resource(key));
 }
 
 // -- Assets
@@ -158,18 +479,154 @@ void AssetDatabase::insert_asset(refl::BasePtr<Asset> asset)
 	this->asset_id_map.insert(asset->uuid, asset);
 }
 
-// -- Serialization
+void AssetDatabase::update_dependency_closure(const AssetId &id)
+{
+	auto asset = this->get_asset(id);
+	ASSERT(asset.is_valid());
+
+	Vec<AssetId> closure;
+	exo::Set<AssetId> visited;
+	visited.insert(id);
 
-void serialize(exo::Serializer &serializer, Resource &data)
+	Vec<AssetId> stack;
+	for (const auto &dep : asset->dependencies) {
+		stack.push(dep);
+	}
+	while (!stack.is_empty()) {
+		const AssetId dep_id = stack.last();
+		stack.pop();
+		if (visited.contains(dep_id)) {
+			continue;
+		}
+		visited.insert(dep_id);
+		closure.push(dep_id);
+
+		// Assets imported before this one are not always in memory, their stored closure is used instead
+		if (auto dep = this->get_asset(dep_id); dep.is_valid()) {
+			for (const auto &dep_dep : dep->dependencies) {
+				stack.push(dep_dep);
+			}
+		} else if (Vec<AssetId> dep_closure; this->get_dependency_closure(dep_id, dep_closure)) {
+			for (const auto &dep_dep : dep_closure) {
+				if (!visited.contains(dep_dep)) {
+					visited.insert(dep_dep);
+					closure.push(dep_dep);
+				}
+			}
+		}
+	}
+
+	if (auto *existing = this->asset_dependency_closures.at(id)) {
+		*existing = std::move(closure);
+	} else {
+		this->asset_dependency_closures.insert(id, std::move(closure));
+	}
+}
+
+bool AssetDatabase::get_dependency_closure(const AssetId &id, Vec<AssetId> &out_closure) const
+{
+	if (const auto *closure = this->asset_dependency_closures.at(id)) {
+		for (const auto &dep : *closure) {
+			out_closure.push(dep);
+		}
+		return true;
+	}
+
+	const u32 i_closure = this->index.find_closure(id.name_hash);
+	if (i_closure == u32_invalid) {
+		return false;
+	}
+	const u32 dependency_count = this->index.get_closure_dependency_count(i_closure);
+	for (u32 i_dependency = 0; i_dependency < dependency_count; ++i_dependency) {
+		const auto dep = this->index.get_closure_dependency(i_closure, i_dependency);
+		out_closure.push(AssetId{.name = exo::String(dep.name), .name_hash = dep.name_hash});
+	}
+	return true;
+}
+
+// -- Index
+
+void AssetDatabase::open_index(const exo::Path &path)
+{
+	EXO_PROFILE_SCOPE
+	this->index = {};
+	this->index_file.close();
+	if (!std::filesystem::exists(std::filesystem::path{path.view().data()})) {
+		return;
+	}
+
+	this->index_file = cross::MappedFile::open(path.view()).value();
+	// Indexes written by another version or hashed with another algorithm are dropped, every resource will be tracked
+	// and imported again
+	this->index =
+		DatabaseIndex::from_bytes(this->index_file.content(), ASSET_DATABASE_VERSION, assets::get_hash_algorithm());
+	this->last_scan_time = this->index.get_last_scan_time();
+}
+
+static DatabaseIndexAsset to_index_asset(const AssetId &id)
 {
-	exo::serialize(serializer, data.asset_id);
-	exo::serialize(serializer, data.resource_path);
-	exo::serialize(serializer, data.last_imported_hash);
+	return DatabaseIndexAsset{.name = id.name, .name_hash = id.name_hash};
 }
 
-void serialize(exo::Serializer &serializer, AssetDatabase &db)
+void AssetDatabase::save_index(const exo::Path &path)
 {
-	exo::serialize(serializer, db.resource_path_map);
-	exo::serialize(serializer, db.resource_content_map);
-	exo::serialize(serializer, db.resource_records);
+	EXO_PROFILE_SCOPE
+	DatabaseIndexWriter writer;
+
+	for (u32 i_indexed = 0; i_indexed < this->index.get_resource_count(); ++i_indexed) {
+		if (!this->is_journaled(i_indexed)) {
+			writer.add_resource(this->index.get_resource(i_indexed));
+		}
+	}
+	for (auto [handle, p_resource] : this->resource_records) {
+		writer.add_resource(this->get_resource_view(ResourceKey{.journal = handle}));
+	}
+
+	Vec<DatabaseIndexAsset> closure;
+	for (u32 i_closure = 0; i_closure < this->index.get_closure_count(); ++i_closure) {
+		const auto asset = this->index.get_closure_asset(i_closure);
+		// Only the hash is compared by the lookup
+		if (this->asset_dependency_closures.at(AssetId{.name_hash = asset.name_hash})) {
+			continue;
+		}
+
+		closure.clear();
+		const u32 dependency_count = this->index.get_closure_dependency_count(i_closure);
+		for (u32 i_dependency = 0; i_dependency < dependency_count; ++i_dependency) {
+			closure.push(this->index.get_closure_dependency(i_closure, i_dependency));
+		}
+		writer.add_closure(asset, closure);
+	}
+	for (const auto &[id, dependencies] : this->asset_dependency_closures) {
+		closure.clear();
+		for (const auto &dep : dependencies) {
+			closure.push(to_index_asset(dep));
+		}
+		writer.add_closure(to_index_asset(id), closure);
+	}
+
+	const auto content = writer.write(ASSET_DATABASE_VERSION, assets::get_hash_algorithm(), this->last_scan_time);
+
+	// The new index is written next to the current one and renamed over it, a crash while writing keeps the old index
+	const auto index_path = std::filesystem::path{path.view().data()};
+	auto       temp_path  = index_path;
+	temp_path += ".tmp";
+
+	FILE *fp = fopen(temp_path.string().c_str(), "wb");
+	ASSERT(fp != nullptr);
+	auto bwritten = fwrite(content.data(), 1, content.len(), fp);
+	ASSERT(bwritten == content.len());
+	fclose(fp);
+
+	// The file cannot be replaced while it is mapped
+	this->index = {};
+	this->index_file.close();
+	std::filesystem::rename(temp_path, index_path);
+
+	this->indexed_journal.clear();
+	this->resource_records = {};
+	this->resource_path_map = {};
+	this->resource_content_map = {};
+	this->asset_dependency_closures = {};
+	this->open_index(path);
 }
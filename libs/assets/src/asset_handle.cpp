@@ -0,0 +1,25 @@
+#include "assets/asset_handle.h"
+
+#include "exo/macros/assert.h"
+
+AssetHandle AssetNameTable::intern(const AssetId &id)
+{
+	const auto handle = AssetHandle::from_id(id);
+	if (handle.is_valid() && !this->ids.at(handle)) {
+		this->ids.insert(handle, id);
+	}
+	return handle;
+}
+
+const AssetId &AssetNameTable::get_id(AssetHandle handle) const
+{
+	const auto *id = this->ids.at(handle);
+	ASSERT(id != nullptr);
+	return *id;
+}
+
+exo::StringView AssetNameTable::get_name(AssetHandle handle) const
+{
+	const auto *id = this->ids.at(handle);
+	return id ? exo::StringView{id->name} : exo::StringView{};
+}
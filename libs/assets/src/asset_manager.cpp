@@ -1,11 +1,16 @@
 #include "assets/asset_manager.h"
 #include "assets/asset.h"
+#include "assets/hash_file.h"
 #include "assets/importers/gltf_importer.h"
 #include "assets/importers/ktx2_importer.h"
 #include "assets/importers/png_importer.h"
+#include "cross/file_watcher.h"
 #include "cross/jobmanager.h"
 #include "cross/jobs/custom.h"
+#include "cross/jobs/foreach.h"
 #include "cross/mapped_file.h"
+#include "exo/collections/map.h"
+#include "exo/collections/set.h"
 #include "exo/collections/span.h"
 #include "exo/format.h"
 #include "exo/hash.h"
@@ -13,12 +18,16 @@
 #include "exo/memory/scope_stack.h"
 #include "exo/serialization/serializer.h"
 #include "exo/serialization/serializer_helper.h"
-#include "hash_file.h"
 #include "reflection/reflection.h"
 #include "reflection/reflection_serializer.h"
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
+#include <mutex>
+#include <thread>
+
+using Clock = std::chrono::high_resolution_clock;
 
-static const exo::Path AssetPath = exo::Path::from_string(ASSET_PATH);
 static const exo::Path DatabasePath = exo::Path::from_string(DATABASE_PATH);
 static const exo::Path CompiledAssetPath = exo::Path::from_string(COMPILED_ASSET_PATH);
 
@@ -28,7 +37,7 @@ exo::Path AssetManager::get_asset_path(const AssetId &id)
 	return exo::Path::join(CompiledAssetPath, filename);
 }
 
-AssetManager AssetManager::create(cross::JobManager &jobmanager)
+AssetManager AssetManager::open(cross::JobManager &jobmanager)
 {
 	AssetManager asset_manager = {};
 	asset_manager.jobmanager = &jobmanager;
@@ -36,95 +45,502 @@ AssetManager AssetManager::create(cross::JobManager &jobmanager)
 	asset_manager.importers.push(new GLTFImporter{});
 	asset_manager.importers.push(new PNGImporter{});
 	asset_manager.importers.push(new KTX2Importer{});
+	asset_manager.import_stats.resize(asset_manager.importers.len());
 
-	const auto database_path = std::filesystem::path{DatabasePath.view().data()};
-	if (std::filesystem::exists(database_path)) {
-		auto resource_file = cross::MappedFile::open(DatabasePath.view()).value();
-		exo::serializer_helper::read_object(resource_file.content(), asset_manager.database);
-	}
+	asset_manager.blob_store = BlobStore::open(CompiledAssetPath);
 
-	Vec<Handle<Resource>> outdated_resources;
-	asset_manager.database.track_resource_changes(jobmanager, AssetPath, outdated_resources);
-	asset_manager._import_resources(outdated_resources);
+	asset_manager.database.open_index(DatabasePath);
 
-	exo::serializer_helper::write_object_to_file(DatabasePath.view(), asset_manager.database);
+	return asset_manager;
+}
 
+AssetManager AssetManager::create(
+	cross::JobManager &jobmanager, ResourceTrackingMode tracking_mode, exo::StringView resource_directory)
+{
+	AssetManager asset_manager = AssetManager::open(jobmanager);
+	asset_manager.import_outdated_resources(tracking_mode, resource_directory);
 	return asset_manager;
 }
 
-static void import_resource(AssetManager &manager, AssetId id, const exo::Path &path)
+void AssetManager::import_outdated_resources(
+	ResourceTrackingMode tracking_mode, exo::StringView resource_directory, ImportProgress *progress)
 {
-	auto file_extension = path.extension();
+	EXO_PROFILE_SCOPE
+	auto set_phase = [&](ImportPhase phase) {
+		if (progress) {
+			progress->phase.store(phase);
+		}
+	};
+
+	set_phase(ImportPhase::TrackingResources);
+	Vec<Handle<Resource>> outdated_resources;
+	this->database.track_resource_changes(
+		*this->jobmanager, exo::Path::from_string(resource_directory), outdated_resources, tracking_mode);
+	this->_collect_stale_imports(outdated_resources);
+
+	set_phase(ImportPhase::Importing);
+	this->_import_resources(outdated_resources, progress);
 
-	// Find an importer for this resource
-	u32 i_found_importer = u32_invalid;
+	set_phase(ImportPhase::SavingDatabase);
+	this->database.save_index(DatabasePath);
+	this->blob_store.save_index();
+
+	set_phase(ImportPhase::Done);
+}
+
+// -- Import
+// Every resource to import is a node of a graph. Dependencies are discovered with `Importer::create_asset` and have to
+// be processed before the resources depending on them. Nodes whose dependencies are processed are processed
+// concurrently on the job system.
+struct ImportContext;
+
+struct ImportNode
+{
+	ImportContext *ctx = nullptr;
+	AssetId asset_id = {}; // invalid when the importer should create a new id
+	exo::Path path = {};
+	u32 i_importer = u32_invalid;
+	bool needs_create = true;
+
+	CreateResponse create_response = {};
+	ProcessResponse process_response = {};
+	exo::RawHash resource_hash = {};
+	double create_seconds = 0.0;
+	double process_seconds = 0.0;
+	usize blob_size = 0;
+	Vec<refl::BasePtr<Asset>> replaced_assets = {};
+
+	Vec<u32> dependents = {};
+	u32 remaining_dependencies = 0;
+	bool is_processed = false;
+};
+
+struct ImportContext
+{
+	AssetManager *manager = nullptr;
+	ImportProgress *progress = nullptr;
+	std::mutex mutex;
+	Vec<ImportNode> nodes;
+	exo::Map<exo::Path, u32> node_path_map;
+};
+
+static double seconds_since(Clock::time_point start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Same as `exo::Path::extension`, without allocating a path for every resource of the database
+static exo::StringView get_extension(exo::StringView path)
+{
+	for (usize i = path.len(); i > 0; --i) {
+		if (path.data()[i - 1] == '.') {
+			return exo::StringView{path.data() + i - 1, path.len() - i + 1};
+		}
+	}
+	return exo::StringView{};
+}
+
+static u32 find_importer(const AssetManager &manager, exo::StringView path)
+{
+	auto file_extension = get_extension(path);
 	for (u32 i_importer = 0; i_importer < manager.importers.len(); ++i_importer) {
 		if (manager.importers[i_importer]->can_import_extension({&file_extension, 1})) {
-			i_found_importer = i_importer;
-			break;
+			return i_importer;
+		}
+	}
+	return u32_invalid;
+}
+
+// Dependencies whose compiled asset is up to date are read from disk by the importers instead of being imported again
+static bool is_import_up_to_date(const AssetManager &manager, const AssetId &id, const exo::Path &path)
+{
+	const auto key = manager.database.find_resource_from_path(path);
+	const u32 i_importer = find_importer(manager, path.view());
+	if (!key.is_valid() || i_importer == u32_invalid) {
+		return false;
+	}
+
+	const auto resource = manager.database.get_resource_view(key);
+	return resource.asset.name_hash == id.name_hash && resource.content_hash != 0 &&
+	       resource.import_key == get_import_key(*manager.importers[i_importer], resource.content_hash) &&
+	       std::filesystem::exists(std::filesystem::path{AssetManager::get_asset_path(id).view().data()});
+}
+
+static u32 add_import_node(ImportContext &ctx, const AssetId &id, const exo::Path &path)
+{
+	if (const u32 *i_existing = ctx.node_path_map.at(path)) {
+		auto &node = ctx.nodes[*i_existing];
+		if (!(node.asset_id == id)) {
+			if (!node.asset_id.is_valid()) {
+				// The resource did not have an asset yet, use the id expected by the resource depending on it
+				node.asset_id = id;
+				node.needs_create = true;
+			} else {
+				exo::logger::error("%s is imported as %s but %s was requested.\n",
+					path.view().data(),
+					node.asset_id.name.c_str(),
+					id.name.c_str());
+			}
 		}
+		return *i_existing;
 	}
-	if (i_found_importer == u32_invalid) {
+
+	const u32 i_importer = find_importer(*ctx.manager, path.view());
+	if (i_importer == u32_invalid) {
 		exo::logger::error("Importer not found. %s\n", path.view().data());
-		return;
+		return u32_invalid;
 	}
 
-	auto &importer = *manager.importers[i_found_importer];
+	const u32 i_node = u32(ctx.nodes.len());
+	auto &node = ctx.nodes.push();
+	node.ctx = &ctx;
+	node.asset_id = id;
+	node.path = path;
+	node.i_importer = i_importer;
+	ctx.node_path_map.insert(path, i_node);
+	return i_node;
+}
 
-	// Create a new asset for this resource
-	CreateRequest create_req{};
-	create_req.asset = std::move(id);
-	create_req.path = path;
-	auto create_resp = std::move(importer.create_asset(create_req).value());
-	ASSERT(create_resp.new_id.is_valid());
+// Creates the nodes until no new dependency is discovered
+static void create_import_nodes(ImportContext &ctx)
+{
+	EXO_PROFILE_SCOPE
+	Vec<u32> wave;
+	while (true) {
+		wave.clear();
+		for (u32 i_node = 0; i_node < ctx.nodes.len(); ++i_node) {
+			if (ctx.nodes[i_node].needs_create) {
+				ctx.nodes[i_node].needs_create = false;
+				wave.push(i_node);
+			}
+		}
+		if (wave.is_empty()) {
+			break;
+		}
+
+		auto w = cross::parallel_foreach_userdata<u32, ImportContext, true>(
+			*ctx.manager->jobmanager,
+			wave,
+			&ctx,
+			[](u32 &i_node, ImportContext *import_ctx) {
+				EXO_PROFILE_SCOPE_NAMED("Create asset")
+				const auto start = Clock::now();
+				auto &node = import_ctx->nodes[i_node];
+				auto *importer = import_ctx->manager->importers[node.i_importer];
+				CreateRequest create_req{};
+				create_req.asset = node.asset_id;
+				create_req.path = node.path;
+				node.create_response = std::move(importer->create_asset(create_req).value());
+				ASSERT(node.create_response.new_id.is_valid());
+				node.create_seconds += seconds_since(start);
+			},
+			1);
+		w->wait();
 
-	// Create and process its dependencies
-	for (u32 i_dep = 0; i_dep < create_resp.dependencies_id.len(); ++i_dep) {
-		import_resource(manager, create_resp.dependencies_id[i_dep], create_resp.dependencies_paths[i_dep]);
+		// `nodes` can grow while the dependencies are added, don't keep references to nodes
+		for (u32 i_node : wave) {
+			const usize dependencies_count = ctx.nodes[i_node].create_response.dependencies_id.len();
+			for (usize i_dep = 0; i_dep < dependencies_count; ++i_dep) {
+				const auto dep_id = ctx.nodes[i_node].create_response.dependencies_id[i_dep];
+				const auto dep_path = ctx.nodes[i_node].create_response.dependencies_paths[i_dep];
+				if (!ctx.node_path_map.at(dep_path) && is_import_up_to_date(*ctx.manager, dep_id, dep_path)) {
+					continue;
+				}
+				add_import_node(ctx, dep_id, dep_path);
+			}
+		}
 	}
 
-	// Process this new asset
-	ImporterApi api{manager};
-	ProcessRequest process_req{.importer_api = api};
-	process_req.asset = create_resp.new_id;
-	process_req.path = path;
-	auto process_resp = std::move(importer.process_asset(process_req).value());
-	ASSERT(!process_resp.products.is_empty());
+	for (u32 i_node = 0; i_node < ctx.nodes.len(); ++i_node) {
+		for (const auto &dep_path : ctx.nodes[i_node].create_response.dependencies_paths) {
+			if (const u32 *i_dep_node = ctx.node_path_map.at(dep_path)) {
+				ctx.nodes[*i_dep_node].dependents.push(i_node);
+				ctx.nodes[i_node].remaining_dependencies += 1;
+			}
+		}
+	}
+}
 
-	// Update the resource in the database
-	auto resource_file = cross::MappedFile::open(path.view()).value();
-	auto resource_hash = exo::RawHash{assets::hash_file64(resource_file.content())};
-	resource_file.close();
-	auto &asset_record = manager.database.get_resource_from_content(resource_hash);
-	if (asset_record.asset_id != process_req.asset) {
+static std::unique_ptr<cross::Waitable> launch_process_job(ImportContext &ctx, u32 i_node)
+{
+	return cross::custom_job<ImportNode>(*ctx.manager->jobmanager, &ctx.nodes[i_node], [](ImportNode *node) {
+		EXO_PROFILE_SCOPE_NAMED("Process asset")
+		const auto start = Clock::now();
+		auto *importer = node->ctx->manager->importers[node->i_importer];
+		ImporterApi api{*node->ctx->manager, node->ctx->mutex};
+		ProcessRequest process_req{.importer_api = api};
+		process_req.asset = node->create_response.new_id;
+		process_req.path = node->path;
+		node->process_response = std::move(importer->process_asset(process_req).value());
+		ASSERT(!node->process_response.products.is_empty());
+		node->blob_size = api.saved_blob_size;
+		node->replaced_assets = std::move(api.replaced_assets);
+		for (auto dependency : api.compiled_dependencies) {
+			dependency->~Asset();
+			free(dependency.get());
+		}
+
+		auto resource_file = cross::MappedFile::open(node->path.view()).value();
+		node->resource_hash = exo::RawHash{assets::hash_file64(resource_file.content())};
+		resource_file.close();
+		node->process_seconds = seconds_since(start);
+	});
+}
+
+// Called on the thread running the import when the process job of a node is done
+static void finish_import_node(ImportContext &ctx, ImportNode &node)
+{
+	auto &manager = *ctx.manager;
+	node.is_processed = true;
+
+	// Update the resource in the database, the records are only accessed from the thread running the import
+	auto &asset_record = manager.database.get_resource_from_content(node.resource_hash);
+	if (asset_record.asset_id != node.create_response.new_id) {
 		ASSERT(!asset_record.asset_id.is_valid());
-		asset_record.asset_id = process_req.asset;
+		asset_record.asset_id = node.create_response.new_id;
+	}
+	asset_record.last_imported_hash = node.resource_hash;
+	asset_record.import_key = get_import_key(*manager.importers[node.i_importer], node.resource_hash.value);
+
+	auto &stats = manager.import_stats[node.i_importer];
+	stats.resource_count += 1;
+	stats.product_count += u32(node.process_response.products.len());
+	stats.create_seconds += node.create_seconds;
+	stats.process_seconds += node.process_seconds;
+	stats.blob_size += node.blob_size;
+
+	// The loaded assets replaced by this import are published to their consumers and released, their replacements are
+	// accounted like a first import
+	for (auto previous : node.replaced_assets) {
+		manager.reimported_assets.push(previous->uuid);
+		manager._destroy_asset(previous);
 	}
-	asset_record.last_imported_hash = resource_hash;
 
 	// write the assets produced by this resource to disk
-	for (const auto &product : process_resp.products) {
-		auto asset = manager.load_asset(product);
-		manager._save_to_disk(asset);
+	for (const auto &product : node.process_response.products) {
+		refl::BasePtr<Asset> asset = refl::BasePtr<Asset>::invalid();
+		{
+			std::lock_guard lock{ctx.mutex};
+			asset = manager.load_asset(product);
+			// The dependencies were processed before this node, their closures are up to date
+			manager.database.update_dependency_closure(product);
+		}
+		stats.asset_size += manager._save_to_disk(asset);
+
+		// Reimported assets keep the accounting of their first import
+		if (const auto *resident = manager.residency.assets.at(product); !resident || !resident->is_resident) {
+			for (const auto &dep : asset->dependencies) {
+				manager.residency.add_ref(dep);
+			}
+			// Completes the loaded assets that were waiting for the replaced one
+			manager._set_fully_loaded(asset->uuid);
+		}
 	}
 }
 
-void AssetManager::_import_resources(exo::Span<const Handle<Resource>> records)
+static void process_import_nodes(ImportContext &ctx)
 {
+	EXO_PROFILE_SCOPE
+	Vec<u32> running_nodes;
+	Vec<std::unique_ptr<cross::Waitable>> running_jobs;
+
+	for (u32 i_node = 0; i_node < ctx.nodes.len(); ++i_node) {
+		if (ctx.nodes[i_node].remaining_dependencies == 0) {
+			running_nodes.push(i_node);
+			running_jobs.push(launch_process_job(ctx, i_node));
+		}
+	}
+
+	while (!running_nodes.is_empty()) {
+		bool finished_any = false;
+		for (usize i_running = 0; i_running < running_nodes.len();) {
+			if (!running_jobs[i_running]->is_done()) {
+				i_running += 1;
+				continue;
+			}
+			finished_any = true;
+
+			const u32 i_node = running_nodes[i_running];
+			running_nodes[i_running] = running_nodes.last();
+			running_jobs[i_running] = std::move(running_jobs.last());
+			running_nodes.pop();
+			running_jobs.pop();
+
+			auto &node = ctx.nodes[i_node];
+			finish_import_node(ctx, node);
+			if (ctx.progress) {
+				ctx.progress->imported_count.fetch_add(1);
+			}
+
+			for (u32 i_dependent : node.dependents) {
+				auto &dependent = ctx.nodes[i_dependent];
+				ASSERT(dependent.remaining_dependencies > 0);
+				dependent.remaining_dependencies -= 1;
+				if (dependent.remaining_dependencies == 0) {
+					running_nodes.push(i_dependent);
+					running_jobs.push(launch_process_job(ctx, i_dependent));
+				}
+			}
+		}
+
+		if (!finished_any) {
+			std::this_thread::yield();
+		}
+	}
+
+	for (const auto &node : ctx.nodes) {
+		if (!node.is_processed) {
+			exo::logger::error("%s was not imported, its dependencies form a cycle.\n", node.path.view().data());
+		}
+	}
+}
+
+void AssetManager::_import_resources(exo::Span<const Handle<Resource>> records, ImportProgress *progress)
+{
+	EXO_PROFILE_SCOPE
+	ImportContext ctx = {};
+	ctx.manager = this;
+	ctx.progress = progress;
+
 	for (auto handle : records) {
-		auto &asset_record = this->database.resource_records.get(handle);
-		const auto &asset_path = asset_record.resource_path;
+		const auto &asset_record = this->database.resource_records.get(handle);
 
-		auto resource_file = cross::MappedFile::open(asset_path.view()).value();
-		auto resource_hash = exo::RawHash{assets::hash_file64(resource_file.content())};
-		resource_file.close();
+		// The content hash was updated when tracking resource changes
+		const u32 i_importer = find_importer(*this, asset_record.resource_path.view());
+		if (i_importer == u32_invalid) {
+			add_import_node(ctx, asset_record.asset_id, asset_record.resource_path);
+			continue;
+		}
+		const u64 import_key = get_import_key(*this->importers[i_importer], asset_record.content_hash.value);
+		if (asset_record.import_key.value != import_key) {
+			add_import_node(ctx, asset_record.asset_id, asset_record.resource_path);
+		}
+	}
+
+	if (ctx.nodes.is_empty()) {
+		return;
+	}
+
+	const usize first_reimported = this->reimported_assets.len();
+	create_import_nodes(ctx);
+	if (progress) {
+		progress->resource_count.store(u32(ctx.nodes.len()));
+	}
+	process_import_nodes(ctx);
+	if (this->reimported_assets.len() == first_reimported) {
+		return;
+	}
 
-		if (asset_record.last_imported_hash != resource_hash) {
-			import_resource(*this, asset_record.asset_id, asset_path);
+	// The compiled assets reference their dependencies by id, the loaded assets depending on a reimported asset are
+	// not imported again but get a new version as well
+	auto bump_version = [&](const AssetId &id) {
+		if (auto *version = this->asset_versions.at(id)) {
+			*version += 1;
+		} else {
+			this->asset_versions.insert(id, 1);
+		}
+	};
+
+	exo::Set<AssetId> reimported;
+	for (usize i_reimported = first_reimported; i_reimported < this->reimported_assets.len(); ++i_reimported) {
+		reimported.insert(this->reimported_assets[i_reimported]);
+		bump_version(this->reimported_assets[i_reimported]);
+	}
+
+	Vec<AssetId> closure;
+	for (const auto &[id, asset] : this->database.asset_id_map) {
+		closure.clear();
+		if (reimported.contains(id) || !this->database.get_dependency_closure(id, closure)) {
+			continue;
+		}
+		for (const auto &dep : closure) {
+			if (reimported.contains(dep)) {
+				bump_version(id);
+				break;
+			}
 		}
 	}
 }
 
+void AssetManager::_collect_stale_imports(Vec<Handle<Resource>> &out_resources)
+{
+	EXO_PROFILE_SCOPE
+	// The records are journaled after the iteration, journaling adds records to the journal being iterated
+	Vec<exo::Path> stale_paths;
+	this->database.for_each_resource([&](const DatabaseIndexResource &resource) {
+		const u32 i_importer = find_importer(*this, resource.path);
+		if (resource.content_hash == 0 || i_importer == u32_invalid) {
+			return;
+		}
+		if (resource.import_key != get_import_key(*this->importers[i_importer], resource.content_hash)) {
+			stale_paths.push(exo::Path::from_string(resource.path));
+		}
+	});
+
+	for (const auto &path : stale_paths) {
+		out_resources.push(this->database.journal_resource(this->database.find_resource_from_path(path)));
+	}
+}
+
+void AssetManager::on_file_change(const cross::Watch &watch, const cross::WatchEvent &event)
+{
+	// Removed resources keep their record and their compiled assets
+	if (event.action == cross::WatchEventAction::FileRemoved) {
+		return;
+	}
+
+	this->last_resource_change = std::chrono::steady_clock::now();
+	auto path = exo::Path::join(exo::Path::from_string(watch.path), event.name);
+	for (const auto &changed_path : this->changed_resources) {
+		if (changed_path == path) {
+			return;
+		}
+	}
+	this->changed_resources.push(std::move(path));
+}
+
+u32 AssetManager::get_asset_version(const AssetId &id) const
+{
+	const auto *version = this->asset_versions.at(id);
+	return version ? *version : 0;
+}
+
+void AssetManager::_reimport_changed_resources()
+{
+	if (this->changed_resources.is_empty()) {
+		return;
+	}
+	const auto settle_time = std::chrono::steady_clock::now() - this->last_resource_change;
+	if (std::chrono::duration<double>(settle_time).count() < this->reimport_delay) {
+		return;
+	}
+
+	EXO_PROFILE_SCOPE
+	const auto start = Clock::now();
+
+	// Only the resources that changed are hashed, the files without importer are not tracked
+	Vec<Handle<Resource>> outdated_resources;
+	for (const auto &path : this->changed_resources) {
+		if (find_importer(*this, path.view()) != u32_invalid) {
+			this->database.track_resource_change(*this->jobmanager, path, outdated_resources);
+		}
+	}
+	this->changed_resources.clear();
+
+	if (outdated_resources.is_empty()) {
+		return;
+	}
+
+	this->_import_resources(outdated_resources);
+	this->database.save_index(DatabasePath);
+	this->blob_store.save_index();
+
+	printf("[AssetManager] Reimported %u resources (%u assets replaced) in %.1f ms.\n",
+		u32(outdated_resources.len()),
+		u32(this->reimported_assets.len()),
+		seconds_since(start) * 1000.0);
+}
+
 refl::BasePtr<Asset> AssetManager::_load_from_disk(const AssetId &id)
 {
 	auto asset_path = AssetManager::get_asset_path(id);
@@ -137,11 +553,12 @@ refl::BasePtr<Asset> AssetManager::_load_from_disk(const AssetId &id)
 	return new_asset;
 }
 
-void AssetManager::_save_to_disk(refl::BasePtr<Asset> asset)
+usize AssetManager::_save_to_disk(refl::BasePtr<Asset> asset)
 {
 	auto asset_path = AssetManager::get_asset_path(asset->uuid);
-	exo::serializer_helper::write_object_to_file(asset_path.view(), asset);
+	const usize size = exo::serializer_helper::write_object_to_file(asset_path.view(), asset);
 	exo::logger::info("Saving %s\n", asset_path.view().data());
+	return size;
 }
 
 static exo::Path get_blob_path(exo::u128 blob_hash)
@@ -158,107 +575,462 @@ static exo::Path get_blob_path(exo::u128 blob_hash)
 
 void AssetManager::update_async()
 {
-	auto to_remove = exo::Vec<AssetId>::with_capacity(this->database.asset_async_waiting_for_deps.size);
+	this->reimported_assets.clear();
 
-	// Update the state of assets waiting for their dependencies to load.
-	for (const auto &asset_id : this->database.asset_async_waiting_for_deps) {
-		auto asset = this->database.get_asset(asset_id);
-		ASSERT(asset->state == AssetState::LoadedWaitingForDeps);
+	// Reimport the resources that changed without changing their stat signature
+	Vec<Handle<Resource>> outdated_resources;
+	if (this->database.poll_resource_verification(outdated_resources) && !outdated_resources.is_empty()) {
+		printf("[AssetManager] %u resources changed since the last scan.\n", u32(outdated_resources.len()));
+		this->_import_resources(outdated_resources);
+		this->database.save_index(DatabasePath);
+		this->blob_store.save_index();
+	}
 
-		u32 loaded_deps = 0;
-		for (const auto &dep : asset->dependencies) {
-			if (this->is_fully_loaded(dep)) {
-				loaded_deps += 1;
-			}
+	// Reimport the resources reported by the file watcher
+	this->_reimport_changed_resources();
+
+	// The load jobs push their asset when they are done, only the completed loads are visited
+	Vec<AssetId> completed;
+	{
+		std::lock_guard lock{this->database.asset_async_completions->mutex};
+		std::swap(completed, this->database.asset_async_completions->asset_ids);
+	}
+
+	Vec<AssetId> still_running;
+	for (const auto &asset_id : completed) {
+		auto *req = this->database.asset_async_requests.at(asset_id);
+		ASSERT(req);
+		// The job pushes its asset right before returning, its waitable owns the job and is released once it is done
+		if (!req->waitable->is_done()) {
+			still_running.push(asset_id);
+			continue;
 		}
-		if (loaded_deps == asset->dependencies.len()) {
-			asset->state = AssetState::FullyLoaded;
-			to_remove.push(asset_id);
+
+		auto asset = req->data->result;
+		const u32 priority = req->priority;
+		this->database.asset_async_requests.remove(asset_id);
+		this->finish_loading_async(asset, priority);
+	}
+	if (!still_running.is_empty()) {
+		std::lock_guard lock{this->database.asset_async_completions->mutex};
+		for (const auto &asset_id : still_running) {
+			this->database.asset_async_completions->asset_ids.push(asset_id);
 		}
 	}
-	for (const auto &asset_id : to_remove) {
-		this->database.asset_async_waiting_for_deps.remove(asset_id);
+
+	this->_issue_async_loads();
+
+	this->residency.i_frame += 1;
+	this->evict_unused_assets();
+}
+
+void AssetManager::load_asset_async(const AssetId &id, u32 priority)
+{
+	// The asset can already be loaded as a dependency of another asset
+	if (this->is_loaded(id)) {
+		return;
 	}
 
-	// Update the state of assets that finished loading asynchronously
-	to_remove.clear();
-	to_remove.reserve(this->database.asset_async_requests.size);
-	for (const auto &[asset_id, req] : this->database.asset_async_requests) {
-		if (req.waitable->is_done()) {
-			this->finish_loading_async(req.data->result);
-			to_remove.push(asset_id);
+	// The whole closure is requested up front, the dependencies load in parallel instead of one level per frame
+	this->_request_async_load(id, priority);
+	if (Vec<AssetId> closure; this->database.get_dependency_closure(id, closure)) {
+		for (const auto &dep : closure) {
+			if (!this->is_loaded(dep)) {
+				this->_request_async_load(dep, priority);
+			}
 		}
 	}
-	for (const auto &asset_id : to_remove) {
-		this->database.asset_async_requests.remove(asset_id);
-	}
+
+	this->_issue_async_loads();
 }
 
-void AssetManager::load_asset_async(const AssetId &id)
+void AssetManager::_request_async_load(const AssetId &id, u32 priority)
 {
-	ASSERT(!this->is_loaded(id));
-
 	// Avoid loading the same assets twice
 	if (this->database.asset_async_requests.at(id)) {
 		return;
 	}
 
-	printf("[AssetManager] Loading %s asynchronously.\n", id.name.c_str());
+	// A pending load requested again keeps its place in the queue with the highest of the two priorities
+	if (auto *pending = this->database.asset_async_pending.at(id)) {
+		pending->priority = std::max(pending->priority, priority);
+		return;
+	}
 
-	auto *req = this->database.asset_async_requests.insert(id, {});
-	req->data = std::make_unique<AssetAsyncRequest::Data>();
-	req->data->asset_id = id;
+	this->database.asset_async_pending.insert(id,
+		AssetAsyncPendingLoad{.priority = priority, .order = this->database.asset_async_order});
+	this->database.asset_async_order += 1;
+}
+
+void AssetManager::_issue_async_loads()
+{
+	auto &db = this->database;
+	if (db.asset_async_pending.size == 0 || db.asset_async_requests.size >= this->max_async_loads) {
+		return;
+	}
+
+	struct PendingLoad
+	{
+		AssetId asset_id;
+		AssetAsyncPendingLoad load;
+	};
+	Vec<PendingLoad> pending_loads = Vec<PendingLoad>::with_capacity(db.asset_async_pending.size);
+	for (const auto &[asset_id, load] : db.asset_async_pending) {
+		pending_loads.push(PendingLoad{.asset_id = asset_id, .load = load});
+	}
+
+	const usize free_slots = std::min(usize(this->max_async_loads - db.asset_async_requests.size), pending_loads.len());
+	std::partial_sort(pending_loads.begin(),
+		pending_loads.begin() + free_slots,
+		pending_loads.end(),
+		[](const PendingLoad &lhs, const PendingLoad &rhs) {
+			return lhs.load.priority != rhs.load.priority ? lhs.load.priority > rhs.load.priority
+			                                              : lhs.load.order < rhs.load.order;
+		});
+
+	for (usize i_load = 0; i_load < free_slots; ++i_load) {
+		const auto &id = pending_loads[i_load].asset_id;
+		db.asset_async_pending.remove(id);
 
-	req->waitable = cross::custom_job<AssetAsyncRequest::Data>(*this->jobmanager,
-		req->data.get(),
-		[](AssetAsyncRequest::Data *data) { data->result = AssetManager::_load_from_disk(data->asset_id); });
+		printf("[AssetManager] Loading %s asynchronously.\n", id.name.c_str());
+
+		auto *req = db.asset_async_requests.insert(id, {});
+		req->priority = pending_loads[i_load].load.priority;
+		req->data = std::make_unique<AssetAsyncRequest::Data>();
+		req->data->asset_id = id;
+		req->data->completions = db.asset_async_completions.get();
+
+		req->waitable = cross::custom_job<AssetAsyncRequest::Data>(*this->jobmanager,
+			req->data.get(),
+			[](AssetAsyncRequest::Data *data) {
+				data->result = AssetManager::_load_from_disk(data->asset_id);
+
+				std::lock_guard lock{data->completions->mutex};
+				data->completions->asset_ids.push(data->asset_id);
+			});
+	}
 }
 
-void AssetManager::finish_loading_async(refl::BasePtr<Asset> asset)
+void AssetManager::finish_loading_async(refl::BasePtr<Asset> asset, u32 priority)
 {
 	printf("[AssetManager] Finished loading [%s](%s) asynchronously.\n",
 		asset.typeinfo().name,
 		asset->uuid.name.c_str());
 
+	// The asset was imported again while it was loading, the imported one is already in the database
+	if (this->database.get_asset(asset->uuid).is_valid()) {
+		asset->~Asset();
+		free(asset.get());
+		return;
+	}
+
 	this->database.insert_asset(asset);
+	for (const auto &dep : asset->dependencies) {
+		this->residency.add_ref(dep);
+	}
 
-	u32 deps_requests = 0;
+	// Dependencies are usually requested with the closure already, assets compiled without a closure discover them here
+	u32 missing_deps = 0;
 	for (const auto &dep : asset->dependencies) {
+		if (this->is_fully_loaded(dep)) {
+			continue;
+		}
 		if (!this->is_loaded(dep)) {
-			this->load_asset_async(dep);
-			deps_requests += 1;
+			this->_request_async_load(dep, priority);
+		}
+
+		if (auto *dependents = this->database.asset_async_dependents.at(dep)) {
+			dependents->push(asset->uuid);
+		} else {
+			Vec<AssetId> new_dependents;
+			new_dependents.push(asset->uuid);
+			this->database.asset_async_dependents.insert(dep, std::move(new_dependents));
 		}
+		missing_deps += 1;
 	}
 
-	if (deps_requests > 0) {
+	if (missing_deps > 0) {
 		asset->state = AssetState::LoadedWaitingForDeps;
-		this->database.asset_async_waiting_for_deps.insert(asset->uuid);
+		this->database.asset_async_waiting_for_deps.insert(asset->uuid, missing_deps);
 	} else {
-		asset->state = AssetState::FullyLoaded;
+		this->_set_fully_loaded(asset->uuid);
 	}
 }
 
-void AssetManager::unload_asset(const AssetId &id) { this->database.remove_asset(id); }
+// Assets waiting for their dependencies count the ones that are not fully loaded, the last one to become fully loaded
+// completes them
+void AssetManager::_set_fully_loaded(const AssetId &id)
+{
+	Vec<AssetId> ready;
+	ready.push(id);
+	while (!ready.is_empty()) {
+		const AssetId ready_id = ready.last();
+		ready.pop();
+		auto ready_asset = this->database.get_asset(ready_id);
+		ready_asset->state = AssetState::FullyLoaded;
+		this->_set_resident(ready_asset);
 
-usize AssetManager::read_blob(exo::u128 blob_hash, exo::Span<u8> out_data)
+		auto *dependents = this->database.asset_async_dependents.at(ready_id);
+		if (!dependents) {
+			continue;
+		}
+		for (const auto &dependent : *dependents) {
+			// The dependent can have been replaced by a reimport in the meantime
+			auto *missing_deps = this->database.asset_async_waiting_for_deps.at(dependent);
+			if (!missing_deps) {
+				continue;
+			}
+			ASSERT(*missing_deps > 0);
+			*missing_deps -= 1;
+			if (*missing_deps == 0) {
+				this->database.asset_async_waiting_for_deps.remove(dependent);
+				ready.push(dependent);
+			}
+		}
+		this->database.asset_async_dependents.remove(ready_id);
+	}
+}
+
+void AssetManager::unload_asset(const AssetId &id)
+{
+	auto asset = this->database.get_asset(id);
+	if (!asset.is_valid()) {
+		return;
+	}
+
+	this->database.remove_asset(id);
+	this->_destroy_asset(asset);
+}
+
+void AssetManager::_destroy_asset(refl::BasePtr<Asset> asset)
+{
+	const auto &id = asset->uuid;
+	for (const auto &dep : asset->dependencies) {
+		this->residency.release(dep);
+	}
+	if (const auto *resident = this->residency.assets.at(id); resident && resident->is_resident) {
+		this->residency.set_evicted(id);
+	}
+	if (this->database.asset_async_waiting_for_deps.at(id)) {
+		this->database.asset_async_waiting_for_deps.remove(id);
+	}
+
+	asset->~Asset();
+	free(asset.get());
+}
+
+void AssetManager::_set_resident(refl::BasePtr<Asset> asset)
+{
+	// The blobs are read from the blob store when the asset is installed, they are accounted with the asset
+	usize memory_size = asset.typeinfo().size;
+	Vec<exo::u128> blobs;
+	asset->collect_blobs(blobs);
+	for (const auto &blob_hash : blobs) {
+		if (const auto location = this->blob_store.find(blob_hash)) {
+			memory_size += location->size;
+		}
+	}
+
+	this->residency.set_resident(asset->uuid, asset.typeinfo().name, memory_size);
+}
+
+void AssetManager::evict_unused_assets()
+{
+	EXO_PROFILE_SCOPE
+	// Unloading an asset releases its dependencies, they can be evicted by the next pass
+	Vec<AssetId> evictions;
+	while (true) {
+		evictions.clear();
+		this->residency.collect_evictions(evictions);
+		if (evictions.is_empty()) {
+			break;
+		}
+		for (const auto &id : evictions) {
+			printf("[AssetManager] Evicting %s.\n", id.name.c_str());
+			this->unload_asset(id);
+		}
+	}
+}
+
+AssetRef::AssetRef(AssetManager &new_manager, const AssetId &new_id) : manager{&new_manager}, id{new_id}
+{
+	this->manager->acquire_asset(this->id);
+}
+
+AssetRef::~AssetRef() { this->reset(); }
+
+AssetRef::AssetRef(const AssetRef &other) : manager{other.manager}, id{other.id}
+{
+	if (this->manager) {
+		this->manager->acquire_asset(this->id);
+	}
+}
+
+AssetRef &AssetRef::operator=(const AssetRef &other)
+{
+	if (this != &other) {
+		this->reset();
+		this->manager = other.manager;
+		this->id = other.id;
+		if (this->manager) {
+			this->manager->acquire_asset(this->id);
+		}
+	}
+	return *this;
+}
+
+AssetRef::AssetRef(AssetRef &&other) noexcept : manager{other.manager}, id{std::move(other.id)}
+{
+	other.manager = nullptr;
+}
+
+AssetRef &AssetRef::operator=(AssetRef &&other) noexcept
 {
+	if (this != &other) {
+		this->reset();
+		this->manager = other.manager;
+		this->id = std::move(other.id);
+		other.manager = nullptr;
+	}
+	return *this;
+}
+
+void AssetRef::reset()
+{
+	if (this->manager) {
+		this->manager->release_asset(this->id);
+		this->manager = nullptr;
+	}
+}
+
+// Returns the blob content from the blob store, blobs saved before the store was introduced are read from their own
+// file and `out_file` keeps their mapping alive
+static exo::Span<const u8> get_blob_content(AssetManager &manager, exo::u128 blob_hash, cross::MappedFile &out_file)
+{
+	auto blob_content = manager.blob_store.get(blob_hash);
+	if (!blob_content.empty()) {
+		return blob_content;
+	}
+
 	auto path = get_blob_path(blob_hash);
-	auto blob_file = cross::MappedFile::open(path.view()).value();
-	auto blob_content = blob_file.content();
+	out_file = cross::MappedFile::open(path.view()).value();
+	return out_file.content();
+}
+
+usize AssetManager::read_blob(exo::u128 blob_hash, exo::Span<u8> out_data)
+{
+	cross::MappedFile blob_file;
+	auto blob_content = get_blob_content(*this, blob_hash, blob_file);
+
+	if (assets::is_compressed_blob(blob_content)) {
+		return assets::decompress_blob(this->jobmanager, blob_content, out_data);
+	}
+
 	ASSERT(out_data.len() >= blob_content.len());
 	std::memcpy(out_data.data(), blob_content.data(), blob_content.len());
 	return blob_content.len();
 }
 
+usize AssetManager::read_blob_range(exo::u128 blob_hash, usize offset, exo::Span<u8> out_data)
+{
+	cross::MappedFile blob_file;
+	auto blob_content = get_blob_content(*this, blob_hash, blob_file);
+
+	if (assets::is_compressed_blob(blob_content)) {
+		return assets::decompress_blob_range(blob_content, offset, out_data);
+	}
+
+	if (offset >= blob_content.len()) {
+		return 0;
+	}
+	const usize size = std::min(out_data.len(), blob_content.len() - offset);
+	std::memcpy(out_data.data(), blob_content.data() + offset, size);
+	return size;
+}
+
+// Returns the content written to the blob store, `storage` holds the compressed blob when compression is enabled
+static exo::Span<const u8> encode_blob(
+	const assets::BlobCompressionSettings &settings, exo::Span<const u8> blob_data, Vec<u8> &storage)
+{
+	if (settings.codec == assets::BlobCodec::None) {
+		return blob_data;
+	}
+	storage = assets::compress_blob(blob_data, settings);
+	return storage;
+}
+
 exo::u128 AssetManager::save_blob(exo::Span<const u8> blob_data)
 {
+	// Blobs are addressed by the hash of their uncompressed content
 	auto blob_hash = assets::hash_file128(blob_data);
-	auto path = get_blob_path(blob_hash);
+	if (this->blob_store.contains(blob_hash)) {
+		return blob_hash;
+	}
+
+	Vec<u8> compressed_blob;
+	this->blob_store.add(blob_hash, encode_blob(this->blob_compression, blob_data, compressed_blob));
+
+	return blob_hash;
+}
+
+refl::BasePtr<Asset> ImporterApi::_retrieve_asset(const AssetId &id)
+{
+	{
+		// The residency is only accessed from the main thread, don't touch the asset
+		std::lock_guard lock{this->mutex};
+		if (auto asset = this->manager.database.get_asset(id); asset.is_valid()) {
+			return asset;
+		}
+	}
 
-	FILE *fp = fopen(path.view().data(), "wb");
-	auto bwritten = fwrite(blob_data.data(), 1, blob_data.len(), fp);
-	ASSERT(bwritten == blob_data.len());
-	fclose(fp);
+	auto asset = AssetManager::_load_from_disk(id);
+	this->compiled_dependencies.push(asset);
+	return asset;
+}
 
+exo::u128 ImporterApi::save_blob(exo::Span<const u8> data)
+{
+	auto blob_hash = assets::hash_file128(data);
+	{
+		std::lock_guard lock{this->mutex};
+		if (this->manager.blob_store.contains(blob_hash)) {
+			return blob_hash;
+		}
+	}
+
+	// Two importers can encode the same blob at the same time, the store ignores the second one
+	Vec<u8> compressed_blob;
+	auto file_content = encode_blob(this->manager.blob_compression, data, compressed_blob);
+
+	std::lock_guard lock{this->mutex};
+	if (!this->manager.blob_store.contains(blob_hash)) {
+		this->saved_blob_size += file_content.len();
+	}
+	this->manager.blob_store.add(blob_hash, file_content);
 	return blob_hash;
 }
+
+void AssetManager::compact_blobs()
+{
+	EXO_PROFILE_SCOPE
+
+	// Every compiled asset is loaded to find the blobs it references
+	Vec<exo::u128> live_blobs;
+	const auto compiled_assets_path = std::filesystem::path{CompiledAssetPath.view().data()};
+	for (const auto &file_entry : std::filesystem::directory_iterator{compiled_assets_path}) {
+		if (!file_entry.is_regular_file() || file_entry.path().extension() != ".asset") {
+			continue;
+		}
+
+		auto path_string = file_entry.path().string();
+		auto asset_file = cross::MappedFile::open(exo::StringView{path_string.c_str(), path_string.size()}).value();
+		auto asset = refl::BasePtr<Asset>::invalid();
+		exo::serializer_helper::read_object(asset_file.content(), asset);
+		asset->collect_blobs(live_blobs);
+
+		asset->~Asset();
+		free(asset.get());
+	}
+
+	this->blob_store.compact(live_blobs);
+}
@@ -0,0 +1,133 @@
+#include "assets/asset_residency.h"
+
+#include "exo/macros/assert.h"
+
+#include <algorithm>
+#include <cstring>
+
+void AssetResidency::add_ref(const AssetId &id)
+{
+	if (auto *asset = this->assets.at(id)) {
+		asset->ref_count += 1;
+		return;
+	}
+	this->assets.insert(id, ResidentAsset{.ref_count = 1});
+}
+
+void AssetResidency::release(const AssetId &id)
+{
+	auto *asset = this->assets.at(id);
+	ASSERT(asset && asset->ref_count > 0);
+	asset->ref_count -= 1;
+
+	// Unreferenced assets are kept while they are resident to be evicted later
+	if (asset->ref_count == 0 && !asset->is_resident) {
+		this->assets.remove(id);
+	}
+}
+
+void AssetResidency::touch(const AssetId &id)
+{
+	if (auto *asset = this->assets.at(id)) {
+		asset->last_used_frame = this->i_frame;
+	}
+}
+
+void AssetResidency::set_resident(const AssetId &id, const char *type_name, usize memory_size)
+{
+	auto *asset = this->assets.at(id);
+	if (!asset) {
+		asset = this->assets.insert(id, ResidentAsset{});
+	}
+	ASSERT(!asset->is_resident);
+
+	asset->type_name       = type_name;
+	asset->memory_size     = memory_size;
+	asset->last_used_frame = this->i_frame;
+	asset->is_resident     = true;
+	this->resident_size += memory_size;
+
+	auto &type_memory = this->get_or_add_type_memory(type_name);
+	type_memory.memory_size += memory_size;
+	type_memory.asset_count += 1;
+}
+
+void AssetResidency::set_evicted(const AssetId &id)
+{
+	auto *asset = this->assets.at(id);
+	ASSERT(asset && asset->is_resident);
+
+	this->resident_size -= asset->memory_size;
+	auto &type_memory = this->get_or_add_type_memory(asset->type_name);
+	type_memory.memory_size -= asset->memory_size;
+	type_memory.asset_count -= 1;
+
+	if (asset->ref_count == 0) {
+		this->assets.remove(id);
+	} else {
+		asset->is_resident = false;
+		asset->memory_size = 0;
+	}
+}
+
+void AssetResidency::collect_evictions(Vec<AssetId> &out_evictions) const
+{
+	if (this->resident_size <= this->settings.memory_budget) {
+		return;
+	}
+
+	struct Candidate
+	{
+		AssetId id;
+		u64     last_used_frame;
+		usize   memory_size;
+	};
+	Vec<Candidate> candidates;
+	for (const auto &[id, asset] : this->assets) {
+		if (asset.is_resident && asset.ref_count == 0) {
+			candidates.push(Candidate{
+				.id              = id,
+				.last_used_frame = asset.last_used_frame,
+				.memory_size     = asset.memory_size,
+			});
+		}
+	}
+	std::sort(candidates.begin(), candidates.end(), [](const Candidate &lhs, const Candidate &rhs) {
+		return lhs.last_used_frame < rhs.last_used_frame;
+	});
+
+	usize size = this->resident_size;
+	for (const auto &candidate : candidates) {
+		if (size <= this->settings.memory_budget) {
+			break;
+		}
+		out_evictions.push(candidate.id);
+		size -= candidate.memory_size;
+	}
+}
+
+u32 AssetResidency::get_ref_count(const AssetId &id) const
+{
+	const auto *asset = this->assets.at(id);
+	return asset ? asset->ref_count : 0;
+}
+
+const AssetTypeMemory *AssetResidency::get_type_memory(const char *type_name) const
+{
+	for (const auto &type_memory : this->memory_per_type) {
+		if (std::strcmp(type_memory.type_name, type_name) == 0) {
+			return &type_memory;
+		}
+	}
+	return nullptr;
+}
+
+AssetTypeMemory &AssetResidency::get_or_add_type_memory(const char *type_name)
+{
+	for (auto &type_memory : this->memory_per_type) {
+		if (std::strcmp(type_memory.type_name, type_name) == 0) {
+			return type_memory;
+		}
+	}
+	return this->memory_per_type.push(AssetTypeMemory{.type_name = type_name});
+}
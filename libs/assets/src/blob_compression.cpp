@@ -0,0 +1,206 @@
+#include "assets/blob_compression.h"
+
+#include "cross/jobmanager.h"
+#include "cross/jobs/foreach.h"
+#include "exo/macros/assert.h"
+#include "exo/maths/pointer.h"
+#include "exo/profile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <zlib.h>
+
+namespace assets
+{
+bool is_compressed_blob(exo::Span<const u8> content)
+{
+	if (content.len() < sizeof(CompressedBlobHeader)) {
+		return false;
+	}
+
+	const auto &header = *reinterpret_cast<const CompressedBlobHeader *>(content.data());
+	if (header.magic != COMPRESSED_BLOB_MAGIC || header.version != COMPRESSED_BLOB_VERSION ||
+		header.codec >= BlobCodec::Count || header.block_size == 0) {
+		return false;
+	}
+
+	const usize expected_blocks = (header.uncompressed_size + header.block_size - 1) / header.block_size;
+	const usize index_end       = sizeof(CompressedBlobHeader) + header.block_count * sizeof(CompressedBlobBlock);
+	return expected_blocks == header.block_count && index_end <= content.len();
+}
+
+const CompressedBlobHeader &get_compressed_blob_header(exo::Span<const u8> content)
+{
+	ASSERT(is_compressed_blob(content));
+	return *reinterpret_cast<const CompressedBlobHeader *>(content.data());
+}
+
+exo::Span<const CompressedBlobBlock> get_compressed_blob_blocks(exo::Span<const u8> content)
+{
+	const auto &header = get_compressed_blob_header(content);
+	const auto *blocks =
+		reinterpret_cast<const CompressedBlobBlock *>(exo::ptr_offset(content.data(), sizeof(CompressedBlobHeader)));
+	return exo::Span(blocks, header.block_count);
+}
+
+Vec<u8> compress_blob(exo::Span<const u8> data, const BlobCompressionSettings &settings)
+{
+	EXO_PROFILE_SCOPE
+	ASSERT(settings.block_size > 0);
+
+	CompressedBlobHeader header = {};
+	header.codec                = settings.codec;
+	header.block_size           = settings.block_size;
+	header.uncompressed_size    = data.len();
+	header.block_count          = u32((data.len() + settings.block_size - 1) / settings.block_size);
+
+	const usize index_size = header.block_count * sizeof(CompressedBlobBlock);
+	usize       max_size   = sizeof(CompressedBlobHeader) + index_size;
+	for (u32 i_block = 0; i_block < header.block_count; i_block += 1) {
+		max_size += compressBound(settings.block_size);
+	}
+
+	auto result = Vec<u8>::with_length(max_size);
+	std::memcpy(result.data(), &header, sizeof(CompressedBlobHeader));
+	auto *blocks = reinterpret_cast<CompressedBlobBlock *>(exo::ptr_offset(result.data(), sizeof(CompressedBlobHeader)));
+
+	usize offset = sizeof(CompressedBlobHeader) + index_size;
+	for (u32 i_block = 0; i_block < header.block_count; i_block += 1) {
+		const usize block_start = usize(i_block) * settings.block_size;
+		const usize block_len   = std::min(usize(settings.block_size), data.len() - block_start);
+		const u8   *src         = data.data() + block_start;
+		u8         *dst         = result.data() + offset;
+
+		auto &block             = blocks[i_block];
+		block.offset            = offset;
+		block.uncompressed_size = u32(block_len);
+		block.compressed_size   = u32(block_len);
+
+		bool stored = true;
+		if (settings.codec == BlobCodec::Zlib) {
+			uLongf dst_len = compressBound(uLong(block_len));
+			int    res     = compress2(dst, &dst_len, src, uLong(block_len), settings.level);
+			ASSERT(res == Z_OK);
+			// Incompressible blocks are stored as is
+			if (dst_len < block_len) {
+				block.compressed_size = u32(dst_len);
+				stored                = false;
+			}
+		}
+
+		if (stored) {
+			std::memcpy(dst, src, block_len);
+		}
+		offset += block.compressed_size;
+	}
+
+	result.resize(offset);
+	return result;
+}
+
+usize decompress_blob_block(exo::Span<const u8> content, u32 i_block, exo::Span<u8> out_data)
+{
+	const auto &header = get_compressed_blob_header(content);
+	const auto  blocks = get_compressed_blob_blocks(content);
+	const auto &block  = blocks[i_block];
+
+	ASSERT(block.offset + block.compressed_size <= content.len());
+	ASSERT(out_data.len() >= block.uncompressed_size);
+	const u8 *src = content.data() + block.offset;
+
+	if (block.compressed_size == block.uncompressed_size) {
+		std::memcpy(out_data.data(), src, block.uncompressed_size);
+		return block.uncompressed_size;
+	}
+
+	ASSERT(header.codec == BlobCodec::Zlib);
+	uLongf dst_len = block.uncompressed_size;
+	int    res     = uncompress(out_data.data(), &dst_len, src, block.compressed_size);
+	ASSERT(res == Z_OK);
+	ASSERT(dst_len == block.uncompressed_size);
+	return block.uncompressed_size;
+}
+
+struct BlockDecodeContext
+{
+	exo::Span<const u8> content;
+	exo::Span<u8>       out_data;
+	u32                 block_size;
+};
+
+usize decompress_blob(const cross::JobManager *jobmanager, exo::Span<const u8> content, exo::Span<u8> out_data)
+{
+	EXO_PROFILE_SCOPE
+	const auto &header = get_compressed_blob_header(content);
+	ASSERT(out_data.len() >= header.uncompressed_size);
+
+	if (jobmanager == nullptr || header.block_count <= 1) {
+		for (u32 i_block = 0; i_block < header.block_count; i_block += 1) {
+			const usize block_start = usize(i_block) * header.block_size;
+			decompress_blob_block(content, i_block, out_data.subspan(block_start));
+		}
+		return header.uncompressed_size;
+	}
+
+	BlockDecodeContext ctx = {
+		.content    = content,
+		.out_data   = out_data,
+		.block_size = header.block_size,
+	};
+
+	auto block_indices = Vec<u32>::with_length(header.block_count);
+	for (u32 i_block = 0; i_block < header.block_count; i_block += 1) {
+		block_indices[i_block] = i_block;
+	}
+
+	// Each block is decoded straight to its final location in the output
+	auto w = cross::parallel_foreach_userdata<u32, const BlockDecodeContext, true>(
+		*jobmanager,
+		block_indices,
+		&ctx,
+		[](u32 &i_block, const BlockDecodeContext *decode_ctx) {
+			EXO_PROFILE_SCOPE_NAMED("Decode blob block")
+			const usize block_start = usize(i_block) * decode_ctx->block_size;
+			u8         *dst         = decode_ctx->out_data.data() + block_start;
+			decompress_blob_block(decode_ctx->content, i_block, exo::Span(dst, decode_ctx->out_data.len() - block_start));
+		},
+		2);
+	w->wait();
+
+	return header.uncompressed_size;
+}
+
+usize decompress_blob_range(exo::Span<const u8> content, usize offset, exo::Span<u8> out_data)
+{
+	EXO_PROFILE_SCOPE
+	const auto &header = get_compressed_blob_header(content);
+	if (offset >= header.uncompressed_size) {
+		return 0;
+	}
+
+	const usize range_end   = std::min(header.uncompressed_size, offset + out_data.len());
+	const u32   first_block = u32(offset / header.block_size);
+	const u32   last_block  = u32((range_end - 1) / header.block_size);
+
+	Vec<u8> block_buffer;
+	usize   bwritten = 0;
+	for (u32 i_block = first_block; i_block <= last_block; i_block += 1) {
+		const usize block_start = usize(i_block) * header.block_size;
+		const usize copy_start  = std::max(offset, block_start);
+		const usize copy_end    = std::min(range_end, block_start + header.block_size);
+		u8         *dst         = out_data.data() + (copy_start - offset);
+
+		// Fully covered blocks are decoded in place, partial ones go through a temporary buffer
+		if (copy_start == block_start && copy_end - copy_start == header.block_size) {
+			decompress_blob_block(content, i_block, exo::Span(dst, copy_end - copy_start));
+		} else {
+			block_buffer.resize(header.block_size);
+			decompress_blob_block(content, i_block, exo::Span(block_buffer.data(), block_buffer.len()));
+			std::memcpy(dst, block_buffer.data() + (copy_start - block_start), copy_end - copy_start);
+		}
+		bwritten += copy_end - copy_start;
+	}
+
+	return bwritten;
+}
+} // namespace assets
@@ -0,0 +1,275 @@
+#include "assets/blob_store.h"
+
+#include "exo/format.h"
+#include "exo/memory/scope_stack.h"
+#include "exo/profile.h"
+#include "exo/serialization/serializer.h"
+#include "exo/serialization/serializer_helper.h"
+
+#include <bit>
+#include <cstdio>
+#include <filesystem>
+
+inline constexpr u32 BLOB_STORE_INDEX_VERSION = 1;
+inline constexpr usize BLOB_STORE_MIN_CAPACITY = 1024;
+
+static u32 slot_from_hash(u64 hash0, usize capacity) { return u32(hash0 & (capacity - 1)); }
+
+BlobStore BlobStore::open(const exo::Path &directory, u64 max_pack_size)
+{
+	EXO_PROFILE_SCOPE
+	BlobStore store = {};
+	store.directory = directory;
+	store.max_pack_size = max_pack_size;
+
+	const auto index_path = store.get_index_path();
+	if (std::filesystem::exists(std::filesystem::path{index_path.view().data()})) {
+		auto index_file = cross::MappedFile::open(index_path.view()).value();
+		exo::serializer_helper::read_object(index_file.content(), store);
+	}
+
+	if (store.index_slots.is_empty()) {
+		store.index_slots.resize(BLOB_STORE_MIN_CAPACITY);
+	}
+
+	return store;
+}
+
+void BlobStore::save_index()
+{
+	EXO_PROFILE_SCOPE
+	const auto index_path = this->get_index_path();
+	exo::serializer_helper::write_object_to_file(index_path.view(), *this);
+}
+
+exo::Path BlobStore::get_pack_path(u32 pack_id) const
+{
+	exo::ScopeStack scope;
+	auto pack_filename = exo::formatf(scope, "%08x.pack", pack_id);
+	return exo::Path::join(this->directory, pack_filename);
+}
+
+exo::Path BlobStore::get_index_path() const { return exo::Path::join(this->directory, "blobs.index"); }
+
+const BlobLocation *BlobStore::find_location(exo::u128 hash) const
+{
+	u64 hash0 = 0;
+	u64 hash1 = 0;
+	exo::u128_to_u64(hash, &hash0, &hash1);
+
+	const usize capacity = this->index_slots.len();
+	const u32 i_first_slot = slot_from_hash(hash0, capacity);
+	for (usize i = 0; i < capacity; ++i) {
+		const auto &slot = this->index_slots[(i_first_slot + i) & (capacity - 1)];
+		if (slot.location.i_pack == u32_invalid) {
+			return nullptr;
+		}
+		if (slot.hash0 == hash0 && slot.hash1 == hash1) {
+			return &slot.location;
+		}
+	}
+	return nullptr;
+}
+
+Option<BlobLocation> BlobStore::find(exo::u128 hash) const
+{
+	std::lock_guard lock{*this->mutex};
+	if (const auto *location = this->find_location(hash)) {
+		return *location;
+	}
+	return None;
+}
+
+bool BlobStore::contains(exo::u128 hash) const
+{
+	std::lock_guard lock{*this->mutex};
+	return this->find_location(hash) != nullptr;
+}
+
+exo::Span<const u8> BlobStore::get(exo::u128 hash)
+{
+	std::lock_guard lock{*this->mutex};
+	const auto *location = this->find_location(hash);
+	if (!location) {
+		return {};
+	}
+
+	auto &pack = this->packs[location->i_pack];
+	const u64 blob_end = location->offset + location->size;
+	ASSERT(blob_end <= pack.size);
+
+	// The pack grew since it was mapped, the mapping needs to be recreated to see the new blobs.
+	// The old mapping is kept alive for the spans that were already returned.
+	if (pack.mapping.base_addr == nullptr || pack.mapping.size < blob_end) {
+		EXO_PROFILE_SCOPE_NAMED("Map pack")
+		if (pack.mapping.base_addr != nullptr) {
+			pack.retired_mappings.push(std::move(pack.mapping));
+		}
+		const auto pack_path = this->get_pack_path(pack.pack_id);
+		pack.mapping = cross::MappedFile::open(pack_path.view()).value();
+	}
+
+	return exo::Span(pack.mapping.content().data() + location->offset, location->size);
+}
+
+void BlobStore::add(exo::u128 hash, exo::Span<const u8> content)
+{
+	std::lock_guard lock{*this->mutex};
+	if (this->find_location(hash) != nullptr) {
+		return;
+	}
+
+	BlobLocation location = {};
+	location.size = content.len();
+	location.i_pack = this->append_to_pack(content, location.offset);
+
+	u64 hash0 = 0;
+	u64 hash1 = 0;
+	exo::u128_to_u64(hash, &hash0, &hash1);
+	this->insert_slot(hash0, hash1, location);
+}
+
+u32 BlobStore::append_to_pack(exo::Span<const u8> content, u64 &out_offset)
+{
+	EXO_PROFILE_SCOPE
+	if (this->packs.is_empty() || (this->packs.last().size > 0 && this->packs.last().size + content.len() > this->max_pack_size)) {
+		auto &new_pack = this->packs.push();
+		new_pack.pack_id = this->next_pack_id;
+		this->next_pack_id += 1;
+	}
+
+	const u32 i_pack = u32(this->packs.len() - 1);
+	auto &pack = this->packs[i_pack];
+
+	// The existing mapping stays valid, it only covers the blobs appended before it was created
+	const auto pack_path = this->get_pack_path(pack.pack_id);
+	FILE *fp = fopen(pack_path.view().data(), "ab");
+	ASSERT(fp != nullptr);
+
+	// The file can be longer than the indexed size (blobs appended after the last `save_index`, an orphaned pack
+	// file), the blob is written at the end of the file so its offset is taken from the file itself
+	std::error_code error;
+	const auto file_size = std::filesystem::file_size(std::filesystem::path{pack_path.view().data()}, error);
+	ASSERT(!error);
+
+	auto bwritten = fwrite(content.data(), 1, content.len(), fp);
+	ASSERT(bwritten == content.len());
+	fclose(fp);
+
+	out_offset = file_size;
+	pack.size = file_size + content.len();
+	return i_pack;
+}
+
+void BlobStore::insert_slot(u64 hash0, u64 hash1, BlobLocation location)
+{
+	if ((this->blob_count + 1) * 4 > this->index_slots.len() * 3) {
+		this->grow_index();
+	}
+
+	const usize capacity = this->index_slots.len();
+	u32 i_slot = slot_from_hash(hash0, capacity);
+	while (this->index_slots[i_slot].location.i_pack != u32_invalid) {
+		i_slot = (i_slot + 1) & u32(capacity - 1);
+	}
+
+	auto &slot = this->index_slots[i_slot];
+	slot.hash0 = hash0;
+	slot.hash1 = hash1;
+	slot.location = location;
+	this->blob_count += 1;
+}
+
+void BlobStore::grow_index()
+{
+	EXO_PROFILE_SCOPE
+	auto old_slots = std::move(this->index_slots);
+	const usize new_capacity = old_slots.len() < BLOB_STORE_MIN_CAPACITY ? BLOB_STORE_MIN_CAPACITY : 2 * old_slots.len();
+	ASSERT(std::has_single_bit(new_capacity));
+
+	this->index_slots = Vec<BlobIndexSlot>::with_length(new_capacity);
+	this->blob_count = 0;
+	for (const auto &slot : old_slots) {
+		if (slot.location.i_pack != u32_invalid) {
+			this->insert_slot(slot.hash0, slot.hash1, slot.location);
+		}
+	}
+}
+
+void BlobStore::compact(exo::Span<const exo::u128> live_blobs)
+{
+	EXO_PROFILE_SCOPE
+
+	// Copy the live blobs to new packs, following the same id sequence
+	BlobStore compacted = {};
+	compacted.directory = this->directory;
+	compacted.next_pack_id = this->next_pack_id;
+	compacted.max_pack_size = this->max_pack_size;
+	compacted.index_slots.resize(BLOB_STORE_MIN_CAPACITY);
+
+	u64 old_size = 0;
+	for (const auto &pack : this->packs) {
+		old_size += pack.size;
+	}
+
+	for (auto hash : live_blobs) {
+		auto content = this->get(hash);
+		if (!content.empty()) {
+			compacted.add(hash, content);
+		}
+	}
+
+	// The new index has to be on disk before the old packs are deleted, a crash in between only leaks the old packs
+	compacted.save_index();
+
+	for (auto &pack : this->packs) {
+		pack.mapping.close();
+		pack.retired_mappings.clear();
+		const auto pack_path = this->get_pack_path(pack.pack_id);
+		std::filesystem::remove(std::filesystem::path{pack_path.view().data()});
+	}
+
+	u64 new_size = 0;
+	for (const auto &pack : compacted.packs) {
+		new_size += pack.size;
+	}
+	printf("[BlobStore] Compacted %zu blobs to %zu, %llu bytes -> %llu bytes.\n",
+		this->blob_count,
+		compacted.blob_count,
+		static_cast<unsigned long long>(old_size),
+		static_cast<unsigned long long>(new_size));
+
+	*this = std::move(compacted);
+}
+
+// -- Serialization
+
+static void serialize(exo::Serializer &serializer, BlobIndexSlot &slot)
+{
+	exo::serialize(serializer, slot.hash0);
+	exo::serialize(serializer, slot.hash1);
+	exo::serialize(serializer, slot.location.i_pack);
+	exo::serialize(serializer, slot.location.offset);
+	exo::serialize(serializer, slot.location.size);
+}
+
+static void serialize(exo::Serializer &serializer, BlobPack &pack)
+{
+	exo::serialize(serializer, pack.pack_id);
+	exo::serialize(serializer, pack.size);
+}
+
+void serialize(exo::Serializer &serializer, BlobStore &store)
+{
+	u32 version = BLOB_STORE_INDEX_VERSION;
+	exo::serialize(serializer, version);
+	ASSERT(version == BLOB_STORE_INDEX_VERSION);
+
+	exo::serialize(serializer, store.next_pack_id);
+	// The pack size is configured when opening the store, the serialized one is ignored
+	u64 max_pack_size = store.max_pack_size;
+	exo::serialize(serializer, max_pack_size);
+	exo::serialize(serializer, store.blob_count);
+	exo::serialize(serializer, store.packs);
+	exo::serialize(serializer, store.index_slots);
+}
@@ -0,0 +1,660 @@
+#include "assets/block_compression.h"
+
+#include "cross/jobmanager.h"
+#include "cross/jobs/foreach.h"
+#include "exo/collections/vector.h"
+#include "exo/macros/assert.h"
+#include "exo/profile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+// -- Blocks
+
+// Texels of a 4x4 block in row order, channel values are in [0, 255]
+struct BlockTexels
+{
+	float values[16][4];
+};
+
+struct EncodeContext
+{
+	exo::Span<const u8>      pixels;
+	u32                      width;
+	u32                      height;
+	u32                      channels;
+	u32                      blocks_x;
+	PixelFormat              format;
+	usize                    block_byte_size;
+	exo::Span<u8>            out_blocks;
+	BlockCompressionSettings settings;
+};
+
+// Blocks crossing the border of the image repeat the last row and column
+static void load_block(const EncodeContext &ctx, u32 block_x, u32 block_y, BlockTexels &out)
+{
+	for (u32 i_texel = 0; i_texel < 16; i_texel += 1) {
+		const u32 x     = std::min(4 * block_x + i_texel % 4, ctx.width - 1);
+		const u32 y     = std::min(4 * block_y + i_texel / 4, ctx.height - 1);
+		const u8 *texel = ctx.pixels.data() + (usize(y) * ctx.width + x) * ctx.channels;
+
+		float *values = out.values[i_texel];
+		values[0]     = 0.0f;
+		values[1]     = 0.0f;
+		values[2]     = 0.0f;
+		values[3]     = 255.0f;
+		for (u32 i_channel = 0; i_channel < ctx.channels; i_channel += 1) {
+			values[i_channel] = float(texel[i_channel]);
+		}
+	}
+}
+
+struct BlockBitWriter
+{
+	u8 *bytes      = nullptr;
+	u32 bit_offset = 0;
+
+	// Bits are written from the least significant bit of the first byte
+	void write(u32 value, u32 bits_count)
+	{
+		for (u32 i_bit = 0; i_bit < bits_count; i_bit += 1) {
+			if ((value >> i_bit) & 1u) {
+				this->bytes[this->bit_offset / 8] |= u8(1u << (this->bit_offset % 8));
+			}
+			this->bit_offset += 1;
+		}
+	}
+};
+
+// -- Endpoints
+
+static float squared_distance(const float *a, const float *b, u32 channels)
+{
+	float distance = 0.0f;
+	for (u32 i_channel = 0; i_channel < channels; i_channel += 1) {
+		const float delta = a[i_channel] - b[i_channel];
+		distance += delta * delta;
+	}
+	return distance;
+}
+
+// Endpoints of the segment covering the texels along the direction of largest variance, found by power iteration on
+// the covariance matrix of the block
+static void compute_axis_endpoints(const BlockTexels &block, u32 channels, float (&out_e0)[4], float (&out_e1)[4])
+{
+	float mean[4] = {};
+	float min[4]  = {255.0f, 255.0f, 255.0f, 255.0f};
+	float max[4]  = {};
+	for (const auto &texel : block.values) {
+		for (u32 i_channel = 0; i_channel < channels; i_channel += 1) {
+			mean[i_channel] += texel[i_channel] / 16.0f;
+			min[i_channel] = std::min(min[i_channel], texel[i_channel]);
+			max[i_channel] = std::max(max[i_channel], texel[i_channel]);
+		}
+	}
+
+	float covariance[4][4] = {};
+	for (const auto &texel : block.values) {
+		for (u32 i_row = 0; i_row < channels; i_row += 1) {
+			for (u32 i_col = 0; i_col < channels; i_col += 1) {
+				covariance[i_row][i_col] += (texel[i_row] - mean[i_row]) * (texel[i_col] - mean[i_col]);
+			}
+		}
+	}
+
+	float axis[4] = {};
+	for (u32 i_channel = 0; i_channel < channels; i_channel += 1) {
+		axis[i_channel] = max[i_channel] - min[i_channel];
+	}
+	for (u32 i_iteration = 0; i_iteration < 8; i_iteration += 1) {
+		float next[4]       = {};
+		float largest_value = 0.0f;
+		for (u32 i_row = 0; i_row < channels; i_row += 1) {
+			for (u32 i_col = 0; i_col < channels; i_col += 1) {
+				next[i_row] += covariance[i_row][i_col] * axis[i_col];
+			}
+			largest_value = std::max(largest_value, std::abs(next[i_row]));
+		}
+		if (largest_value == 0.0f) {
+			break;
+		}
+		for (u32 i_channel = 0; i_channel < channels; i_channel += 1) {
+			axis[i_channel] = next[i_channel] / largest_value;
+		}
+	}
+
+	float axis_length_sq = 0.0f;
+	for (u32 i_channel = 0; i_channel < channels; i_channel += 1) {
+		axis_length_sq += axis[i_channel] * axis[i_channel];
+	}
+
+	float t_min = 0.0f;
+	float t_max = 0.0f;
+	if (axis_length_sq > 0.0f) {
+		t_min = std::numeric_limits<float>::infinity();
+		t_max = -std::numeric_limits<float>::infinity();
+		for (const auto &texel : block.values) {
+			float t = 0.0f;
+			for (u32 i_channel = 0; i_channel < channels; i_channel += 1) {
+				t += (texel[i_channel] - mean[i_channel]) * axis[i_channel];
+			}
+			t_min = std::min(t_min, t / axis_length_sq);
+			t_max = std::max(t_max, t / axis_length_sq);
+		}
+	}
+
+	for (u32 i_channel = 0; i_channel < 4; i_channel += 1) {
+		out_e0[i_channel] = std::clamp(mean[i_channel] + t_min * axis[i_channel], 0.0f, 255.0f);
+		out_e1[i_channel] = std::clamp(mean[i_channel] + t_max * axis[i_channel], 0.0f, 255.0f);
+	}
+}
+
+// Least squares endpoints given the interpolation weight of each texel, 0 selects the first endpoint
+static bool fit_endpoints(
+	const BlockTexels &block, const float (&weights)[16], u32 channels, float (&out_e0)[4], float (&out_e1)[4])
+{
+	float a       = 0.0f;
+	float b       = 0.0f;
+	float c       = 0.0f;
+	float rhs0[4] = {};
+	float rhs1[4] = {};
+	for (u32 i_texel = 0; i_texel < 16; i_texel += 1) {
+		const float w1 = weights[i_texel];
+		const float w0 = 1.0f - w1;
+		a += w0 * w0;
+		b += w0 * w1;
+		c += w1 * w1;
+		for (u32 i_channel = 0; i_channel < channels; i_channel += 1) {
+			rhs0[i_channel] += w0 * block.values[i_texel][i_channel];
+			rhs1[i_channel] += w1 * block.values[i_texel][i_channel];
+		}
+	}
+
+	const float determinant = a * c - b * b;
+	if (std::abs(determinant) < 1e-6f) {
+		return false;
+	}
+
+	for (u32 i_channel = 0; i_channel < 4; i_channel += 1) {
+		out_e0[i_channel] = 0.0f;
+		out_e1[i_channel] = 0.0f;
+	}
+	for (u32 i_channel = 0; i_channel < channels; i_channel += 1) {
+		out_e0[i_channel] = (c * rhs0[i_channel] - b * rhs1[i_channel]) / determinant;
+		out_e1[i_channel] = (a * rhs1[i_channel] - b * rhs0[i_channel]) / determinant;
+		out_e0[i_channel] = std::clamp(out_e0[i_channel], 0.0f, 255.0f);
+		out_e1[i_channel] = std::clamp(out_e1[i_channel], 0.0f, 255.0f);
+	}
+	return true;
+}
+
+// -- BC1
+
+static u16 quantize_565(const float (&color)[4])
+{
+	const u32 r = u32(color[0] * 31.0f / 255.0f + 0.5f);
+	const u32 g = u32(color[1] * 63.0f / 255.0f + 0.5f);
+	const u32 b = u32(color[2] * 31.0f / 255.0f + 0.5f);
+	return u16((r << 11) | (g << 5) | b);
+}
+
+static void expand_565(u16 color, float (&out)[4])
+{
+	const u32 r = (color >> 11) & 31u;
+	const u32 g = (color >> 5) & 63u;
+	const u32 b = color & 31u;
+	out[0]      = float((r << 3) | (r >> 2));
+	out[1]      = float((g << 2) | (g >> 4));
+	out[2]      = float((b << 3) | (b >> 2));
+	out[3]      = 255.0f;
+}
+
+// Four colors mode: the texels select c0, c1, 2/3 c0 + 1/3 c1 or 1/3 c0 + 2/3 c1
+static float select_bc1_indices(const BlockTexels &block, u16 c0, u16 c1, u8 (&out_indices)[16])
+{
+	float palette[4][4] = {};
+	expand_565(c0, palette[0]);
+	expand_565(c1, palette[1]);
+	for (u32 i_channel = 0; i_channel < 3; i_channel += 1) {
+		palette[2][i_channel] = (2.0f * palette[0][i_channel] + palette[1][i_channel]) / 3.0f;
+		palette[3][i_channel] = (palette[0][i_channel] + 2.0f * palette[1][i_channel]) / 3.0f;
+	}
+
+	float error = 0.0f;
+	for (u32 i_texel = 0; i_texel < 16; i_texel += 1) {
+		float best_distance = std::numeric_limits<float>::infinity();
+		for (u8 i_color = 0; i_color < 4; i_color += 1) {
+			const float distance = squared_distance(block.values[i_texel], palette[i_color], 3);
+			if (distance < best_distance) {
+				best_distance        = distance;
+				out_indices[i_texel] = i_color;
+			}
+		}
+		error += best_distance;
+	}
+	return error;
+}
+
+static void encode_bc1(const BlockTexels &block, u8 *out)
+{
+	const float bc1_weights[4] = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+
+	float e0[4] = {};
+	float e1[4] = {};
+	compute_axis_endpoints(block, 3, e0, e1);
+
+	u16   c0          = quantize_565(e0);
+	u16   c1          = quantize_565(e1);
+	u8    indices[16] = {};
+	float best_error  = select_bc1_indices(block, c0, c1, indices);
+
+	for (u32 i_iteration = 0; i_iteration < 2 && best_error > 0.0f; i_iteration += 1) {
+		float weights[16] = {};
+		for (u32 i_texel = 0; i_texel < 16; i_texel += 1) {
+			weights[i_texel] = bc1_weights[indices[i_texel]];
+		}
+		if (!fit_endpoints(block, weights, 3, e0, e1)) {
+			break;
+		}
+
+		const u16   new_c0          = quantize_565(e0);
+		const u16   new_c1          = quantize_565(e1);
+		u8          new_indices[16] = {};
+		const float error           = select_bc1_indices(block, new_c0, new_c1, new_indices);
+		if (error >= best_error) {
+			break;
+		}
+		best_error = error;
+		c0         = new_c0;
+		c1         = new_c1;
+		std::memcpy(indices, new_indices, sizeof(indices));
+	}
+
+	// The four colors mode needs c0 > c1, swapping the endpoints swaps indices 0 and 1, and 2 and 3
+	if (c0 < c1) {
+		std::swap(c0, c1);
+		for (auto &index : indices) {
+			index ^= 1u;
+		}
+	} else if (c0 == c1) {
+		std::memset(indices, 0, sizeof(indices));
+	}
+
+	u32 index_bits = 0;
+	for (u32 i_texel = 0; i_texel < 16; i_texel += 1) {
+		index_bits |= u32(indices[i_texel]) << (2 * i_texel);
+	}
+	out[0] = u8(c0 & 0xff);
+	out[1] = u8(c0 >> 8);
+	out[2] = u8(c1 & 0xff);
+	out[3] = u8(c1 >> 8);
+	std::memcpy(out + 4, &index_bits, sizeof(index_bits));
+}
+
+// -- BC4
+
+// Eight values mode: a0 > a1, indices 2 to 7 interpolate from a0 to a1
+static void encode_bc4(const BlockTexels &block, u32 channel, u8 *out)
+{
+	float min = 255.0f;
+	float max = 0.0f;
+	for (const auto &texel : block.values) {
+		min = std::min(min, texel[channel]);
+		max = std::max(max, texel[channel]);
+	}
+
+	const u8 a0 = u8(max + 0.5f);
+	const u8 a1 = u8(min + 0.5f);
+	std::memset(out, 0, 8);
+	out[0] = a0;
+	out[1] = a1;
+	if (a0 == a1) {
+		return;
+	}
+
+	// Position of each value on the segment from a0 to a1, rounded to the closest of the 8 values
+	u64 index_bits = 0;
+	for (u32 i_texel = 0; i_texel < 16; i_texel += 1) {
+		const float t        = (float(a0) - block.values[i_texel][channel]) / float(a0 - a1);
+		const u32   position = u32(std::clamp(t, 0.0f, 1.0f) * 7.0f + 0.5f);
+
+		u32 index = position + 1;
+		if (position == 0) {
+			index = 0;
+		} else if (position == 7) {
+			index = 1;
+		}
+		index_bits |= u64(index) << (3 * i_texel);
+	}
+	for (u32 i_byte = 0; i_byte < 6; i_byte += 1) {
+		out[2 + i_byte] = u8(index_bits >> (8 * i_byte));
+	}
+}
+
+// -- BC7
+
+inline constexpr u8 BC7_WEIGHTS4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+// Mode 6 endpoints: 7 bits per channel and a shared least significant bit per endpoint
+struct BC7Endpoints
+{
+	u8 values[2][4] = {};
+	u8 pbits[2]     = {};
+};
+
+static float select_bc7_indices(const BlockTexels &block, const BC7Endpoints &endpoints, u8 (&out_indices)[16])
+{
+	u32 e[2][4] = {};
+	for (u32 i_endpoint = 0; i_endpoint < 2; i_endpoint += 1) {
+		for (u32 i_channel = 0; i_channel < 4; i_channel += 1) {
+			const u32 value          = endpoints.values[i_endpoint][i_channel];
+			e[i_endpoint][i_channel] = (value << 1) | endpoints.pbits[i_endpoint];
+		}
+	}
+
+	float palette[16][4] = {};
+	for (u32 i_color = 0; i_color < 16; i_color += 1) {
+		const u32 w = BC7_WEIGHTS4[i_color];
+		for (u32 i_channel = 0; i_channel < 4; i_channel += 1) {
+			palette[i_color][i_channel] = float(((64 - w) * e[0][i_channel] + w * e[1][i_channel] + 32) >> 6);
+		}
+	}
+
+	float error = 0.0f;
+	for (u32 i_texel = 0; i_texel < 16; i_texel += 1) {
+		float best_distance = std::numeric_limits<float>::infinity();
+		for (u8 i_color = 0; i_color < 16; i_color += 1) {
+			const float distance = squared_distance(block.values[i_texel], palette[i_color], 4);
+			if (distance < best_distance) {
+				best_distance        = distance;
+				out_indices[i_texel] = i_color;
+			}
+		}
+		error += best_distance;
+	}
+	return error;
+}
+
+// Tries every combination of pbits
+static float quantize_bc7_endpoints(const BlockTexels &block,
+	const float (&e0)[4],
+	const float (&e1)[4],
+	BC7Endpoints &out_endpoints,
+	u8 (&out_indices)[16])
+{
+	const float *e[2]       = {e0, e1};
+	float        best_error = std::numeric_limits<float>::infinity();
+	for (u32 i_combination = 0; i_combination < 4; i_combination += 1) {
+		BC7Endpoints candidate = {};
+		for (u32 i_endpoint = 0; i_endpoint < 2; i_endpoint += 1) {
+			const u8 pbit               = u8((i_combination >> i_endpoint) & 1u);
+			candidate.pbits[i_endpoint] = pbit;
+			for (u32 i_channel = 0; i_channel < 4; i_channel += 1) {
+				const float value = (e[i_endpoint][i_channel] - float(pbit)) / 2.0f;
+				candidate.values[i_endpoint][i_channel] = u8(std::clamp(value + 0.5f, 0.0f, 127.0f));
+			}
+		}
+
+		u8          indices[16] = {};
+		const float error       = select_bc7_indices(block, candidate, indices);
+		if (error < best_error) {
+			best_error    = error;
+			out_endpoints = candidate;
+			std::memcpy(out_indices, indices, sizeof(indices));
+		}
+	}
+	return best_error;
+}
+
+// Moves the quantized endpoints one step at a time while the error decreases
+static float search_bc7_endpoints(
+	const BlockTexels &block, float best_error, BC7Endpoints &endpoints, u8 (&indices)[16])
+{
+	for (u32 i_pass = 0; i_pass < 4 && best_error > 0.0f; i_pass += 1) {
+		bool improved = false;
+		for (u32 i_endpoint = 0; i_endpoint < 2; i_endpoint += 1) {
+			for (u32 i_channel = 0; i_channel < 4; i_channel += 1) {
+				for (int delta = -1; delta <= 1; delta += 2) {
+					const int value = int(endpoints.values[i_endpoint][i_channel]) + delta;
+					if (value < 0 || value > 127) {
+						continue;
+					}
+
+					BC7Endpoints candidate                  = endpoints;
+					candidate.values[i_endpoint][i_channel] = u8(value);
+					u8          candidate_indices[16]       = {};
+					const float error = select_bc7_indices(block, candidate, candidate_indices);
+					if (error < best_error) {
+						best_error = error;
+						endpoints  = candidate;
+						std::memcpy(indices, candidate_indices, sizeof(candidate_indices));
+						improved = true;
+					}
+				}
+			}
+		}
+		if (!improved) {
+			break;
+		}
+	}
+	return best_error;
+}
+
+// Only mode 6 is used: a single subset with RGBA endpoints and 4 bits indices
+static void encode_bc7(const BlockTexels &block, BC7Quality quality, u8 *out)
+{
+	float e0[4] = {};
+	float e1[4] = {};
+	compute_axis_endpoints(block, 4, e0, e1);
+
+	BC7Endpoints endpoints   = {};
+	u8           indices[16] = {};
+	float        best_error  = quantize_bc7_endpoints(block, e0, e1, endpoints, indices);
+
+	u32 refine_iterations = 0;
+	if (quality == BC7Quality::Normal) {
+		refine_iterations = 2;
+	} else if (quality == BC7Quality::High) {
+		refine_iterations = 4;
+	}
+
+	for (u32 i_iteration = 0; i_iteration < refine_iterations && best_error > 0.0f; i_iteration += 1) {
+		float weights[16] = {};
+		for (u32 i_texel = 0; i_texel < 16; i_texel += 1) {
+			weights[i_texel] = float(BC7_WEIGHTS4[indices[i_texel]]) / 64.0f;
+		}
+		if (!fit_endpoints(block, weights, 4, e0, e1)) {
+			break;
+		}
+
+		BC7Endpoints new_endpoints   = {};
+		u8           new_indices[16] = {};
+		const float  error           = quantize_bc7_endpoints(block, e0, e1, new_endpoints, new_indices);
+		if (error >= best_error) {
+			break;
+		}
+		best_error = error;
+		endpoints  = new_endpoints;
+		std::memcpy(indices, new_indices, sizeof(indices));
+	}
+
+	if (quality == BC7Quality::High) {
+		best_error = search_bc7_endpoints(block, best_error, endpoints, indices);
+	}
+
+	// The most significant bit of the first index is implicitly 0, swap the endpoints when it is set
+	if (indices[0] & 8u) {
+		std::swap(endpoints.values[0], endpoints.values[1]);
+		std::swap(endpoints.pbits[0], endpoints.pbits[1]);
+		for (auto &index : indices) {
+			index = u8(15u - index);
+		}
+	}
+
+	std::memset(out, 0, 16);
+	BlockBitWriter writer = {.bytes = out};
+	writer.write(1u << 6, 7);
+	for (u32 i_channel = 0; i_channel < 4; i_channel += 1) {
+		writer.write(endpoints.values[0][i_channel], 7);
+		writer.write(endpoints.values[1][i_channel], 7);
+	}
+	writer.write(endpoints.pbits[0], 1);
+	writer.write(endpoints.pbits[1], 1);
+	writer.write(indices[0], 3);
+	for (u32 i_texel = 1; i_texel < 16; i_texel += 1) {
+		writer.write(indices[i_texel], 4);
+	}
+	ASSERT(writer.bit_offset == 128);
+}
+
+// --
+
+static void encode_block(const EncodeContext &ctx, u32 block_x, u32 block_y)
+{
+	BlockTexels block = {};
+	load_block(ctx, block_x, block_y, block);
+
+	u8 *out = ctx.out_blocks.data() + (usize(block_y) * ctx.blocks_x + block_x) * ctx.block_byte_size;
+	switch (ctx.format) {
+	case PixelFormat::BC1_UNORM:
+	case PixelFormat::BC1_SRGB: {
+		encode_bc1(block, out);
+		break;
+	}
+	case PixelFormat::BC3_UNORM:
+	case PixelFormat::BC3_SRGB: {
+		encode_bc4(block, 3, out);
+		encode_bc1(block, out + 8);
+		break;
+	}
+	case PixelFormat::BC4_UNORM: {
+		encode_bc4(block, 0, out);
+		break;
+	}
+	case PixelFormat::BC5_UNORM: {
+		encode_bc4(block, 0, out);
+		encode_bc4(block, 1, out + 8);
+		break;
+	}
+	case PixelFormat::BC7_UNORM:
+	case PixelFormat::BC7_SRGB: {
+		encode_bc7(block, ctx.settings.bc7_quality, out);
+		break;
+	}
+	default:
+		ASSERT(false);
+	}
+}
+
+static void encode_block_row(const EncodeContext &ctx, u32 block_y)
+{
+	for (u32 block_x = 0; block_x < ctx.blocks_x; block_x += 1) {
+		encode_block(ctx, block_x, block_y);
+	}
+}
+
+PixelFormat choose_block_format(TextureUsage usage, u32 channels, bool has_alpha, bool prefer_bc7)
+{
+	if (channels == 1) {
+		return PixelFormat::BC4_UNORM;
+	}
+	if (channels == 2 || usage == TextureUsage::Normal) {
+		return PixelFormat::BC5_UNORM;
+	}
+	const bool is_srgb = usage == TextureUsage::Color;
+	if (prefer_bc7) {
+		return is_srgb ? PixelFormat::BC7_SRGB : PixelFormat::BC7_UNORM;
+	}
+	if (has_alpha) {
+		return is_srgb ? PixelFormat::BC3_SRGB : PixelFormat::BC3_UNORM;
+	}
+	return is_srgb ? PixelFormat::BC1_SRGB : PixelFormat::BC1_UNORM;
+}
+
+bool is_block_compressed(PixelFormat format)
+{
+	switch (format) {
+	case PixelFormat::BC1_UNORM:
+	case PixelFormat::BC1_SRGB:
+	case PixelFormat::BC3_UNORM:
+	case PixelFormat::BC3_SRGB:
+	case PixelFormat::BC4_UNORM:
+	case PixelFormat::BC5_UNORM:
+	case PixelFormat::BC7_UNORM:
+	case PixelFormat::BC7_SRGB:
+		return true;
+	default:
+		return false;
+	}
+}
+
+usize get_block_byte_size(PixelFormat format)
+{
+	ASSERT(is_block_compressed(format));
+	if (format == PixelFormat::BC1_UNORM || format == PixelFormat::BC1_SRGB || format == PixelFormat::BC4_UNORM) {
+		return 8;
+	}
+	return 16;
+}
+
+usize get_compressed_size(PixelFormat format, u32 width, u32 height)
+{
+	const usize blocks_x = (usize(width) + 3) / 4;
+	const usize blocks_y = (usize(height) + 3) / 4;
+	return blocks_x * blocks_y * get_block_byte_size(format);
+}
+
+void compress_blocks(const cross::JobManager *jobmanager,
+	exo::Span<const u8>                       pixels,
+	u32                                       width,
+	u32                                       height,
+	u32                                       channels,
+	PixelFormat                               format,
+	exo::Span<u8>                             out_blocks,
+	const BlockCompressionSettings           &settings)
+{
+	EXO_PROFILE_SCOPE
+	ASSERT(0 < channels && channels <= 4);
+	ASSERT(width > 0 && height > 0);
+	ASSERT(pixels.len() == usize(width) * height * channels);
+	ASSERT(out_blocks.len() == get_compressed_size(format, width, height));
+
+	EncodeContext ctx   = {};
+	ctx.pixels          = pixels;
+	ctx.width           = width;
+	ctx.height          = height;
+	ctx.channels        = channels;
+	ctx.blocks_x        = (width + 3) / 4;
+	ctx.format          = format;
+	ctx.block_byte_size = get_block_byte_size(format);
+	ctx.out_blocks      = out_blocks;
+	ctx.settings        = settings;
+
+	const u32 blocks_y = (height + 3) / 4;
+	if (jobmanager == nullptr) {
+		for (u32 block_y = 0; block_y < blocks_y; block_y += 1) {
+			encode_block_row(ctx, block_y);
+		}
+		return;
+	}
+
+	Vec<u32> rows = Vec<u32>::with_length(blocks_y);
+	for (u32 block_y = 0; block_y < blocks_y; block_y += 1) {
+		rows[block_y] = block_y;
+	}
+
+	const u32 rows_per_job = std::max(1u, settings.blocks_per_job / ctx.blocks_x);
+
+	auto w = cross::parallel_foreach_userdata<u32, const EncodeContext, true>(
+		*jobmanager,
+		rows,
+		&ctx,
+		[](u32 &block_y, const EncodeContext *encode_ctx) {
+			EXO_PROFILE_SCOPE_NAMED("Encode blocks")
+			encode_block_row(*encode_ctx, block_y);
+		},
+		int(rows_per_job));
+	w->wait();
+}
@@ -0,0 +1,354 @@
+#include "assets/bvh.h"
+
+#include "cross/jobmanager.h"
+#include "cross/jobs/foreach.h"
+#include "exo/macros/assert.h"
+#include "exo/maths/aabb.h"
+#include "exo/profile.h"
+
+#include <algorithm>
+
+inline constexpr u32 BVH_MAX_BINS = 64;
+
+struct BVHPrimitive
+{
+	exo::AABB bounds     = {};
+	float3    centroid   = {};
+	u32       prim_index = u32_invalid;
+};
+
+// A subtree of `end - begin` triangles always has 2 * (end - begin) - 1 nodes, so the position of every subtree in the
+// final array is known before it is built and subtrees can be built independently.
+struct BVHBuildRange
+{
+	u32 begin  = 0;
+	u32 end    = 0;
+	u32 i_node = 0;
+};
+
+struct BVHBuildContext
+{
+	const BVHBuildSettings  *settings;
+	exo::Span<BVHPrimitive> primitives;
+	exo::Span<BVHNode>      nodes;
+};
+
+struct BVHBin
+{
+	exo::AABB bounds = {};
+	u32       count  = 0;
+};
+
+// Empty bounds are inverted
+static float get_surface(const exo::AABB &bounds)
+{
+	return bounds.min.x <= bounds.max.x ? exo::surface(bounds) : 0.0f;
+}
+
+static u32 get_bin(const BVHPrimitive &primitive, usize axis, float axis_min, float bin_scale, u32 bins_count)
+{
+	return std::min(bins_count - 1, u32((primitive.centroid[axis] - axis_min) * bin_scale));
+}
+
+// Partitions `primitives` and returns the number of primitives in the left child
+static usize split_primitives(const BVHBuildSettings &settings, exo::Span<BVHPrimitive> primitives)
+{
+	exo::AABB centroid_bounds = {};
+	for (const auto &primitive : primitives) {
+		exo::extend(centroid_bounds, primitive.centroid);
+	}
+	const float3 centroid_extent = exo::extent(centroid_bounds);
+
+	// -- Find the cheapest split between bins on each axis
+	const u32 bins_count = std::min(settings.bins_count, BVH_MAX_BINS);
+	float     best_cost  = std::numeric_limits<float>::infinity();
+	usize     best_axis  = 0;
+	u32       best_split = 0;
+	for (usize axis = 0; axis < 3 && bins_count > 1; axis += 1) {
+		if (centroid_extent[axis] <= 0.0f) {
+			continue;
+		}
+
+		BVHBin      bins[BVH_MAX_BINS] = {};
+		const float bin_scale          = float(bins_count) / centroid_extent[axis];
+		for (const auto &primitive : primitives) {
+			const u32 i_bin = get_bin(primitive, axis, centroid_bounds.min[axis], bin_scale, bins_count);
+			exo::extend(bins[i_bin].bounds, primitive.bounds);
+			bins[i_bin].count += 1;
+		}
+
+		// Sweep from the right to get the cost of the right side of every split
+		float     right_costs[BVH_MAX_BINS] = {};
+		exo::AABB right_bounds              = {};
+		u32       right_count               = 0;
+		for (u32 i_bin = bins_count - 1; i_bin > 0; i_bin -= 1) {
+			// exo::extend with empty bounds would give infinite bounds
+			if (bins[i_bin].count != 0) {
+				exo::extend(right_bounds, bins[i_bin].bounds);
+			}
+			right_count += bins[i_bin].count;
+			right_costs[i_bin] = float(right_count) * get_surface(right_bounds);
+		}
+
+		exo::AABB left_bounds = {};
+		u32       left_count  = 0;
+		for (u32 i_split = 1; i_split < bins_count; i_split += 1) {
+			if (bins[i_split - 1].count != 0) {
+				exo::extend(left_bounds, bins[i_split - 1].bounds);
+			}
+			left_count += bins[i_split - 1].count;
+			const float cost = float(left_count) * get_surface(left_bounds) + right_costs[i_split];
+			if (left_count != 0 && left_count != primitives.len() && cost < best_cost) {
+				best_cost  = cost;
+				best_axis  = axis;
+				best_split = i_split;
+			}
+		}
+	}
+
+	if (best_split != 0) {
+		const float axis_min  = centroid_bounds.min[best_axis];
+		const float bin_scale = float(bins_count) / centroid_extent[best_axis];
+
+		auto is_left = [&](const BVHPrimitive &primitive) {
+			return get_bin(primitive, best_axis, axis_min, bin_scale, bins_count) < best_split;
+		};
+		auto *middle = std::partition(primitives.begin(), primitives.end(), is_left);
+		return usize(middle - primitives.begin());
+	}
+
+	// -- Fall back to a median split along the largest axis, when all centroids are in the same bin
+	usize largest_axis = 0;
+	for (usize axis = 1; axis < 3; axis += 1) {
+		if (centroid_extent[axis] > centroid_extent[largest_axis]) {
+			largest_axis = axis;
+		}
+	}
+
+	const usize middle = primitives.len() / 2;
+	std::nth_element(primitives.begin(),
+		primitives.begin() + middle,
+		primitives.end(),
+		[&](const BVHPrimitive &a, const BVHPrimitive &b) {
+			return a.centroid[largest_axis] < b.centroid[largest_axis];
+		});
+	return middle;
+}
+
+// Builds the nodes of `root`, ranges smaller than `parallel_min_size` are appended to `out_tasks` instead when provided
+static void build_ranges(const BVHBuildContext &ctx, BVHBuildRange root, Vec<BVHBuildRange> *out_tasks)
+{
+	Vec<BVHBuildRange> stack;
+	stack.push(root);
+
+	while (!stack.is_empty()) {
+		const BVHBuildRange range = stack.last();
+		stack.pop();
+
+		const u32 primitives_count = range.end - range.begin;
+		if (out_tasks && primitives_count <= ctx.settings->parallel_min_size) {
+			out_tasks->push(range);
+			continue;
+		}
+
+		auto primitives = exo::Span<BVHPrimitive>(ctx.primitives.data() + range.begin, primitives_count);
+
+		exo::AABB bounds = {};
+		for (const auto &primitive : primitives) {
+			exo::extend(bounds, primitive.bounds);
+		}
+
+		const u32 next_node = range.i_node + 2 * primitives_count - 1;
+
+		auto &node      = ctx.nodes[range.i_node];
+		node.bbox_min   = bounds.min;
+		node.bbox_max   = bounds.max;
+		node.prim_index = primitives_count == 1 ? primitives[0].prim_index : u32_invalid;
+		node.next_node  = next_node < ctx.nodes.len() ? next_node : u32_invalid;
+		if (primitives_count == 1) {
+			continue;
+		}
+
+		const u32 left_count = u32(split_primitives(*ctx.settings, primitives));
+		ASSERT(0 < left_count && left_count < primitives_count);
+
+		// The left child directly follows its parent and is built first
+		stack.push(BVHBuildRange{
+			.begin  = range.begin + left_count,
+			.end    = range.end,
+			.i_node = range.i_node + 2 * left_count,
+		});
+		stack.push(BVHBuildRange{
+			.begin  = range.begin,
+			.end    = range.begin + left_count,
+			.i_node = range.i_node + 1,
+		});
+	}
+}
+
+Vec<BVHNode> build_bvh(const cross::JobManager *jobmanager,
+	exo::Span<const float4>                     positions,
+	exo::Span<const u32>                        indices,
+	const BVHBuildSettings                     &settings)
+{
+	EXO_PROFILE_SCOPE
+	ASSERT(indices.len() % 3 == 0);
+	const usize triangles_count = indices.len() / 3;
+	if (triangles_count == 0) {
+		return {};
+	}
+
+	auto primitives = Vec<BVHPrimitive>::with_length(triangles_count);
+	for (usize i_triangle = 0; i_triangle < triangles_count; i_triangle += 1) {
+		auto &primitive = primitives[i_triangle];
+		for (usize i_corner = 0; i_corner < 3; i_corner += 1) {
+			exo::extend(primitive.bounds, positions[indices[3 * i_triangle + i_corner]].xyz());
+		}
+		primitive.centroid   = exo::center(primitive.bounds);
+		primitive.prim_index = u32(3 * i_triangle);
+	}
+
+	auto nodes = Vec<BVHNode>::with_length(2 * triangles_count - 1);
+
+	const BVHBuildContext ctx = {
+		.settings   = &settings,
+		.primitives = primitives,
+		.nodes      = nodes,
+	};
+	const BVHBuildRange root = {.begin = 0, .end = u32(triangles_count), .i_node = 0};
+
+	if (jobmanager == nullptr || triangles_count <= settings.parallel_min_size) {
+		build_ranges(ctx, root, nullptr);
+		return nodes;
+	}
+
+	// The top of the tree is built on the calling thread, then each small subtree is built in its own job
+	Vec<BVHBuildRange> tasks;
+	build_ranges(ctx, root, &tasks);
+
+	auto w = cross::parallel_foreach_userdata<BVHBuildRange, const BVHBuildContext, true>(
+		*jobmanager,
+		tasks,
+		&ctx,
+		[](BVHBuildRange &range, const BVHBuildContext *build_ctx) {
+			EXO_PROFILE_SCOPE_NAMED("Build BVH subtree")
+			build_ranges(*build_ctx, range, nullptr);
+		},
+		1);
+	w->wait();
+
+	return nodes;
+}
+
+float compute_sah_cost(exo::Span<const BVHNode> nodes, const BVHBuildSettings &settings)
+{
+	if (nodes.empty()) {
+		return 0.0f;
+	}
+
+	const float root_surface = get_surface(exo::AABB{.min = nodes[0].bbox_min, .max = nodes[0].bbox_max});
+	if (root_surface <= 0.0f) {
+		return 0.0f;
+	}
+
+	float cost = 0.0f;
+	for (const auto &node : nodes) {
+		const float surface = get_surface(exo::AABB{.min = node.bbox_min, .max = node.bbox_max});
+		cost += (node.is_leaf() ? settings.intersection_cost : settings.traversal_cost) * surface / root_surface;
+	}
+	return cost;
+}
+
+// -- Ray queries
+
+static bool intersect_box(const BVHNode &node, const BVHRay &ray, float3 inv_ray_dir)
+{
+	const float3 t0 = (node.bbox_min - ray.origin) * inv_ray_dir;
+	const float3 t1 = (node.bbox_max - ray.origin) * inv_ray_dir;
+
+	float t_min = ray.t_min;
+	float t_max = ray.t_max;
+	for (usize i_component = 0; i_component < 3; i_component += 1) {
+		t_min = std::max(t_min, std::min(t0[i_component], t1[i_component]));
+		t_max = std::min(t_max, std::max(t0[i_component], t1[i_component]));
+	}
+	return t_min <= t_max;
+}
+
+// Same as triangle_intersection in libs/engine/shaders/include/engine/raytracing.h, returns a negative distance on miss
+static float intersect_triangle(const BVHRay &ray,
+	exo::Span<const float4>                   positions,
+	exo::Span<const u32>                      indices,
+	u32                                       prim_index,
+	float3                                   &out_bary)
+{
+	const float3 v0 = positions[indices[prim_index + 0]].xyz();
+	const float3 e0 = positions[indices[prim_index + 1]].xyz() - v0;
+	const float3 e1 = positions[indices[prim_index + 2]].xyz() - v0;
+
+	const float3 rov0 = ray.origin - v0;
+	const float3 n    = exo::cross(e0, e1);
+	const float3 q    = exo::cross(rov0, ray.direction);
+	const float  d    = 1.0f / dot(ray.direction, n);
+	const float  u    = d * dot(-1.0f * q, e1);
+	const float  v    = d * dot(q, e0);
+
+	out_bary = float3(1.0f - u - v, u, v);
+	if (u < 0.0f || u > 1.0f || v < 0.0f || (u + v) > 1.0f) {
+		return -1.0f;
+	}
+	return d * dot(-1.0f * n, rov0);
+}
+
+bool bvh_closest_hit(exo::Span<const BVHNode> nodes,
+	exo::Span<const float4>                   positions,
+	exo::Span<const u32>                      indices,
+	const BVHRay                             &ray,
+	BVHHit                                   &out_hit)
+{
+	out_hit = {};
+	if (nodes.empty()) {
+		return false;
+	}
+
+	const float3 inv_ray_dir = float3(1.0f) / ray.direction;
+
+	u32 i_node = 0;
+	while (i_node != u32_invalid) {
+		const auto &node = nodes[i_node];
+
+		if (node.is_leaf()) {
+			float3      barycentrics = {};
+			const float d            = intersect_triangle(ray, positions, indices, node.prim_index, barycentrics);
+			if (0.0f < d && d < out_hit.d) {
+				out_hit.d            = d;
+				out_hit.prim_index   = node.prim_index;
+				out_hit.barycentrics = barycentrics;
+			}
+		} else if (intersect_box(node, ray, inv_ray_dir)) {
+			i_node += 1;
+			continue;
+		}
+
+		// The ray missed the triangle or the node's bounding box, skip the subtree
+		i_node = node.next_node;
+	}
+
+	return out_hit.prim_index != u32_invalid;
+}
+
+bool brute_force_closest_hit(
+	exo::Span<const float4> positions, exo::Span<const u32> indices, const BVHRay &ray, BVHHit &out_hit)
+{
+	out_hit = {};
+	for (u32 prim_index = 0; prim_index < indices.len(); prim_index += 3) {
+		float3      barycentrics = {};
+		const float d            = intersect_triangle(ray, positions, indices, prim_index, barycentrics);
+		if (0.0f < d && d < out_hit.d) {
+			out_hit.d            = d;
+			out_hit.prim_index   = prim_index;
+			out_hit.barycentrics = barycentrics;
+		}
+	}
+	return out_hit.prim_index != u32_invalid;
+}
@@ -0,0 +1,252 @@
+#include "assets/database_index.h"
+
+#include "exo/macros/assert.h"
+#include "exo/profile.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <xxhash.h>
+
+u64 hash_database_string(exo::StringView string) { return XXH3_64bits(string.data(), string.len()); }
+
+// Tables are kept at most half full, a lookup of a missing key stops at the first empty slot
+static u32 get_slot_count(usize element_count) { return u32(std::bit_ceil(std::max(2 * element_count, usize(16)))); }
+
+static u32 find_slot(exo::Span<const DatabaseIndexSlot> slots, u64 hash, auto &&is_match)
+{
+	if (slots.empty()) {
+		return u32_invalid;
+	}
+
+	const usize mask = slots.len() - 1;
+	for (usize i_slot = hash & mask;; i_slot = (i_slot + 1) & mask) {
+		const auto &slot = slots[i_slot];
+		if (slot.index == u32_invalid) {
+			return u32_invalid;
+		}
+		if (slot.hash == hash && is_match(slot.index)) {
+			return slot.index;
+		}
+	}
+}
+
+static void insert_slot(Vec<DatabaseIndexSlot> &slots, u64 hash, u32 index)
+{
+	const usize mask   = slots.len() - 1;
+	usize       i_slot = hash & mask;
+	while (slots[i_slot].index != u32_invalid) {
+		i_slot = (i_slot + 1) & mask;
+	}
+	slots[i_slot].hash  = hash;
+	slots[i_slot].index = index;
+}
+
+template <typename T>
+static exo::Span<const T> read_section(exo::Span<const u8> content, usize &offset, usize count)
+{
+	const auto *elements = reinterpret_cast<const T *>(content.data() + offset);
+	offset += count * sizeof(T);
+	return exo::Span<const T>(elements, count);
+}
+
+static void write_section(Vec<u8> &content, usize &offset, const void *data, usize size)
+{
+	if (size > 0) {
+		std::memcpy(content.data() + offset, data, size);
+	}
+	offset += size;
+}
+
+// -- Reader
+
+DatabaseIndex DatabaseIndex::from_bytes(exo::Span<const u8> content, u32 version, assets::HashAlgorithm hash_algorithm)
+{
+	EXO_PROFILE_SCOPE
+	DatabaseIndex index = {};
+	if (content.len() < sizeof(DatabaseIndexHeader)) {
+		return index;
+	}
+
+	const auto *header = reinterpret_cast<const DatabaseIndexHeader *>(content.data());
+	if (header->magic != DATABASE_INDEX_MAGIC || header->version != version ||
+		header->hash_algorithm != u32(hash_algorithm)) {
+		return index;
+	}
+
+	const usize expected_size = sizeof(DatabaseIndexHeader) + header->resource_count * sizeof(IndexedResource) +
+	                            2 * usize(header->resource_slot_count) * sizeof(DatabaseIndexSlot) +
+	                            header->closure_count * sizeof(IndexedClosure) +
+	                            header->closure_slot_count * sizeof(DatabaseIndexSlot) +
+	                            header->dependency_count * sizeof(IndexedAsset) + header->strings_size;
+	if (content.len() != expected_size || !std::has_single_bit(header->resource_slot_count) ||
+		!std::has_single_bit(header->closure_slot_count)) {
+		return index;
+	}
+
+	usize offset        = sizeof(DatabaseIndexHeader);
+	index.header        = header;
+	index.resources     = read_section<IndexedResource>(content, offset, header->resource_count);
+	index.path_slots    = read_section<DatabaseIndexSlot>(content, offset, header->resource_slot_count);
+	index.content_slots = read_section<DatabaseIndexSlot>(content, offset, header->resource_slot_count);
+	index.closures      = read_section<IndexedClosure>(content, offset, header->closure_count);
+	index.closure_slots = read_section<DatabaseIndexSlot>(content, offset, header->closure_slot_count);
+	index.dependencies  = read_section<IndexedAsset>(content, offset, header->dependency_count);
+	index.strings       = read_section<char>(content, offset, header->strings_size);
+	return index;
+}
+
+exo::StringView DatabaseIndex::get_string(DatabaseIndexString string) const
+{
+	ASSERT(usize(string.offset) + string.length <= this->strings.len());
+	return exo::StringView{this->strings.data() + string.offset, string.length};
+}
+
+DatabaseIndexAsset DatabaseIndex::get_asset(const IndexedAsset &asset) const
+{
+	return DatabaseIndexAsset{.name = this->get_string(asset.name), .name_hash = asset.name_hash};
+}
+
+DatabaseIndexResource DatabaseIndex::get_resource(u32 i_resource) const
+{
+	const auto &resource = this->resources[i_resource];
+	return DatabaseIndexResource{
+		.asset              = this->get_asset(resource.asset),
+		.path               = this->get_string(resource.path),
+		.last_imported_hash = resource.last_imported_hash,
+		.import_key         = resource.import_key,
+		.content_hash       = resource.content_hash,
+		.stat               = resource.stat,
+	};
+}
+
+DatabaseIndexAsset DatabaseIndex::get_closure_asset(u32 i_closure) const
+{
+	return this->get_asset(this->closures[i_closure].asset);
+}
+
+u32 DatabaseIndex::get_closure_dependency_count(u32 i_closure) const
+{
+	return this->closures[i_closure].dependency_count;
+}
+
+DatabaseIndexAsset DatabaseIndex::get_closure_dependency(u32 i_closure, u32 i_dependency) const
+{
+	const auto &closure = this->closures[i_closure];
+	ASSERT(i_dependency < closure.dependency_count);
+	return this->get_asset(this->dependencies[closure.first_dependency + i_dependency]);
+}
+
+u32 DatabaseIndex::find_resource_by_path(exo::StringView path) const
+{
+	return find_slot(this->path_slots, hash_database_string(path), [&](u32 i_resource) {
+		return this->get_string(this->resources[i_resource].path) == path;
+	});
+}
+
+u32 DatabaseIndex::find_resource_by_content(u64 content_hash) const
+{
+	return find_slot(this->content_slots, content_hash, [](u32) { return true; });
+}
+
+u32 DatabaseIndex::find_closure(u64 asset_name_hash) const
+{
+	return find_slot(this->closure_slots, asset_name_hash, [](u32) { return true; });
+}
+
+// -- Writer
+
+DatabaseIndexString DatabaseIndexWriter::add_string(exo::StringView string)
+{
+	const DatabaseIndexString result = {.offset = u32(this->strings.len()), .length = u32(string.len())};
+	for (usize i_char = 0; i_char < string.len(); i_char += 1) {
+		this->strings.push(string.data()[i_char]);
+	}
+	// Strings are null terminated to be usable as C strings from the mapping
+	this->strings.push('\0');
+	return result;
+}
+
+IndexedAsset DatabaseIndexWriter::add_asset(const DatabaseIndexAsset &asset)
+{
+	return IndexedAsset{.name_hash = asset.name_hash, .name = this->add_string(asset.name)};
+}
+
+void DatabaseIndexWriter::add_resource(const DatabaseIndexResource &resource)
+{
+	this->resources.push(IndexedResource{
+		.asset              = this->add_asset(resource.asset),
+		.path               = this->add_string(resource.path),
+		.path_hash          = hash_database_string(resource.path),
+		.last_imported_hash = resource.last_imported_hash,
+		.import_key         = resource.import_key,
+		.content_hash       = resource.content_hash,
+		.stat               = resource.stat,
+	});
+}
+
+void DatabaseIndexWriter::add_closure(
+	const DatabaseIndexAsset &asset, exo::Span<const DatabaseIndexAsset> closure_dependencies)
+{
+	IndexedClosure closure   = {};
+	closure.asset            = this->add_asset(asset);
+	closure.first_dependency = u32(this->dependencies.len());
+	closure.dependency_count = u32(closure_dependencies.len());
+	for (const auto &dependency : closure_dependencies) {
+		this->dependencies.push(this->add_asset(dependency));
+	}
+	this->closures.push(closure);
+}
+
+Vec<u8> DatabaseIndexWriter::write(u32 version, assets::HashAlgorithm hash_algorithm, u64 last_scan_time) const
+{
+	EXO_PROFILE_SCOPE
+	// The string table is padded, the file size stays a multiple of 8 bytes
+	const usize strings_size = (this->strings.len() + 7) & ~usize(7);
+
+	DatabaseIndexHeader header = {};
+	header.version             = version;
+	header.hash_algorithm      = u32(hash_algorithm);
+	header.last_scan_time      = last_scan_time;
+	header.resource_count      = u32(this->resources.len());
+	header.resource_slot_count = get_slot_count(this->resources.len());
+	header.closure_count       = u32(this->closures.len());
+	header.closure_slot_count  = get_slot_count(this->closures.len());
+	header.dependency_count    = u32(this->dependencies.len());
+	header.strings_size        = strings_size;
+
+	auto path_slots    = Vec<DatabaseIndexSlot>::with_length(header.resource_slot_count);
+	auto content_slots = Vec<DatabaseIndexSlot>::with_length(header.resource_slot_count);
+	for (u32 i_resource = 0; i_resource < header.resource_count; i_resource += 1) {
+		const auto &resource = this->resources[i_resource];
+		insert_slot(path_slots, resource.path_hash, i_resource);
+		if (resource.content_hash != 0) {
+			insert_slot(content_slots, resource.content_hash, i_resource);
+		}
+	}
+
+	auto closure_slots = Vec<DatabaseIndexSlot>::with_length(header.closure_slot_count);
+	for (u32 i_closure = 0; i_closure < header.closure_count; i_closure += 1) {
+		insert_slot(closure_slots, this->closures[i_closure].asset.name_hash, i_closure);
+	}
+
+	const usize content_size = sizeof(DatabaseIndexHeader) + this->resources.len() * sizeof(IndexedResource) +
+	                           (path_slots.len() + content_slots.len()) * sizeof(DatabaseIndexSlot) +
+	                           this->closures.len() * sizeof(IndexedClosure) +
+	                           closure_slots.len() * sizeof(DatabaseIndexSlot) +
+	                           this->dependencies.len() * sizeof(IndexedAsset) + strings_size;
+
+	// Zeroed, the padding of the string table is written as is and the output only depends on the content
+	auto  content = Vec<u8>::with_values(content_size, 0);
+	usize offset  = 0;
+	write_section(content, offset, &header, sizeof(header));
+	write_section(content, offset, this->resources.data(), this->resources.len() * sizeof(IndexedResource));
+	write_section(content, offset, path_slots.data(), path_slots.len() * sizeof(DatabaseIndexSlot));
+	write_section(content, offset, content_slots.data(), content_slots.len() * sizeof(DatabaseIndexSlot));
+	write_section(content, offset, this->closures.data(), this->closures.len() * sizeof(IndexedClosure));
+	write_section(content, offset, closure_slots.data(), closure_slots.len() * sizeof(DatabaseIndexSlot));
+	write_section(content, offset, this->dependencies.data(), this->dependencies.len() * sizeof(IndexedAsset));
+	write_section(content, offset, this->strings.data(), this->strings.len());
+	ASSERT(offset + strings_size - this->strings.len() == content_size);
+	return content;
+}
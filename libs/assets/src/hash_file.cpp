@@ -0,0 +1,160 @@
+#include "assets/hash_file.h"
+
+#include "cross/file_stat.h"
+#include "exo/macros/assert.h"
+#include "exo/profile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <meow_hash_x64_aesni.h>
+#include <xxhash.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace assets
+{
+static bool cpu_has_aes()
+{
+#if defined(_MSC_VER)
+	int cpu_info[4] = {};
+	__cpuid(cpu_info, 1);
+	return (cpu_info[2] & (1 << 25)) != 0;
+#else
+	return __builtin_cpu_supports("aes");
+#endif
+}
+
+static HashAlgorithm &get_algorithm_storage()
+{
+	static HashAlgorithm algorithm = cpu_has_aes() ? HashAlgorithm::Meow : HashAlgorithm::XXH3;
+	return algorithm;
+}
+
+HashAlgorithm get_hash_algorithm() { return get_algorithm_storage(); }
+
+void set_hash_algorithm(HashAlgorithm algorithm)
+{
+	ASSERT(algorithm != HashAlgorithm::Meow || cpu_has_aes());
+	get_algorithm_storage() = algorithm;
+}
+
+static exo::u128 hash_bytes(exo::Span<const u8> content)
+{
+	if (get_hash_algorithm() == HashAlgorithm::Meow) {
+		void *non_const_data = const_cast<u8 *>(content.data());
+		return MeowHash(MeowDefaultSeed, content.len(), non_const_data);
+	}
+
+	const auto hash = XXH3_128bits(content.data(), content.len());
+	return exo::u128_from_u64(hash.high64, hash.low64);
+}
+
+u64 to_hash64(exo::u128 hash)
+{
+	u64 low  = 0;
+	u64 high = 0;
+	exo::u128_to_u64(hash, &low, &high);
+	return low;
+}
+
+void split_hash_chunks(exo::Span<const u8> content, Vec<HashChunk> &out_chunks)
+{
+	ASSERT(content.len() >= CHUNKED_HASH_MIN_SIZE);
+	for (usize offset = 0; offset < content.len(); offset += HASH_CHUNK_SIZE) {
+		const usize chunk_size = std::min(HASH_CHUNK_SIZE, content.len() - offset);
+		out_chunks.push(HashChunk{.content = exo::Span<const u8>(content.data() + offset, chunk_size)});
+	}
+}
+
+void hash_chunk(HashChunk &chunk) { chunk.hash = hash_bytes(chunk.content); }
+
+exo::u128 combine_chunk_hashes(exo::Span<const exo::u128> chunk_hashes, usize content_size)
+{
+	// The size is hashed last, files whose chunk hashes are a prefix of each other still differ
+	Vec<exo::u128> tree_content;
+	tree_content.reserve(chunk_hashes.len() + 1);
+	for (const auto &chunk_hash : chunk_hashes) {
+		tree_content.push(chunk_hash);
+	}
+	tree_content.push(exo::u128_from_u64(0, u64(content_size)));
+
+	const auto *tree_bytes = reinterpret_cast<const u8 *>(tree_content.data());
+	return hash_bytes(exo::Span<const u8>(tree_bytes, tree_content.len() * sizeof(exo::u128)));
+}
+
+static exo::u128 combine_chunks(exo::Span<const HashChunk> chunks, usize content_size)
+{
+	Vec<exo::u128> chunk_hashes;
+	chunk_hashes.reserve(chunks.len());
+	for (const auto &chunk : chunks) {
+		chunk_hashes.push(chunk.hash);
+	}
+	return combine_chunk_hashes(chunk_hashes, content_size);
+}
+
+exo::u128 hash_file128(exo::Span<const u8> content)
+{
+	EXO_PROFILE_SCOPE
+	if (content.len() < CHUNKED_HASH_MIN_SIZE) {
+		return hash_bytes(content);
+	}
+
+	Vec<HashChunk> chunks;
+	split_hash_chunks(content, chunks);
+	for (auto &chunk : chunks) {
+		hash_chunk(chunk);
+	}
+	return combine_chunks(chunks, content.len());
+}
+
+u64 hash_file64(exo::Span<const u8> content) { return to_hash64(hash_file128(content)); }
+
+Option<exo::u128> hash_file128_streamed(exo::StringView path)
+{
+	EXO_PROFILE_SCOPE
+	const auto stat = cross::get_file_stat(path);
+	if (!stat) {
+		return None;
+	}
+
+	std::FILE *file = std::fopen(path.data(), "rb");
+	if (!file) {
+		return None;
+	}
+
+	// Small files are read at once, their hash is not chunked
+	const usize file_size = usize(stat->size);
+	if (file_size < CHUNKED_HASH_MIN_SIZE) {
+		auto        buffer    = Vec<u8>::with_length(file_size);
+		const usize read_size = std::fread(buffer.data(), 1, file_size, file);
+		std::fclose(file);
+		if (read_size != file_size) {
+			return None;
+		}
+		return hash_bytes(exo::Span<const u8>(buffer.data(), file_size));
+	}
+
+	auto           buffer = Vec<u8>::with_length(HASH_CHUNK_SIZE);
+	Vec<exo::u128> chunk_hashes;
+	for (usize offset = 0; offset < file_size; offset += HASH_CHUNK_SIZE) {
+		const usize chunk_size = std::min(HASH_CHUNK_SIZE, file_size - offset);
+		if (std::fread(buffer.data(), 1, chunk_size, file) != chunk_size) {
+			std::fclose(file);
+			return None;
+		}
+		chunk_hashes.push(hash_bytes(exo::Span<const u8>(buffer.data(), chunk_size)));
+	}
+	std::fclose(file);
+	return combine_chunk_hashes(chunk_hashes, file_size);
+}
+
+Option<u64> hash_file64_streamed(exo::StringView path)
+{
+	if (auto hash = hash_file128_streamed(path)) {
+		return to_hash64(*hash);
+	}
+	return None;
+}
+} // namespace assets
@@ -0,0 +1,332 @@
+#include "assets/image_ops.h"
+
+#include "exo/collections/vector.h"
+#include "exo/macros/assert.h"
+#include "exo/profile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <smmintrin.h>
+
+// -- Channels
+
+void expand_rgb_to_rgba(exo::Span<const u8> rgb, exo::Span<u8> rgba, u8 alpha)
+{
+	EXO_PROFILE_SCOPE
+	ASSERT(rgb.len() % 3 == 0);
+	const usize texel_count = rgb.len() / 3;
+	ASSERT(rgba.len() == 4 * texel_count);
+
+	const __m128i shuffle    = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	const __m128i alpha_mask = _mm_set1_epi32(static_cast<int>(u32(alpha) << 24));
+
+	// 16 bytes are loaded for 4 texels, the last texels are expanded one at a time to not read past the image
+	usize i_texel = 0;
+	for (; 3 * i_texel + 16 <= rgb.len(); i_texel += 4) {
+		const __m128i texels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rgb.data() + 3 * i_texel));
+		const __m128i result = _mm_or_si128(_mm_shuffle_epi8(texels, shuffle), alpha_mask);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(rgba.data() + 4 * i_texel), result);
+	}
+	for (; i_texel < texel_count; i_texel += 1) {
+		rgba[4 * i_texel + 0] = rgb[3 * i_texel + 0];
+		rgba[4 * i_texel + 1] = rgb[3 * i_texel + 1];
+		rgba[4 * i_texel + 2] = rgb[3 * i_texel + 2];
+		rgba[4 * i_texel + 3] = alpha;
+	}
+}
+
+void swizzle_rgba(exo::Span<const u8> src, exo::Span<u8> dst, ChannelSwizzle swizzle)
+{
+	EXO_PROFILE_SCOPE
+	ASSERT(src.len() % 4 == 0 && dst.len() == src.len());
+
+	alignas(16) u8 shuffle_bytes[16] = {};
+	for (u32 i_byte = 0; i_byte < 16; i_byte += 1) {
+		const u8 source = swizzle.sources[i_byte % 4];
+		ASSERT(source < 4);
+		shuffle_bytes[i_byte] = u8((i_byte & ~3u) + source);
+	}
+	const __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i *>(shuffle_bytes));
+
+	usize i_byte = 0;
+	for (; i_byte + 16 <= src.len(); i_byte += 16) {
+		const __m128i texels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src.data() + i_byte));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst.data() + i_byte), _mm_shuffle_epi8(texels, shuffle));
+	}
+	for (; i_byte < src.len(); i_byte += 4) {
+		u8 texel[4];
+		std::memcpy(texel, src.data() + i_byte, 4);
+		for (u32 i_channel = 0; i_channel < 4; i_channel += 1) {
+			dst[i_byte + i_channel] = texel[swizzle.sources[i_channel]];
+		}
+	}
+}
+
+// -- sRGB
+
+struct SrgbTables
+{
+	float srgb_to_linear[256];
+	float unorm_to_float[256];
+};
+
+static SrgbTables create_srgb_tables()
+{
+	SrgbTables tables = {};
+	for (u32 i = 0; i < 256; i += 1) {
+		const float c            = float(i) / 255.0f;
+		tables.unorm_to_float[i] = c;
+		tables.srgb_to_linear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+	}
+	return tables;
+}
+
+static const SrgbTables &get_srgb_tables()
+{
+	static const SrgbTables tables = create_srgb_tables();
+	return tables;
+}
+
+void srgb_to_linear_rgba(exo::Span<const u8> rgba, exo::Span<float> linear)
+{
+	EXO_PROFILE_SCOPE
+	ASSERT(rgba.len() % 4 == 0 && linear.len() == rgba.len());
+	const auto &tables = get_srgb_tables();
+	for (usize i_byte = 0; i_byte < rgba.len(); i_byte += 4) {
+		const __m128 texel = _mm_setr_ps(tables.srgb_to_linear[rgba[i_byte + 0]],
+			tables.srgb_to_linear[rgba[i_byte + 1]],
+			tables.srgb_to_linear[rgba[i_byte + 2]],
+			tables.unorm_to_float[rgba[i_byte + 3]]);
+		_mm_storeu_ps(linear.data() + i_byte, texel);
+	}
+}
+
+// x^(1/2.4) is approximated from x^(1/2), x^(1/4) and x^(1/8), the square roots are exact and fast
+static __m128i encode_srgb_texel(__m128 linear)
+{
+	const __m128 x  = _mm_min_ps(_mm_max_ps(linear, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+	const __m128 s1 = _mm_sqrt_ps(x);
+	const __m128 s2 = _mm_sqrt_ps(s1);
+	const __m128 s3 = _mm_sqrt_ps(s2);
+
+	__m128 curve = _mm_mul_ps(s1, _mm_set1_ps(0.662002687f));
+	curve        = _mm_add_ps(curve, _mm_mul_ps(s2, _mm_set1_ps(0.684122060f)));
+	curve        = _mm_sub_ps(curve, _mm_mul_ps(s3, _mm_set1_ps(0.323583601f)));
+	curve        = _mm_sub_ps(curve, _mm_mul_ps(x, _mm_set1_ps(0.0225411470f)));
+
+	const __m128 linear_segment = _mm_mul_ps(x, _mm_set1_ps(12.92f));
+	const __m128 is_linear      = _mm_cmple_ps(x, _mm_set1_ps(0.0031308f));
+	const __m128 srgb           = _mm_blendv_ps(curve, linear_segment, is_linear);
+
+	// Alpha stays linear
+	const __m128 value = _mm_blend_ps(srgb, x, 0b1000);
+	return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+}
+
+void linear_to_srgb_rgba(exo::Span<const float> linear, exo::Span<u8> rgba)
+{
+	EXO_PROFILE_SCOPE
+	ASSERT(linear.len() % 4 == 0 && rgba.len() == linear.len());
+
+	// The packs saturate, values rounded up to 256 are stored as 255
+	usize i_value = 0;
+	for (; i_value + 16 <= linear.len(); i_value += 16) {
+		const __m128i texel0 = encode_srgb_texel(_mm_loadu_ps(linear.data() + i_value + 0));
+		const __m128i texel1 = encode_srgb_texel(_mm_loadu_ps(linear.data() + i_value + 4));
+		const __m128i texel2 = encode_srgb_texel(_mm_loadu_ps(linear.data() + i_value + 8));
+		const __m128i texel3 = encode_srgb_texel(_mm_loadu_ps(linear.data() + i_value + 12));
+		const __m128i bytes  = _mm_packus_epi16(_mm_packus_epi32(texel0, texel1), _mm_packus_epi32(texel2, texel3));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(rgba.data() + i_value), bytes);
+	}
+	for (; i_value < linear.len(); i_value += 4) {
+		const __m128i texel = encode_srgb_texel(_mm_loadu_ps(linear.data() + i_value));
+		const __m128i bytes = _mm_packus_epi16(_mm_packus_epi32(texel, texel), texel);
+		const i32     packed = _mm_cvtsi128_si32(bytes);
+		std::memcpy(rgba.data() + i_value, &packed, 4);
+	}
+}
+
+// -- Alpha
+
+// Rounded a * b / 255 of 8 bits values in 16 bits lanes
+static __m128i multiply_unorm8(__m128i lhs, __m128i rhs)
+{
+	const __m128i product = _mm_add_epi16(_mm_mullo_epi16(lhs, rhs), _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+}
+
+void premultiply_alpha(exo::Span<u8> rgba)
+{
+	EXO_PROFILE_SCOPE
+	ASSERT(rgba.len() % 4 == 0);
+
+	// The alpha of each texel is multiplied by 255 to stay the same
+	const __m128i alpha_shuffle = _mm_setr_epi8(3, 3, 3, -1, 7, 7, 7, -1, 11, 11, 11, -1, 15, 15, 15, -1);
+	const __m128i alpha_mask    = _mm_set1_epi32(static_cast<int>(0xff000000u));
+	const __m128i zero          = _mm_setzero_si128();
+
+	usize i_byte = 0;
+	for (; i_byte + 16 <= rgba.len(); i_byte += 16) {
+		auto         *p_texels = reinterpret_cast<__m128i *>(rgba.data() + i_byte);
+		const __m128i texels   = _mm_loadu_si128(p_texels);
+		const __m128i alphas   = _mm_or_si128(_mm_shuffle_epi8(texels, alpha_shuffle), alpha_mask);
+
+		const __m128i low  = multiply_unorm8(_mm_unpacklo_epi8(texels, zero), _mm_unpacklo_epi8(alphas, zero));
+		const __m128i high = multiply_unorm8(_mm_unpackhi_epi8(texels, zero), _mm_unpackhi_epi8(alphas, zero));
+		_mm_storeu_si128(p_texels, _mm_packus_epi16(low, high));
+	}
+	for (; i_byte < rgba.len(); i_byte += 4) {
+		const u32 alpha = rgba[i_byte + 3];
+		for (u32 i_channel = 0; i_channel < 3; i_channel += 1) {
+			const u32 product        = u32(rgba[i_byte + i_channel]) * alpha + 128;
+			rgba[i_byte + i_channel] = u8((product + (product >> 8)) >> 8);
+		}
+	}
+}
+
+// -- Bit depth
+
+static u32 get_dither_threshold(u32 x, u32 y)
+{
+	constexpr u32 bayer[4][4] = {{0, 8, 2, 10}, {12, 4, 14, 6}, {3, 11, 1, 9}, {15, 7, 13, 5}};
+	return (2 * bayer[y & 3][x & 3] + 1) * 65535 / 32;
+}
+
+// (value * 255 + threshold) / 65535, the division is exact with the shifts for the n < 2^24 reached here
+static u32 quantize_16_to_8(u32 value, u32 threshold)
+{
+	const u32 n = value * 255 + threshold;
+	return (n + 1 + (n >> 16)) >> 16;
+}
+
+static __m128i quantize_16_to_8(__m128i values, __m128i thresholds)
+{
+	const __m128i n = _mm_add_epi32(_mm_sub_epi32(_mm_slli_epi32(values, 8), values), thresholds);
+	return _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(n, _mm_set1_epi32(1)), _mm_srli_epi32(n, 16)), 16);
+}
+
+void convert_16_to_8_bits(
+	exo::Span<const u16> src, exo::Span<u8> dst, u32 width, u32 height, u32 channels, bool dither)
+{
+	EXO_PROFILE_SCOPE
+	const usize row_length = usize(width) * channels;
+	ASSERT(src.len() == row_length * height && dst.len() == src.len());
+
+	// The dither pattern repeats every 4 rows, the threshold of each channel is precomputed for these rows
+	const u32 rounding = 65535 / 2;
+	Vec<u32>  thresholds;
+	if (dither) {
+		thresholds = Vec<u32>::with_length(4 * row_length);
+		for (u32 y = 0; y < 4; y += 1) {
+			for (usize i_value = 0; i_value < row_length; i_value += 1) {
+				thresholds[y * row_length + i_value] = get_dither_threshold(u32(i_value / channels), y);
+			}
+		}
+	}
+
+	for (u32 y = 0; y < height; y += 1) {
+		const u16 *src_row        = src.data() + y * row_length;
+		u8        *dst_row        = dst.data() + y * row_length;
+		const u32 *row_thresholds = dither ? thresholds.data() + (y & 3) * row_length : nullptr;
+
+		usize i_value = 0;
+		for (; i_value + 8 <= row_length; i_value += 8) {
+			const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src_row + i_value));
+			__m128i       low_thresholds  = _mm_set1_epi32(static_cast<int>(rounding));
+			__m128i       high_thresholds = low_thresholds;
+			if (dither) {
+				low_thresholds  = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row_thresholds + i_value));
+				high_thresholds = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row_thresholds + i_value + 4));
+			}
+
+			const __m128i low   = quantize_16_to_8(_mm_cvtepu16_epi32(values), low_thresholds);
+			const __m128i high  = quantize_16_to_8(_mm_cvtepu16_epi32(_mm_srli_si128(values, 8)), high_thresholds);
+			const __m128i words = _mm_packus_epi32(low, high);
+			_mm_storel_epi64(reinterpret_cast<__m128i *>(dst_row + i_value), _mm_packus_epi16(words, words));
+		}
+		for (; i_value < row_length; i_value += 1) {
+			const u32 threshold = dither ? row_thresholds[i_value] : rounding;
+			dst_row[i_value]    = u8(quantize_16_to_8(src_row[i_value], threshold));
+		}
+	}
+}
+
+// -- Resampling
+
+struct ResampleTaps
+{
+	Vec<i32>   first_texels; // first source texel of each destination texel, can be outside of the image
+	Vec<float> weights;      // `tap_count` normalized weights per destination texel
+	u32        tap_count = 0;
+};
+
+static ResampleTaps compute_resample_taps(u32 src_size, u32 dst_size)
+{
+	const float scale  = float(src_size) / float(dst_size);
+	const float radius = std::max(1.0f, scale);
+
+	ResampleTaps taps = {};
+	taps.tap_count    = u32(std::ceil(2.0f * radius)) + 1;
+	for (u32 i_dst = 0; i_dst < dst_size; i_dst += 1) {
+		const float center = (float(i_dst) + 0.5f) * scale - 0.5f;
+		const i32   first  = i32(std::floor(center - radius)) + 1;
+		taps.first_texels.push(first);
+
+		const usize first_weight = taps.weights.len();
+		float       total        = 0.0f;
+		for (u32 i_tap = 0; i_tap < taps.tap_count; i_tap += 1) {
+			const float weight = std::max(0.0f, 1.0f - std::abs(float(first + i32(i_tap)) - center) / radius);
+			taps.weights.push(weight);
+			total += weight;
+		}
+		for (u32 i_tap = 0; i_tap < taps.tap_count; i_tap += 1) {
+			taps.weights[first_weight + i_tap] /= total;
+		}
+	}
+	return taps;
+}
+
+static usize clamp_texel(i32 texel, u32 size) { return usize(std::clamp(texel, 0, i32(size) - 1)); }
+
+void resize_rgba(
+	exo::Span<const float> src, u32 src_width, u32 src_height, exo::Span<float> dst, u32 dst_width, u32 dst_height)
+{
+	EXO_PROFILE_SCOPE
+	ASSERT(src.len() == 4 * usize(src_width) * src_height);
+	ASSERT(dst.len() == 4 * usize(dst_width) * dst_height);
+
+	const auto horizontal_taps = compute_resample_taps(src_width, dst_width);
+	const auto vertical_taps   = compute_resample_taps(src_height, dst_height);
+
+	// -- Resize the rows first, then the columns of the resized rows
+	auto rows = Vec<float>::with_length(4 * usize(dst_width) * src_height);
+	for (u32 y = 0; y < src_height; y += 1) {
+		const float *src_row = src.data() + 4 * usize(y) * src_width;
+		for (u32 x = 0; x < dst_width; x += 1) {
+			const float *weights = horizontal_taps.weights.data() + usize(x) * horizontal_taps.tap_count;
+			const i32    first   = horizontal_taps.first_texels[x];
+
+			__m128 sum = _mm_setzero_ps();
+			for (u32 i_tap = 0; i_tap < horizontal_taps.tap_count; i_tap += 1) {
+				const __m128 texel = _mm_loadu_ps(src_row + 4 * clamp_texel(first + i32(i_tap), src_width));
+				sum                = _mm_add_ps(sum, _mm_mul_ps(texel, _mm_set1_ps(weights[i_tap])));
+			}
+			_mm_storeu_ps(rows.data() + 4 * (usize(y) * dst_width + x), sum);
+		}
+	}
+
+	for (u32 y = 0; y < dst_height; y += 1) {
+		const float *weights = vertical_taps.weights.data() + usize(y) * vertical_taps.tap_count;
+		const i32    first   = vertical_taps.first_texels[y];
+		for (u32 x = 0; x < dst_width; x += 1) {
+			__m128 sum = _mm_setzero_ps();
+			for (u32 i_tap = 0; i_tap < vertical_taps.tap_count; i_tap += 1) {
+				const usize  row   = clamp_texel(first + i32(i_tap), src_height);
+				const __m128 texel = _mm_loadu_ps(rows.data() + 4 * (row * dst_width + x));
+				sum                = _mm_add_ps(sum, _mm_mul_ps(texel, _mm_set1_ps(weights[i_tap])));
+			}
+			_mm_storeu_ps(dst.data() + 4 * (usize(y) * dst_width + x), sum);
+		}
+	}
+}
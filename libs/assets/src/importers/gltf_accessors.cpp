@@ -0,0 +1,191 @@
+#include "assets/importers/gltf_accessors.h"
+
+#include "exo/macros/assert.h"
+#include "exo/profile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace gltf
+{
+u32 size_of(ComponentType type)
+{
+	switch (type) {
+	case ComponentType::Byte:
+	case ComponentType::UnsignedByte:
+		return 1;
+
+	case ComponentType::Short:
+	case ComponentType::UnsignedShort:
+		return 2;
+
+	case ComponentType::UnsignedInt:
+	case ComponentType::Float:
+		return 4;
+
+	default:
+		ASSERT(false);
+		return 4;
+	}
+}
+
+float read_component(const u8 *component, ComponentType type, bool normalized)
+{
+	switch (type) {
+	case ComponentType::Byte: {
+		const auto value = i8(component[0]);
+		return normalized ? std::max(float(value) / 127.0f, -1.0f) : float(value);
+	}
+	case ComponentType::UnsignedByte: {
+		return normalized ? float(component[0]) / 255.0f : float(component[0]);
+	}
+	case ComponentType::Short: {
+		i16 value = 0;
+		std::memcpy(&value, component, sizeof(value));
+		return normalized ? std::max(float(value) / 32767.0f, -1.0f) : float(value);
+	}
+	case ComponentType::UnsignedShort: {
+		u16 value = 0;
+		std::memcpy(&value, component, sizeof(value));
+		return normalized ? float(value) / 65535.0f : float(value);
+	}
+	case ComponentType::UnsignedInt: {
+		u32 value = 0;
+		std::memcpy(&value, component, sizeof(value));
+		return float(value);
+	}
+	case ComponentType::Float: {
+		float value = 0.0f;
+		std::memcpy(&value, component, sizeof(value));
+		return value;
+	}
+	default:
+		ASSERT(false);
+		return 0.0f;
+	}
+}
+
+static u32 read_index(const u8 *element, ComponentType type)
+{
+	switch (type) {
+	case ComponentType::UnsignedByte: {
+		return element[0];
+	}
+	case ComponentType::UnsignedShort: {
+		u16 value = 0;
+		std::memcpy(&value, element, sizeof(value));
+		return value;
+	}
+	case ComponentType::UnsignedInt: {
+		u32 value = 0;
+		std::memcpy(&value, element, sizeof(value));
+		return value;
+	}
+	default:
+		ASSERT(false);
+		return 0;
+	}
+}
+
+void decode_indices(const AccessorData &src, u32 vertex_base, u32 *dst)
+{
+	EXO_PROFILE_SCOPE
+	const __m128i base   = _mm_set1_epi32(i32(vertex_base));
+	const __m128i zero   = _mm_setzero_si128();
+	const bool    packed = src.byte_stride == size_of(src.component_type);
+
+	u32 i_index = 0;
+	if (packed && src.component_type == ComponentType::UnsignedByte) {
+		for (; i_index + 16 <= src.count; i_index += 16) {
+			const __m128i bytes   = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src.data + i_index));
+			const __m128i shorts0 = _mm_unpacklo_epi8(bytes, zero);
+			const __m128i shorts1 = _mm_unpackhi_epi8(bytes, zero);
+			auto         *out     = reinterpret_cast<__m128i *>(dst + i_index);
+			_mm_storeu_si128(out + 0, _mm_add_epi32(_mm_unpacklo_epi16(shorts0, zero), base));
+			_mm_storeu_si128(out + 1, _mm_add_epi32(_mm_unpackhi_epi16(shorts0, zero), base));
+			_mm_storeu_si128(out + 2, _mm_add_epi32(_mm_unpacklo_epi16(shorts1, zero), base));
+			_mm_storeu_si128(out + 3, _mm_add_epi32(_mm_unpackhi_epi16(shorts1, zero), base));
+		}
+	} else if (packed && src.component_type == ComponentType::UnsignedShort) {
+		for (; i_index + 8 <= src.count; i_index += 8) {
+			const __m128i shorts = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src.data + 2 * usize(i_index)));
+			auto         *out    = reinterpret_cast<__m128i *>(dst + i_index);
+			_mm_storeu_si128(out + 0, _mm_add_epi32(_mm_unpacklo_epi16(shorts, zero), base));
+			_mm_storeu_si128(out + 1, _mm_add_epi32(_mm_unpackhi_epi16(shorts, zero), base));
+		}
+	} else if (packed && src.component_type == ComponentType::UnsignedInt) {
+		for (; i_index + 4 <= src.count; i_index += 4) {
+			const __m128i ints = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src.data + 4 * usize(i_index)));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i_index), _mm_add_epi32(ints, base));
+		}
+	}
+
+	for (; i_index < src.count; i_index += 1) {
+		dst[i_index] = vertex_base + read_index(src.data + i_index * src.byte_stride, src.component_type);
+	}
+}
+
+void decode_positions(const AccessorData &src, float4 *dst)
+{
+	EXO_PROFILE_SCOPE
+	ASSERT(src.nb_component >= 3);
+
+	u32 i_position = 0;
+	if (src.component_type == ComponentType::Float && src.byte_stride >= 3 * sizeof(float)) {
+		// A 16 bytes load of an element reads the first component of the next one, the last element is read alone
+		const __m128 xyz_mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+		const __m128 w_one    = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+		for (; i_position + 1 < src.count; i_position += 1) {
+			const __m128 xyzn = _mm_loadu_ps(reinterpret_cast<const float *>(src.data + i_position * src.byte_stride));
+			_mm_storeu_ps(&dst[i_position].x, _mm_or_ps(_mm_and_ps(xyzn, xyz_mask), w_one));
+		}
+	}
+
+	const usize component_size = size_of(src.component_type);
+	for (; i_position < src.count; i_position += 1) {
+		const u8 *element = src.data + i_position * src.byte_stride;
+		dst[i_position]   = float4(read_component(element, src.component_type, src.normalized),
+			read_component(element + component_size, src.component_type, src.normalized),
+			read_component(element + 2 * component_size, src.component_type, src.normalized),
+			1.0f);
+	}
+}
+
+void decode_uvs(const AccessorData &src, float2 *dst)
+{
+	EXO_PROFILE_SCOPE
+	ASSERT(src.nb_component >= 2);
+
+	u32 i_uv = 0;
+	if (src.component_type == ComponentType::Float) {
+		if (src.byte_stride == sizeof(float2)) {
+			std::memcpy(dst, src.data, src.count * sizeof(float2));
+			return;
+		}
+		for (; i_uv < src.count; i_uv += 1) {
+			std::memcpy(&dst[i_uv], src.data + i_uv * src.byte_stride, sizeof(float2));
+		}
+		return;
+	}
+
+	if (src.component_type == ComponentType::UnsignedShort && src.normalized && src.byte_stride == 2 * sizeof(u16)) {
+		const __m128i zero  = _mm_setzero_si128();
+		const __m128  scale = _mm_set1_ps(1.0f / 65535.0f);
+		for (; i_uv + 4 <= src.count; i_uv += 4) {
+			const __m128i shorts = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src.data + 4 * usize(i_uv)));
+			const __m128  uv01   = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(shorts, zero)), scale);
+			const __m128  uv23   = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(shorts, zero)), scale);
+			_mm_storeu_ps(&dst[i_uv].x, uv01);
+			_mm_storeu_ps(&dst[i_uv + 2].x, uv23);
+		}
+	}
+
+	const usize component_size = size_of(src.component_type);
+	for (; i_uv < src.count; i_uv += 1) {
+		const u8 *element = src.data + i_uv * src.byte_stride;
+		dst[i_uv]         = float2(read_component(element, src.component_type, src.normalized),
+			read_component(element + component_size, src.component_type, src.normalized));
+	}
+}
+} // namespace gltf
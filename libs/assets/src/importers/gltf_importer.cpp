@@ -1,16 +1,25 @@
 #include "assets/importers/gltf_importer.h"
+#include "assets/importers/gltf_accessors.h"
 #include "assets/asset_manager.h"
+#include "assets/bvh.h"
 #include "assets/importers/importer.h"
 #include "assets/material.h"
 #include "assets/mesh.h"
 #include "assets/subscene.h"
 #include "assets/texture.h"
+#include "cross/jobmanager.h"
+#include "cross/jobs/foreach.h"
 #include "cross/mapped_file.h"
 #include "exo/collections/span.h"
 #include "exo/format.h"
 #include "exo/maths/pointer.h"
 #include "exo/memory/scope_stack.h"
 #include "exo/memory/string_repository.h"
+#include "exo/hash.h"
+#include "exo/profile.h"
+#include <algorithm>
+#include <bit>
+#include <meshoptimizer.h>
 #include <rapidjson/document.h>
 #include <rapidjson/error/en.h>
 #include <rapidjson/filewritestream.h>
@@ -20,37 +29,6 @@
 
 namespace gltf
 {
-enum struct ComponentType : i32
-{
-	Byte          = 5120,
-	UnsignedByte  = 5121,
-	Short         = 5122,
-	UnsignedShort = 5123,
-	UnsignedInt   = 5125,
-	Float         = 5126,
-	Invalid
-};
-
-inline u32 size_of(ComponentType type)
-{
-	switch (type) {
-	case ComponentType::Byte:
-	case ComponentType::UnsignedByte:
-		return 1;
-
-	case ComponentType::Short:
-	case ComponentType::UnsignedShort:
-		return 2;
-
-	case ComponentType::UnsignedInt:
-	case ComponentType::Float:
-		return 4;
-
-	default:
-		ASSERT(false);
-		return 4;
-	}
-}
 enum struct ChunkType : u32
 {
 	Json   = 0x4E4F534A,
@@ -73,15 +51,28 @@ struct Header
 	Chunk first_chunk;
 };
 
+// Elements of an accessor replaced by other values, the replaced elements are listed in `indices`
+struct SparseAccessor
+{
+	u32           count                  = 0;
+	u32           indices_bufferview     = u32_invalid;
+	u32           indices_byte_offset    = 0;
+	ComponentType indices_component_type = ComponentType::Invalid;
+	u32           values_bufferview      = u32_invalid;
+	u32           values_byte_offset     = 0;
+};
+
 struct Accessor
 {
-	ComponentType component_type   = ComponentType::Invalid;
-	u32           count            = 0;
-	u32           nb_component     = 0;
-	u32           bufferview_index = 0;
-	u32           byte_offset      = 0;
-	float         min_float;
-	float         max_float;
+	ComponentType  component_type   = ComponentType::Invalid;
+	u32            count            = 0;
+	u32            nb_component     = 0;
+	u32            bufferview_index = u32_invalid; // elements are zeros without a buffer view
+	u32            byte_offset      = 0;
+	bool           normalized       = false;
+	SparseAccessor sparse           = {};
+	float          min_float;
+	float          max_float;
 };
 
 struct BufferView
@@ -98,15 +89,20 @@ static Accessor get_accessor(const rapidjson::Value &object)
 
 	Accessor res = {};
 
-	// technically not required but it doesn't make sense not to have one
-	res.bufferview_index = accessor["bufferView"].GetUint();
-	res.byte_offset      = 0;
+	// Sparse accessors can omit the buffer view, the elements that are not replaced are zeros
+	if (accessor.HasMember("bufferView")) {
+		res.bufferview_index = accessor["bufferView"].GetUint();
+	}
+	res.byte_offset = 0;
 
 	if (accessor.HasMember("byteOffset")) {
 		res.byte_offset = accessor["byteOffset"].GetUint();
 	}
 
 	res.component_type = ComponentType(accessor["componentType"].GetInt());
+	if (accessor.HasMember("normalized")) {
+		res.normalized = accessor["normalized"].GetBool();
+	}
 
 	res.count = accessor["count"].GetUint();
 
@@ -127,6 +123,22 @@ static Accessor get_accessor(const rapidjson::Value &object)
 		ASSERT(false);
 	}
 
+	if (accessor.HasMember("sparse")) {
+		const auto &sparse                = accessor["sparse"].GetObj();
+		const auto &indices               = sparse["indices"].GetObj();
+		const auto &values                = sparse["values"].GetObj();
+		res.sparse.count                  = sparse["count"].GetUint();
+		res.sparse.indices_bufferview     = indices["bufferView"].GetUint();
+		res.sparse.indices_component_type = ComponentType(indices["componentType"].GetInt());
+		res.sparse.values_bufferview      = values["bufferView"].GetUint();
+		if (indices.HasMember("byteOffset")) {
+			res.sparse.indices_byte_offset = indices["byteOffset"].GetUint();
+		}
+		if (values.HasMember("byteOffset")) {
+			res.sparse.values_byte_offset = values["byteOffset"].GetUint();
+		}
+	}
+
 	return res;
 }
 
@@ -153,6 +165,7 @@ static BufferView get_bufferview(const rapidjson::Value &object)
 struct ImporterContext
 {
 	ImporterApi               &api;
+	const MeshImportSettings  &mesh_settings;
 	const exo::Path           &main_path; // path of the gltf file
 	SubScene                  *new_scene;
 	const rapidjson::Document &j_document;
@@ -166,10 +179,8 @@ struct ImporterContext
 	Vec<AssetId>               material_ids;
 	Vec<AssetId>               mesh_ids;
 	Vec<AssetId>               texture_ids;
-
-	Vec<uint>   indices;
-	Vec<float4> positions;
-	Vec<float2> uvs;
+	Vec<Mesh *>                new_meshes;    // filled by the jobs of `import_meshes`
+	Vec<Material *>            new_materials; // filled by the jobs of `import_materials`
 
 	[[nodiscard]] exo::Path relative_to_absolute_path(exo::StringView relative_path_str) const
 	{
@@ -185,14 +196,28 @@ struct ImporterContext
 	}
 };
 
-static exo::Span<const u8> get_binary_data(
-	ImporterContext &ctx, const gltf::BufferView &view, const gltf::Accessor &accessor, usize i_element = 0)
+// Vertex data of the mesh being imported, each mesh is imported in its own job
+struct MeshGeometry
+{
+	Vec<uint>   indices;
+	Vec<float4> positions;
+	Vec<float2> uvs;
+};
 
+// Resolves `count` elements starting at `byte_offset` in a buffer view, the stride of the view is used when it has one
+static gltf::AccessorData get_accessor_data(ImporterContext &ctx,
+	u32                                                      i_bufferview,
+	u32                                                      byte_offset,
+	gltf::ComponentType                                      component_type,
+	u32                                                      nb_component,
+	u32                                                      count,
+	bool                                                     normalized)
 {
-	const usize byte_stride =
-		view.byte_stride > 0 ? view.byte_stride : gltf::size_of(accessor.component_type) * accessor.nb_component;
+	const auto &j_bufferviews = ctx.j_document["bufferViews"].GetArray();
+	const auto  view          = gltf::get_bufferview(j_bufferviews[i_bufferview]);
 
-	const usize offset = view.byte_offset + accessor.byte_offset + i_element * byte_stride;
+	const usize element_size = gltf::size_of(component_type) * nb_component;
+	const usize byte_stride  = view.byte_stride > 0 ? view.byte_stride : element_size;
 
 	const u8 *source = nullptr;
 	if (view.i_buffer == u32_invalid) {
@@ -200,10 +225,68 @@ static exo::Span<const u8> get_binary_data(
 	} else {
 		source = ctx.buffers[view.i_buffer].data();
 		ASSERT(ctx.buffers[view.i_buffer].len() >= view.byte_offset + view.byte_length);
-		ASSERT(offset < view.byte_offset + view.byte_length);
 	}
 	ASSERT(source != nullptr);
-	return exo::Span{exo::ptr_offset(source, offset), view.byte_length};
+	ASSERT(count == 0 || byte_offset + (count - 1) * byte_stride + element_size <= view.byte_length);
+
+	return gltf::AccessorData{
+		.data           = source + view.byte_offset + byte_offset,
+		.byte_stride    = byte_stride,
+		.count          = count,
+		.component_type = component_type,
+		.nb_component   = nb_component,
+		.normalized     = normalized,
+	};
+}
+
+// Decodes the `accessor.count` elements of an accessor to `dst` with `decode`, then applies its sparse values
+template <typename T, typename DecodeFn>
+static void decode_accessor(
+	ImporterContext &ctx, const gltf::Accessor &accessor, T default_value, T *dst, DecodeFn decode)
+{
+	if (accessor.bufferview_index != u32_invalid) {
+		decode(get_accessor_data(ctx,
+				   accessor.bufferview_index,
+				   accessor.byte_offset,
+				   accessor.component_type,
+				   accessor.nb_component,
+				   accessor.count,
+				   accessor.normalized),
+			dst);
+	} else {
+		std::fill(dst, dst + accessor.count, default_value);
+	}
+
+	const auto &sparse = accessor.sparse;
+	if (sparse.count == 0) {
+		return;
+	}
+
+	auto indices = Vec<u32>::with_length(sparse.count);
+	gltf::decode_indices(get_accessor_data(ctx,
+							 sparse.indices_bufferview,
+							 sparse.indices_byte_offset,
+							 sparse.indices_component_type,
+							 1,
+							 sparse.count,
+							 false),
+		0,
+		indices.data());
+
+	auto values = Vec<T>::with_length(sparse.count);
+	decode(get_accessor_data(ctx,
+			   sparse.values_bufferview,
+			   sparse.values_byte_offset,
+			   accessor.component_type,
+			   accessor.nb_component,
+			   sparse.count,
+			   accessor.normalized),
+		values.data());
+
+	for (u32 i_value = 0; i_value < sparse.count; i_value += 1) {
+		ASSERT(indices[i_value] < accessor.count);
+		dst[indices[i_value]] = values[i_value];
+	}
 }
 
 static void import_buffers(ImporterContext &ctx)
@@ -228,10 +311,425 @@ static void import_buffers(ImporterContext &ctx)
 	}
 }
 
+// -- Mesh optimization
+
+// Reorders the triangles of each submesh for the post-transform vertex cache and to reduce overdraw, then reorders
+// the vertices in the order they are fetched. Unreferenced vertices are dropped, submeshes stay contiguous.
+static void optimize_submeshes(MeshGeometry &geometry, Vec<SubMesh> &submeshes)
+{
+	EXO_PROFILE_SCOPE
+
+	auto positions = Vec<float4>::with_capacity(geometry.positions.len());
+	auto uvs       = Vec<float2>::with_capacity(geometry.uvs.len());
+	Vec<u32> remap;
+
+	for (usize i_submesh = 0; i_submesh < submeshes.len(); i_submesh += 1) {
+		auto &submesh = submeshes[i_submesh];
+
+		// The vertices of a submesh end where the next submesh's vertices begin, next submeshes are not remapped yet
+		const usize vertex_end   = i_submesh + 1 < submeshes.len() ? submeshes[i_submesh + 1].first_vertex
+		                                                           : geometry.positions.len();
+		const usize vertex_count = vertex_end - submesh.first_vertex;
+		const usize index_count  = submesh.index_count;
+		u32        *indices      = geometry.indices.data() + submesh.first_index;
+		if (vertex_count == 0) {
+			submesh.first_vertex = u32(positions.len());
+			continue;
+		}
+
+		for (usize i_index = 0; i_index < index_count; i_index += 1) {
+			indices[i_index] -= submesh.first_vertex;
+		}
+
+		meshopt_optimizeVertexCache(indices, indices, index_count, vertex_count);
+		meshopt_optimizeOverdraw(indices,
+			indices,
+			index_count,
+			&geometry.positions[submesh.first_vertex].x,
+			vertex_count,
+			sizeof(float4),
+			1.05f);
+
+		remap.resize(vertex_count);
+		const usize unique_vertices =
+			meshopt_optimizeVertexFetchRemap(remap.data(), indices, index_count, vertex_count);
+		meshopt_remapIndexBuffer(indices, indices, index_count, remap.data());
+
+		const u32 new_first_vertex = u32(positions.len());
+		positions.resize(new_first_vertex + unique_vertices);
+		uvs.resize(new_first_vertex + unique_vertices);
+		meshopt_remapVertexBuffer(positions.data() + new_first_vertex,
+			geometry.positions.data() + submesh.first_vertex,
+			vertex_count,
+			sizeof(float4),
+			remap.data());
+		meshopt_remapVertexBuffer(uvs.data() + new_first_vertex,
+			geometry.uvs.data() + submesh.first_vertex,
+			vertex_count,
+			sizeof(float2),
+			remap.data());
+
+		for (usize i_index = 0; i_index < index_count; i_index += 1) {
+			indices[i_index] += new_first_vertex;
+		}
+		submesh.first_vertex = new_first_vertex;
+	}
+
+	geometry.positions = std::move(positions);
+	geometry.uvs       = std::move(uvs);
+}
+
+// Splits each submesh in meshlets and writes the meshlet vertices and triangles blobs
+static void build_mesh_meshlets(ImporterContext &ctx, MeshGeometry &geometry, Mesh &mesh)
+{
+	EXO_PROFILE_SCOPE
+
+	MeshletData meshlet_data = {};
+	Vec<u32>    local_indices;
+	for (usize i_submesh = 0; i_submesh < mesh.submeshes.len(); i_submesh += 1) {
+		auto       &submesh      = mesh.submeshes[i_submesh];
+		const usize vertex_end   = i_submesh + 1 < mesh.submeshes.len() ? mesh.submeshes[i_submesh + 1].first_vertex
+		                                                                : geometry.positions.len();
+		const usize vertex_count = vertex_end - submesh.first_vertex;
+
+		submesh.first_meshlet = u32(meshlet_data.meshlets.len());
+		submesh.meshlet_count = 0;
+		if (vertex_count == 0 || submesh.index_count == 0) {
+			continue;
+		}
+
+		// Meshlets are built on the vertices of the submesh only, the vertex base makes them global again
+		local_indices.resize(submesh.index_count);
+		for (u32 i_index = 0; i_index < submesh.index_count; i_index += 1) {
+			local_indices[i_index] = geometry.indices[submesh.first_index + i_index] - submesh.first_vertex;
+		}
+
+		build_meshlets(exo::Span<const float4>(geometry.positions.data() + submesh.first_vertex, vertex_count),
+			local_indices,
+			submesh.first_vertex,
+			meshlet_data);
+		submesh.meshlet_count = u32(meshlet_data.meshlets.len()) - submesh.first_meshlet;
+	}
+
+	auto vertices_bytes              = exo::span_to_bytes<u32>(meshlet_data.vertices);
+	mesh.meshlet_vertices_hash       = ctx.api.save_blob(vertices_bytes);
+	mesh.meshlet_vertices_byte_size  = vertices_bytes.len();
+	auto triangles_bytes             = exo::span_to_bytes<u8>(meshlet_data.triangles);
+	mesh.meshlet_triangles_hash      = ctx.api.save_blob(triangles_bytes);
+	mesh.meshlet_triangles_byte_size = triangles_bytes.len();
+	mesh.meshlets                    = std::move(meshlet_data.meshlets);
+	mesh.meshlet_bounds              = std::move(meshlet_data.bounds);
+}
+
+// Builds the BVH of the LOD 0 triangles, the first `lod0_index_count` indices. It is built once the blobs are saved,
+// from the positions as they are stored in the mesh.
+static void build_mesh_bvh(ImporterContext &ctx, MeshGeometry &geometry, Mesh &mesh, usize lod0_index_count)
+{
+	EXO_PROFILE_SCOPE
+
+	const auto indices = exo::Span<const u32>(geometry.indices.data(), lod0_index_count);
+	const auto nodes   = build_bvh(ctx.api.manager.jobmanager, geometry.positions, indices);
+
+	auto nodes_bytes         = exo::span_to_bytes<const BVHNode>(nodes);
+	mesh.bvh_nodes_hash      = ctx.api.save_blob(nodes_bytes);
+	mesh.bvh_nodes_byte_size = nodes_bytes.len();
+	mesh.bvh_sah_cost        = compute_sah_cost(nodes);
+}
+
+// Simplifies each submesh into a chain of LODs, the simplified indices are appended to the index buffer
+static void generate_lods(ImporterContext &ctx, MeshGeometry &geometry, Mesh &mesh)
+{
+	EXO_PROFILE_SCOPE
+
+	const u32   max_lods      = std::min(ctx.mesh_settings.max_lods, MESH_MAX_LODS);
+	const usize submesh_count = mesh.submeshes.len();
+	if (max_lods <= 1 || submesh_count == 0) {
+		return;
+	}
+
+	// levels[i_lod * submesh_count + i_submesh]
+	Vec<MeshLod> levels;
+	Vec<float>   errors;
+	Vec<float>   error_scales;
+	for (const auto &submesh : mesh.submeshes) {
+		levels.push(MeshLod{.first_index = submesh.first_index, .index_count = submesh.index_count});
+	}
+	errors.push(0.0f);
+
+	for (usize i_submesh = 0; i_submesh < submesh_count; i_submesh += 1) {
+		const auto &submesh      = mesh.submeshes[i_submesh];
+		const usize vertex_end   = i_submesh + 1 < submesh_count ? mesh.submeshes[i_submesh + 1].first_vertex
+		                                                         : geometry.positions.len();
+		const usize vertex_count = vertex_end - submesh.first_vertex;
+		float       error_scale  = 0.0f;
+		if (vertex_count != 0) {
+			error_scale =
+				meshopt_simplifyScale(&geometry.positions[submesh.first_vertex].x, vertex_count, sizeof(float4));
+		}
+		error_scales.push(error_scale);
+	}
+
+	Vec<u32> local_indices;
+	Vec<u32> lod_indices;
+	for (u32 i_lod = 1; i_lod < max_lods; i_lod += 1) {
+		bool  reduced     = false;
+		float level_error = errors.last();
+		for (usize i_submesh = 0; i_submesh < submesh_count; i_submesh += 1) {
+			const auto   &submesh      = mesh.submeshes[i_submesh];
+			const MeshLod previous_lod = levels[(i_lod - 1) * submesh_count + i_submesh];
+			const usize   vertex_end   = i_submesh + 1 < submesh_count ? mesh.submeshes[i_submesh + 1].first_vertex
+			                                                           : geometry.positions.len();
+			const usize   vertex_count = vertex_end - submesh.first_vertex;
+			if (vertex_count == 0) {
+				levels.push(previous_lod);
+				continue;
+			}
+
+			// Every level is simplified from the full submesh to get its error relative to LOD 0
+			local_indices.resize(submesh.index_count);
+			for (u32 i_index = 0; i_index < submesh.index_count; i_index += 1) {
+				local_indices[i_index] = geometry.indices[submesh.first_index + i_index] - submesh.first_vertex;
+			}
+			lod_indices.resize(submesh.index_count);
+
+			const usize target_index_count = (usize(submesh.index_count >> i_lod) / 3) * 3;
+			float       lod_error          = 0.0f;
+			const usize index_count        = meshopt_simplify(lod_indices.data(),
+				local_indices.data(),
+				local_indices.len(),
+				&geometry.positions[submesh.first_vertex].x,
+				vertex_count,
+				sizeof(float4),
+				target_index_count,
+				ctx.mesh_settings.lod_max_error,
+				&lod_error);
+
+			// Submeshes that cannot be simplified further keep their previous level
+			if (index_count == 0 || index_count * 100 > previous_lod.index_count * 95) {
+				levels.push(previous_lod);
+				continue;
+			}
+
+			meshopt_optimizeVertexCache(lod_indices.data(), lod_indices.data(), index_count, vertex_count);
+
+			levels.push(MeshLod{.first_index = u32(geometry.indices.len()), .index_count = u32(index_count)});
+			for (usize i_index = 0; i_index < index_count; i_index += 1) {
+				geometry.indices.push(submesh.first_vertex + lod_indices[i_index]);
+			}
+			level_error = std::max(level_error, lod_error * error_scales[i_submesh]);
+			reduced     = true;
+		}
+
+		if (!reduced) {
+			levels.resize(levels.len() - submesh_count);
+			break;
+		}
+		errors.push(level_error);
+	}
+
+	if (errors.len() <= 1) {
+		return;
+	}
+
+	// Store the levels of each submesh contiguously
+	const usize lod_count = errors.len();
+	mesh.lods             = Vec<MeshLod>::with_length(lod_count * submesh_count);
+	for (usize i_lod = 0; i_lod < lod_count; i_lod += 1) {
+		for (usize i_submesh = 0; i_submesh < submesh_count; i_submesh += 1) {
+			mesh.lods[i_submesh * lod_count + i_lod] = levels[i_lod * submesh_count + i_submesh];
+		}
+	}
+	mesh.lod_errors = std::move(errors);
+}
+
+// Writes the vertex and index blobs in the smallest format allowed by the settings
+static void save_mesh_blobs(ImporterContext &ctx, MeshGeometry &geometry, Mesh &mesh)
+{
+	EXO_PROFILE_SCOPE
+
+	// -- Indices
+	if (geometry.positions.len() <= (1u << 16)) {
+		// The buffer is padded to 4 bytes to be usable as a storage buffer
+		auto indices = Vec<u16>::with_length(exo::round_up_to_alignment(2, geometry.indices.len()));
+		for (usize i_index = 0; i_index < geometry.indices.len(); i_index += 1) {
+			indices[i_index] = u16(geometry.indices[i_index]);
+		}
+		if (indices.len() > geometry.indices.len()) {
+			indices.last() = 0;
+		}
+
+		auto indices_bytes      = exo::span_to_bytes<u16>(indices);
+		mesh.indices_hash      = ctx.api.save_blob(indices_bytes);
+		mesh.indices_byte_size = indices_bytes.len();
+		mesh.indices_format    = IndexFormat::U16;
+	} else {
+		auto indices_bytes      = exo::span_to_bytes<uint>(geometry.indices);
+		mesh.indices_hash      = ctx.api.save_blob(indices_bytes);
+		mesh.indices_byte_size = indices_bytes.len();
+		mesh.indices_format    = IndexFormat::U32;
+	}
+
+	// -- Positions
+	if (ctx.mesh_settings.quantize_positions && !geometry.positions.is_empty()) {
+		float3 bounds_min = geometry.positions[0].xyz();
+		float3 bounds_max = geometry.positions[0].xyz();
+		for (const auto &position : geometry.positions) {
+			for (usize i_component = 0; i_component < 3; i_component += 1) {
+				bounds_min[i_component] = std::min(bounds_min[i_component], position[i_component]);
+				bounds_max[i_component] = std::max(bounds_max[i_component], position[i_component]);
+			}
+		}
+
+		// Positions are stored in [-1, 1] relative to the center of the bounds
+		float3 decode_offset = 0.5f * (bounds_min + bounds_max);
+		float3 decode_scale  = 0.5f * (bounds_max - bounds_min);
+		for (usize i_component = 0; i_component < 3; i_component += 1) {
+			if (decode_scale[i_component] <= 0.0f) {
+				decode_scale[i_component] = 1.0f;
+			}
+		}
+
+		auto quantized = Vec<i16>::with_length(4 * geometry.positions.len());
+		for (usize i_position = 0; i_position < geometry.positions.len(); i_position += 1) {
+			const float3 normalized = (geometry.positions[i_position].xyz() - decode_offset) / decode_scale;
+			for (usize i_component = 0; i_component < 3; i_component += 1) {
+				quantized[4 * i_position + i_component] = i16(meshopt_quantizeSnorm(normalized[i_component], 16));
+			}
+			quantized[4 * i_position + 3] = 0;
+		}
+
+		auto positions_bytes         = exo::span_to_bytes<i16>(quantized);
+		mesh.positions_hash          = ctx.api.save_blob(positions_bytes);
+		mesh.positions_byte_size     = positions_bytes.len();
+		mesh.positions_format        = PositionFormat::Snorm16x4;
+		mesh.positions_decode_scale  = decode_scale;
+		mesh.positions_decode_offset = decode_offset;
+
+		// The positions are replaced by the decoded ones, the BVH has to bound the triangles that will be rendered
+		for (usize i_position = 0; i_position < geometry.positions.len(); i_position += 1) {
+			for (usize i_component = 0; i_component < 3; i_component += 1) {
+				const float snorm = float(quantized[4 * i_position + i_component]) / 32767.0f;
+				geometry.positions[i_position][i_component] =
+					std::max(snorm, -1.0f) * decode_scale[i_component] + decode_offset[i_component];
+			}
+		}
+	} else {
+		auto positions_bytes     = exo::span_to_bytes<float4>(geometry.positions);
+		mesh.positions_hash      = ctx.api.save_blob(positions_bytes);
+		mesh.positions_byte_size = positions_bytes.len();
+		mesh.positions_format    = PositionFormat::Float32x4;
+	}
+
+	// -- UVs
+	if (ctx.mesh_settings.quantize_uvs) {
+		auto quantized = Vec<u16>::with_length(2 * geometry.uvs.len());
+		for (usize i_uv = 0; i_uv < geometry.uvs.len(); i_uv += 1) {
+			quantized[2 * i_uv + 0] = meshopt_quantizeHalf(geometry.uvs[i_uv].x);
+			quantized[2 * i_uv + 1] = meshopt_quantizeHalf(geometry.uvs[i_uv].y);
+		}
+
+		auto uvs_bytes     = exo::span_to_bytes<u16>(quantized);
+		mesh.uvs_hash      = ctx.api.save_blob(uvs_bytes);
+		mesh.uvs_byte_size = uvs_bytes.len();
+		mesh.uvs_format    = UvFormat::Float16x2;
+	} else {
+		auto uvs_bytes     = exo::span_to_bytes<float2>(geometry.uvs);
+		mesh.uvs_hash      = ctx.api.save_blob(uvs_bytes);
+		mesh.uvs_byte_size = uvs_bytes.len();
+		mesh.uvs_format    = UvFormat::Float32x2;
+	}
+}
+
+// Decodes the primitives of a mesh, then optimizes it and saves its blobs
+static void import_mesh(ImporterContext &ctx, u32 i_mesh)
+{
+	EXO_PROFILE_SCOPE
+
+	const auto &j_accessors = ctx.j_document["accessors"].GetArray();
+	const auto &j_mesh      = ctx.j_document["meshes"].GetArray()[i_mesh];
+	auto       *new_mesh    = ctx.new_meshes[i_mesh];
+
+	MeshGeometry geometry = {};
+	for (auto &j_primitive : j_mesh["primitives"].GetArray()) {
+		ASSERT(j_primitive.HasMember("attributes"));
+		const auto &j_attributes = j_primitive["attributes"].GetObj();
+		ASSERT(j_attributes.HasMember("POSITION"));
+
+		new_mesh->submeshes.push();
+		auto &new_submesh = new_mesh->submeshes.last();
+
+		new_submesh.index_count  = 0;
+		new_submesh.first_vertex = static_cast<u32>(geometry.positions.len());
+		new_submesh.first_index  = static_cast<u32>(geometry.indices.len());
+		new_submesh.material     = {};
+
+		// -- Attributes
+		ASSERT(j_primitive.HasMember("indices"));
+		{
+			auto accessor = gltf::get_accessor(j_accessors[j_primitive["indices"].GetUint()]);
+
+			const usize first_index = geometry.indices.len();
+			geometry.indices.resize(first_index + accessor.count);
+			const u32 vertex_base = new_submesh.first_vertex;
+			decode_accessor(ctx,
+				accessor,
+				vertex_base,
+				geometry.indices.data() + first_index,
+				[vertex_base](const gltf::AccessorData &src, u32 *dst) {
+					gltf::decode_indices(src, vertex_base, dst);
+				});
+
+			new_submesh.index_count = accessor.count;
+		}
+
+		usize vertex_count = 0;
+		{
+			auto accessor = gltf::get_accessor(j_accessors[j_attributes["POSITION"].GetUint()]);
+			vertex_count  = accessor.count;
+
+			const usize first_position = geometry.positions.len();
+			geometry.positions.resize(first_position + accessor.count);
+			decode_accessor(ctx,
+				accessor,
+				float4(0.0f, 0.0f, 0.0f, 1.0f),
+				geometry.positions.data() + first_position,
+				gltf::decode_positions);
+		}
+
+		const usize first_uv = geometry.uvs.len();
+		geometry.uvs.resize(first_uv + vertex_count);
+		if (j_attributes.HasMember("TEXCOORD_0")) {
+			auto accessor = gltf::get_accessor(j_accessors[j_attributes["TEXCOORD_0"].GetUint()]);
+			ASSERT(accessor.count == vertex_count);
+			decode_accessor(ctx, accessor, float2(0.0f), geometry.uvs.data() + first_uv, gltf::decode_uvs);
+		} else {
+			std::fill(geometry.uvs.begin() + first_uv, geometry.uvs.end(), float2(0.0f, 0.0f));
+		}
+
+		if (j_primitive.HasMember("material")) {
+			const u32 i_material = j_primitive["material"].GetUint();
+			new_submesh.material = ctx.material_ids[i_material];
+			new_mesh->add_dependency_checked(new_submesh.material);
+		}
+	}
+
+	if (ctx.mesh_settings.optimize) {
+		optimize_submeshes(geometry, new_mesh->submeshes);
+	}
+	if (ctx.mesh_settings.build_meshlets) {
+		build_mesh_meshlets(ctx, geometry, *new_mesh);
+	}
+	const usize lod0_index_count = geometry.indices.len();
+	generate_lods(ctx, geometry, *new_mesh);
+	save_mesh_blobs(ctx, geometry, *new_mesh);
+	if (ctx.mesh_settings.build_bvh) {
+		build_mesh_bvh(ctx, geometry, *new_mesh, lod0_index_count);
+	}
+}
+
 static void import_meshes(ImporterContext &ctx)
 {
-	const auto &j_accessors   = ctx.j_document["accessors"].GetArray();
-	const auto &j_bufferviews = ctx.j_document["bufferViews"].GetArray();
+	EXO_PROFILE_SCOPE
 
 	if (!ctx.j_document.HasMember("meshes")) {
 		return;
@@ -241,7 +739,8 @@ static void import_meshes(ImporterContext &ctx)
 
 	const auto &j_meshes = ctx.j_document["meshes"].GetArray();
 	ctx.mesh_ids.resize(j_meshes.Size());
-	// Generate new UUID for the meshes if needed
+	ctx.new_meshes.resize(j_meshes.Size());
+	// The meshes are named in order, so that unnamed meshes keep the same UUID when the file is imported again
 	for (u32 i_mesh = 0; i_mesh < j_meshes.Size(); i_mesh += 1) {
 		const auto &j_mesh = j_meshes[i_mesh];
 
@@ -252,137 +751,30 @@ static void import_meshes(ImporterContext &ctx)
 			mesh_name = exo::formatf(scope, "Mesh%u", ctx.i_unnamed_mesh);
 			ctx.i_unnamed_mesh += 1;
 		}
-		auto mesh_uuid       = ctx.create_id<Mesh>(mesh_name);
-		ctx.mesh_ids[i_mesh] = mesh_uuid;
-		auto *new_mesh       = ctx.api.create_asset<Mesh>(mesh_uuid);
-		ctx.positions.clear();
-		ctx.uvs.clear();
-		ctx.indices.clear();
+		auto mesh_uuid         = ctx.create_id<Mesh>(mesh_name);
+		ctx.mesh_ids[i_mesh]   = mesh_uuid;
+		ctx.new_meshes[i_mesh] = ctx.api.create_asset<Mesh>(mesh_uuid);
 
 		if (j_mesh.HasMember("name")) {
-			new_mesh->name = exo::tls_string_repository->intern(j_mesh["name"].GetString());
-		}
-
-		for (auto &j_primitive : j_mesh["primitives"].GetArray()) {
-			ASSERT(j_primitive.HasMember("attributes"));
-			const auto &j_attributes = j_primitive["attributes"].GetObj();
-			ASSERT(j_attributes.HasMember("POSITION"));
-
-			new_mesh->submeshes.push();
-			auto &new_submesh = new_mesh->submeshes.last();
-
-			new_submesh.index_count  = 0;
-			new_submesh.first_vertex = static_cast<u32>(ctx.positions.len());
-			new_submesh.first_index  = static_cast<u32>(ctx.indices.len());
-			new_submesh.material     = {};
-
-			// -- Attributes
-			ASSERT(j_primitive.HasMember("indices"));
-			{
-				auto j_accessor = j_accessors[j_primitive["indices"].GetUint()].GetObj();
-				auto accessor   = gltf::get_accessor(j_accessor);
-				auto bufferview = gltf::get_bufferview(j_bufferviews[accessor.bufferview_index]);
-
-				// Copy the data from the binary buffer
-				ctx.indices.reserve(accessor.count);
-				for (usize i_index = 0; i_index < usize(accessor.count); i_index += 1) {
-					u32 index = u32_invalid;
-					if (accessor.component_type == gltf::ComponentType::UnsignedShort) {
-						index =
-							new_submesh.first_vertex +
-							*reinterpret_cast<const u16 *>(get_binary_data(ctx, bufferview, accessor, i_index).data());
-					} else if (accessor.component_type == gltf::ComponentType::UnsignedInt) {
-						index =
-							new_submesh.first_vertex +
-							*reinterpret_cast<const u32 *>(get_binary_data(ctx, bufferview, accessor, i_index).data());
-					} else {
-						ASSERT(false);
-					}
-					ctx.indices.push(index);
-				}
-
-				new_submesh.index_count = accessor.count;
-			}
-
-			usize vertex_count = 0;
-			{
-				auto j_accessor = j_accessors[j_attributes["POSITION"].GetUint()].GetObj();
-				auto accessor   = gltf::get_accessor(j_accessor);
-				vertex_count    = accessor.count;
-				auto bufferview = gltf::get_bufferview(j_bufferviews[accessor.bufferview_index]);
-
-				// Copy the data from the binary buffer
-				ctx.positions.reserve(accessor.count);
-				for (usize i_position = 0; i_position < usize(accessor.count); i_position += 1) {
-					float4 new_position = {1.0f};
-
-					if (accessor.component_type == gltf::ComponentType::UnsignedShort) {
-						const auto *components = reinterpret_cast<const u16 *>(
-							get_binary_data(ctx, bufferview, accessor, i_position).data());
-						new_position = {float(components[0]), float(components[1]), float(components[2]), 1.0f};
-					} else if (accessor.component_type == gltf::ComponentType::Float) {
-						const auto *components = reinterpret_cast<const float *>(
-							get_binary_data(ctx, bufferview, accessor, i_position).data());
-						new_position = {float(components[0]), float(components[1]), float(components[2]), 1.0f};
-					} else {
-						ASSERT(false);
-					}
-
-					ctx.positions.push(new_position);
-				}
-			}
-
-			if (j_attributes.HasMember("TEXCOORD_0")) {
-				auto j_accessor = j_accessors[j_attributes["TEXCOORD_0"].GetUint()].GetObj();
-				auto accessor   = gltf::get_accessor(j_accessor);
-				ASSERT(accessor.count == vertex_count);
-				auto bufferview = gltf::get_bufferview(j_bufferviews[accessor.bufferview_index]);
-
-				// Copy the data from the binary buffer
-				ctx.uvs.reserve(accessor.count);
-				for (usize i_uv = 0; i_uv < usize(accessor.count); i_uv += 1) {
-					float2 new_uv = {1.0f};
-
-					if (accessor.component_type == gltf::ComponentType::UnsignedShort) {
-						const auto *components =
-							reinterpret_cast<const u16 *>(get_binary_data(ctx, bufferview, accessor, i_uv).data());
-						new_uv = {float(components[0]), float(components[1])};
-					} else if (accessor.component_type == gltf::ComponentType::Float) {
-						const auto *components =
-							reinterpret_cast<const float *>(get_binary_data(ctx, bufferview, accessor, i_uv).data());
-						new_uv = {float(components[0]), float(components[1])};
-					} else {
-						ASSERT(false);
-					}
-
-					ctx.uvs.push(new_uv);
-				}
-			} else {
-				ctx.uvs.reserve(vertex_count);
-				for (usize i = 0; i < vertex_count; i += 1) {
-					ctx.uvs.push(float2(0.0f, 0.0f));
-				}
-			}
-
-			if (j_primitive.HasMember("material")) {
-				const u32 i_material = j_primitive["material"].GetUint();
-				new_submesh.material = ctx.material_ids[i_material];
-				new_mesh->add_dependency_checked(new_submesh.material);
-			}
+			ctx.new_meshes[i_mesh]->name = exo::tls_string_repository->intern(j_mesh["name"].GetString());
 		}
+	}
 
-		auto positions_bytes          = exo::span_to_bytes<float4>(ctx.positions);
-		new_mesh->positions_hash      = ctx.api.save_blob(positions_bytes);
-		new_mesh->positions_byte_size = positions_bytes.len();
-
-		auto uvs_bytes          = exo::span_to_bytes<float2>(ctx.uvs);
-		new_mesh->uvs_hash      = ctx.api.save_blob(uvs_bytes);
-		new_mesh->uvs_byte_size = uvs_bytes.len();
-
-		auto indices_bytes          = exo::span_to_bytes<uint>(ctx.indices);
-		new_mesh->indices_hash      = ctx.api.save_blob(indices_bytes);
-		new_mesh->indices_byte_size = indices_bytes.len();
-
+	// Each mesh is decoded, optimized and saved in its own job. Waiting from the import job is fine, the waiting
+	// worker runs the queued jobs.
+	auto mesh_indices = Vec<u32>::with_length(j_meshes.Size());
+	for (u32 i_mesh = 0; i_mesh < j_meshes.Size(); i_mesh += 1) {
+		mesh_indices[i_mesh] = i_mesh;
+	}
+	auto w = cross::parallel_foreach_userdata<u32, ImporterContext, true>(
+		*ctx.api.manager.jobmanager,
+		mesh_indices,
+		&ctx,
+		[](u32 &i_mesh, ImporterContext *import_ctx) { import_mesh(*import_ctx, i_mesh); },
+		1);
+	w->wait();
+
+	for (const auto *new_mesh : ctx.new_meshes) {
 		ctx.new_scene->add_dependency_checked(new_mesh->uuid);
 	}
 }
@@ -499,9 +891,97 @@ static void import_nodes(ImporterContext &ctx)
 	}
 }
 
+// Reads the textures and factors of a material
+static void import_material(ImporterContext &ctx, u32 i_material)
+{
+	const auto &j_document   = ctx.j_document;
+	const auto &j_material   = j_document["materials"].GetArray()[i_material];
+	auto       *new_material = ctx.new_materials[i_material];
+
+	auto load_texture = [&](auto &json_object, const char *texture_name) -> u32 {
+		if (json_object.HasMember(texture_name)) {
+			const auto &j_texture_desc  = json_object[texture_name];
+			u32 const   i_texture_index = j_texture_desc["index"].GetUint();
+			const auto &j_texture       = j_document["textures"][i_texture_index];
+			u32         i_texture       = u32_invalid;
+
+			if (j_texture.HasMember("extensions")) {
+				for (const auto &j_extension : j_texture["extensions"].GetObj()) {
+					if (exo::StringView(j_extension.name.GetString()) == exo::StringView("KHR_texture_basisu")) {
+						i_texture = j_extension.value["source"].GetUint();
+						break;
+					}
+				}
+			}
+
+			if (i_texture == u32_invalid) {
+				i_texture = j_texture["source"].GetUint();
+			}
+
+			ASSERT(i_texture != u32_invalid);
+			return i_texture;
+		}
+		return u32_invalid;
+	};
+
+	if (auto i_normal_texture = load_texture(j_material, "normalTexture"); i_normal_texture != u32_invalid) {
+		new_material->normal_texture = ctx.texture_ids[i_normal_texture];
+		new_material->dependencies.push(new_material->normal_texture);
+	}
+
+	if (j_material.HasMember("pbrMetallicRoughness")) {
+		const auto &j_pbr = j_material["pbrMetallicRoughness"].GetObj();
+
+		if (auto i_base_color = load_texture(j_pbr, "baseColorTexture"); i_base_color != u32_invalid) {
+			new_material->base_color_texture = ctx.texture_ids[i_base_color];
+			new_material->dependencies.push(new_material->base_color_texture);
+
+// TODO: implement KHR_texture_transform
+#if 0
+			if (j_base_color_texture.HasMember("extensions") &&
+				j_base_color_texture["extensions"].HasMember("KHR_texture_transform")) {
+				const auto &extension = j_base_color_texture["extensions"]["KHR_texture_transform"];
+				if (extension.HasMember("offset")) {
+					new_material->uv_transform.offset[0] = extension["offset"].GetArray()[0].GetFloat();
+					new_material->uv_transform.offset[1] = extension["offset"].GetArray()[1].GetFloat();
+				}
+				if (extension.HasMember("scale")) {
+					new_material->uv_transform.scale[0] = extension["scale"].GetArray()[0].GetFloat();
+					new_material->uv_transform.scale[1] = extension["scale"].GetArray()[1].GetFloat();
+				}
+				if (extension.HasMember("rotation")) {
+					new_material->uv_transform.rotation = extension["rotation"].GetFloat();
+				}
+			}
+#endif
+		}
+
+		if (auto i_metallic_roughness = load_texture(j_pbr, "metallicRoughnessTexture");
+			i_metallic_roughness != u32_invalid) {
+			new_material->metallic_roughness_texture = ctx.texture_ids[i_metallic_roughness];
+			new_material->dependencies.push(new_material->metallic_roughness_texture);
+		}
+
+		if (j_pbr.HasMember("baseColorFactor")) {
+			new_material->base_color_factor = {1.0, 1.0, 1.0, 1.0};
+			for (u32 i = 0; i < 4; i += 1) {
+				new_material->base_color_factor[i] = j_pbr["baseColorFactor"].GetArray()[i].GetFloat();
+			}
+		}
+
+		if (j_pbr.HasMember("metallicFactor")) {
+			new_material->metallic_factor = j_pbr["metallicFactor"].GetFloat();
+		}
+
+		if (j_pbr.HasMember("roughnessFactor")) {
+			new_material->roughness_factor = j_pbr["roughnessFactor"].GetFloat();
+		}
+	}
+}
+
 static void import_materials(ImporterContext &ctx)
 {
-	const auto &j_document = ctx.j_document;
+	EXO_PROFILE_SCOPE
 
 	if (!ctx.j_document.HasMember("materials")) {
 		return;
@@ -510,6 +990,7 @@ static void import_materials(ImporterContext &ctx)
 	exo::ScopeStack scope;
 	const auto     &j_materials = ctx.j_document["materials"].GetArray();
 	ctx.material_ids.resize(j_materials.Size());
+	ctx.new_materials.resize(j_materials.Size());
 	for (u32 i_material = 0; i_material < j_materials.Size(); i_material += 1) {
 		const auto &j_material = j_materials[i_material];
 
@@ -520,94 +1001,26 @@ static void import_materials(ImporterContext &ctx)
 			material_name = exo::formatf(scope, "Material%u", ctx.i_unnamed_material);
 			ctx.i_unnamed_material += 1;
 		}
-		auto  material_uuid          = ctx.create_id<Material>(material_name);
-		auto *new_material           = ctx.api.create_asset<Material>(material_uuid);
-		ctx.material_ids[i_material] = material_uuid;
+		auto material_uuid            = ctx.create_id<Material>(material_name);
+		ctx.material_ids[i_material]  = material_uuid;
+		ctx.new_materials[i_material] = ctx.api.create_asset<Material>(material_uuid);
 
 		if (j_material.HasMember("name")) {
-			new_material->name = exo::tls_string_repository->intern(j_material["name"].GetString());
-		}
-
-		auto load_texture = [&](auto &json_object, const char *texture_name) -> u32 {
-			if (json_object.HasMember(texture_name)) {
-				const auto &j_texture_desc  = json_object[texture_name];
-				u32 const   i_texture_index = j_texture_desc["index"].GetUint();
-				const auto &j_texture       = j_document["textures"][i_texture_index];
-				u32         i_texture       = u32_invalid;
-
-				if (j_texture.HasMember("extensions")) {
-					for (const auto &j_extension : j_texture["extensions"].GetObj()) {
-						if (exo::StringView(j_extension.name.GetString()) == exo::StringView("KHR_texture_basisu")) {
-							i_texture = j_extension.value["source"].GetUint();
-							break;
-						}
-					}
-				}
-
-				if (i_texture == u32_invalid) {
-					i_texture = j_texture["source"].GetUint();
-				}
-
-				ASSERT(i_texture != u32_invalid);
-				return i_texture;
-			}
-			return u32_invalid;
-		};
-
-		if (auto i_normal_texture = load_texture(j_material, "normalTexture"); i_normal_texture != u32_invalid) {
-			new_material->normal_texture = ctx.texture_ids[i_normal_texture];
-			new_material->dependencies.push(new_material->normal_texture);
+			ctx.new_materials[i_material]->name = exo::tls_string_repository->intern(j_material["name"].GetString());
 		}
+	}
 
-		if (j_material.HasMember("pbrMetallicRoughness")) {
-			const auto &j_pbr = j_material["pbrMetallicRoughness"].GetObj();
-
-			if (auto i_base_color = load_texture(j_pbr, "baseColorTexture"); i_base_color != u32_invalid) {
-				new_material->base_color_texture = ctx.texture_ids[i_base_color];
-				new_material->dependencies.push(new_material->base_color_texture);
-
-// TODO: implement KHR_texture_transform
-#if 0
-				if (j_base_color_texture.HasMember("extensions") &&
-					j_base_color_texture["extensions"].HasMember("KHR_texture_transform")) {
-					const auto &extension = j_base_color_texture["extensions"]["KHR_texture_transform"];
-					if (extension.HasMember("offset")) {
-						new_material->uv_transform.offset[0] = extension["offset"].GetArray()[0].GetFloat();
-						new_material->uv_transform.offset[1] = extension["offset"].GetArray()[1].GetFloat();
-					}
-					if (extension.HasMember("scale")) {
-						new_material->uv_transform.scale[0] = extension["scale"].GetArray()[0].GetFloat();
-						new_material->uv_transform.scale[1] = extension["scale"].GetArray()[1].GetFloat();
-					}
-					if (extension.HasMember("rotation")) {
-						new_material->uv_transform.rotation = extension["rotation"].GetFloat();
-					}
-				}
-#endif
-			}
-
-			if (auto i_metallic_roughness = load_texture(j_pbr, "metallicRoughnessTexture");
-				i_metallic_roughness != u32_invalid) {
-				new_material->metallic_roughness_texture = ctx.texture_ids[i_metallic_roughness];
-				new_material->dependencies.push(new_material->metallic_roughness_texture);
-			}
-
-			if (j_pbr.HasMember("baseColorFactor")) {
-				new_material->base_color_factor = {1.0, 1.0, 1.0, 1.0};
-				for (u32 i = 0; i < 4; i += 1) {
-					new_material->base_color_factor[i] = j_pbr["baseColorFactor"].GetArray()[i].GetFloat();
-				}
-			}
-
-			if (j_pbr.HasMember("metallicFactor")) {
-				new_material->metallic_factor = j_pbr["metallicFactor"].GetFloat();
-			}
-
-			if (j_pbr.HasMember("roughnessFactor")) {
-				new_material->roughness_factor = j_pbr["roughnessFactor"].GetFloat();
-			}
-		}
+	auto material_indices = Vec<u32>::with_length(j_materials.Size());
+	for (u32 i_material = 0; i_material < j_materials.Size(); i_material += 1) {
+		material_indices[i_material] = i_material;
 	}
+	auto w = cross::parallel_foreach_userdata<u32, ImporterContext, true>(
+		*ctx.api.manager.jobmanager,
+		material_indices,
+		&ctx,
+		[](u32 &i_material, ImporterContext *import_ctx) { import_material(*import_ctx, i_material); },
+		16);
+	w->wait();
 }
 
 static void import_textures(ImporterContext &ctx)
@@ -639,6 +1052,20 @@ static void import_textures(ImporterContext &ctx)
 	}
 }
 
+u64 GLTFImporter::get_settings_hash() const
+{
+	const auto &settings = this->mesh_settings;
+	u64 hash = 0;
+	hash = exo::hash_combine(hash, settings.optimize);
+	hash = exo::hash_combine(hash, settings.quantize_positions);
+	hash = exo::hash_combine(hash, settings.quantize_uvs);
+	hash = exo::hash_combine(hash, settings.build_meshlets);
+	hash = exo::hash_combine(hash, settings.build_bvh);
+	hash = exo::hash_combine(hash, settings.max_lods);
+	hash = exo::hash_combine(hash, std::bit_cast<u32>(settings.lod_max_error));
+	return hash;
+}
+
 bool GLTFImporter::can_import_extension(exo::Span<const exo::StringView> extensions)
 {
 	for (const auto &extension : extensions) {
@@ -724,11 +1151,12 @@ Result<ProcessResponse> GLTFImporter::process_asset(const ProcessRequest &reques
 	auto *new_scene = request.importer_api.create_asset<SubScene>(request.asset);
 
 	ImporterContext ctx = {
-		.api        = request.importer_api,
-		.main_path  = request.path,
-		.new_scene  = new_scene,
-		.j_document = document,
-		.main_id    = request.asset,
+		.api           = request.importer_api,
+		.mesh_settings = this->mesh_settings,
+		.main_path     = request.path,
+		.new_scene     = new_scene,
+		.j_document    = document,
+		.main_id       = request.asset,
 	};
 
 	import_buffers(ctx);
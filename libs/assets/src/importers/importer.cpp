@@ -1 +1,11 @@
 #include "assets/importers/importer.h"
+
+#include "exo/hash.h"
+
+u64 get_import_key(const Importer &importer, u64 content_hash)
+{
+	u64 key = content_hash;
+	key = exo::hash_combine(key, importer.get_version());
+	key = exo::hash_combine(key, importer.get_settings_hash());
+	return key;
+}
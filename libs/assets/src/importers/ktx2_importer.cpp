@@ -1,14 +1,92 @@
 #include "assets/importers/ktx2_importer.h"
+#include "assets/asset_id.h"
 #include "assets/asset_manager.h"
 #include "assets/texture.h"
+#include "cross/mapped_file.h"
 #include "exo/macros/defer.h"
+#include "exo/maths/pointer.h"
+#include "exo/profile.h"
 #include <ktx.h>
-#include <rapidjson/document.h>
-#include <rapidjson/error/en.h>
-#include <rapidjson/filewritestream.h>
-#include <rapidjson/prettywriter.h>
 #include <volk.h>
 
+#include <atomic>
+#include <mutex>
+
+// Three-channel formats are rejected, the renderer has no matching image format
+static bool to_pixel_format(VkFormat vk_format, PixelFormat &out_format)
+{
+	switch (vk_format) {
+	case VK_FORMAT_R8_UNORM:
+		out_format = PixelFormat::R8_UNORM;
+		return true;
+	case VK_FORMAT_R8G8_UNORM:
+		out_format = PixelFormat::R8G8_UNORM;
+		return true;
+	case VK_FORMAT_R8G8B8A8_UNORM:
+		out_format = PixelFormat::R8G8B8A8_UNORM;
+		return true;
+	case VK_FORMAT_R8G8B8A8_SRGB:
+		out_format = PixelFormat::R8G8B8A8_SRGB;
+		return true;
+	case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+		out_format = PixelFormat::BC1_UNORM;
+		return true;
+	case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+	case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+		out_format = PixelFormat::BC1_SRGB;
+		return true;
+	case VK_FORMAT_BC3_UNORM_BLOCK:
+		out_format = PixelFormat::BC3_UNORM;
+		return true;
+	case VK_FORMAT_BC3_SRGB_BLOCK:
+		out_format = PixelFormat::BC3_SRGB;
+		return true;
+	case VK_FORMAT_BC4_UNORM_BLOCK:
+		out_format = PixelFormat::BC4_UNORM;
+		return true;
+	case VK_FORMAT_BC5_UNORM_BLOCK:
+		out_format = PixelFormat::BC5_UNORM;
+		return true;
+	case VK_FORMAT_BC7_UNORM_BLOCK:
+		out_format = PixelFormat::BC7_UNORM;
+		return true;
+	case VK_FORMAT_BC7_SRGB_BLOCK:
+		out_format = PixelFormat::BC7_SRGB;
+		return true;
+	default:
+		return false;
+	}
+}
+
+// Transcodes Basis ETC1S and UASTC textures to BC formats
+// https://github.com/KhronosGroup/3D-Formats-Guidelines/blob/main/KTXDeveloperGuide.md
+static KTX_error_code transcode_to_bc(ktxTexture2 *ktx_texture)
+{
+	EXO_PROFILE_SCOPE
+	ktx_transcode_fmt_e target_format = KTX_TTF_BC7_RGBA;
+
+	const u32 components_count = ktxTexture2_GetNumComponents(ktx_texture);
+	if (components_count == 1) {
+		target_format = KTX_TTF_BC4_R;
+	} else if (components_count == 2) {
+		target_format = KTX_TTF_BC5_RG;
+	}
+
+	// libktx initializes the transcoder tables during the first transcode without synchronization, importers run
+	// concurrently so the first transcode is done under a lock
+	static std::atomic<bool> is_transcoder_initialized = false;
+	if (!is_transcoder_initialized.load()) {
+		static std::mutex           init_mutex;
+		std::lock_guard             lock{init_mutex};
+		const KTX_error_code result = ktxTexture2_TranscodeBasis(ktx_texture, target_format, 0);
+		is_transcoder_initialized   = true;
+		return result;
+	}
+	return ktxTexture2_TranscodeBasis(ktx_texture, target_format, 0);
+}
+
+
 bool KTX2Importer::can_import_extension(exo::Span<const exo::StringView> extensions)
 {
 	for (const auto &extension : extensions) {
@@ -27,68 +105,84 @@ bool KTX2Importer::can_import_blob(exo::Span<const u8> blob)
 	return std::memcmp(blob.data(), signature, sizeof(signature)) == 0;
 }
 
-Result<CreateResponse> KTX2Importer::create_asset(const CreateRequest & /*request*/) { return Ok(CreateResponse{}); }
-
-Result<ProcessResponse> KTX2Importer::process_asset(const ProcessRequest & /*request*/)
+Result<CreateResponse> KTX2Importer::create_asset(const CreateRequest &request)
 {
-	return Ok(ProcessResponse{});
+	CreateResponse response{};
+	if (request.asset.is_valid()) {
+		response.new_id = request.asset;
+	} else {
+		response.new_id = AssetId::create<Texture>(request.path.filename());
+	}
+
+	return Ok(std::move(response));
 }
 
-#if 0
-Result<Asset *> KTX2Importer::import(ImporterApi &api, exo::UUID resource_uuid, exo::Span<u8 const> blob)
+Result<ProcessResponse> KTX2Importer::process_asset(const ProcessRequest &request)
 {
+	ASSERT(request.asset.is_valid());
+
+	auto file = cross::MappedFile::open(request.path.view()).value();
+	auto blob = file.content();
+
+	// Zstd supercompressed levels are inflated when the image data is loaded
 	ktxTexture2 *ktx_texture = nullptr;
 	auto         result =
 		ktxTexture2_CreateFromMemory(blob.data(), blob.len(), KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &ktx_texture);
 	if (result != KTX_SUCCESS) {
 		return Err<Asset *>(KTX2Errors::CreateFailed);
 	}
+	DEFER { ktxTexture_Destroy(ktxTexture(ktx_texture)); };
 
-	auto *new_texture = new Texture();
-	new_texture->uuid = resource_uuid;
+	if (ktx_texture->numLayers != 1 || ktx_texture->numFaces != 1 || ktx_texture->baseDepth != 1) {
+		return Err<Asset *>(KTX2Errors::UnsupportedLayout);
+	}
 
-	// https://github.com/KhronosGroup/3D-Formats-Guidelines/blob/main/KTXDeveloperGuide.md
 	if (ktxTexture2_NeedsTranscoding(ktx_texture)) {
-		ktx_transcode_fmt_e target_format = KTX_TTF_BC7_RGBA;
-
-		u32 nb_components = ktxTexture2_GetNumComponents(ktx_texture);
-		if (ktx_texture->supercompressionScheme == KTX_SS_BASIS_LZ) {
-			if (nb_components == 1) {
-				target_format = KTX_TTF_BC4_R;
-			} else if (nb_components == 2) {
-				target_format = KTX_TTF_BC5_RG;
-			}
-		}
-
-		result = ktxTexture2_TranscodeBasis(ktx_texture, target_format, 0);
+		result = transcode_to_bc(ktx_texture);
 		if (result != KTX_SUCCESS) {
-			ktxTexture_Destroy(reinterpret_cast<ktxTexture *>(ktx_texture));
-			ktx_texture = nullptr;
 			return Err<Asset *>(KTX2Errors::TranscodeFailed);
 		}
 	}
 
-	new_texture->impl_data = ktx_texture;
-	new_texture->format    = from_vk(static_cast<VkFormat>(ktx_texture->vkFormat));
-	new_texture->extension = ImageExtension::KTX2;
-	new_texture->width     = static_cast<int>(ktx_texture->baseWidth);
-	new_texture->height    = static_cast<int>(ktx_texture->baseHeight);
-	new_texture->depth     = static_cast<int>(ktx_texture->baseDepth);
-	new_texture->levels    = static_cast<int>(ktx_texture->numLevels);
-
-	for (int i = 0; i < new_texture->levels; i += 1) {
-		new_texture->mip_offsets.push_back(0);
-		result = ktxTexture_GetImageOffset(reinterpret_cast<ktxTexture *>(ktx_texture),
-			i,
-			0,
-			0,
-			&new_texture->mip_offsets.last());
+	auto pixel_format = PixelFormat::R8G8B8A8_UNORM;
+	if (!to_pixel_format(static_cast<VkFormat>(ktx_texture->vkFormat), pixel_format)) {
+		return Err<Asset *>(KTX2Errors::UnsupportedFormat);
+	}
+
+	// KTX2 stores the smallest level first, the blob starts with the largest level like the other texture importers.
+	// Each level starts on a 4 bytes boundary for buffer to image copies.
+	Vec<usize> mip_offsets;
+	usize      pixels_data_size = 0;
+	for (u32 i_level = 0; i_level < ktx_texture->numLevels; i_level += 1) {
+		pixels_data_size = exo::round_up_to_alignment(4, pixels_data_size);
+		mip_offsets.push(pixels_data_size);
+		pixels_data_size += ktxTexture_GetImageSize(ktxTexture(ktx_texture), i_level);
+	}
+
+	auto pixels = Vec<u8>::with_length(pixels_data_size);
+	for (u32 i_level = 0; i_level < ktx_texture->numLevels; i_level += 1) {
+		ktx_size_t level_offset = 0;
+		result = ktxTexture_GetImageOffset(ktxTexture(ktx_texture), i_level, 0, 0, &level_offset);
 		ASSERT(result == KTX_SUCCESS);
+
+		const usize level_size = ktxTexture_GetImageSize(ktxTexture(ktx_texture), i_level);
+		std::memcpy(pixels.data() + mip_offsets[i_level], ktx_texture->pData + level_offset, level_size);
 	}
 
-	new_texture->pixels_data = ktx_texture->pData;
-	new_texture->data_size   = ktx_texture->dataSize;
+	auto  asset_id                = request.asset;
+	auto *new_texture             = request.importer_api.create_asset<Texture>(request.asset);
+	new_texture->name             = request.asset.name;
+	new_texture->extension        = ImageExtension::KTX2;
+	new_texture->width            = static_cast<int>(ktx_texture->baseWidth);
+	new_texture->height           = static_cast<int>(ktx_texture->baseHeight);
+	new_texture->depth            = static_cast<int>(ktx_texture->baseDepth);
+	new_texture->levels           = static_cast<int>(ktx_texture->numLevels);
+	new_texture->format           = pixel_format;
+	new_texture->mip_offsets      = std::move(mip_offsets);
+	new_texture->pixels_data_size = pixels.len();
+	new_texture->pixels_hash      = request.importer_api.save_blob(pixels);
 
-	return Ok<Asset *>(new_texture);
+	Vec<AssetId> products;
+	products.push(std::move(asset_id));
+	return Ok(ProcessResponse{.products = std::move(products)});
 }
-#endif
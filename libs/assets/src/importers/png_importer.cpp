@@ -1,12 +1,94 @@
 #include "assets/importers/png_importer.h"
 #include "assets/asset_id.h"
 #include "exo/macros/defer.h"
+#include "exo/hash.h"
 #include "exo/profile.h"
 #include "cross/mapped_file.h"
 #include "assets/asset_manager.h"
+#include "assets/image_ops.h"
 #include "assets/texture.h"
 #include <spng.h>
 
+#include <algorithm>
+#include <bit>
+
+// Tangent space normal maps decode to unit vectors pointing out of the surface
+static bool looks_like_normal_map(exo::Span<const u8> rgba_pixels)
+{
+	const usize texel_count  = rgba_pixels.len() / 4;
+	usize       normal_count = 0;
+	for (usize i_texel = 0; i_texel < texel_count; i_texel += 1) {
+		const float x         = float(rgba_pixels[4 * i_texel + 0]) / 127.5f - 1.0f;
+		const float y         = float(rgba_pixels[4 * i_texel + 1]) / 127.5f - 1.0f;
+		const float z         = float(rgba_pixels[4 * i_texel + 2]) / 127.5f - 1.0f;
+		const float length_sq = x * x + y * y + z * z;
+		if (z > 0.0f && 0.8f < length_sq && length_sq < 1.2f) {
+			normal_count += 1;
+		}
+	}
+	return 100 * normal_count >= 95 * texel_count;
+}
+
+static bool has_transparent_texels(exo::Span<const u8> rgba_pixels)
+{
+	for (usize i_texel = 0; i_texel < rgba_pixels.len() / 4; i_texel += 1) {
+		if (rgba_pixels[4 * i_texel + 3] != 255) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// Compresses each level of the chain, `mip_offsets` is updated with the offsets of the compressed levels
+static Vec<u8> compress_mip_chain(const cross::JobManager *jobmanager,
+	exo::Span<const u8>                               mip_chain,
+	Vec<usize>                                       &mip_offsets,
+	u32                                               width,
+	u32                                               height,
+	u32                                               channels,
+	PixelFormat                                       format,
+	const BlockCompressionSettings                   &settings)
+{
+	EXO_PROFILE_SCOPE
+	Vec<usize> compressed_offsets;
+	usize      compressed_size = 0;
+	for (u32 i_level = 0; i_level < mip_offsets.len(); i_level += 1) {
+		compressed_offsets.push(compressed_size);
+		compressed_size += get_compressed_size(format, std::max(1u, width >> i_level), std::max(1u, height >> i_level));
+	}
+
+	auto compressed = Vec<u8>::with_length(compressed_size);
+	for (u32 i_level = 0; i_level < mip_offsets.len(); i_level += 1) {
+		const u32 level_width  = std::max(1u, width >> i_level);
+		const u32 level_height = std::max(1u, height >> i_level);
+
+		const auto level_pixels =
+			exo::Span<const u8>(mip_chain.data() + mip_offsets[i_level], usize(level_width) * level_height * channels);
+		const auto level_blocks = exo::Span<u8>(compressed.data() + compressed_offsets[i_level],
+			get_compressed_size(format, level_width, level_height));
+
+		compress_blocks(jobmanager, level_pixels, level_width, level_height, channels, format, level_blocks, settings);
+	}
+
+	mip_offsets = std::move(compressed_offsets);
+	return compressed;
+}
+
+u64 PNGImporter::get_settings_hash() const
+{
+	const auto &settings = this->texture_settings;
+	u64 hash = 0;
+	hash = exo::hash_combine(hash, settings.generate_mips);
+	hash = exo::hash_combine(hash, settings.compress);
+	hash = exo::hash_combine(hash, settings.prefer_bc7);
+	hash = exo::hash_combine(hash, settings.mip_settings.srgb);
+	hash = exo::hash_combine(hash, settings.mip_settings.preserve_alpha_coverage);
+	hash = exo::hash_combine(hash, std::bit_cast<u32>(settings.mip_settings.alpha_cutoff));
+	hash = exo::hash_combine(hash, u64(settings.compression_settings.bc7_quality));
+	// `blocks_per_job` only changes how the work is split
+	return hash;
+}
+
 bool PNGImporter::can_import_extension(exo::Span<const exo::StringView> extensions)
 {
 	for (const auto &extension : extensions) {
@@ -54,6 +136,7 @@ Result<ProcessResponse> PNGImporter::process_asset(const ProcessRequest &request
 		return Err<Asset *>(PNGErrors::IhdrNotFound);
 	}
 
+	// Images are decoded in their own format, palettes are expanded to RGB
 	int fmt = SPNG_FMT_PNG;
 	if (ihdr.color_type == SPNG_COLOR_TYPE_INDEXED) {
 		fmt = SPNG_FMT_RGB8;
@@ -68,61 +151,106 @@ Result<ProcessResponse> PNGImporter::process_asset(const ProcessRequest &request
 	ASSERT(((decoded_size / ihdr.width) % ihdr.height) == 0);
 	const usize bytes_per_pixel = (decoded_size / usize(ihdr.width)) / usize(ihdr.height);
 
-	// dont support 16 bits for now
-	ASSERT(ihdr.bit_depth == 8);
+	// Bit depths below 8 are not supported
+	const u32 bit_depth = fmt == SPNG_FMT_RGB8 ? 8 : u32(ihdr.bit_depth);
+	ASSERT(bit_depth == 8 || bit_depth == 16);
+	const u32 channel_count = u32(bytes_per_pixel / (bit_depth / 8));
+	ASSERT(1 <= channel_count && channel_count <= 4);
 
-	ASSERT(((8 * bytes_per_pixel) % ihdr.bit_depth) == 0);
-	const u32 channel_count = u32((8 * bytes_per_pixel) / u32(ihdr.bit_depth));
-	auto      pixel_format  = PixelFormat::R8G8B8A8_UNORM;
-	switch (channel_count) {
-	case 1: {
-		pixel_format = PixelFormat::R8_UNORM;
-		break;
+	u8 *buffer = reinterpret_cast<u8 *>(malloc(decoded_size));
+	EXO_PROFILE_MALLOC(buffer, decoded_size);
+	DEFER
+	{
+		EXO_PROFILE_MFREE(buffer);
+		free(buffer);
+	};
+	if (spng_decode_image(ctx, buffer, decoded_size, fmt, 0)) {
+		return Err<Asset *>(PNGErrors::CannotDecodeSize);
+	}
+
+	// 16 bits channels are dithered to 8 bits, RGB is expanded to RGBA (there is no R8G8B8_UNORM)
+	const usize texel_count    = usize(ihdr.width) * ihdr.height;
+	auto        decoded_pixels = exo::Span<const u8>(buffer, decoded_size);
+	Vec<u8>     pixels_8bits;
+	if (bit_depth == 16) {
+		pixels_8bits = Vec<u8>::with_length(texel_count * channel_count);
+		convert_16_to_8_bits(exo::Span<const u16>(reinterpret_cast<const u16 *>(buffer), texel_count * channel_count),
+			pixels_8bits,
+			ihdr.width,
+			ihdr.height,
+			channel_count,
+			true);
+		decoded_pixels = pixels_8bits;
 	}
-	case 2: {
+	Vec<u8> pixels_rgba;
+	if (channel_count == 3) {
+		pixels_rgba = Vec<u8>::with_length(texel_count * 4);
+		expand_rgb_to_rgba(decoded_pixels, pixels_rgba);
+		decoded_pixels = pixels_rgba;
+	}
+
+	const u32 decoded_channel_count = channel_count == 3 ? 4 : channel_count;
+	auto      pixel_format          = PixelFormat::R8G8B8A8_UNORM;
+	if (decoded_channel_count == 1) {
+		pixel_format = PixelFormat::R8_UNORM;
+	} else if (decoded_channel_count == 2) {
 		pixel_format = PixelFormat::R8G8_UNORM;
-		break;
 	}
-	case 3: {
-		// dont use R8G8B8_UNORM
-		fmt          = SPNG_FMT_RGBA8;
-		pixel_format = PixelFormat::R8G8B8A8_UNORM;
 
-		if (spng_decoded_image_size(ctx, fmt, &decoded_size)) {
-			return Err<Asset *>(PNGErrors::CannotDecodeSize);
-		}
-		break;
+	// Normal maps are not colors, they are filtered linearly and stored in two channels
+	auto mip_settings = this->texture_settings.mip_settings;
+	auto usage        = mip_settings.srgb ? TextureUsage::Color : TextureUsage::Linear;
+	if (decoded_channel_count == 4 && looks_like_normal_map(decoded_pixels)) {
+		usage                                = TextureUsage::Normal;
+		mip_settings.srgb                    = false;
+		mip_settings.preserve_alpha_coverage = false;
 	}
-	case 4: {
-		pixel_format = PixelFormat::R8G8B8A8_UNORM;
-		break;
+	// The color channels were filtered in linear space, they are sampled through an sRGB format
+	if (decoded_channel_count == 4 && usage == TextureUsage::Color) {
+		pixel_format = PixelFormat::R8G8B8A8_SRGB;
 	}
-	default:
-		ASSERT(false);
+
+	Vec<usize> mip_offsets;
+	Vec<u8>    mip_chain;
+	if (this->texture_settings.generate_mips) {
+		mip_chain = generate_mip_chain(decoded_pixels,
+			ihdr.width,
+			ihdr.height,
+			decoded_channel_count,
+			mip_settings,
+			mip_offsets);
+	} else {
+		mip_offsets.push(0u);
+		mip_chain = Vec<u8>::with_length(decoded_pixels.len());
+		std::memcpy(mip_chain.data(), decoded_pixels.data(), decoded_pixels.len());
 	}
 
-	u8 *buffer = reinterpret_cast<u8 *>(malloc(decoded_size));
-	EXO_PROFILE_MALLOC(buffer, decoded_size);
-	if (spng_decode_image(ctx, buffer, decoded_size, fmt, 0)) {
-		return Err<Asset *>(PNGErrors::CannotDecodeSize);
+	if (this->texture_settings.compress) {
+		const bool has_alpha = channel_count == 4 && has_transparent_texels(decoded_pixels);
+		pixel_format =
+			choose_block_format(usage, decoded_channel_count, has_alpha, this->texture_settings.prefer_bc7);
+		mip_chain = compress_mip_chain(request.importer_api.manager.jobmanager,
+			mip_chain,
+			mip_offsets,
+			ihdr.width,
+			ihdr.height,
+			decoded_channel_count,
+			pixel_format,
+			this->texture_settings.compression_settings);
 	}
 
-	auto  asset_id         = request.asset;
-	auto *new_texture      = request.importer_api.create_asset<Texture>(request.asset);
-	new_texture->name      = request.asset.name;
-	new_texture->extension = ImageExtension::PNG;
-	new_texture->width     = static_cast<int>(ihdr.width);
-	new_texture->height    = static_cast<int>(ihdr.height);
-	new_texture->depth     = 1;
-	new_texture->levels    = 1;
-	new_texture->format    = pixel_format;
-	new_texture->mip_offsets.push(0u);
-	new_texture->pixels_data_size = decoded_size;
-	new_texture->pixels_hash      = request.importer_api.save_blob(exo::Span(buffer, decoded_size));
-	new_texture->pixels_data_size = decoded_size;
-
-	EXO_PROFILE_MFREE(buffer);
-	free(buffer);
+	auto  asset_id                = request.asset;
+	auto *new_texture             = request.importer_api.create_asset<Texture>(request.asset);
+	new_texture->name             = request.asset.name;
+	new_texture->extension        = ImageExtension::PNG;
+	new_texture->width            = static_cast<int>(ihdr.width);
+	new_texture->height           = static_cast<int>(ihdr.height);
+	new_texture->depth            = 1;
+	new_texture->levels           = static_cast<int>(mip_offsets.len());
+	new_texture->format           = pixel_format;
+	new_texture->mip_offsets      = std::move(mip_offsets);
+	new_texture->pixels_data_size = mip_chain.len();
+	new_texture->pixels_hash      = request.importer_api.save_blob(mip_chain);
 
 	Vec<AssetId> products;
 	products.push(std::move(asset_id));
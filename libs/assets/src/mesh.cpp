@@ -1,23 +1,117 @@
 #include "assets/mesh.h"
 
+#include "exo/macros/assert.h"
 #include "exo/serialization/serializer.h"
 #include "exo/serialization/u128_serializer.h"
 #include "exo/serialization/uuid_serializer.h"
 
+namespace exo
+{
+void serialize(Serializer &serializer, IndexFormat &data)
+{
+	auto value = static_cast<std::underlying_type_t<IndexFormat>>(data);
+	serialize(serializer, value);
+	if (serializer.is_writing == false) {
+		data = static_cast<IndexFormat>(value);
+	}
+}
+
+void serialize(Serializer &serializer, PositionFormat &data)
+{
+	auto value = static_cast<std::underlying_type_t<PositionFormat>>(data);
+	serialize(serializer, value);
+	if (serializer.is_writing == false) {
+		data = static_cast<PositionFormat>(value);
+	}
+}
+
+void serialize(Serializer &serializer, UvFormat &data)
+{
+	auto value = static_cast<std::underlying_type_t<UvFormat>>(data);
+	serialize(serializer, value);
+	if (serializer.is_writing == false) {
+		data = static_cast<UvFormat>(value);
+	}
+}
+} // namespace exo
+
 void Mesh::serialize(exo::Serializer &serializer)
 {
 	Asset::serialize(serializer);
 
 	exo::serialize(serializer, this->indices_hash);
 	exo::serialize(serializer, this->indices_byte_size);
+	exo::serialize(serializer, this->indices_format);
 
 	exo::serialize(serializer, this->positions_hash);
 	exo::serialize(serializer, this->positions_byte_size);
+	exo::serialize(serializer, this->positions_format);
+	exo::serialize(serializer, this->positions_decode_scale);
+	exo::serialize(serializer, this->positions_decode_offset);
 
 	exo::serialize(serializer, this->uvs_hash);
 	exo::serialize(serializer, this->uvs_byte_size);
+	exo::serialize(serializer, this->uvs_format);
 
 	exo::serialize(serializer, this->submeshes);
+
+	exo::serialize(serializer, this->meshlet_vertices_hash);
+	exo::serialize(serializer, this->meshlet_vertices_byte_size);
+	exo::serialize(serializer, this->meshlet_triangles_hash);
+	exo::serialize(serializer, this->meshlet_triangles_byte_size);
+	exo::serialize(serializer, this->meshlets);
+	exo::serialize(serializer, this->meshlet_bounds);
+
+	exo::serialize(serializer, this->bvh_nodes_hash);
+	exo::serialize(serializer, this->bvh_nodes_byte_size);
+	exo::serialize(serializer, this->bvh_sah_cost);
+
+	exo::serialize(serializer, this->lod_errors);
+	exo::serialize(serializer, this->lods);
+}
+
+void Mesh::collect_blobs(Vec<exo::u128> &out_blobs) const
+{
+	out_blobs.push(this->indices_hash);
+	out_blobs.push(this->positions_hash);
+	out_blobs.push(this->uvs_hash);
+	if (!this->meshlets.is_empty()) {
+		out_blobs.push(this->meshlet_vertices_hash);
+		out_blobs.push(this->meshlet_triangles_hash);
+	}
+	if (this->bvh_nodes_byte_size != 0) {
+		out_blobs.push(this->bvh_nodes_hash);
+	}
+}
+
+u32 Mesh::select_lod(float max_error) const
+{
+	u32 lod = 0;
+	for (u32 i_lod = 1; i_lod < this->lod_errors.len(); i_lod += 1) {
+		if (this->lod_errors[i_lod] > max_error) {
+			break;
+		}
+		lod = i_lod;
+	}
+	return lod;
+}
+
+MeshLod Mesh::get_submesh_lod(u32 i_submesh, u32 lod) const
+{
+	const auto &submesh = this->submeshes[i_submesh];
+	if (this->lod_errors.is_empty()) {
+		return MeshLod{.first_index = submesh.first_index, .index_count = submesh.index_count};
+	}
+
+	const u32 lod_count = this->get_lod_count();
+	ASSERT(lod < lod_count);
+	return this->lods[i_submesh * lod_count + lod];
+}
+
+void serialize(exo::Serializer &serializer, MeshLod &data)
+{
+	exo::serialize(serializer, data.first_index);
+	exo::serialize(serializer, data.index_count);
 }
 
 void serialize(exo::Serializer &serializer, SubMesh &data)
@@ -25,5 +119,7 @@ void serialize(exo::Serializer &serializer, SubMesh &data)
 	exo::serialize(serializer, data.first_index);
 	exo::serialize(serializer, data.first_vertex);
 	exo::serialize(serializer, data.index_count);
+	exo::serialize(serializer, data.first_meshlet);
+	exo::serialize(serializer, data.meshlet_count);
 	exo::serialize(serializer, data.material);
 }
@@ -0,0 +1,165 @@
+#include "assets/meshlet.h"
+
+#include "exo/macros/assert.h"
+#include "exo/profile.h"
+#include "exo/serialization/serializer.h"
+
+#include <meshoptimizer.h>
+
+void build_meshlets(
+	exo::Span<const float4> positions, exo::Span<const u32> indices, u32 vertex_base, MeshletData &out_data)
+{
+	EXO_PROFILE_SCOPE
+	ASSERT(indices.len() % 3 == 0);
+	if (indices.empty()) {
+		return;
+	}
+
+	const usize max_meshlets = meshopt_buildMeshletsBound(indices.len(), MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES);
+	auto        meshlets     = Vec<meshopt_Meshlet>::with_length(max_meshlets);
+	auto        vertices     = Vec<u32>::with_length(max_meshlets * MESHLET_MAX_VERTICES);
+	auto        triangles    = Vec<u8>::with_length(max_meshlets * MESHLET_MAX_TRIANGLES * 3);
+
+	const usize meshlets_count = meshopt_buildMeshlets(meshlets.data(),
+		vertices.data(),
+		triangles.data(),
+		indices.data(),
+		indices.len(),
+		&positions[0].x,
+		positions.len(),
+		sizeof(float4),
+		MESHLET_MAX_VERTICES,
+		MESHLET_MAX_TRIANGLES,
+		MESHLET_CONE_WEIGHT);
+
+	for (usize i_meshlet = 0; i_meshlet < meshlets_count; i_meshlet += 1) {
+		const auto &src = meshlets[i_meshlet];
+
+		const auto bounds = meshopt_computeMeshletBounds(&vertices[src.vertex_offset],
+			&triangles[src.triangle_offset],
+			src.triangle_count,
+			&positions[0].x,
+			positions.len(),
+			sizeof(float4));
+
+		auto &meshlet           = out_data.meshlets.push();
+		meshlet.vertex_offset   = u32(out_data.vertices.len());
+		meshlet.triangle_offset = u32(out_data.triangles.len());
+		meshlet.vertex_count    = src.vertex_count;
+		meshlet.triangle_count  = src.triangle_count;
+
+		auto &meshlet_bounds       = out_data.bounds.push();
+		meshlet_bounds.center      = float3(bounds.center[0], bounds.center[1], bounds.center[2]);
+		meshlet_bounds.radius      = bounds.radius;
+		meshlet_bounds.cone_axis   = float3(bounds.cone_axis[0], bounds.cone_axis[1], bounds.cone_axis[2]);
+		meshlet_bounds.cone_cutoff = bounds.cone_cutoff;
+
+		for (u32 i_vertex = 0; i_vertex < src.vertex_count; i_vertex += 1) {
+			out_data.vertices.push(vertex_base + vertices[src.vertex_offset + i_vertex]);
+		}
+
+		// Triangles are padded so that each meshlet starts on a 4 bytes boundary
+		const u32 triangles_size = src.triangle_count * 3;
+		for (u32 i_byte = 0; i_byte < ((triangles_size + 3) & ~3u); i_byte += 1) {
+			out_data.triangles.push(i_byte < triangles_size ? triangles[src.triangle_offset + i_byte] : u8(0));
+		}
+	}
+}
+
+// -- Culling
+
+static float4 get_row(const float4x4 &m, usize i_row)
+{
+	return float4(m.at(i_row, 0), m.at(i_row, 1), m.at(i_row, 2), m.at(i_row, 3));
+}
+
+MeshletCullingView MeshletCullingView::create(
+	const float4x4 &world_transform, const float4x4 &view, const float4x4 &projection, float3 camera_position)
+{
+	MeshletCullingView result = {};
+
+	// Planes are extracted from the rows of the object to clip matrix (Gribb-Hartmann), Vulkan clip space is
+	// -w <= x <= w, -w <= y <= w, 0 <= z <= w
+	const float4x4 object_to_clip = projection * view * world_transform;
+	const float4   rows[4]        = {
+		get_row(object_to_clip, 0),
+		get_row(object_to_clip, 1),
+		get_row(object_to_clip, 2),
+		get_row(object_to_clip, 3),
+	};
+
+	const float4 planes[6] = {
+		rows[3] + rows[0],
+		rows[3] - rows[0],
+		rows[3] + rows[1],
+		rows[3] - rows[1],
+		rows[2],
+		rows[3] - rows[2],
+	};
+
+	for (const auto &plane : planes) {
+		// The far plane of an infinite projection is degenerate
+		const float normal_length = length(plane.xyz());
+		if (normal_length <= 1e-6f) {
+			continue;
+		}
+		const float inv_length                     = 1.0f / normal_length;
+		result.frustum_planes[result.planes_count] = float4(inv_length * plane.xyz(), inv_length * plane.w);
+		result.planes_count += 1;
+	}
+
+	result.camera_position = (inverse_transform(world_transform) * float4(camera_position, 1.0f)).xyz();
+	return result;
+}
+
+bool is_meshlet_visible(const MeshletCullingView &view, const MeshletBounds &bounds)
+{
+	for (u32 i_plane = 0; i_plane < view.planes_count; i_plane += 1) {
+		const auto &plane = view.frustum_planes[i_plane];
+		if (dot(plane.xyz(), bounds.center) + plane.w < -bounds.radius) {
+			return false;
+		}
+	}
+
+	if (view.backface_culling) {
+		const float3 to_center = bounds.center - view.camera_position;
+		if (dot(to_center, bounds.cone_axis) >= bounds.cone_cutoff * length(to_center) + bounds.radius) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void cull_meshlets(const MeshletCullingView &view,
+	exo::Span<const MeshletBounds>           bounds,
+	u32                                      first_meshlet,
+	u32                                      meshlets_count,
+	Vec<u32>                                &out_visible)
+{
+	EXO_PROFILE_SCOPE
+	ASSERT(usize(first_meshlet) + meshlets_count <= bounds.len());
+	for (u32 i_meshlet = first_meshlet; i_meshlet < first_meshlet + meshlets_count; i_meshlet += 1) {
+		if (is_meshlet_visible(view, bounds[i_meshlet])) {
+			out_visible.push(i_meshlet);
+		}
+	}
+}
+
+// -- Serialization
+
+void serialize(exo::Serializer &serializer, Meshlet &data)
+{
+	exo::serialize(serializer, data.vertex_offset);
+	exo::serialize(serializer, data.triangle_offset);
+	exo::serialize(serializer, data.vertex_count);
+	exo::serialize(serializer, data.triangle_count);
+}
+
+void serialize(exo::Serializer &serializer, MeshletBounds &data)
+{
+	exo::serialize(serializer, data.center);
+	exo::serialize(serializer, data.radius);
+	exo::serialize(serializer, data.cone_axis);
+	exo::serialize(serializer, data.cone_cutoff);
+}
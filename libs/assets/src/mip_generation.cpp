@@ -0,0 +1,307 @@
+#include "assets/mip_generation.h"
+
+#include "exo/macros/assert.h"
+#include "exo/maths/pointer.h"
+#include "exo/profile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <smmintrin.h>
+
+// -- Color conversions
+
+struct ColorTables
+{
+	float srgb_to_linear[256];
+	float unorm_to_float[256];
+	u8    linear_to_srgb[4096]; // indexed by the linear value quantized to 12 bits
+};
+
+static ColorTables create_color_tables()
+{
+	ColorTables tables = {};
+	for (u32 i = 0; i < 256; i += 1) {
+		const float c            = float(i) / 255.0f;
+		tables.unorm_to_float[i] = c;
+		tables.srgb_to_linear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+	}
+	for (u32 i = 0; i < 4096; i += 1) {
+		const float c            = float(i) / 4095.0f;
+		const float srgb         = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+		tables.linear_to_srgb[i] = u8(std::clamp(srgb, 0.0f, 1.0f) * 255.0f + 0.5f);
+	}
+	return tables;
+}
+
+static const ColorTables &get_color_tables()
+{
+	static const ColorTables tables = create_color_tables();
+	return tables;
+}
+
+// Levels are filtered in float, with every texel stored as 4 floats whatever the number of channels
+struct MipFilterContext
+{
+	u32          channels;
+	const float *decode_tables[4]; // u8 to linear float for each channel
+	bool         is_srgb[4];
+};
+
+// Linear RGBA texels are converted with SSE, one texel per vector. sRGB channels and images with fewer channels go
+// through the lookup tables one channel at a time, SSE has no gather.
+static bool is_linear_rgba(const MipFilterContext &ctx) { return ctx.channels == 4 && !ctx.is_srgb[0]; }
+
+static void decode_row(const MipFilterContext &ctx, const u8 *src, u32 width, float *dst)
+{
+	if (is_linear_rgba(ctx)) {
+		const __m128 unorm_max = _mm_set1_ps(255.0f);
+		for (u32 x = 0; x < width; x += 1) {
+			i32 packed = 0;
+			std::memcpy(&packed, src + 4 * usize(x), sizeof(packed));
+			const __m128i texel = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(packed));
+			_mm_storeu_ps(dst + 4 * usize(x), _mm_div_ps(_mm_cvtepi32_ps(texel), unorm_max));
+		}
+		return;
+	}
+
+	for (u32 x = 0; x < width; x += 1) {
+		float *texel = dst + 4 * usize(x);
+		for (u32 i_channel = 0; i_channel < 4; i_channel += 1) {
+			texel[i_channel] = i_channel < ctx.channels
+			                     ? ctx.decode_tables[i_channel][src[usize(x) * ctx.channels + i_channel]]
+			                     : 0.0f;
+		}
+	}
+}
+
+// -- Filtering
+
+// Averages 2x2 texels of two source rows, odd dimensions drop their last column
+static void downsample_rows(const float *row0, const float *row1, u32 src_width, float *dst, u32 dst_width)
+{
+	const __m128 quarter = _mm_set1_ps(0.25f);
+	for (u32 x = 0; x < dst_width; x += 1) {
+		const usize x0 = 4 * usize(std::min(2 * x, src_width - 1));
+		const usize x1 = 4 * usize(std::min(2 * x + 1, src_width - 1));
+
+		const __m128 sum0 = _mm_add_ps(_mm_loadu_ps(row0 + x0), _mm_loadu_ps(row0 + x1));
+		const __m128 sum1 = _mm_add_ps(_mm_loadu_ps(row1 + x0), _mm_loadu_ps(row1 + x1));
+		_mm_storeu_ps(dst + 4 * usize(x), _mm_mul_ps(_mm_add_ps(sum0, sum1), quarter));
+	}
+}
+
+// The first level is decoded two rows at a time, a float copy of the whole image would be 4 times its size at least
+static void downsample_from_bytes(const MipFilterContext &ctx,
+	const u8                                              *src,
+	u32                                                    src_width,
+	u32                                                    src_height,
+	float                                                 *dst,
+	u32                                                    dst_width,
+	u32                                                    dst_height)
+{
+	EXO_PROFILE_SCOPE
+	auto        rows       = Vec<float>::with_length(8 * usize(src_width));
+	float      *row0       = rows.data();
+	float      *row1       = rows.data() + 4 * usize(src_width);
+	const usize row_stride = usize(src_width) * ctx.channels;
+	for (u32 y = 0; y < dst_height; y += 1) {
+		decode_row(ctx, src + usize(std::min(2 * y, src_height - 1)) * row_stride, src_width, row0);
+		decode_row(ctx, src + usize(std::min(2 * y + 1, src_height - 1)) * row_stride, src_width, row1);
+		downsample_rows(row0, row1, src_width, dst + 4 * usize(y) * dst_width, dst_width);
+	}
+}
+
+static void downsample_from_floats(
+	const float *src, u32 src_width, u32 src_height, float *dst, u32 dst_width, u32 dst_height)
+{
+	EXO_PROFILE_SCOPE
+	for (u32 y = 0; y < dst_height; y += 1) {
+		const float *row0 = src + 4 * usize(std::min(2 * y, src_height - 1)) * src_width;
+		const float *row1 = src + 4 * usize(std::min(2 * y + 1, src_height - 1)) * src_width;
+		downsample_rows(row0, row1, src_width, dst + 4 * usize(y) * dst_width, dst_width);
+	}
+}
+
+static void encode_level(const MipFilterContext &ctx, const float *src, usize texel_count, float alpha_scale, u8 *dst)
+{
+	EXO_PROFILE_SCOPE
+	if (is_linear_rgba(ctx)) {
+		const __m128 channel_scale = _mm_setr_ps(1.0f, 1.0f, 1.0f, alpha_scale);
+		const __m128 zero          = _mm_setzero_ps();
+		const __m128 one           = _mm_set1_ps(1.0f);
+		const __m128 unorm_max     = _mm_set1_ps(255.0f);
+		const __m128 half          = _mm_set1_ps(0.5f);
+		for (usize i_texel = 0; i_texel < texel_count; i_texel += 1) {
+			// Same rounding as the scalar path: clamp to [0, 1], then truncate value * 255 + 0.5
+			__m128 texel = _mm_mul_ps(_mm_loadu_ps(src + 4 * i_texel), channel_scale);
+			texel        = _mm_min_ps(_mm_max_ps(texel, zero), one);
+			texel        = _mm_add_ps(_mm_mul_ps(texel, unorm_max), half);
+
+			const __m128i words   = _mm_packus_epi32(_mm_cvttps_epi32(texel), _mm_setzero_si128());
+			const i32     encoded = _mm_cvtsi128_si32(_mm_packus_epi16(words, _mm_setzero_si128()));
+			std::memcpy(dst + 4 * i_texel, &encoded, sizeof(encoded));
+		}
+		return;
+	}
+
+	const auto &tables = get_color_tables();
+	for (usize i_texel = 0; i_texel < texel_count; i_texel += 1) {
+		for (u32 i_channel = 0; i_channel < ctx.channels; i_channel += 1) {
+			float value = src[4 * i_texel + i_channel];
+			if (i_channel == 3) {
+				value *= alpha_scale;
+			}
+			value = std::clamp(value, 0.0f, 1.0f);
+
+			u8 encoded = 0;
+			if (ctx.is_srgb[i_channel]) {
+				encoded = tables.linear_to_srgb[u32(value * 4095.0f + 0.5f)];
+			} else {
+				encoded = u8(value * 255.0f + 0.5f);
+			}
+			dst[i_texel * ctx.channels + i_channel] = encoded;
+		}
+	}
+}
+
+// -- Alpha coverage
+
+static float compute_level_alpha_coverage(const float *level, usize texel_count, float alpha_ref)
+{
+	usize covered = 0;
+	for (usize i_texel = 0; i_texel < texel_count; i_texel += 1) {
+		covered += level[4 * i_texel + 3] >= alpha_ref ? 1 : 0;
+	}
+	return float(covered) / float(texel_count);
+}
+
+// Finds the alpha threshold that gives the coverage closest to the target, and the scale that moves this threshold to
+// the cutoff
+static float compute_alpha_scale(const float *level, usize texel_count, float alpha_cutoff, float target_coverage)
+{
+	// Coverage decreases with the threshold, keep coverage(low) > target >= coverage(high)
+	float low  = 0.0f;
+	float high = 1.0f;
+	for (u32 i_step = 0; i_step < 12; i_step += 1) {
+		const float alpha_ref = 0.5f * (low + high);
+		const float coverage  = compute_level_alpha_coverage(level, texel_count, alpha_ref);
+		if (coverage > target_coverage) {
+			low = alpha_ref;
+		} else {
+			high = alpha_ref;
+		}
+	}
+
+	const float low_error  = compute_level_alpha_coverage(level, texel_count, low) - target_coverage;
+	const float high_error = target_coverage - compute_level_alpha_coverage(level, texel_count, high);
+	const float alpha_ref  = low_error < high_error ? low : high;
+	return alpha_cutoff / std::max(alpha_ref, 1.0f / 255.0f);
+}
+
+float compute_alpha_coverage(exo::Span<const u8> pixels, float alpha_cutoff)
+{
+	ASSERT(pixels.len() % 4 == 0);
+	const usize texel_count = pixels.len() / 4;
+	if (texel_count == 0) {
+		return 0.0f;
+	}
+
+	usize covered = 0;
+	for (usize i_texel = 0; i_texel < texel_count; i_texel += 1) {
+		covered += float(pixels[4 * i_texel + 3]) / 255.0f >= alpha_cutoff ? 1 : 0;
+	}
+	return float(covered) / float(texel_count);
+}
+
+// --
+
+u32 get_mip_count(u32 width, u32 height)
+{
+	u32 count = 1;
+	while (width > 1 || height > 1) {
+		width  = std::max(1u, width / 2);
+		height = std::max(1u, height / 2);
+		count += 1;
+	}
+	return count;
+}
+
+Vec<u8> generate_mip_chain(exo::Span<const u8> pixels,
+	u32                                        width,
+	u32                                        height,
+	u32                                        channels,
+	const MipGenerationSettings               &settings,
+	Vec<usize>                                &out_mip_offsets)
+{
+	EXO_PROFILE_SCOPE
+	ASSERT(0 < channels && channels <= 4);
+	ASSERT(width > 0 && height > 0);
+	ASSERT(pixels.len() == usize(width) * height * channels);
+
+	const auto &tables = get_color_tables();
+
+	MipFilterContext ctx = {};
+	ctx.channels         = channels;
+	for (u32 i_channel = 0; i_channel < channels; i_channel += 1) {
+		ctx.is_srgb[i_channel]       = settings.srgb && channels >= 3 && i_channel < 3;
+		ctx.decode_tables[i_channel] = ctx.is_srgb[i_channel] ? tables.srgb_to_linear : tables.unorm_to_float;
+	}
+
+	// -- Compute the layout of the chain, each level starts on a 4 bytes boundary for buffer to image copies
+	const u32 mip_count = get_mip_count(width, height);
+	out_mip_offsets.clear();
+	usize total_size = 0;
+	for (u32 i_level = 0; i_level < mip_count; i_level += 1) {
+		const usize level_width  = std::max(1u, width >> i_level);
+		const usize level_height = std::max(1u, height >> i_level);
+		total_size               = exo::round_up_to_alignment(4, total_size);
+		out_mip_offsets.push(total_size);
+		total_size += level_width * level_height * channels;
+	}
+
+	auto result = Vec<u8>::with_length(total_size);
+	std::memcpy(result.data(), pixels.data(), pixels.len());
+	if (mip_count == 1) {
+		return result;
+	}
+
+	const bool  preserve_coverage = settings.preserve_alpha_coverage && channels == 4;
+	const float target_coverage   = preserve_coverage ? compute_alpha_coverage(pixels, settings.alpha_cutoff) : 1.0f;
+
+	// -- Filter each level from the unquantized previous level
+	Vec<float> previous_level;
+	Vec<float> current_level;
+	u32        previous_width  = width;
+	u32        previous_height = height;
+	for (u32 i_level = 1; i_level < mip_count; i_level += 1) {
+		const u32   level_width  = std::max(1u, width >> i_level);
+		const u32   level_height = std::max(1u, height >> i_level);
+		const usize texel_count  = usize(level_width) * level_height;
+		current_level.resize(4 * texel_count);
+
+		if (i_level == 1) {
+			downsample_from_bytes(ctx, pixels.data(), width, height, current_level.data(), level_width, level_height);
+		} else {
+			downsample_from_floats(previous_level.data(),
+				previous_width,
+				previous_height,
+				current_level.data(),
+				level_width,
+				level_height);
+		}
+
+		float alpha_scale = 1.0f;
+		if (preserve_coverage && target_coverage > 0.0f && target_coverage < 1.0f) {
+			alpha_scale =
+				compute_alpha_scale(current_level.data(), texel_count, settings.alpha_cutoff, target_coverage);
+		}
+		encode_level(ctx, current_level.data(), texel_count, alpha_scale, result.data() + out_mip_offsets[i_level]);
+
+		std::swap(previous_level, current_level);
+		previous_width  = level_width;
+		previous_height = level_height;
+	}
+
+	return result;
+}
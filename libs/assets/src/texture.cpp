@@ -37,3 +37,5 @@ void Texture::serialize(exo::Serializer &serializer)
 	exo::serialize(serializer, this->pixels_hash);
 	exo::serialize(serializer, this->pixels_data_size);
 }
+
+void Texture::collect_blobs(Vec<exo::u128> &out_blobs) const { out_blobs.push(this->pixels_hash); }
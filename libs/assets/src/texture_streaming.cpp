@@ -0,0 +1,229 @@
+#include "assets/texture_streaming.h"
+
+#include "exo/macros/assert.h"
+#include "exo/profile.h"
+
+#include <algorithm>
+#include <cmath>
+
+u32 compute_desired_level(u32 width, u32 height, u32 level_count, float screen_size)
+{
+	ASSERT(level_count > 0);
+	const float texture_size = float(std::max(width, height));
+	if (!(screen_size > 0.0f)) {
+		return level_count - 1;
+	}
+	if (texture_size <= screen_size) {
+		return 0;
+	}
+	const auto level = u32(std::floor(std::log2(texture_size / screen_size)));
+	return std::min(level, level_count - 1);
+}
+
+static u32 compute_tail_first_level(const StreamedTextureDesc &desc, u32 tail_dimension)
+{
+	const u32 level_count = u32(desc.level_sizes.len());
+	ASSERT(level_count > 0);
+
+	const u32 max_dimension    = std::max(desc.width, desc.height);
+	u32       tail_first_level = 0;
+	while (tail_first_level + 1 < level_count && (max_dimension >> tail_first_level) > tail_dimension) {
+		tail_first_level += 1;
+	}
+	return tail_first_level;
+}
+
+u32 TextureStreamer::add_texture(StreamedTextureDesc desc)
+{
+	const u32 level_count      = u32(desc.level_sizes.len());
+	const u32 tail_first_level = compute_tail_first_level(desc, this->settings.tail_max_dimension);
+
+	auto texture = StreamedTexture{
+		.desc                 = std::move(desc),
+		.tail_first_level     = tail_first_level,
+		.resident_first_level = level_count,
+		.requested_level      = tail_first_level,
+		.last_used_frame      = 0,
+	};
+
+	if (!this->free_textures.is_empty()) {
+		const u32 i_texture       = this->free_textures.pop();
+		this->textures[i_texture] = std::move(texture);
+		return i_texture;
+	}
+
+	const u32 i_texture = u32(this->textures.len());
+	this->textures.push(std::move(texture));
+	return i_texture;
+}
+
+void TextureStreamer::remove_texture(u32 i_texture)
+{
+	this->resident_size -= this->get_resident_size(i_texture);
+	// A texture without levels is skipped by `update`
+	this->textures[i_texture] = {};
+	this->free_textures.push(i_texture);
+}
+
+void TextureStreamer::replace_texture(u32 i_texture, StreamedTextureDesc desc)
+{
+	auto &texture = this->textures[i_texture];
+	this->resident_size -= this->get_resident_size(i_texture);
+
+	const u32 level_count        = u32(desc.level_sizes.len());
+	texture.tail_first_level     = compute_tail_first_level(desc, this->settings.tail_max_dimension);
+	texture.desc                 = std::move(desc);
+	texture.resident_first_level = level_count;
+	texture.requested_level      = std::min(texture.requested_level, texture.tail_first_level);
+}
+
+void TextureStreamer::request(u32 i_texture, float screen_size)
+{
+	auto &texture = this->textures[i_texture];
+
+	const u32 level_count = u32(texture.desc.level_sizes.len());
+	const u32 desired_level =
+		std::min(compute_desired_level(texture.desc.width, texture.desc.height, level_count, screen_size),
+			texture.tail_first_level);
+
+	// The first request of a frame replaces the previous frame's level, the finest request of the frame wins
+	if (texture.last_used_frame != this->i_frame) {
+		texture.requested_level = desired_level;
+		texture.last_used_frame = this->i_frame;
+	} else {
+		texture.requested_level = std::min(texture.requested_level, desired_level);
+	}
+}
+
+bool TextureStreamer::is_resident(u32 i_texture) const
+{
+	const auto &texture = this->textures[i_texture];
+	return texture.resident_first_level < texture.desc.level_sizes.len();
+}
+
+usize TextureStreamer::get_resident_size(u32 i_texture) const
+{
+	return this->get_levels_size(i_texture, this->textures[i_texture].resident_first_level);
+}
+
+usize TextureStreamer::get_levels_size(u32 i_texture, u32 first_level) const
+{
+	const auto &level_sizes = this->textures[i_texture].desc.level_sizes;
+	usize       size        = 0;
+	for (usize i_level = first_level; i_level < level_sizes.len(); i_level += 1) {
+		size += level_sizes[i_level];
+	}
+	return size;
+}
+
+bool TextureStreamer::set_resident_levels(
+	TextureResidencyUploader &uploader, u32 i_texture, u32 first_level, usize &frame_size)
+{
+	const u32   resident_first_level = this->textures[i_texture].resident_first_level;
+	const usize resident_levels_size = this->get_resident_size(i_texture);
+	const usize levels_size          = this->get_levels_size(i_texture, first_level);
+
+	// The resident levels are kept, only the finer levels are uploaded
+	const usize upload_size = first_level < resident_first_level ? levels_size - resident_levels_size : 0;
+	if (frame_size != 0 && frame_size + upload_size > this->settings.frame_upload_budget) {
+		return false;
+	}
+	if (!uploader.set_resident_levels(i_texture, first_level, resident_first_level)) {
+		return false;
+	}
+
+	this->resident_size -= resident_levels_size;
+	this->resident_size += levels_size;
+	this->textures[i_texture].resident_first_level = first_level;
+	frame_size += upload_size;
+	return true;
+}
+
+// Evicts levels one at a time until `size` more bytes fit in the budget. Levels finer than what was requested this
+// frame are evicted first, then the levels of the least recently used textures. Tails are never evicted.
+bool TextureStreamer::make_room(
+	TextureResidencyUploader &uploader, usize size, u32 i_texture_to_keep, usize &frame_size)
+{
+	while (this->resident_size + size > this->settings.memory_budget) {
+		u32 i_victim           = u32_invalid;
+		u64 victim_last_used   = u64_invalid;
+		u32 victim_first_level = 0;
+		for (u32 i_texture = 0; i_texture < this->textures.len(); i_texture += 1) {
+			const auto &texture = this->textures[i_texture];
+			if (i_texture == i_texture_to_keep || texture.resident_first_level >= texture.tail_first_level) {
+				continue;
+			}
+
+			const bool is_used = texture.last_used_frame == this->i_frame;
+			if (is_used && texture.resident_first_level >= texture.requested_level) {
+				continue;
+			}
+
+			// Over-resident textures used this frame rank before the ones that were not used
+			const u64 last_used = is_used ? 0 : texture.last_used_frame + 1;
+			if (i_victim == u32_invalid || last_used < victim_last_used ||
+				(last_used == victim_last_used && texture.resident_first_level < victim_first_level)) {
+				i_victim           = i_texture;
+				victim_last_used   = last_used;
+				victim_first_level = texture.resident_first_level;
+			}
+		}
+
+		if (i_victim == u32_invalid) {
+			return false;
+		}
+		if (!this->set_resident_levels(uploader, i_victim, victim_first_level + 1, frame_size)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void TextureStreamer::update(TextureResidencyUploader &uploader)
+{
+	EXO_PROFILE_SCOPE
+	usize frame_size = 0;
+
+	// Textures whose tail is loaded this frame wait for the next one to stream finer levels, a texture changes at most
+	// once per frame
+	Vec<u32> candidates;
+	for (u32 i_texture = 0; i_texture < this->textures.len(); i_texture += 1) {
+		const auto &texture = this->textures[i_texture];
+		if (this->is_resident(i_texture) && texture.last_used_frame == this->i_frame &&
+			texture.requested_level < texture.resident_first_level) {
+			candidates.push(i_texture);
+		}
+	}
+
+	// -- Load the tails first, every texture gets something to sample before any texture gets its finer levels
+	for (u32 i_texture = 0; i_texture < this->textures.len(); i_texture += 1) {
+		const auto &texture = this->textures[i_texture];
+		if (!texture.desc.level_sizes.is_empty() && !this->is_resident(i_texture)) {
+			this->set_resident_levels(uploader, i_texture, texture.tail_first_level, frame_size);
+		}
+	}
+
+	// -- Stream in one finer level per texture, the textures the furthest from their requested level first
+	std::sort(candidates.begin(), candidates.end(), [&](u32 lhs, u32 rhs) {
+		const auto &lhs_texture = this->textures[lhs];
+		const auto &rhs_texture = this->textures[rhs];
+		const u32   lhs_deficit = lhs_texture.resident_first_level - lhs_texture.requested_level;
+		const u32   rhs_deficit = rhs_texture.resident_first_level - rhs_texture.requested_level;
+		return lhs_deficit != rhs_deficit ? lhs_deficit > rhs_deficit : lhs < rhs;
+	});
+
+	for (const u32 i_texture : candidates) {
+		const auto &texture     = this->textures[i_texture];
+		const u32   first_level = texture.resident_first_level - 1;
+		const usize upload_size = texture.desc.level_sizes[first_level];
+		if (frame_size != 0 && frame_size + upload_size > this->settings.frame_upload_budget) {
+			continue;
+		}
+		if (!this->make_room(uploader, upload_size, i_texture, frame_size)) {
+			continue;
+		}
+		this->set_resident_levels(uploader, i_texture, first_level, frame_size);
+	}
+
+	this->i_frame += 1;
+}
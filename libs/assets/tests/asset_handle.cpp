@@ -0,0 +1,37 @@
+#include "assets/asset_handle.h"
+#include <catch2/catch_test_macros.hpp>
+#include <type_traits>
+
+namespace
+{
+struct Dummy
+{
+};
+} // namespace
+
+static_assert(std::is_trivially_copyable_v<AssetHandle>);
+static_assert(sizeof(AssetHandle) == sizeof(u64));
+
+TEST_CASE("Asset handles", "[asset_handle]")
+{
+	const auto mesh    = AssetId::create<Dummy>("mesh");
+	const auto texture = AssetId::create<Dummy>("texture");
+
+	REQUIRE(AssetHandle::from_id(mesh) == AssetHandle::from_id(mesh));
+	REQUIRE(!(AssetHandle::from_id(mesh) == AssetHandle::from_id(texture)));
+	REQUIRE(!AssetHandle::from_id(AssetId::invalid()).is_valid());
+
+	AssetNameTable names;
+	const auto     mesh_handle = names.intern(mesh);
+	REQUIRE(mesh_handle == AssetHandle::from_id(mesh));
+	REQUIRE(names.get_name(mesh_handle) == exo::StringView{"mesh"});
+	REQUIRE(names.get_id(mesh_handle) == mesh);
+
+	// Interning again does not add an entry
+	names.intern(mesh);
+	REQUIRE(names.ids.size == 1);
+
+	REQUIRE(names.get_name(AssetHandle::from_id(texture)).len() == 0);
+	REQUIRE(!names.intern(AssetId::invalid()).is_valid());
+	REQUIRE(names.ids.size == 1);
+}
@@ -0,0 +1,104 @@
+#include "assets/asset_residency.h"
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+struct Dummy
+{
+};
+
+AssetId make_id(const char *name) { return AssetId::create<Dummy>(name); }
+} // namespace
+
+TEST_CASE("Asset references", "[asset_residency]")
+{
+	AssetResidency residency;
+	const auto     mesh = make_id("mesh");
+
+	// Assets can be referenced before they are loaded
+	residency.add_ref(mesh);
+	residency.add_ref(mesh);
+	REQUIRE(residency.get_ref_count(mesh) == 2);
+	REQUIRE(residency.resident_size == 0);
+
+	residency.set_resident(mesh, "Mesh", 100);
+	REQUIRE(residency.resident_size == 100);
+
+	residency.release(mesh);
+	residency.release(mesh);
+	REQUIRE(residency.get_ref_count(mesh) == 0);
+	REQUIRE(residency.assets.at(mesh) != nullptr);
+
+	// The entry is removed once the asset is neither referenced nor resident
+	residency.set_evicted(mesh);
+	REQUIRE(residency.assets.at(mesh) == nullptr);
+	REQUIRE(residency.resident_size == 0);
+
+	residency.add_ref(mesh);
+	residency.release(mesh);
+	REQUIRE(residency.assets.at(mesh) == nullptr);
+}
+
+TEST_CASE("Asset memory per type", "[asset_residency]")
+{
+	AssetResidency residency;
+	residency.set_resident(make_id("mesh0"), "Mesh", 100);
+	residency.set_resident(make_id("mesh1"), "Mesh", 50);
+	residency.set_resident(make_id("texture0"), "Texture", 1000);
+
+	const auto *mesh_memory = residency.get_type_memory("Mesh");
+	REQUIRE(mesh_memory != nullptr);
+	REQUIRE(mesh_memory->memory_size == 150);
+	REQUIRE(mesh_memory->asset_count == 2);
+	REQUIRE(residency.get_type_memory("Texture")->memory_size == 1000);
+	REQUIRE(residency.get_type_memory("Material") == nullptr);
+	REQUIRE(residency.resident_size == 1150);
+
+	residency.set_evicted(make_id("mesh0"));
+	REQUIRE(mesh_memory->memory_size == 50);
+	REQUIRE(mesh_memory->asset_count == 1);
+	REQUIRE(residency.resident_size == 1050);
+}
+
+TEST_CASE("Unreferenced assets are evicted over the budget", "[asset_residency]")
+{
+	AssetResidency residency;
+	residency.settings.memory_budget = 250;
+
+	const auto old_asset   = make_id("old");
+	const auto used_asset  = make_id("used");
+	const auto new_asset   = make_id("new");
+	const auto referenced  = make_id("referenced");
+	residency.set_resident(old_asset, "Mesh", 100);
+	residency.set_resident(referenced, "Mesh", 100);
+	residency.add_ref(referenced);
+
+	residency.i_frame += 1;
+	residency.set_resident(used_asset, "Mesh", 100);
+	residency.set_resident(new_asset, "Mesh", 100);
+
+	// `old` was loaded before the other unreferenced assets but used since
+	residency.i_frame += 1;
+	residency.touch(old_asset);
+
+	Vec<AssetId> evictions;
+	residency.collect_evictions(evictions);
+	REQUIRE(evictions.len() == 2);
+	REQUIRE((evictions[0] == used_asset || evictions[0] == new_asset));
+	REQUIRE((evictions[1] == used_asset || evictions[1] == new_asset));
+
+	for (const auto &id : evictions) {
+		residency.set_evicted(id);
+	}
+	REQUIRE(residency.resident_size == 200);
+
+	evictions.clear();
+	residency.collect_evictions(evictions);
+	REQUIRE(evictions.is_empty());
+
+	// Referenced assets stay resident even over the budget
+	residency.settings.memory_budget = 0;
+	residency.collect_evictions(evictions);
+	REQUIRE(evictions.len() == 1);
+	REQUIRE(evictions[0] == old_asset);
+}
@@ -0,0 +1,108 @@
+#include "assets/blob_compression.h"
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+// Half of the bytes are random so that blocks compress, but not to nothing
+Vec<u8> make_content(usize size)
+{
+	auto content = Vec<u8>::with_length(size);
+	u32  state   = 0x12345678;
+	for (usize i_byte = 0; i_byte < size; ++i_byte) {
+		state           = state * 1664525u + 1013904223u;
+		content[i_byte] = (i_byte & 1) ? u8(state >> 24) : u8(i_byte / 64);
+	}
+	return content;
+}
+
+bool is_same_range(exo::Span<const u8> data, usize offset, exo::Span<const u8> range)
+{
+	for (usize i_byte = 0; i_byte < range.len(); ++i_byte) {
+		if (data[offset + i_byte] != range[i_byte]) {
+			return false;
+		}
+	}
+	return true;
+}
+} // namespace
+
+TEST_CASE("Compressed blob round-trip", "[blob_compression]")
+{
+	const auto content = make_content(10000);
+
+	SECTION("Zlib")
+	{
+		const auto blob = assets::compress_blob(content, {.codec = assets::BlobCodec::Zlib, .block_size = 1024});
+		REQUIRE(assets::is_compressed_blob(blob));
+		REQUIRE(assets::get_compressed_blob_header(blob).block_count == 10);
+		REQUIRE(blob.len() < content.len());
+
+		auto out = Vec<u8>::with_length(content.len());
+		REQUIRE(assets::decompress_blob(nullptr, blob, out) == content.len());
+		REQUIRE(is_same_range(content, 0, out));
+	}
+
+	SECTION("Stored")
+	{
+		const auto blob = assets::compress_blob(content, {.codec = assets::BlobCodec::None, .block_size = 4096});
+		REQUIRE(assets::get_compressed_blob_header(blob).block_count == 3);
+		for (const auto &block : assets::get_compressed_blob_blocks(blob)) {
+			REQUIRE(block.compressed_size == block.uncompressed_size);
+		}
+
+		auto out = Vec<u8>::with_length(content.len());
+		REQUIRE(assets::decompress_blob(nullptr, blob, out) == content.len());
+		REQUIRE(is_same_range(content, 0, out));
+	}
+
+	SECTION("Empty")
+	{
+		const auto blob = assets::compress_blob(Vec<u8>{});
+		REQUIRE(assets::is_compressed_blob(blob));
+		REQUIRE(assets::get_compressed_blob_header(blob).block_count == 0);
+		REQUIRE(assets::decompress_blob(nullptr, blob, {}) == 0);
+	}
+
+	SECTION("Invalid header")
+	{
+		auto blob = assets::compress_blob(content, {.block_size = 1024});
+		blob[0] ^= 1;
+		REQUIRE(!assets::is_compressed_blob(blob));
+		REQUIRE(!assets::is_compressed_blob(exo::Span<const u8>(blob.data(), 16)));
+	}
+}
+
+TEST_CASE("Compressed blob range", "[blob_compression]")
+{
+	const auto content = make_content(10000);
+	const auto blob    = assets::compress_blob(content, {.codec = assets::BlobCodec::Zlib, .block_size = 1024});
+
+	SECTION("Inside a block")
+	{
+		auto out = Vec<u8>::with_length(100);
+		REQUIRE(assets::decompress_blob_range(blob, 1100, out) == 100);
+		REQUIRE(is_same_range(content, 1100, out));
+	}
+
+	SECTION("Partial first and last blocks")
+	{
+		auto out = Vec<u8>::with_length(3000);
+		REQUIRE(assets::decompress_blob_range(blob, 500, out) == 3000);
+		REQUIRE(is_same_range(content, 500, out));
+	}
+
+	SECTION("Fully covered blocks")
+	{
+		auto out = Vec<u8>::with_length(2048);
+		REQUIRE(assets::decompress_blob_range(blob, 2048, out) == 2048);
+		REQUIRE(is_same_range(content, 2048, out));
+	}
+
+	SECTION("Range past the end is clamped")
+	{
+		auto out = Vec<u8>::with_length(1000);
+		REQUIRE(assets::decompress_blob_range(blob, 9500, out) == 500);
+		REQUIRE(is_same_range(content, 9500, exo::Span<const u8>(out.data(), 500)));
+		REQUIRE(assets::decompress_blob_range(blob, 10000, out) == 0);
+	}
+}
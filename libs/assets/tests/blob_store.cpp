@@ -0,0 +1,138 @@
+#include "assets/blob_store.h"
+#include <catch2/catch_test_macros.hpp>
+#include <cstdio>
+#include <filesystem>
+
+namespace
+{
+Vec<u8> make_content(usize size, u8 seed)
+{
+	auto content = Vec<u8>::with_length(size);
+	for (usize i_byte = 0; i_byte < size; ++i_byte) {
+		content[i_byte] = u8(i_byte * 7 + seed);
+	}
+	return content;
+}
+
+bool is_same_content(exo::Span<const u8> lhs, exo::Span<const u8> rhs)
+{
+	return lhs.len() == rhs.len() && std::memcmp(lhs.data(), rhs.data(), lhs.len()) == 0;
+}
+
+exo::Path make_store_directory(const char *name)
+{
+	const auto path = std::filesystem::temp_directory_path() / name;
+	std::filesystem::remove_all(path);
+	std::filesystem::create_directories(path);
+	const auto path_str = path.string();
+	return exo::Path::from_string(exo::StringView{path_str.c_str(), path_str.size()});
+}
+
+usize count_packs(const exo::Path &directory)
+{
+	usize count = 0;
+	for (const auto &entry : std::filesystem::directory_iterator{directory.view().data()}) {
+		count += entry.path().extension() == ".pack" ? 1 : 0;
+	}
+	return count;
+}
+} // namespace
+
+TEST_CASE("Blob store", "[blob_store]")
+{
+	const auto directory = make_store_directory("blob_store_test");
+
+	Vec<Vec<u8>>   contents;
+	Vec<exo::u128> hashes;
+	for (u8 i_blob = 0; i_blob < 8; ++i_blob) {
+		contents.push(make_content(1000 + i_blob, i_blob));
+		hashes.push(exo::u128_from_u64(0, i_blob + 1));
+	}
+
+	SECTION("Append and get")
+	{
+		auto store = BlobStore::open(directory, 2500);
+		store.add(hashes[0], contents[0]);
+		const auto first = store.get(hashes[0]);
+		REQUIRE(is_same_content(first, contents[0]));
+
+		for (usize i_blob = 1; i_blob < hashes.len(); ++i_blob) {
+			store.add(hashes[i_blob], contents[i_blob]);
+			REQUIRE(is_same_content(store.get(hashes[i_blob]), contents[i_blob]));
+		}
+		// The pack was remapped since the first read, the span still points to valid memory
+		REQUIRE(is_same_content(first, contents[0]));
+
+		// Duplicates are ignored
+		store.add(hashes[3], contents[3]);
+		REQUIRE(store.blob_count == hashes.len());
+		REQUIRE(store.packs.len() == 4);
+		REQUIRE(store.get(exo::u128_from_u64(0, 100)).empty());
+	}
+
+	SECTION("Reopen")
+	{
+		{
+			auto store = BlobStore::open(directory, 2500);
+			for (usize i_blob = 0; i_blob < hashes.len(); ++i_blob) {
+				store.add(hashes[i_blob], contents[i_blob]);
+			}
+			store.save_index();
+		}
+
+		// The configured pack size is not overridden by the index
+		auto store = BlobStore::open(directory, 1_MiB);
+		REQUIRE(store.max_pack_size == 1_MiB);
+		REQUIRE(store.blob_count == hashes.len());
+		for (usize i_blob = 0; i_blob < hashes.len(); ++i_blob) {
+			REQUIRE(is_same_content(store.get(hashes[i_blob]), contents[i_blob]));
+		}
+	}
+
+	SECTION("Trailing bytes in a pack")
+	{
+		{
+			auto store = BlobStore::open(directory, 2500);
+			store.add(hashes[0], contents[0]);
+			store.save_index();
+		}
+
+		// Bytes appended after the index was saved, e.g. a blob added before a crash
+		const auto pack_path = BlobStore::open(directory).get_pack_path(0);
+		FILE      *fp        = fopen(pack_path.view().data(), "ab");
+		REQUIRE(fp != nullptr);
+		fwrite(contents[7].data(), 1, 100, fp);
+		fclose(fp);
+
+		auto store = BlobStore::open(directory, 2500);
+		store.add(hashes[1], contents[1]);
+		REQUIRE(store.packs.len() == 1);
+		REQUIRE(store.find(hashes[1]).value().offset == 1100);
+		REQUIRE(is_same_content(store.get(hashes[0]), contents[0]));
+		REQUIRE(is_same_content(store.get(hashes[1]), contents[1]));
+	}
+
+	SECTION("Compact")
+	{
+		auto store = BlobStore::open(directory, 2500);
+		for (usize i_blob = 0; i_blob < hashes.len(); ++i_blob) {
+			store.add(hashes[i_blob], contents[i_blob]);
+		}
+		REQUIRE(count_packs(directory) == 4);
+
+		const Vec<exo::u128> live_blobs = {hashes[1], hashes[6]};
+		store.compact(live_blobs);
+		REQUIRE(store.blob_count == 2);
+		REQUIRE(count_packs(directory) == 1);
+		REQUIRE(!store.contains(hashes[0]));
+		REQUIRE(is_same_content(store.get(hashes[1]), contents[1]));
+		REQUIRE(is_same_content(store.get(hashes[6]), contents[6]));
+
+		// The index was saved by the compaction
+		auto reopened = BlobStore::open(directory);
+		REQUIRE(reopened.blob_count == 2);
+		REQUIRE(is_same_content(reopened.get(hashes[6]), contents[6]));
+	}
+
+	std::filesystem::remove_all(directory.view().data());
+}
@@ -0,0 +1,285 @@
+#include "assets/block_compression.h"
+#include <catch2/catch_test_macros.hpp>
+
+#include "exo/collections/vector.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+// -- Reference decoders, BC7 only supports mode 6 as it is the only mode produced by the encoder
+
+static void decode_bc1(const u8 *block, bool allow_three_colors, u8 (&out)[16][4])
+{
+	const u32 c0 = u32(block[0]) | (u32(block[1]) << 8);
+	const u32 c1 = u32(block[2]) | (u32(block[3]) << 8);
+
+	u32 palette[4][4] = {};
+	for (u32 i_endpoint = 0; i_endpoint < 2; i_endpoint += 1) {
+		const u32 c            = i_endpoint == 0 ? c0 : c1;
+		const u32 r            = (c >> 11) & 31u;
+		const u32 g            = (c >> 5) & 63u;
+		const u32 b            = c & 31u;
+		palette[i_endpoint][0] = (r << 3) | (r >> 2);
+		palette[i_endpoint][1] = (g << 2) | (g >> 4);
+		palette[i_endpoint][2] = (b << 3) | (b >> 2);
+		palette[i_endpoint][3] = 255;
+	}
+	for (u32 i_channel = 0; i_channel < 3; i_channel += 1) {
+		if (c0 > c1 || !allow_three_colors) {
+			palette[2][i_channel] = (2 * palette[0][i_channel] + palette[1][i_channel]) / 3;
+			palette[3][i_channel] = (palette[0][i_channel] + 2 * palette[1][i_channel]) / 3;
+		} else {
+			palette[2][i_channel] = (palette[0][i_channel] + palette[1][i_channel]) / 2;
+			palette[3][i_channel] = 0;
+		}
+	}
+	palette[2][3] = 255;
+	palette[3][3] = c0 > c1 || !allow_three_colors ? 255 : 0;
+
+	u32 index_bits = 0;
+	std::memcpy(&index_bits, block + 4, sizeof(index_bits));
+	for (u32 i_texel = 0; i_texel < 16; i_texel += 1) {
+		const u32 index = (index_bits >> (2 * i_texel)) & 3u;
+		for (u32 i_channel = 0; i_channel < 4; i_channel += 1) {
+			out[i_texel][i_channel] = u8(palette[index][i_channel]);
+		}
+	}
+}
+
+static void decode_bc4(const u8 *block, u32 channel, u8 (&out)[16][4])
+{
+	const u32 a0 = block[0];
+	const u32 a1 = block[1];
+
+	u32 palette[8] = {a0, a1};
+	if (a0 > a1) {
+		for (u32 i = 2; i < 8; i += 1) {
+			palette[i] = ((8 - i) * a0 + (i - 1) * a1) / 7;
+		}
+	} else {
+		for (u32 i = 2; i < 6; i += 1) {
+			palette[i] = ((6 - i) * a0 + (i - 1) * a1) / 5;
+		}
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+
+	u64 index_bits = 0;
+	for (u32 i_byte = 0; i_byte < 6; i_byte += 1) {
+		index_bits |= u64(block[2 + i_byte]) << (8 * i_byte);
+	}
+	for (u32 i_texel = 0; i_texel < 16; i_texel += 1) {
+		out[i_texel][channel] = u8(palette[(index_bits >> (3 * i_texel)) & 7u]);
+	}
+}
+
+static u32 read_bits(const u8 *block, u32 &bit_offset, u32 bits_count)
+{
+	u32 value = 0;
+	for (u32 i_bit = 0; i_bit < bits_count; i_bit += 1) {
+		value |= u32((block[bit_offset / 8] >> (bit_offset % 8)) & 1u) << i_bit;
+		bit_offset += 1;
+	}
+	return value;
+}
+
+static void decode_bc7_mode6(const u8 *block, u8 (&out)[16][4])
+{
+	const u8 weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+	u32 bit_offset = 0;
+	REQUIRE(read_bits(block, bit_offset, 7) == (1u << 6));
+
+	u32 endpoints[2][4] = {};
+	for (u32 i_channel = 0; i_channel < 4; i_channel += 1) {
+		endpoints[0][i_channel] = read_bits(block, bit_offset, 7);
+		endpoints[1][i_channel] = read_bits(block, bit_offset, 7);
+	}
+	for (u32 i_endpoint = 0; i_endpoint < 2; i_endpoint += 1) {
+		const u32 pbit = read_bits(block, bit_offset, 1);
+		for (u32 i_channel = 0; i_channel < 4; i_channel += 1) {
+			endpoints[i_endpoint][i_channel] = (endpoints[i_endpoint][i_channel] << 1) | pbit;
+		}
+	}
+
+	for (u32 i_texel = 0; i_texel < 16; i_texel += 1) {
+		const u32 w = weights[read_bits(block, bit_offset, i_texel == 0 ? 3 : 4)];
+		for (u32 i_channel = 0; i_channel < 4; i_channel += 1) {
+			const u32 value         = (64 - w) * endpoints[0][i_channel] + w * endpoints[1][i_channel] + 32;
+			out[i_texel][i_channel] = u8(value >> 6);
+		}
+	}
+}
+
+// Decodes the blocks to RGBA8, channels not stored by the format are left to 0
+static Vec<u8> decompress(exo::Span<const u8> blocks, u32 width, u32 height, PixelFormat format)
+{
+	const u32   blocks_x   = (width + 3) / 4;
+	const u32   blocks_y   = (height + 3) / 4;
+	const usize block_size = get_block_byte_size(format);
+
+	auto pixels = Vec<u8>::with_length(usize(width) * height * 4);
+	for (u32 block_y = 0; block_y < blocks_y; block_y += 1) {
+		for (u32 block_x = 0; block_x < blocks_x; block_x += 1) {
+			const u8 *block = blocks.data() + (usize(block_y) * blocks_x + block_x) * block_size;
+
+			u8 texels[16][4] = {};
+			if (format == PixelFormat::BC1_UNORM) {
+				decode_bc1(block, true, texels);
+			} else if (format == PixelFormat::BC3_UNORM) {
+				decode_bc1(block + 8, false, texels);
+				decode_bc4(block, 3, texels);
+			} else if (format == PixelFormat::BC4_UNORM) {
+				decode_bc4(block, 0, texels);
+			} else if (format == PixelFormat::BC5_UNORM) {
+				decode_bc4(block, 0, texels);
+				decode_bc4(block + 8, 1, texels);
+			} else {
+				decode_bc7_mode6(block, texels);
+			}
+
+			for (u32 i_texel = 0; i_texel < 16; i_texel += 1) {
+				const u32 x = 4 * block_x + i_texel % 4;
+				const u32 y = 4 * block_y + i_texel / 4;
+				if (x < width && y < height) {
+					std::memcpy(pixels.data() + 4 * (usize(y) * width + x), texels[i_texel], 4);
+				}
+			}
+		}
+	}
+	return pixels;
+}
+
+static float compute_psnr(exo::Span<const u8> reference, exo::Span<const u8> decoded, u32 channels_count)
+{
+	double squared_error = 0.0;
+	for (usize i_texel = 0; i_texel < reference.len() / 4; i_texel += 1) {
+		for (u32 i_channel = 0; i_channel < channels_count; i_channel += 1) {
+			const usize  i_value = 4 * i_texel + i_channel;
+			const double delta   = double(reference[i_value]) - double(decoded[i_value]);
+			squared_error += delta * delta;
+		}
+	}
+	const double mse = squared_error / double((reference.len() / 4) * channels_count);
+	if (mse == 0.0) {
+		return 100.0f;
+	}
+	return float(10.0 * std::log10(255.0 * 255.0 / mse));
+}
+
+// Smooth gradients with sharp edges and a bit of noise
+static Vec<u8> create_test_image(u32 width, u32 height)
+{
+	auto pixels = Vec<u8>::with_length(usize(width) * height * 4);
+	u32  state  = 0x12345678;
+	for (u32 y = 0; y < height; y += 1) {
+		for (u32 x = 0; x < width; x += 1) {
+			// xorshift32
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			const float noise = float(state % 9) - 4.0f;
+
+			const float fx   = float(x) / float(width);
+			const float fy   = float(y) / float(height);
+			const bool  edge = ((x / 8) + (y / 8)) % 2 == 0;
+			const float r    = 255.0f * fx + noise;
+			const float g    = 255.0f * fy + noise;
+			const float b    = edge ? 200.0f : 127.5f + 127.5f * std::sin(8.0f * fx);
+			const float a    = 255.0f * (1.0f - fx * fy);
+
+			u8 *texel = pixels.data() + 4 * (usize(y) * width + x);
+			texel[0]  = u8(std::fmin(std::fmax(r, 0.0f), 255.0f));
+			texel[1]  = u8(std::fmin(std::fmax(g, 0.0f), 255.0f));
+			texel[2]  = u8(b);
+			texel[3]  = u8(a);
+		}
+	}
+	return pixels;
+}
+
+static float compress_psnr(const Vec<u8> &pixels, u32 width, u32 height, PixelFormat format, BC7Quality quality)
+{
+	auto blocks = Vec<u8>::with_length(get_compressed_size(format, width, height));
+	compress_blocks(nullptr, pixels, width, height, 4, format, blocks, {.bc7_quality = quality});
+	const auto decoded = decompress(blocks, width, height, format);
+
+	u32 channels_count = 4;
+	if (format == PixelFormat::BC1_UNORM) {
+		channels_count = 3;
+	} else if (format == PixelFormat::BC4_UNORM) {
+		channels_count = 1;
+	} else if (format == PixelFormat::BC5_UNORM) {
+		channels_count = 2;
+	}
+	return compute_psnr(pixels, decoded, channels_count);
+}
+
+TEST_CASE("Block compression formats", "[block_compression]")
+{
+	REQUIRE(get_compressed_size(PixelFormat::BC1_UNORM, 13, 7) == 4 * 2 * 8);
+	REQUIRE(get_compressed_size(PixelFormat::BC7_UNORM, 1, 1) == 16);
+
+	REQUIRE(choose_block_format(TextureUsage::Color, 1, false, true) == PixelFormat::BC4_UNORM);
+	REQUIRE(choose_block_format(TextureUsage::Color, 2, false, true) == PixelFormat::BC5_UNORM);
+	REQUIRE(choose_block_format(TextureUsage::Normal, 4, false, true) == PixelFormat::BC5_UNORM);
+	REQUIRE(choose_block_format(TextureUsage::Color, 4, false, false) == PixelFormat::BC1_SRGB);
+	REQUIRE(choose_block_format(TextureUsage::Color, 4, true, false) == PixelFormat::BC3_SRGB);
+	REQUIRE(choose_block_format(TextureUsage::Color, 4, true, true) == PixelFormat::BC7_SRGB);
+	REQUIRE(choose_block_format(TextureUsage::Linear, 4, false, false) == PixelFormat::BC1_UNORM);
+	REQUIRE(choose_block_format(TextureUsage::Linear, 4, true, false) == PixelFormat::BC3_UNORM);
+	REQUIRE(choose_block_format(TextureUsage::Linear, 4, true, true) == PixelFormat::BC7_UNORM);
+	REQUIRE(choose_block_format(TextureUsage::Linear, 1, false, true) == PixelFormat::BC4_UNORM);
+}
+
+TEST_CASE("Block compression PSNR", "[block_compression]")
+{
+	// The size is not a multiple of 4 to test the partial blocks
+	const u32  width  = 67;
+	const u32  height = 45;
+	const auto pixels = create_test_image(width, height);
+
+	const float bc1_psnr = compress_psnr(pixels, width, height, PixelFormat::BC1_UNORM, BC7Quality::Normal);
+	const float bc3_psnr = compress_psnr(pixels, width, height, PixelFormat::BC3_UNORM, BC7Quality::Normal);
+	const float bc4_psnr = compress_psnr(pixels, width, height, PixelFormat::BC4_UNORM, BC7Quality::Normal);
+	const float bc5_psnr = compress_psnr(pixels, width, height, PixelFormat::BC5_UNORM, BC7Quality::Normal);
+
+	const float bc7_fast_psnr   = compress_psnr(pixels, width, height, PixelFormat::BC7_UNORM, BC7Quality::Fast);
+	const float bc7_normal_psnr = compress_psnr(pixels, width, height, PixelFormat::BC7_UNORM, BC7Quality::Normal);
+	const float bc7_high_psnr   = compress_psnr(pixels, width, height, PixelFormat::BC7_UNORM, BC7Quality::High);
+
+	printf("[block_compression] PSNR: BC1 %.2f dB, BC3 %.2f dB, BC4 %.2f dB, BC5 %.2f dB\n",
+		bc1_psnr,
+		bc3_psnr,
+		bc4_psnr,
+		bc5_psnr);
+	printf("[block_compression] PSNR: BC7 fast %.2f dB, normal %.2f dB, high %.2f dB\n",
+		bc7_fast_psnr,
+		bc7_normal_psnr,
+		bc7_high_psnr);
+
+	REQUIRE(bc1_psnr > 30.0f);
+	REQUIRE(bc3_psnr > 30.0f);
+	REQUIRE(bc4_psnr > 40.0f);
+	REQUIRE(bc5_psnr > 38.0f);
+	REQUIRE(bc7_fast_psnr > 35.0f);
+	REQUIRE(bc7_normal_psnr >= bc7_fast_psnr);
+	REQUIRE(bc7_high_psnr >= bc7_normal_psnr);
+}
+
+TEST_CASE("Block compression of constant blocks", "[block_compression]")
+{
+	auto pixels = Vec<u8>::with_length(8 * 8 * 4);
+	for (u32 i_texel = 0; i_texel < 64; i_texel += 1) {
+		pixels[4 * i_texel + 0] = 255;
+		pixels[4 * i_texel + 1] = 0;
+		pixels[4 * i_texel + 2] = 255;
+		pixels[4 * i_texel + 3] = 255;
+	}
+
+	REQUIRE(compress_psnr(pixels, 8, 8, PixelFormat::BC1_UNORM, BC7Quality::Fast) == 100.0f);
+	REQUIRE(compress_psnr(pixels, 8, 8, PixelFormat::BC4_UNORM, BC7Quality::Fast) == 100.0f);
+	// BC7 mode 6 shares the least significant bit of the channels of an endpoint, 255 and 0 are not exact together
+	REQUIRE(compress_psnr(pixels, 8, 8, PixelFormat::BC7_UNORM, BC7Quality::Normal) > 45.0f);
+}
@@ -0,0 +1,140 @@
+#include "assets/bvh.h"
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+
+struct Random
+{
+	u32 state = 0x12345678;
+
+	// xorshift32, returns a float in [0, 1)
+	float next()
+	{
+		this->state ^= this->state << 13;
+		this->state ^= this->state >> 17;
+		this->state ^= this->state << 5;
+		return float(this->state >> 8) / float(1u << 24);
+	}
+
+	float3 next_float3(float scale) { return scale * float3(this->next(), this->next(), this->next()); }
+};
+
+// Small random triangles grouped in a few clusters
+static void create_triangle_soup(u32 triangles_count, Vec<float4> &out_positions, Vec<u32> &out_indices)
+{
+	Random random = {};
+	float3 clusters[4];
+	for (auto &cluster : clusters) {
+		cluster = random.next_float3(100.0f);
+	}
+
+	for (u32 i_triangle = 0; i_triangle < triangles_count; i_triangle += 1) {
+		const float3 center = clusters[i_triangle % 4] + random.next_float3(10.0f);
+		for (u32 i_corner = 0; i_corner < 3; i_corner += 1) {
+			out_indices.push(u32(out_positions.len()));
+			out_positions.push(float4(center + random.next_float3(1.0f), 1.0f));
+		}
+	}
+}
+
+static bool contains(const BVHNode &parent, const BVHNode &child)
+{
+	for (usize i_component = 0; i_component < 3; i_component += 1) {
+		if (child.bbox_min[i_component] < parent.bbox_min[i_component] ||
+			child.bbox_max[i_component] > parent.bbox_max[i_component]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+TEST_CASE("BVH layout", "[bvh]")
+{
+	Vec<float4> positions;
+	Vec<u32>    indices;
+	create_triangle_soup(1000, positions, indices);
+
+	const auto nodes = build_bvh(nullptr, positions, indices);
+	REQUIRE(nodes.len() == 2 * 1000 - 1);
+	REQUIRE(nodes[0].next_node == u32_invalid);
+
+	Vec<u32> leaf_counts = Vec<u32>::with_length(1000);
+	for (auto &count : leaf_counts) {
+		count = 0;
+	}
+
+	for (u32 i_node = 0; i_node < nodes.len(); i_node += 1) {
+		const auto &node = nodes[i_node];
+		REQUIRE((node.next_node == u32_invalid || (i_node < node.next_node && node.next_node < nodes.len())));
+		if (node.is_leaf()) {
+			REQUIRE(node.prim_index % 3 == 0);
+			leaf_counts[node.prim_index / 3] += 1;
+		} else {
+			// The first child follows its parent
+			REQUIRE(contains(node, nodes[i_node + 1]));
+		}
+	}
+
+	for (auto count : leaf_counts) {
+		REQUIRE(count == 1);
+	}
+}
+
+TEST_CASE("BVH closest hit matches brute force", "[bvh]")
+{
+	Vec<float4> positions;
+	Vec<u32>    indices;
+	create_triangle_soup(2000, positions, indices);
+
+	const auto nodes = build_bvh(nullptr, positions, indices);
+
+	Random random = {.state = 0xdeadbeef};
+	u32    hits   = 0;
+	for (u32 i_ray = 0; i_ray < 1000; i_ray += 1) {
+		BVHRay ray    = {};
+		ray.origin    = random.next_float3(120.0f) - float3(10.0f);
+		ray.direction = normalize(random.next_float3(120.0f) - ray.origin);
+
+		BVHHit     bvh_hit   = {};
+		BVHHit     brute_hit = {};
+		const bool bvh_res   = bvh_closest_hit(nodes, positions, indices, ray, bvh_hit);
+		const bool brute_res = brute_force_closest_hit(positions, indices, ray, brute_hit);
+
+		REQUIRE(bvh_res == brute_res);
+		if (brute_res) {
+			REQUIRE(bvh_hit.prim_index == brute_hit.prim_index);
+			REQUIRE(bvh_hit.d == brute_hit.d);
+			hits += 1;
+		}
+	}
+
+	// Make sure the test is not only testing misses
+	REQUIRE(hits > 10);
+}
+
+TEST_CASE("BVH SAH cost", "[bvh]")
+{
+	Vec<float4> positions;
+	Vec<u32>    indices;
+
+	SECTION("A single triangle costs one intersection")
+	{
+		create_triangle_soup(1, positions, indices);
+		const auto nodes = build_bvh(nullptr, positions, indices);
+		REQUIRE(nodes.len() == 1);
+		REQUIRE(compute_sah_cost(nodes) == 1.0f);
+	}
+
+	SECTION("SAH splits are cheaper than median splits")
+	{
+		create_triangle_soup(4000, positions, indices);
+
+		const auto sah_nodes    = build_bvh(nullptr, positions, indices);
+		const auto median_nodes = build_bvh(nullptr, positions, indices, {.bins_count = 1});
+
+		const float sah_cost    = compute_sah_cost(sah_nodes);
+		const float median_cost = compute_sah_cost(median_nodes);
+		REQUIRE(std::isfinite(sah_cost));
+		REQUIRE(sah_cost < median_cost);
+	}
+}
@@ -0,0 +1,121 @@
+#include "assets/database_index.h"
+#include <catch2/catch_test_macros.hpp>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+constexpr u32  VERSION        = 3;
+constexpr auto HASH_ALGORITHM = assets::HashAlgorithm::XXH3;
+
+DatabaseIndexAsset make_asset(const char *name)
+{
+	const auto view = exo::StringView{name};
+	return DatabaseIndexAsset{.name = view, .name_hash = hash_database_string(view)};
+}
+
+DatabaseIndexResource make_resource(const char *path, const char *asset_name, u64 content_hash)
+{
+	DatabaseIndexResource resource = {};
+	resource.asset                 = asset_name ? make_asset(asset_name) : DatabaseIndexAsset{};
+	resource.path                  = exo::StringView{path};
+	resource.last_imported_hash    = content_hash;
+	resource.import_key            = content_hash + 1;
+	resource.content_hash          = content_hash;
+	resource.stat                  = cross::FileStat{.size = content_hash * 10, .last_write_time = 5, .file_id = 1};
+	return resource;
+}
+} // namespace
+
+TEST_CASE("Database index lookups", "[database_index]")
+{
+	DatabaseIndexWriter writer;
+	for (u64 i_resource = 0; i_resource < 100; i_resource += 1) {
+		char path[32];
+		std::snprintf(path, sizeof(path), "assets/resource%llu.gltf", static_cast<unsigned long long>(i_resource));
+		writer.add_resource(make_resource(path, "asset", 1000 + i_resource));
+	}
+	writer.add_resource(make_resource("assets/new.png", nullptr, 0));
+
+	Vec<DatabaseIndexAsset> dependencies;
+	dependencies.push(make_asset("texture"));
+	dependencies.push(make_asset("material"));
+	writer.add_closure(make_asset("mesh"), dependencies);
+
+	const auto content = writer.write(VERSION, HASH_ALGORITHM, 42);
+	REQUIRE(content.len() % 8 == 0);
+
+	const auto index = DatabaseIndex::from_bytes(content, VERSION, HASH_ALGORITHM);
+	REQUIRE(!index.is_empty());
+	REQUIRE(index.get_last_scan_time() == 42);
+	REQUIRE(index.get_resource_count() == 101);
+
+	const u32 i_resource = index.find_resource_by_path(exo::StringView{"assets/resource57.gltf"});
+	REQUIRE(i_resource != u32_invalid);
+	const auto resource = index.get_resource(i_resource);
+	REQUIRE(resource.path == exo::StringView{"assets/resource57.gltf"});
+	REQUIRE(resource.content_hash == 1057);
+	REQUIRE(resource.import_key == 1058);
+	REQUIRE(resource.stat.size == 10570);
+	REQUIRE(resource.asset.name == exo::StringView{"asset"});
+	REQUIRE(index.find_resource_by_content(1057) == i_resource);
+
+	// Resources that were never hashed are only found by path
+	const u32 i_new = index.find_resource_by_path(exo::StringView{"assets/new.png"});
+	REQUIRE(i_new != u32_invalid);
+	REQUIRE(index.get_resource(i_new).asset.name_hash == 0);
+	REQUIRE(index.find_resource_by_content(0) == u32_invalid);
+
+	REQUIRE(index.find_resource_by_path(exo::StringView{"assets/missing.gltf"}) == u32_invalid);
+	REQUIRE(index.find_resource_by_content(7) == u32_invalid);
+
+	const u32 i_closure = index.find_closure(make_asset("mesh").name_hash);
+	REQUIRE(i_closure != u32_invalid);
+	REQUIRE(index.get_closure_asset(i_closure).name == exo::StringView{"mesh"});
+	REQUIRE(index.get_closure_dependency_count(i_closure) == 2);
+	REQUIRE(index.get_closure_dependency(i_closure, 0).name == exo::StringView{"texture"});
+	REQUIRE(index.get_closure_dependency(i_closure, 1).name == exo::StringView{"material"});
+	REQUIRE(index.find_closure(make_asset("texture").name_hash) == u32_invalid);
+}
+
+TEST_CASE("Database index validation", "[database_index]")
+{
+	DatabaseIndexWriter writer;
+	writer.add_resource(make_resource("assets/a.png", "a", 1));
+	const auto content = writer.write(VERSION, HASH_ALGORITHM, 0);
+
+	REQUIRE(!DatabaseIndex::from_bytes(content, VERSION, HASH_ALGORITHM).is_empty());
+	REQUIRE(DatabaseIndex::from_bytes(content, VERSION + 1, HASH_ALGORITHM).is_empty());
+	// The content hashes of another algorithm cannot be compared
+	REQUIRE(DatabaseIndex::from_bytes(content, VERSION, assets::HashAlgorithm::Meow).is_empty());
+
+	const auto truncated = exo::Span<const u8>(content.data(), content.len() - 8);
+	REQUIRE(DatabaseIndex::from_bytes(truncated, VERSION, HASH_ALGORITHM).is_empty());
+	REQUIRE(DatabaseIndex::from_bytes({}, VERSION, HASH_ALGORITHM).is_empty());
+
+	// An empty database is a valid index
+	const auto empty_content = DatabaseIndexWriter{}.write(VERSION, HASH_ALGORITHM, 0);
+	const auto empty_index   = DatabaseIndex::from_bytes(empty_content, VERSION, HASH_ALGORITHM);
+	REQUIRE(!empty_index.is_empty());
+	REQUIRE(empty_index.get_resource_count() == 0);
+	REQUIRE(empty_index.find_resource_by_path(exo::StringView{"assets/a.png"}) == u32_invalid);
+}
+
+TEST_CASE("Database index output is deterministic", "[database_index]")
+{
+	auto write_index = []() {
+		DatabaseIndexWriter writer;
+		writer.add_resource(make_resource("assets/a.png", "a", 1));
+		writer.add_resource(make_resource("assets/b.png", "b", 2));
+		return writer.write(VERSION, HASH_ALGORITHM, 7);
+	};
+
+	const auto content = write_index();
+	const auto other   = write_index();
+	REQUIRE(content.len() == other.len());
+	REQUIRE(std::memcmp(content.data(), other.data(), content.len()) == 0);
+
+	// The four null terminated strings are 30 bytes, the string table is padded to 32 bytes with zeroes
+	REQUIRE(content[content.len() - 2] == 0);
+	REQUIRE(content[content.len() - 1] == 0);
+}
@@ -0,0 +1,180 @@
+#include "assets/importers/gltf_accessors.h"
+#include "exo/collections/vector.h"
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+template <typename T>
+void write_element(Vec<u8> &buffer, usize offset, T value)
+{
+	std::memcpy(buffer.data() + offset, &value, sizeof(T));
+}
+} // namespace
+
+TEST_CASE("Decode glTF indices", "[gltf_accessors]")
+{
+	// Counts that are not a multiple of the vector width exercise the scalar tail too
+	const u32 count       = 37;
+	const u32 vertex_base = 100;
+
+	auto check_indices = [&](gltf::ComponentType type) {
+		const u32 index_size = gltf::size_of(type);
+		auto      buffer     = Vec<u8>::with_length(count * index_size);
+		for (u32 i_index = 0; i_index < count; i_index += 1) {
+			const u32 value = (i_index * 7919u) % 251u;
+			if (index_size == 1) {
+				write_element(buffer, i_index, u8(value));
+			} else if (index_size == 2) {
+				write_element(buffer, 2 * i_index, u16(value * 200));
+			} else {
+				write_element(buffer, 4 * i_index, u32(value * 100000));
+			}
+		}
+
+		const gltf::AccessorData src = {
+			.data           = buffer.data(),
+			.byte_stride    = index_size,
+			.count          = count,
+			.component_type = type,
+			.nb_component   = 1,
+		};
+		auto indices = Vec<u32>::with_length(count);
+		gltf::decode_indices(src, vertex_base, indices.data());
+
+		for (u32 i_index = 0; i_index < count; i_index += 1) {
+			const u32 value    = (i_index * 7919u) % 251u;
+			const u32 expected = index_size == 1 ? value : index_size == 2 ? value * 200 : value * 100000;
+			REQUIRE(indices[i_index] == vertex_base + expected);
+		}
+	};
+
+	check_indices(gltf::ComponentType::UnsignedByte);
+	check_indices(gltf::ComponentType::UnsignedShort);
+	check_indices(gltf::ComponentType::UnsignedInt);
+}
+
+TEST_CASE("Decode glTF positions", "[gltf_accessors]")
+{
+	const u32 count = 9;
+
+	SECTION("Interleaved floats")
+	{
+		// position and normal
+		const usize stride = 6 * sizeof(float);
+		auto        buffer = Vec<u8>::with_length(count * stride);
+		for (u32 i_vertex = 0; i_vertex < count; i_vertex += 1) {
+			for (u32 i_component = 0; i_component < 6; i_component += 1) {
+				const float value = i_component < 3 ? float(i_vertex) + 0.25f * float(i_component) : -1.0f;
+				write_element(buffer, i_vertex * stride + i_component * sizeof(float), value);
+			}
+		}
+
+		const gltf::AccessorData src = {
+			.data           = buffer.data(),
+			.byte_stride    = stride,
+			.count          = count,
+			.component_type = gltf::ComponentType::Float,
+			.nb_component   = 3,
+		};
+		auto positions = Vec<float4>::with_length(count);
+		gltf::decode_positions(src, positions.data());
+
+		for (u32 i_vertex = 0; i_vertex < count; i_vertex += 1) {
+			REQUIRE(positions[i_vertex].x == float(i_vertex));
+			REQUIRE(positions[i_vertex].y == float(i_vertex) + 0.25f);
+			REQUIRE(positions[i_vertex].z == float(i_vertex) + 0.5f);
+			REQUIRE(positions[i_vertex].w == 1.0f);
+		}
+	}
+
+	SECTION("Normalized shorts")
+	{
+		const usize stride = 4 * sizeof(i16);
+		auto        buffer = Vec<u8>::with_length(count * stride);
+		for (u32 i_vertex = 0; i_vertex < count; i_vertex += 1) {
+			write_element(buffer, i_vertex * stride + 0, i16(32767));
+			write_element(buffer, i_vertex * stride + 2, i16(-32768));
+			write_element(buffer, i_vertex * stride + 4, i16(0));
+		}
+
+		const gltf::AccessorData src = {
+			.data           = buffer.data(),
+			.byte_stride    = stride,
+			.count          = count,
+			.component_type = gltf::ComponentType::Short,
+			.nb_component   = 3,
+			.normalized     = true,
+		};
+		auto positions = Vec<float4>::with_length(count);
+		gltf::decode_positions(src, positions.data());
+
+		for (u32 i_vertex = 0; i_vertex < count; i_vertex += 1) {
+			REQUIRE(positions[i_vertex].x == 1.0f);
+			REQUIRE(positions[i_vertex].y == -1.0f);
+			REQUIRE(positions[i_vertex].z == 0.0f);
+			REQUIRE(positions[i_vertex].w == 1.0f);
+		}
+	}
+}
+
+TEST_CASE("Decode glTF uvs", "[gltf_accessors]")
+{
+	const u32 count = 11;
+
+	SECTION("Normalized unsigned shorts")
+	{
+		auto buffer = Vec<u8>::with_length(count * 2 * sizeof(u16));
+		for (u32 i_component = 0; i_component < 2 * count; i_component += 1) {
+			write_element(buffer, i_component * sizeof(u16), u16(i_component * 3000));
+		}
+
+		const gltf::AccessorData src = {
+			.data           = buffer.data(),
+			.byte_stride    = 2 * sizeof(u16),
+			.count          = count,
+			.component_type = gltf::ComponentType::UnsignedShort,
+			.nb_component   = 2,
+			.normalized     = true,
+		};
+		auto uvs = Vec<float2>::with_length(count);
+		gltf::decode_uvs(src, uvs.data());
+
+		// Same values as the component by component conversion
+		const auto type = gltf::ComponentType::UnsignedShort;
+		for (u32 i_uv = 0; i_uv < count; i_uv += 1) {
+			const float u = gltf::read_component(buffer.data() + 4 * i_uv, type, true);
+			const float v = gltf::read_component(buffer.data() + 4 * i_uv + 2, type, true);
+			REQUIRE(std::abs(uvs[i_uv].x - u) < 1e-6f);
+			REQUIRE(std::abs(uvs[i_uv].y - v) < 1e-6f);
+		}
+		REQUIRE(uvs[0].x == 0.0f);
+	}
+
+	SECTION("Interleaved floats")
+	{
+		const usize stride = 3 * sizeof(float);
+		auto        buffer = Vec<u8>::with_length(count * stride);
+		for (u32 i_uv = 0; i_uv < count; i_uv += 1) {
+			write_element(buffer, i_uv * stride + 0, float(i_uv));
+			write_element(buffer, i_uv * stride + 4, -float(i_uv));
+			write_element(buffer, i_uv * stride + 8, 42.0f);
+		}
+
+		const gltf::AccessorData src = {
+			.data           = buffer.data(),
+			.byte_stride    = stride,
+			.count          = count,
+			.component_type = gltf::ComponentType::Float,
+			.nb_component   = 2,
+		};
+		auto uvs = Vec<float2>::with_length(count);
+		gltf::decode_uvs(src, uvs.data());
+
+		for (u32 i_uv = 0; i_uv < count; i_uv += 1) {
+			REQUIRE(uvs[i_uv].x == float(i_uv));
+			REQUIRE(uvs[i_uv].y == -float(i_uv));
+		}
+	}
+}
@@ -0,0 +1,122 @@
+#include "assets/hash_file.h"
+#include <catch2/catch_test_macros.hpp>
+#include <cstdio>
+#include <filesystem>
+
+namespace
+{
+Vec<u8> make_content(usize size)
+{
+	auto content = Vec<u8>::with_length(size);
+	u32  state   = 0x12345678;
+	for (auto &byte : content) {
+		state = state * 1664525u + 1013904223u;
+		byte  = u8(state >> 24);
+	}
+	return content;
+}
+
+bool is_same_hash(exo::u128 lhs, exo::u128 rhs) { return _mm_test_all_ones(_mm_cmpeq_epi8(lhs, rhs)) != 0; }
+
+std::string write_temp_file(const char *name, exo::Span<const u8> content)
+{
+	const auto path = (std::filesystem::temp_directory_path() / name).string();
+	std::FILE *file = std::fopen(path.c_str(), "wb");
+	REQUIRE(file != nullptr);
+	REQUIRE(std::fwrite(content.data(), 1, content.len(), file) == content.len());
+	std::fclose(file);
+	return path;
+}
+} // namespace
+
+TEST_CASE("Chunked file hash", "[hash_file]")
+{
+	const auto content = make_content(assets::CHUNKED_HASH_MIN_SIZE + assets::HASH_CHUNK_SIZE / 2);
+
+	Vec<assets::HashChunk> chunks;
+	assets::split_hash_chunks(content, chunks);
+	REQUIRE(chunks.len() == 5);
+	REQUIRE(chunks.last().content.len() == assets::HASH_CHUNK_SIZE / 2);
+
+	// The chunks can be hashed in any order
+	Vec<exo::u128> chunk_hashes;
+	for (usize i_chunk = chunks.len(); i_chunk > 0; --i_chunk) {
+		assets::hash_chunk(chunks[i_chunk - 1]);
+	}
+	for (const auto &chunk : chunks) {
+		chunk_hashes.push(chunk.hash);
+	}
+
+	const auto hash = assets::hash_file128(content);
+	REQUIRE(is_same_hash(assets::combine_chunk_hashes(chunk_hashes, content.len()), hash));
+	REQUIRE(assets::hash_file64(content) == assets::to_hash64(hash));
+
+	// A change in any chunk changes the file hash
+	auto modified = make_content(content.len());
+	modified[3 * assets::HASH_CHUNK_SIZE + 17] ^= 1;
+	REQUIRE(!is_same_hash(assets::hash_file128(modified), hash));
+}
+
+TEST_CASE("Streamed file hash", "[hash_file]")
+{
+	SECTION("Small file")
+	{
+		const auto content = make_content(1000);
+		const auto path    = write_temp_file("hash_file_small.bin", content);
+		const auto hash    = assets::hash_file64_streamed(exo::StringView{path.c_str(), path.size()});
+		REQUIRE(hash.has_value());
+		REQUIRE(*hash == assets::hash_file64(content));
+		std::filesystem::remove(path);
+	}
+
+	SECTION("Chunked file")
+	{
+		const auto content = make_content(assets::CHUNKED_HASH_MIN_SIZE + 3);
+		const auto path    = write_temp_file("hash_file_large.bin", content);
+		const auto hash    = assets::hash_file128_streamed(exo::StringView{path.c_str(), path.size()});
+		REQUIRE(hash.has_value());
+		REQUIRE(is_same_hash(*hash, assets::hash_file128(content)));
+		std::filesystem::remove(path);
+	}
+
+	REQUIRE(!assets::hash_file64_streamed(exo::StringView{"missing_hash_file.bin"}).has_value());
+}
+
+TEST_CASE("XXH3 file hash", "[hash_file]")
+{
+	// The fallback of CPUs without AES-NI is tested on every machine
+	const auto cpu_algorithm = assets::get_hash_algorithm();
+	const auto content       = make_content(assets::CHUNKED_HASH_MIN_SIZE + 3);
+	const auto cpu_hash      = assets::hash_file128(content);
+	const auto small         = make_content(1000);
+	const auto cpu_small     = assets::hash_file128(small);
+
+	assets::set_hash_algorithm(assets::HashAlgorithm::XXH3);
+	REQUIRE(assets::get_hash_algorithm() == assets::HashAlgorithm::XXH3);
+
+	const auto hash = assets::hash_file128(content);
+	REQUIRE(is_same_hash(hash, assets::hash_file128(content)));
+	if (cpu_algorithm == assets::HashAlgorithm::Meow) {
+		REQUIRE(!is_same_hash(hash, cpu_hash));
+		REQUIRE(!is_same_hash(assets::hash_file128(small), cpu_small));
+	}
+
+	// The chunked and streamed variants use the same algorithm
+	Vec<assets::HashChunk> chunks;
+	assets::split_hash_chunks(content, chunks);
+	Vec<exo::u128> chunk_hashes;
+	for (auto &chunk : chunks) {
+		assets::hash_chunk(chunk);
+		chunk_hashes.push(chunk.hash);
+	}
+	REQUIRE(is_same_hash(assets::combine_chunk_hashes(chunk_hashes, content.len()), hash));
+
+	const auto path     = write_temp_file("hash_file_xxh3.bin", content);
+	const auto streamed = assets::hash_file128_streamed(exo::StringView{path.c_str(), path.size()});
+	REQUIRE(streamed.has_value());
+	REQUIRE(is_same_hash(*streamed, hash));
+	std::filesystem::remove(path);
+
+	assets::set_hash_algorithm(cpu_algorithm);
+	REQUIRE(is_same_hash(assets::hash_file128(content), cpu_hash));
+}
@@ -0,0 +1,252 @@
+#include "assets/image_ops.h"
+#include "exo/collections/vector.h"
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// Odd sizes, the vectorized loops and their scalar tails are both tested
+Vec<u8> make_bytes(usize count)
+{
+	auto bytes = Vec<u8>::with_length(count);
+	u32  state = 0x12345678;
+	for (auto &byte : bytes) {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		byte = u8(state >> 11);
+	}
+	return bytes;
+}
+
+u8 reference_linear_to_srgb(float value)
+{
+	const float c    = std::clamp(value, 0.0f, 1.0f);
+	const float srgb = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+	return u8(std::clamp(srgb, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+float reference_triangle_weight(i32 texel, u32 i_dst, u32 src_size, u32 dst_size)
+{
+	const double scale  = double(src_size) / double(dst_size);
+	const double radius = std::max(1.0, scale);
+	const double center = (double(i_dst) + 0.5) * scale - 0.5;
+	return float(std::max(0.0, 1.0 - std::abs(double(texel) - center) / radius));
+}
+} // namespace
+
+TEST_CASE("Expand RGB to RGBA", "[image_ops]")
+{
+	const usize texel_count = 37;
+	const auto  rgb         = make_bytes(3 * texel_count);
+	auto        rgba        = Vec<u8>::with_length(4 * texel_count);
+	expand_rgb_to_rgba(rgb, rgba, 200);
+
+	for (usize i_texel = 0; i_texel < texel_count; i_texel += 1) {
+		REQUIRE(rgba[4 * i_texel + 0] == rgb[3 * i_texel + 0]);
+		REQUIRE(rgba[4 * i_texel + 1] == rgb[3 * i_texel + 1]);
+		REQUIRE(rgba[4 * i_texel + 2] == rgb[3 * i_texel + 2]);
+		REQUIRE(rgba[4 * i_texel + 3] == 200);
+	}
+}
+
+TEST_CASE("Swizzle RGBA", "[image_ops]")
+{
+	const auto src = make_bytes(4 * 19);
+	auto       dst = Vec<u8>::with_length(src.len());
+
+	const ChannelSwizzle bgra = {.sources = {2, 1, 0, 3}};
+	swizzle_rgba(src, dst, bgra);
+	for (usize i_byte = 0; i_byte < src.len(); i_byte += 4) {
+		REQUIRE(dst[i_byte + 0] == src[i_byte + 2]);
+		REQUIRE(dst[i_byte + 1] == src[i_byte + 1]);
+		REQUIRE(dst[i_byte + 2] == src[i_byte + 0]);
+		REQUIRE(dst[i_byte + 3] == src[i_byte + 3]);
+	}
+
+	// In place, swapping twice gives the original image back
+	swizzle_rgba(dst, dst, bgra);
+	REQUIRE(std::equal(dst.begin(), dst.end(), src.begin()));
+
+	const ChannelSwizzle broadcast_red = {.sources = {0, 0, 0, 0}};
+	swizzle_rgba(src, dst, broadcast_red);
+	for (usize i_byte = 0; i_byte < src.len(); i_byte += 4) {
+		REQUIRE(dst[i_byte + 3] == src[i_byte]);
+	}
+}
+
+TEST_CASE("sRGB conversions", "[image_ops]")
+{
+	SECTION("Decoding matches the exact conversion")
+	{
+		const auto rgba   = make_bytes(4 * 21);
+		auto       linear = Vec<float>::with_length(rgba.len());
+		srgb_to_linear_rgba(rgba, linear);
+		for (usize i_value = 0; i_value < rgba.len(); i_value += 1) {
+			const float c        = float(rgba[i_value]) / 255.0f;
+			float       expected = c;
+			if (i_value % 4 != 3) {
+				expected = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+			}
+			REQUIRE(std::abs(linear[i_value] - expected) < 1e-6f);
+		}
+	}
+
+	SECTION("Encoding is within one step of the exact conversion")
+	{
+		// Every value of a fine ramp, with values out of range
+		const usize value_count = 4 * 4099;
+		auto        linear      = Vec<float>::with_length(value_count);
+		for (usize i_value = 0; i_value < value_count; i_value += 1) {
+			linear[i_value] = float(i_value) / float(value_count - 64) - 0.001f;
+		}
+
+		auto rgba = Vec<u8>::with_length(value_count);
+		linear_to_srgb_rgba(linear, rgba);
+		for (usize i_value = 0; i_value < value_count; i_value += 1) {
+			if (i_value % 4 == 3) {
+				const float alpha = std::clamp(linear[i_value], 0.0f, 1.0f);
+				REQUIRE(rgba[i_value] == u8(alpha * 255.0f + 0.5f));
+			} else {
+				REQUIRE(std::abs(i32(rgba[i_value]) - i32(reference_linear_to_srgb(linear[i_value]))) <= 1);
+			}
+		}
+
+		// The ends of the range are exact
+		const float extremes[8] = {0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f};
+		u8          encoded[8]  = {};
+		linear_to_srgb_rgba(exo::Span<const float>(extremes, 8), exo::Span<u8>(encoded, 8));
+		REQUIRE(encoded[0] == 0);
+		REQUIRE(encoded[4] == 255);
+	}
+}
+
+TEST_CASE("Premultiply alpha", "[image_ops]")
+{
+	const auto original = make_bytes(4 * 23);
+	auto       rgba     = make_bytes(original.len());
+	premultiply_alpha(rgba);
+
+	for (usize i_byte = 0; i_byte < rgba.len(); i_byte += 4) {
+		const u32 alpha = original[i_byte + 3];
+		for (u32 i_channel = 0; i_channel < 3; i_channel += 1) {
+			const double expected = std::round(double(original[i_byte + i_channel]) * alpha / 255.0);
+			REQUIRE(rgba[i_byte + i_channel] == u8(expected));
+		}
+		REQUIRE(rgba[i_byte + 3] == alpha);
+	}
+}
+
+TEST_CASE("16 to 8 bits conversion", "[image_ops]")
+{
+	const u32 width    = 13;
+	const u32 height   = 6;
+	const u32 channels = 3;
+	auto      src      = Vec<u16>::with_length(usize(width) * height * channels);
+	for (usize i_value = 0; i_value < src.len(); i_value += 1) {
+		src[i_value] = u16((i_value * 2654435761u) >> 16);
+	}
+	src[0] = 0;
+	src[1] = 65535;
+
+	auto dst = Vec<u8>::with_length(src.len());
+
+	SECTION("Values are rounded without dithering")
+	{
+		convert_16_to_8_bits(src, dst, width, height, channels, false);
+		for (usize i_value = 0; i_value < src.len(); i_value += 1) {
+			const double expected = std::floor(double(src[i_value]) * 255.0 / 65535.0 + 0.5);
+			REQUIRE(dst[i_value] == u8(expected));
+		}
+		REQUIRE(dst[0] == 0);
+		REQUIRE(dst[1] == 255);
+	}
+
+	SECTION("Dithering adds an ordered threshold")
+	{
+		const u32 bayer[4][4] = {{0, 8, 2, 10}, {12, 4, 14, 6}, {3, 11, 1, 9}, {15, 7, 13, 5}};
+		convert_16_to_8_bits(src, dst, width, height, channels, true);
+		for (u32 y = 0; y < height; y += 1) {
+			for (u32 x = 0; x < width; x += 1) {
+				const double threshold = std::floor((2.0 * bayer[y % 4][x % 4] + 1.0) * 65535.0 / 32.0) / 65535.0;
+				for (u32 i_channel = 0; i_channel < channels; i_channel += 1) {
+					const usize  i_value  = (usize(y) * width + x) * channels + i_channel;
+					const double expected = std::floor(double(src[i_value]) * 255.0 / 65535.0 + threshold);
+					REQUIRE(dst[i_value] == u8(expected));
+				}
+			}
+		}
+	}
+
+	SECTION("Dithering keeps the average of a flat area")
+	{
+		// 1/3 of a step above 100, a third of the texels round up
+		const u16 value = u16((100.0 + 1.0 / 3.0) * 65535.0 / 255.0);
+		auto      flat  = Vec<u16>::with_values(16 * 16, value);
+		auto      out   = Vec<u8>::with_length(flat.len());
+		convert_16_to_8_bits(flat, out, 16, 16, 1, true);
+
+		double sum = 0.0;
+		for (const u8 byte : out) {
+			REQUIRE((byte == 100 || byte == 101));
+			sum += byte;
+		}
+		REQUIRE(std::abs(sum / double(out.len()) - (100.0 + 1.0 / 3.0)) < 0.05);
+	}
+}
+
+TEST_CASE("Resize RGBA", "[image_ops]")
+{
+	struct Size
+	{
+		u32 src_width;
+		u32 src_height;
+		u32 dst_width;
+		u32 dst_height;
+	};
+	const Size sizes[] = {{37, 23, 16, 11}, {5, 3, 12, 7}, {8, 8, 8, 8}, {9, 1, 2, 1}};
+
+	for (const auto &size : sizes) {
+		const auto bytes = make_bytes(4 * usize(size.src_width) * size.src_height);
+		auto       src   = Vec<float>::with_length(bytes.len());
+		for (usize i_value = 0; i_value < bytes.len(); i_value += 1) {
+			src[i_value] = float(bytes[i_value]) / 255.0f;
+		}
+
+		auto dst = Vec<float>::with_length(4 * usize(size.dst_width) * size.dst_height);
+		resize_rgba(src, size.src_width, size.src_height, dst, size.dst_width, size.dst_height);
+
+		// Direct evaluation of the separable filter over the whole source image
+		for (u32 y = 0; y < size.dst_height; y += 1) {
+			for (u32 x = 0; x < size.dst_width; x += 1) {
+				double expected[4] = {};
+				double total_x     = 0.0;
+				double total_y     = 0.0;
+				for (i32 sx = -8; sx < i32(size.src_width) + 8; sx += 1) {
+					total_x += reference_triangle_weight(sx, x, size.src_width, size.dst_width);
+				}
+				for (i32 sy = -8; sy < i32(size.src_height) + 8; sy += 1) {
+					total_y += reference_triangle_weight(sy, y, size.src_height, size.dst_height);
+				}
+				for (i32 sy = -8; sy < i32(size.src_height) + 8; sy += 1) {
+					const double wy = reference_triangle_weight(sy, y, size.src_height, size.dst_height) / total_y;
+					const usize  row = usize(std::clamp(sy, 0, i32(size.src_height) - 1));
+					for (i32 sx = -8; sx < i32(size.src_width) + 8; sx += 1) {
+						const double wx = reference_triangle_weight(sx, x, size.src_width, size.dst_width) / total_x;
+						const usize  column = usize(std::clamp(sx, 0, i32(size.src_width) - 1));
+						for (u32 i_channel = 0; i_channel < 4; i_channel += 1) {
+							expected[i_channel] += wx * wy * src[4 * (row * size.src_width + column) + i_channel];
+						}
+					}
+				}
+
+				for (u32 i_channel = 0; i_channel < 4; i_channel += 1) {
+					const float value = dst[4 * (usize(y) * size.dst_width + x) + i_channel];
+					REQUIRE(std::abs(double(value) - expected[i_channel]) < 1e-5);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,41 @@
+#include "assets/mesh.h"
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("Mesh LOD selection", "[mesh]")
+{
+	Mesh mesh = {};
+	mesh.submeshes.push(SubMesh{.first_index = 0, .first_vertex = 0, .index_count = 300});
+	mesh.submeshes.push(SubMesh{.first_index = 300, .first_vertex = 100, .index_count = 60});
+
+	SECTION("A mesh without LODs always uses the submeshes")
+	{
+		REQUIRE(mesh.get_lod_count() == 1);
+		REQUIRE(mesh.select_lod(1000.0f) == 0);
+		REQUIRE(mesh.get_submesh_lod(1, 0) == MeshLod{.first_index = 300, .index_count = 60});
+	}
+
+	SECTION("The coarsest LOD below the error is selected")
+	{
+		mesh.lod_errors.push(0.0f);
+		mesh.lod_errors.push(0.1f);
+		mesh.lod_errors.push(0.5f);
+		// submesh 0
+		mesh.lods.push(MeshLod{.first_index = 0, .index_count = 300});
+		mesh.lods.push(MeshLod{.first_index = 360, .index_count = 150});
+		mesh.lods.push(MeshLod{.first_index = 510, .index_count = 75});
+		// submesh 1, cannot be simplified past LOD 1
+		mesh.lods.push(MeshLod{.first_index = 300, .index_count = 60});
+		mesh.lods.push(MeshLod{.first_index = 585, .index_count = 30});
+		mesh.lods.push(MeshLod{.first_index = 585, .index_count = 30});
+
+		REQUIRE(mesh.get_lod_count() == 3);
+		REQUIRE(mesh.select_lod(0.0f) == 0);
+		REQUIRE(mesh.select_lod(0.05f) == 0);
+		REQUIRE(mesh.select_lod(0.1f) == 1);
+		REQUIRE(mesh.select_lod(0.4f) == 1);
+		REQUIRE(mesh.select_lod(10.0f) == 2);
+
+		REQUIRE(mesh.get_submesh_lod(0, 2) == MeshLod{.first_index = 510, .index_count = 75});
+		REQUIRE(mesh.get_submesh_lod(1, 1) == MeshLod{.first_index = 585, .index_count = 30});
+	}
+}
@@ -0,0 +1,179 @@
+#include "assets/meshlet.h"
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+
+// A grid of `size` x `size` quads in the plane z = `depth`, facing +Z
+static void create_grid(u32 size, float depth, Vec<float4> &out_positions, Vec<u32> &out_indices)
+{
+	for (u32 y = 0; y <= size; y += 1) {
+		for (u32 x = 0; x <= size; x += 1) {
+			const float2 uv = float2(float(x), float(y)) / float(size);
+			out_positions.push(float4(2.0f * uv.x - 1.0f, 2.0f * uv.y - 1.0f, depth, 1.0f));
+		}
+	}
+
+	for (u32 y = 0; y < size; y += 1) {
+		for (u32 x = 0; x < size; x += 1) {
+			const u32 i0 = y * (size + 1) + x;
+			const u32 i1 = i0 + 1;
+			const u32 i2 = i0 + size + 1;
+			const u32 i3 = i2 + 1;
+			out_indices.push(i0);
+			out_indices.push(i1);
+			out_indices.push(i3);
+			out_indices.push(i0);
+			out_indices.push(i3);
+			out_indices.push(i2);
+		}
+	}
+}
+
+// Same conventions as the engine camera: reverse-Z in [0, w]
+static float4x4 create_projection(float near_plane, float far_plane)
+{
+	const float A = near_plane / (far_plane - near_plane);
+	const float B = far_plane * A;
+	// clang-format off
+	return float4x4({
+		1.0f, 0.0f,  0.0f, 0.0f,
+		0.0f, -1.0f, 0.0f, 0.0f,
+		0.0f, 0.0f,  A,    B,
+		0.0f, 0.0f,  -1.0f, 0.0f,
+	});
+	// clang-format on
+}
+
+// Camera at (0, 0, `z`) looking toward +Z
+static float4x4 create_view_looking_backward(float z)
+{
+	// clang-format off
+	return float4x4({
+		-1.0f, 0.0f, 0.0f,  0.0f,
+		0.0f,  1.0f, 0.0f,  0.0f,
+		0.0f,  0.0f, -1.0f, z,
+		0.0f,  0.0f, 0.0f,  1.0f,
+	});
+	// clang-format on
+}
+
+static bool is_inside_sphere(float3 p, const MeshletBounds &bounds)
+{
+	return length(p - bounds.center) <= bounds.radius + 1e-4f;
+}
+
+TEST_CASE("Meshlets cover every triangle once", "[meshlet]")
+{
+	Vec<float4> positions;
+	Vec<u32>    indices;
+	create_grid(16, -5.0f, positions, indices);
+
+	const u32   vertex_base = 100;
+	MeshletData data        = {};
+	build_meshlets(positions, indices, vertex_base, data);
+
+	REQUIRE(data.meshlets.len() > 1);
+	REQUIRE(data.meshlets.len() == data.bounds.len());
+
+	// Each triangle is identified by its sorted vertex indices
+	auto triangle_key = [&](u32 a, u32 b, u32 c) {
+		u32 v[3] = {a, b, c};
+		std::sort(v, v + 3);
+		return (u64(v[0]) * positions.len() + v[1]) * positions.len() + v[2];
+	};
+
+	Vec<u64> expected_triangles;
+	for (usize i_index = 0; i_index < indices.len(); i_index += 3) {
+		expected_triangles.push(triangle_key(indices[i_index], indices[i_index + 1], indices[i_index + 2]));
+	}
+
+	Vec<u64> meshlet_triangles;
+	for (usize i_meshlet = 0; i_meshlet < data.meshlets.len(); i_meshlet += 1) {
+		const auto &meshlet = data.meshlets[i_meshlet];
+		REQUIRE(meshlet.vertex_count <= MESHLET_MAX_VERTICES);
+		REQUIRE(meshlet.triangle_count <= MESHLET_MAX_TRIANGLES);
+		REQUIRE(meshlet.triangle_offset % 4 == 0);
+
+		for (u32 i_triangle = 0; i_triangle < meshlet.triangle_count; i_triangle += 1) {
+			u32 vertices[3] = {};
+			for (u32 i_corner = 0; i_corner < 3; i_corner += 1) {
+				const u8 i_local = data.triangles[meshlet.triangle_offset + 3 * i_triangle + i_corner];
+				REQUIRE(i_local < meshlet.vertex_count);
+				vertices[i_corner] = data.vertices[meshlet.vertex_offset + i_local];
+				REQUIRE(vertices[i_corner] >= vertex_base);
+				vertices[i_corner] -= vertex_base;
+
+				REQUIRE(is_inside_sphere(positions[vertices[i_corner]].xyz(), data.bounds[i_meshlet]));
+			}
+			meshlet_triangles.push(triangle_key(vertices[0], vertices[1], vertices[2]));
+		}
+	}
+
+	std::sort(expected_triangles.begin(), expected_triangles.end());
+	std::sort(meshlet_triangles.begin(), meshlet_triangles.end());
+	REQUIRE(meshlet_triangles.len() == expected_triangles.len());
+	for (usize i_triangle = 0; i_triangle < expected_triangles.len(); i_triangle += 1) {
+		REQUIRE(meshlet_triangles[i_triangle] == expected_triangles[i_triangle]);
+	}
+}
+
+TEST_CASE("Meshlet culling", "[meshlet]")
+{
+	Vec<float4> positions;
+	Vec<u32>    indices;
+	create_grid(16, -5.0f, positions, indices);
+
+	MeshletData data = {};
+	build_meshlets(positions, indices, 0, data);
+	const u32 meshlets_count = u32(data.meshlets.len());
+
+	const float4x4 projection = create_projection(0.1f, 100.0f);
+	Vec<u32>       visible;
+
+	SECTION("Camera facing the grid sees every meshlet")
+	{
+		auto view = MeshletCullingView::create(float4x4::identity(), float4x4::identity(), projection, float3(0.0f));
+		REQUIRE(view.planes_count == 6);
+		cull_meshlets(view, data.bounds, 0, meshlets_count, visible);
+		REQUIRE(visible.len() == meshlets_count);
+	}
+
+	SECTION("Camera looking away sees nothing")
+	{
+		auto view = MeshletCullingView::create(
+			float4x4::identity(), create_view_looking_backward(0.0f), projection, float3(0.0f));
+		cull_meshlets(view, data.bounds, 0, meshlets_count, visible);
+		REQUIRE(visible.is_empty());
+	}
+
+	SECTION("Camera behind the grid culls backfacing meshlets")
+	{
+		auto view = MeshletCullingView::create(
+			float4x4::identity(), create_view_looking_backward(-10.0f), projection, float3(0.0f, 0.0f, -10.0f));
+		cull_meshlets(view, data.bounds, 0, meshlets_count, visible);
+		REQUIRE(visible.is_empty());
+
+		view.backface_culling = false;
+		cull_meshlets(view, data.bounds, 0, meshlets_count, visible);
+		REQUIRE(visible.len() == meshlets_count);
+	}
+
+	SECTION("Culling happens in the object space of the mesh")
+	{
+		// The grid is moved behind the camera
+		float4x4 world_transform = float4x4::identity();
+		world_transform.at(2, 3) = 10.0f;
+
+		auto view = MeshletCullingView::create(world_transform, float4x4::identity(), projection, float3(0.0f));
+		cull_meshlets(view, data.bounds, 0, meshlets_count, visible);
+		REQUIRE(visible.is_empty());
+	}
+
+	SECTION("Only the requested range is tested")
+	{
+		auto view = MeshletCullingView::create(float4x4::identity(), float4x4::identity(), projection, float3(0.0f));
+		cull_meshlets(view, data.bounds, 1, meshlets_count - 1, visible);
+		REQUIRE(visible.len() == meshlets_count - 1);
+		REQUIRE(visible[0] == 1);
+	}
+}
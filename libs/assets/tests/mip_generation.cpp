@@ -0,0 +1,146 @@
+#include "assets/mip_generation.h"
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("Mip chain layout", "[mip_generation]")
+{
+	REQUIRE(get_mip_count(1, 1) == 1);
+	REQUIRE(get_mip_count(256, 256) == 9);
+	REQUIRE(get_mip_count(5, 3) == 3);
+
+	// 5x3 -> 2x1 -> 1x1, every level starts on a 4 bytes boundary
+	const auto pixels = Vec<u8>::with_length(5 * 3 * 3);
+
+	Vec<usize> mip_offsets;
+	const auto mip_chain = generate_mip_chain(pixels, 5, 3, 3, {}, mip_offsets);
+	REQUIRE(mip_offsets.len() == 3);
+	REQUIRE(mip_offsets[0] == 0);
+	REQUIRE(mip_offsets[1] == 48);
+	REQUIRE(mip_offsets[2] == 56);
+	REQUIRE(mip_chain.len() == 59);
+}
+
+TEST_CASE("Mip filtering", "[mip_generation]")
+{
+	// A black and white checkerboard
+	Vec<u8> pixels = Vec<u8>::with_length(4 * 4 * 4);
+	for (u32 i_texel = 0; i_texel < 16; i_texel += 1) {
+		const u8 value = ((i_texel % 4) + (i_texel / 4)) % 2 == 0 ? 0 : 255;
+		for (u32 i_channel = 0; i_channel < 4; i_channel += 1) {
+			pixels[4 * i_texel + i_channel] = value;
+		}
+	}
+
+	SECTION("Colors are averaged in linear space")
+	{
+		Vec<usize> mip_offsets;
+		const auto mip_chain =
+			generate_mip_chain(pixels, 4, 4, 4, {.preserve_alpha_coverage = false}, mip_offsets);
+		REQUIRE(mip_offsets.len() == 3);
+
+		for (usize i_level = 1; i_level < mip_offsets.len(); i_level += 1) {
+			const u8 *texel = mip_chain.data() + mip_offsets[i_level];
+			// 0.5 in linear space is 188 in sRGB, alpha is linear
+			REQUIRE(texel[0] == 188);
+			REQUIRE(texel[1] == 188);
+			REQUIRE(texel[2] == 188);
+			REQUIRE(texel[3] == 128);
+		}
+	}
+
+	SECTION("Linear images are averaged directly")
+	{
+		Vec<usize> mip_offsets;
+		const auto mip_chain =
+			generate_mip_chain(pixels, 4, 4, 4, {.srgb = false, .preserve_alpha_coverage = false}, mip_offsets);
+		const u8  *texel = mip_chain.data() + mip_offsets[1];
+		REQUIRE(texel[0] == 128);
+		REQUIRE(texel[3] == 128);
+	}
+}
+
+TEST_CASE("Mip alpha coverage", "[mip_generation]")
+{
+	// A cutout with scattered opaque texels, like foliage, box filtering blurs them under the cutoff
+	const u32 size   = 64;
+	Vec<u8>   pixels = Vec<u8>::with_length(size * size * 4);
+	u32       state  = 0x12345678;
+	for (u32 i_texel = 0; i_texel < size * size; i_texel += 1) {
+		// xorshift32
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+
+		u8 *texel = pixels.data() + 4 * i_texel;
+		texel[0]  = 255;
+		texel[1]  = 255;
+		texel[2]  = 255;
+		texel[3]  = (state >> 8) % 10 < 3 ? 255 : 0;
+	}
+
+	const float coverage = compute_alpha_coverage(pixels, 0.5f);
+	REQUIRE(coverage > 0.25f);
+	REQUIRE(coverage < 0.35f);
+
+	auto level_coverage = [&](const Vec<u8> &mip_chain, const Vec<usize> &mip_offsets, u32 i_level) {
+		const u32 level_size = size >> i_level;
+		const u8 *level      = mip_chain.data() + mip_offsets[i_level];
+		return compute_alpha_coverage(exo::Span<const u8>(level, level_size * level_size * 4), 0.5f);
+	};
+
+	SECTION("Without preservation")
+	{
+		Vec<usize> mip_offsets;
+		const auto mip_chain =
+			generate_mip_chain(pixels, size, size, 4, {.preserve_alpha_coverage = false}, mip_offsets);
+		REQUIRE(level_coverage(mip_chain, mip_offsets, 3) < 0.5f * coverage);
+	}
+
+	SECTION("With preservation")
+	{
+		Vec<usize> mip_offsets;
+		const auto mip_chain = generate_mip_chain(pixels, size, size, 4, {}, mip_offsets);
+		for (u32 i_level = 1; i_level < 5; i_level += 1) {
+			const float level_coverage_error = level_coverage(mip_chain, mip_offsets, i_level) - coverage;
+			REQUIRE(level_coverage_error * level_coverage_error < 0.1f * 0.1f);
+		}
+	}
+}
+
+TEST_CASE("Mip filtering of linear RGBA images", "[mip_generation]")
+{
+	// Linear RGBA images are filtered with SSE, each channel must match the scalar path of a single channel image
+	const u32 width  = 13;
+	const u32 height = 7;
+	auto      pixels = Vec<u8>::with_length(usize(width) * height * 4);
+	u32       state  = 0x2545F491;
+	for (auto &value : pixels) {
+		state = state * 1664525u + 1013904223u;
+		value = u8(state >> 24);
+	}
+
+	const MipGenerationSettings settings = {.srgb = false, .preserve_alpha_coverage = false};
+	Vec<usize>                  mip_offsets;
+	const auto                  mip_chain = generate_mip_chain(pixels, width, height, 4, settings, mip_offsets);
+
+	for (u32 i_channel = 0; i_channel < 4; i_channel += 1) {
+		auto channel_pixels = Vec<u8>::with_length(usize(width) * height);
+		for (usize i_texel = 0; i_texel < channel_pixels.len(); i_texel += 1) {
+			channel_pixels[i_texel] = pixels[4 * i_texel + i_channel];
+		}
+
+		Vec<usize> channel_offsets;
+		const auto channel_chain = generate_mip_chain(channel_pixels, width, height, 1, settings, channel_offsets);
+		REQUIRE(channel_offsets.len() == mip_offsets.len());
+
+		bool is_same = true;
+		for (usize i_level = 1; i_level < mip_offsets.len(); i_level += 1) {
+			const usize texel_count = usize(std::max(1u, width >> i_level)) * std::max(1u, height >> i_level);
+			for (usize i_texel = 0; i_texel < texel_count; i_texel += 1) {
+				const u8 rgba   = mip_chain[mip_offsets[i_level] + 4 * i_texel + i_channel];
+				const u8 single = channel_chain[channel_offsets[i_level] + i_texel];
+				is_same         = is_same && rgba == single;
+			}
+		}
+		REQUIRE(is_same);
+	}
+}
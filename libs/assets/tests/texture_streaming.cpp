@@ -0,0 +1,272 @@
+#include "assets/texture_streaming.h"
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+// Records the residency changes instead of uploading anything
+struct FakeUploader final : TextureResidencyUploader
+{
+	Vec<u32> uploaded_textures;
+	Vec<u32> uploaded_levels;
+	Vec<u32> kept_levels;
+	bool     accept = true;
+
+	bool set_resident_levels(u32 i_texture, u32 first_level, u32 resident_first_level) override
+	{
+		if (!this->accept) {
+			return false;
+		}
+		this->uploaded_textures.push(i_texture);
+		this->uploaded_levels.push(first_level);
+		this->kept_levels.push(resident_first_level);
+		return true;
+	}
+
+	void clear()
+	{
+		this->uploaded_textures.clear();
+		this->uploaded_levels.clear();
+		this->kept_levels.clear();
+	}
+};
+
+// Square RGBA8 texture with its full mip chain
+StreamedTextureDesc make_texture_desc(u32 size)
+{
+	StreamedTextureDesc desc = {.width = size, .height = size};
+	for (u32 level_size = size; level_size > 0; level_size /= 2) {
+		desc.level_sizes.push(usize(level_size) * level_size * 4);
+	}
+	return desc;
+}
+} // namespace
+
+TEST_CASE("Desired texture level", "[texture_streaming]")
+{
+	REQUIRE(compute_desired_level(1024, 1024, 11, 2048.0f) == 0);
+	REQUIRE(compute_desired_level(1024, 1024, 11, 1024.0f) == 0);
+	REQUIRE(compute_desired_level(1024, 1024, 11, 1000.0f) == 0);
+	REQUIRE(compute_desired_level(1024, 1024, 11, 512.0f) == 1);
+	REQUIRE(compute_desired_level(1024, 512, 11, 100.0f) == 3);
+	REQUIRE(compute_desired_level(1024, 1024, 11, 0.5f) == 10);
+	REQUIRE(compute_desired_level(1024, 1024, 11, 0.0f) == 10);
+}
+
+TEST_CASE("Texture tails are loaded first", "[texture_streaming]")
+{
+	TextureStreamer streamer;
+	streamer.settings.tail_max_dimension = 64;
+
+	const u32 i_texture0 = streamer.add_texture(make_texture_desc(1024));
+	const u32 i_texture1 = streamer.add_texture(make_texture_desc(32));
+	REQUIRE(streamer.textures[i_texture0].tail_first_level == 4);
+	REQUIRE(streamer.textures[i_texture1].tail_first_level == 0);
+	REQUIRE(!streamer.is_resident(i_texture0));
+
+	// The first frame only loads the tails, even for textures requested at full resolution
+	FakeUploader uploader;
+	streamer.request(i_texture0, 1024.0f);
+	streamer.update(uploader);
+	REQUIRE(uploader.uploaded_textures.len() == 2);
+	REQUIRE(uploader.uploaded_levels[0] == 4);
+	REQUIRE(uploader.uploaded_levels[1] == 0);
+	REQUIRE(streamer.is_resident(i_texture0));
+	REQUIRE(streamer.is_resident(i_texture1));
+	REQUIRE(streamer.resident_size == streamer.get_resident_size(i_texture0) + streamer.get_resident_size(i_texture1));
+
+	// Finer levels are then streamed in one at a time
+	for (u32 i_level = 4; i_level > 0; i_level -= 1) {
+		uploader.clear();
+		streamer.request(i_texture0, 1024.0f);
+		streamer.update(uploader);
+		REQUIRE(uploader.uploaded_textures.len() == 1);
+		REQUIRE(uploader.uploaded_levels[0] == i_level - 1);
+		REQUIRE(uploader.kept_levels[0] == i_level);
+	}
+	REQUIRE(streamer.textures[i_texture0].resident_first_level == 0);
+
+	// Nothing changes once the requested levels are resident
+	uploader.clear();
+	streamer.request(i_texture0, 1024.0f);
+	streamer.update(uploader);
+	REQUIRE(uploader.uploaded_textures.is_empty());
+}
+
+TEST_CASE("Texture streaming frame upload budget", "[texture_streaming]")
+{
+	TextureStreamer streamer;
+	streamer.settings.tail_max_dimension  = 64;
+	streamer.settings.frame_upload_budget = 150 * 1024;
+
+	for (u32 i_texture = 0; i_texture < 4; i_texture += 1) {
+		streamer.add_texture(make_texture_desc(256));
+	}
+
+	FakeUploader uploader;
+	streamer.update(uploader);
+	REQUIRE(uploader.uploaded_textures.len() == 4);
+
+	// Only the new levels are uploaded: level 1 of a 256x256 texture is 64KiB, two of them fit in a frame
+	uploader.clear();
+	for (u32 i_texture = 0; i_texture < 4; i_texture += 1) {
+		streamer.request(i_texture, 256.0f);
+	}
+	streamer.update(uploader);
+	REQUIRE(uploader.uploaded_textures.len() == 2);
+	REQUIRE(uploader.uploaded_textures[0] == 0);
+	REQUIRE(uploader.uploaded_textures[1] == 1);
+
+	// The textures the furthest from their requested level go first
+	uploader.clear();
+	for (u32 i_texture = 0; i_texture < 4; i_texture += 1) {
+		streamer.request(i_texture, 256.0f);
+	}
+	streamer.update(uploader);
+	REQUIRE(uploader.uploaded_textures.len() == 2);
+	REQUIRE(uploader.uploaded_textures[0] == 2);
+	REQUIRE(uploader.uploaded_textures[1] == 3);
+
+	// The first upload of a frame can go over the budget, a texture never waits forever
+	uploader.clear();
+	streamer.request(0, 256.0f);
+	streamer.update(uploader);
+	REQUIRE(uploader.uploaded_textures.len() == 1);
+	REQUIRE(uploader.uploaded_levels[0] == 0);
+
+	// Refused uploads are requested again the next frame
+	uploader.clear();
+	uploader.accept = false;
+	streamer.request(1, 256.0f);
+	streamer.update(uploader);
+	REQUIRE(streamer.textures[1].resident_first_level == 1);
+
+	uploader.accept = true;
+	streamer.request(1, 256.0f);
+	streamer.update(uploader);
+	REQUIRE(streamer.textures[1].resident_first_level == 0);
+}
+
+TEST_CASE("Texture streaming memory budget", "[texture_streaming]")
+{
+	TextureStreamer streamer;
+	streamer.settings.tail_max_dimension  = 64;
+	streamer.settings.frame_upload_budget = 64_MiB;
+
+	const u32 i_texture0 = streamer.add_texture(make_texture_desc(128));
+	const u32 i_texture1 = streamer.add_texture(make_texture_desc(128));
+	const u32 i_texture2 = streamer.add_texture(make_texture_desc(128));
+	const usize tail_size = streamer.get_levels_size(i_texture0, 1);
+	const usize full_size = streamer.get_levels_size(i_texture0, 0);
+
+	// Room for the three tails and two full textures
+	streamer.settings.memory_budget = 2 * full_size + tail_size;
+
+	FakeUploader uploader;
+	streamer.update(uploader);
+	streamer.request(i_texture0, 128.0f);
+	streamer.request(i_texture1, 128.0f);
+	streamer.update(uploader);
+	REQUIRE(streamer.textures[i_texture0].resident_first_level == 0);
+	REQUIRE(streamer.textures[i_texture1].resident_first_level == 0);
+	REQUIRE(streamer.resident_size == streamer.settings.memory_budget);
+
+	SECTION("The least recently used texture is evicted")
+	{
+		streamer.request(i_texture1, 128.0f);
+		streamer.update(uploader);
+
+		uploader.clear();
+		streamer.request(i_texture1, 128.0f);
+		streamer.request(i_texture2, 128.0f);
+		streamer.update(uploader);
+		REQUIRE(streamer.textures[i_texture0].resident_first_level == 1);
+		REQUIRE(streamer.textures[i_texture1].resident_first_level == 0);
+		REQUIRE(streamer.textures[i_texture2].resident_first_level == 0);
+		REQUIRE(uploader.uploaded_textures.len() == 2);
+		REQUIRE(uploader.uploaded_textures[0] == i_texture0);
+		REQUIRE(uploader.uploaded_textures[1] == i_texture2);
+		// The evicted texture keeps its coarser levels
+		REQUIRE(uploader.kept_levels[0] == 0);
+	}
+
+	SECTION("Textures used this frame are kept")
+	{
+		uploader.clear();
+		streamer.request(i_texture0, 128.0f);
+		streamer.request(i_texture1, 128.0f);
+		streamer.request(i_texture2, 128.0f);
+		streamer.update(uploader);
+		REQUIRE(uploader.uploaded_textures.is_empty());
+		REQUIRE(streamer.textures[i_texture2].resident_first_level == 1);
+	}
+
+	SECTION("Levels finer than requested are evicted first")
+	{
+		uploader.clear();
+		streamer.request(i_texture0, 128.0f);
+		streamer.request(i_texture1, 32.0f);
+		streamer.request(i_texture2, 128.0f);
+		streamer.update(uploader);
+		REQUIRE(streamer.textures[i_texture0].resident_first_level == 0);
+		REQUIRE(streamer.textures[i_texture1].resident_first_level == 1);
+		REQUIRE(streamer.textures[i_texture2].resident_first_level == 0);
+		REQUIRE(streamer.resident_size <= streamer.settings.memory_budget);
+	}
+}
+
+TEST_CASE("Replaced textures stream their new levels", "[texture_streaming]")
+{
+	TextureStreamer streamer;
+	streamer.settings.tail_max_dimension = 64;
+
+	const u32 i_texture = streamer.add_texture(make_texture_desc(256));
+	FakeUploader uploader;
+	streamer.update(uploader);
+	streamer.request(i_texture, 256.0f);
+	streamer.update(uploader);
+	REQUIRE(streamer.textures[i_texture].resident_first_level == 1);
+
+	// The texture was imported again with a different size, its new tail is uploaded first
+	streamer.replace_texture(i_texture, make_texture_desc(1024));
+	REQUIRE(!streamer.is_resident(i_texture));
+	REQUIRE(streamer.resident_size == 0);
+	REQUIRE(streamer.textures[i_texture].tail_first_level == 4);
+
+	uploader.clear();
+	streamer.request(i_texture, 1024.0f);
+	streamer.update(uploader);
+	REQUIRE(uploader.uploaded_textures.len() == 1);
+	REQUIRE(uploader.uploaded_levels[0] == 4);
+	REQUIRE(uploader.kept_levels[0] == 11);
+	REQUIRE(streamer.resident_size == streamer.get_levels_size(i_texture, 4));
+
+	streamer.request(i_texture, 1024.0f);
+	streamer.update(uploader);
+	REQUIRE(streamer.textures[i_texture].resident_first_level == 3);
+}
+
+TEST_CASE("Removed textures are not streamed", "[texture_streaming]")
+{
+	TextureStreamer streamer;
+	streamer.settings.tail_max_dimension = 64;
+
+	const u32 i_texture0 = streamer.add_texture(make_texture_desc(256));
+	const u32 i_texture1 = streamer.add_texture(make_texture_desc(256));
+	FakeUploader uploader;
+	streamer.update(uploader);
+	REQUIRE(streamer.resident_size == 2 * streamer.get_levels_size(i_texture0, 2));
+
+	streamer.remove_texture(i_texture0);
+	REQUIRE(streamer.resident_size == streamer.get_resident_size(i_texture1));
+
+	uploader.clear();
+	streamer.request(i_texture1, 256.0f);
+	streamer.update(uploader);
+	REQUIRE(uploader.uploaded_textures.len() == 1);
+	REQUIRE(uploader.uploaded_textures[0] == i_texture1);
+
+	// The index of the removed texture is reused
+	REQUIRE(streamer.add_texture(make_texture_desc(128)) == i_texture0);
+	REQUIRE(!streamer.is_resident(i_texture0));
+	REQUIRE(streamer.textures[i_texture0].tail_first_level == 1);
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include "exo/maths/numerics.h"
+#include "exo/option.h"
+
+#include "exo/string_view.h"
+
+namespace cross
+{
+// Metadata of a file that can be read without opening its content
+struct FileStat
+{
+	u64 size            = 0;
+	u64 last_write_time = 0; // platform specific unit, only comparable with other file times from the same platform
+	u64 file_id         = 0; // inode on linux, file index on windows
+
+	bool operator==(const FileStat &other) const = default;
+};
+
+Option<FileStat> get_file_stat(const exo::StringView &path);
+
+// Returns the current time in the same unit as `FileStat::last_write_time`
+u64 get_current_file_time();
+} // namespace cross
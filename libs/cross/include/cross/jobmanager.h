@@ -24,6 +24,8 @@ struct JobManager
 	// --
 	static JobManager create();
 	void              queue_job(Job &job) const;
+	// Runs one queued job on the calling thread, returns false when no job is queued or when it is not a worker
+	bool              run_pending_job() const;
 	void              destroy();
 };
 } // namespace cross
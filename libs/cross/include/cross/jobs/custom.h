@@ -30,6 +30,7 @@ std::unique_ptr<Waitable> custom_job(const JobManager &jobmanager, UserData *use
 {
 	auto waitable = std::make_unique<Waitable>();
 	waitable->jobs.reserve(1);
+	waitable->jobmanager = &jobmanager;
 
 	auto job         = std::make_shared<CustomJob>(CustomJob{.done_counter = &waitable->jobs_finished});
 	job->type        = CustomJob::TASK_TYPE;
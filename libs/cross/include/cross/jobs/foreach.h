@@ -36,6 +36,7 @@ std::unique_ptr<Waitable> parallel_foreach(
 
 	auto waitable = std::make_unique<Waitable>();
 	waitable->jobs.reserve(std::size_t(chunks));
+	waitable->jobmanager = &jobmanager;
 
 	for (int i_chunk = 0; i_chunk < chunks; ++i_chunk) {
 		EXO_PROFILE_SCOPE_NAMED("Prepare chunk")
@@ -81,6 +82,7 @@ std::unique_ptr<Waitable> parallel_foreach_userdata(const JobManager &jobmanager
 
 	auto waitable = std::make_unique<Waitable>();
 	waitable->jobs.reserve(std::size_t(chunks));
+	waitable->jobmanager = &jobmanager;
 
 	int i_chunk = 0;
 	if constexpr (UseCurrentThread) {
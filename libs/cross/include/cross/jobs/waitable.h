@@ -7,10 +7,13 @@
 namespace cross
 {
 struct Job;
+struct JobManager;
 struct Waitable
 {
 	Vec<std::shared_ptr<Job>> jobs          = {};
 	volatile i64              jobs_finished = 0;
+	// A waiting worker runs the queued jobs of this manager, waiting from a job cannot block every worker
+	const JobManager         *jobmanager    = nullptr;
 
 	void wait();
 	bool is_done();
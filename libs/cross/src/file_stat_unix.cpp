@@ -0,0 +1,30 @@
+#include "cross/file_stat.h"
+
+#include <sys/stat.h>
+#include <time.h>
+
+namespace cross
+{
+static u64 timespec_to_u64(const timespec &time) { return u64(time.tv_sec) * 1'000'000'000ull + u64(time.tv_nsec); }
+
+Option<FileStat> get_file_stat(const exo::StringView &path)
+{
+	struct stat file_stat = {};
+	if (::stat(path.data(), &file_stat) < 0) {
+		return {};
+	}
+
+	FileStat stat        = {};
+	stat.size            = u64(file_stat.st_size);
+	stat.last_write_time = timespec_to_u64(file_stat.st_mtim);
+	stat.file_id         = u64(file_stat.st_ino);
+	return stat;
+}
+
+u64 get_current_file_time()
+{
+	timespec now = {};
+	clock_gettime(CLOCK_REALTIME, &now);
+	return timespec_to_u64(now);
+}
+} // namespace cross
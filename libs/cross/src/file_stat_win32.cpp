@@ -0,0 +1,50 @@
+#include "cross/file_stat.h"
+
+#include "exo/macros/defer.h"
+#include "utils_win32.h"
+
+#include <windows.h>
+
+namespace cross
+{
+static u64 file_time_to_u64(FILETIME file_time)
+{
+	return (u64(file_time.dwHighDateTime) << 32) | u64(file_time.dwLowDateTime);
+}
+
+Option<FileStat> get_file_stat(const exo::StringView &path)
+{
+	auto utf16_path = utils::utf8_to_utf16(path);
+
+	// Only the attributes are read, other processes can keep writing to the file
+	auto fd = CreateFile(utf16_path.c_str(),
+		FILE_READ_ATTRIBUTES,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		nullptr,
+		OPEN_EXISTING,
+		FILE_FLAG_BACKUP_SEMANTICS,
+		nullptr);
+	if (!utils::is_handle_valid(fd)) {
+		return {};
+	}
+	DEFER { CloseHandle(fd); };
+
+	BY_HANDLE_FILE_INFORMATION info = {};
+	if (!GetFileInformationByHandle(fd, &info)) {
+		return {};
+	}
+
+	FileStat stat        = {};
+	stat.size            = (u64(info.nFileSizeHigh) << 32) | u64(info.nFileSizeLow);
+	stat.last_write_time = file_time_to_u64(info.ftLastWriteTime);
+	stat.file_id         = (u64(info.nFileIndexHigh) << 32) | u64(info.nFileIndexLow);
+	return stat;
+}
+
+u64 get_current_file_time()
+{
+	FILETIME now = {};
+	GetSystemTimeAsFileTime(&now);
+	return file_time_to_u64(now);
+}
+} // namespace cross
@@ -18,6 +18,12 @@
 namespace cross
 {
 DWORD      worker_thread_proc(void *param);
+void       execute_job(Job &job, unsigned long bytes_transferred, ULONG_PTR completion_key);
+
+// Only the workers run pending jobs while waiting, the main thread would otherwise execute unrelated jobs (a whole
+// asset load or import) in the middle of a frame
+static thread_local bool is_worker_thread = false;
+
 JobManager JobManager::create()
 {
 	EXO_PROFILE_SCOPE
@@ -49,6 +55,26 @@ void JobManager::queue_job(Job &job) const
 	ASSERT(res);
 }
 
+bool JobManager::run_pending_job() const
+{
+	if (!is_worker_thread) {
+		return false;
+	}
+
+	const auto &manager_impl = this->impl.get();
+
+	unsigned long bytes_transferred = 0;
+	ULONG_PTR     completion_key    = NULL;
+	LPOVERLAPPED  overlapped        = nullptr;
+	GetQueuedCompletionStatus(manager_impl.completion_port, &bytes_transferred, &completion_key, &overlapped, 0);
+	if (!overlapped) {
+		return false;
+	}
+
+	execute_job(*(Job *)overlapped, bytes_transferred, completion_key);
+	return true;
+}
+
 void JobManager::destroy()
 {
 	EXO_PROFILE_SCOPE
@@ -91,6 +117,35 @@ void worker_thread_read_file(ReadFileJob &job)
 	ASSERT(!res && last_error == ERROR_IO_PENDING);
 }
 
+void execute_job(Job &job, unsigned long bytes_transferred, ULONG_PTR completion_key)
+{
+	EXO_PROFILE_SCOPE_NAMED("Job execution")
+	auto *p_job = &job;
+	ASSERT(p_job->type != u32_invalid);
+	if (p_job->type == ForeachJob::TASK_TYPE) {
+		auto &foreachjob = *reinterpret_cast<ForeachJob *>(p_job);
+		foreachjob.callback(foreachjob);
+		InterlockedIncrement64(foreachjob.done_counter);
+	} else if (p_job->type == ReadFileJob::TASK_TYPE) {
+		auto &readfile_job = *reinterpret_cast<ReadFileJob *>(p_job);
+		worker_thread_read_file(readfile_job);
+	} else if (p_job->type == ReadFileCompletedJob::TASK_TYPE) {
+		auto readcomplete_job = reinterpret_cast<ReadFileCompletedJob *>(p_job);
+		ASSERT(readcomplete_job->read_size >= bytes_transferred);
+		InterlockedIncrement64(readcomplete_job->done_counter);
+		delete readcomplete_job;
+
+		auto file_handle = (HANDLE)(completion_key);
+		CloseHandle(file_handle);
+	} else if (p_job->type == CustomJob::TASK_TYPE) {
+		auto &custom_job = *reinterpret_cast<CustomJob *>(p_job);
+		custom_job.callback(custom_job);
+		InterlockedIncrement64(custom_job.done_counter);
+	} else {
+		ASSERT(false);
+	}
+}
+
 DWORD worker_thread_proc(void *param)
 {
 	HANDLE completion_port = param;
@@ -101,37 +156,13 @@ DWORD worker_thread_proc(void *param)
 	LPOVERLAPPED  overlapped        = nullptr;
 	BOOL          res;
 
+	is_worker_thread = true;
 	while (true) {
 		res = GetQueuedCompletionStatus(completion_port, &bytes_transferred, &completion_key, &overlapped, INFINITE);
 		if (!overlapped || !res) {
 			break;
 		}
-
-		EXO_PROFILE_SCOPE_NAMED("Job execution")
-		auto *p_job = (Job *)overlapped;
-		ASSERT(p_job->type != u32_invalid);
-		if (p_job->type == ForeachJob::TASK_TYPE) {
-			auto &foreachjob = *reinterpret_cast<ForeachJob *>(p_job);
-			foreachjob.callback(foreachjob);
-			InterlockedIncrement64(foreachjob.done_counter);
-		} else if (p_job->type == ReadFileJob::TASK_TYPE) {
-			auto &readfile_job = *reinterpret_cast<ReadFileJob *>(p_job);
-			worker_thread_read_file(readfile_job);
-		} else if (p_job->type == ReadFileCompletedJob::TASK_TYPE) {
-			auto readcomplete_job = reinterpret_cast<ReadFileCompletedJob *>(p_job);
-			ASSERT(readcomplete_job->read_size >= bytes_transferred);
-			InterlockedIncrement64(readcomplete_job->done_counter);
-			delete readcomplete_job;
-
-			auto file_handle = (HANDLE)(completion_key);
-			CloseHandle(file_handle);
-		} else if (p_job->type == CustomJob::TASK_TYPE) {
-			auto &custom_job = *reinterpret_cast<CustomJob *>(p_job);
-			custom_job.callback(custom_job);
-			InterlockedIncrement64(custom_job.done_counter);
-		} else {
-			ASSERT(false);
-		}
+		execute_job(*(Job *)overlapped, bytes_transferred, completion_key);
 	}
 	return 0;
 }
@@ -21,6 +21,7 @@ std::unique_ptr<Waitable> read_files(const JobManager &jobmanager, exo::Span<con
 
 	auto waitable = std::make_unique<Waitable>();
 	waitable->jobs.reserve(job_descs.len());
+	waitable->jobmanager = &jobmanager;
 
 	for (const auto &job_desc : job_descs) {
 		EXO_PROFILE_SCOPE_NAMED("Prepare job")
@@ -2,6 +2,8 @@
 
 #include "exo/profile.h"
 
+#include "cross/jobmanager.h"
+
 #include <windows.h>
 
 namespace cross
@@ -17,6 +19,10 @@ void Waitable::wait()
 		if (res == done) {
 			break;
 		}
+		// Help the workers instead of spinning, the awaited jobs can be queued behind jobs that are waiting as well
+		if (res < comperand && this->jobmanager) {
+			this->jobmanager->run_pending_job();
+		}
 	}
 }
 
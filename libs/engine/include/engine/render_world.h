@@ -4,13 +4,15 @@
 #include "exo/maths/aabb.h"
 #include "exo/maths/matrices.h"
 
-#include "assets/asset_id.h"
+#include "assets/asset_handle.h"
 
 struct DrawableInstance
 {
-	AssetId   mesh_asset;
-	float4x4  world_transform;
-	exo::AABB world_bounds;
+	AssetHandle mesh_asset; // interned in the asset manager
+	float4x4    world_transform;
+	exo::AABB   world_bounds;
+	u32         lod         = 0;    // level of detail selected from the projected error of the mesh LODs
+	float       screen_size = 0.0f; // projected size in pixels of the bounds, selects the resident texture levels
 };
 
 // Description of the world that the renderer will use
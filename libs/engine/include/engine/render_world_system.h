@@ -6,6 +6,7 @@
 #include "reflection/reflection.h"
 
 struct RenderWorld;
+struct AssetManager;
 struct MeshComponent;
 struct CameraComponent;
 
@@ -15,7 +16,7 @@ struct PrepareRenderWorld : GlobalSystem
 	using Super = GlobalSystem;
 	REFL_REGISTER_TYPE_WITH_SUPER("PrepareRenderWorld")
 
-	PrepareRenderWorld();
+	PrepareRenderWorld(AssetManager *_asset_manager);
 
 	void initialize(const SystemRegistry &) final;
 	void shutdown() final;
@@ -27,7 +28,12 @@ struct PrepareRenderWorld : GlobalSystem
 
 	RenderWorld render_world;
 
+	// LOD selection, an instance uses the coarsest LOD whose projected error is below `lod_pixel_error`
+	float lod_pixel_error = 1.0f;
+	float viewport_height = 1080.0f;
+
 private:
+	AssetManager                             *asset_manager;
 	CameraComponent                          *main_camera;
 	exo::Map<const Entity *, MeshComponent *> entities;
 };
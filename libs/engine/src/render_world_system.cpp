@@ -3,16 +3,69 @@
 #include "exo/hash.h"
 #include "exo/profile.h"
 
+#include "assets/asset_manager.h"
+#include "assets/mesh.h"
+
 #include "gameplay/components/camera_component.h"
 #include "gameplay/components/mesh_component.h"
 #include "gameplay/entity.h"
 #include "gameplay/update_stages.h"
 #include "reflection/reflection.h"
 
-PrepareRenderWorld::PrepareRenderWorld()
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+PrepareRenderWorld::PrepareRenderWorld(AssetManager *_asset_manager)
+{
+	update_stage  = UpdateStage::FrameEnd;
+	priority      = 1.0f;
+	asset_manager = _asset_manager;
+}
+
+// Distance to the closest point of the bounds, 0 when the camera is inside
+static float get_distance_to_bounds(const exo::AABB &bounds, float3 camera_position)
+{
+	float3 closest_point = camera_position;
+	for (usize i_component = 0; i_component < 3; i_component += 1) {
+		closest_point[i_component] =
+			std::clamp(closest_point[i_component], bounds.min[i_component], bounds.max[i_component]);
+	}
+	return length(closest_point - camera_position);
+}
+
+// Size in pixels of an object of size 1 at a distance of 1
+static float get_projection_scale(float fov, float viewport_height)
 {
-	update_stage = UpdateStage::FrameEnd;
-	priority     = 1.0f;
+	return viewport_height / (2.0f * std::tan(exo::to_radians(fov) / 2.0f));
+}
+
+// Largest object space error that projects to less than `pixel_error` pixels on screen
+static float get_max_lod_error(
+	const DrawableInstance &instance, float distance, float projection_scale, float pixel_error)
+{
+	float max_scale = 0.0f;
+	for (usize i_column = 0; i_column < 3; i_column += 1) {
+		const float3 axis = float3(instance.world_transform.at(0, i_column),
+			instance.world_transform.at(1, i_column),
+			instance.world_transform.at(2, i_column));
+		max_scale         = std::max(max_scale, length(axis));
+	}
+
+	if (max_scale <= 0.0f || projection_scale <= 0.0f) {
+		return 0.0f;
+	}
+	return pixel_error * distance / (projection_scale * max_scale);
+}
+
+// Projected size in pixels of the diagonal of the bounds at its closest point, used to stream the texture levels
+static float get_screen_size(const DrawableInstance &instance, float distance, float projection_scale)
+{
+	if (distance <= 0.0f) {
+		return std::numeric_limits<float>::max();
+	}
+	const float diagonal = length(instance.world_bounds.max - instance.world_bounds.min);
+	return projection_scale * diagonal / distance;
 }
 
 void PrepareRenderWorld::initialize(const SystemRegistry &) {}
@@ -32,6 +85,11 @@ void PrepareRenderWorld::update(const UpdateContext &)
 	render_world.main_camera_fov          = main_camera->fov;
 	render_world.main_camera_view_inverse = main_camera->get_view_inverse();
 
+	const float3 camera_position  = float3(render_world.main_camera_view_inverse.at(0, 3),
+		render_world.main_camera_view_inverse.at(1, 3),
+		render_world.main_camera_view_inverse.at(2, 3));
+	const float  projection_scale = get_projection_scale(main_camera->fov, viewport_height);
+
 	for (auto &[p_entity, mesh_component] : entities) {
 		render_world.drawable_instances.push();
 		auto &new_drawable = render_world.drawable_instances.last();
@@ -39,9 +97,24 @@ void PrepareRenderWorld::update(const UpdateContext &)
 		// HACK: update world transform here :D
 		mesh_component->set_local_transform(mesh_component->get_local_transform());
 
-		new_drawable.mesh_asset      = mesh_component->mesh_asset;
+		// The renderer finds the mesh id again from its handle, the name is only copied the first time
+		const auto &mesh_id          = mesh_component->mesh_asset;
+		new_drawable.mesh_asset      = asset_manager ? asset_manager->asset_names.intern(mesh_id)
+		                                             : AssetHandle::from_id(mesh_id);
 		new_drawable.world_transform = mesh_component->get_world_transform();
 		new_drawable.world_bounds    = mesh_component->get_world_bounds();
+		new_drawable.lod             = 0;
+
+		const float distance     = get_distance_to_bounds(new_drawable.world_bounds, camera_position);
+		new_drawable.screen_size = get_screen_size(new_drawable, distance, projection_scale);
+
+		if (asset_manager && asset_manager->is_loaded(mesh_id)) {
+			const auto *mesh = asset_manager->load_asset_t<Mesh>(mesh_id);
+			if (mesh->get_lod_count() > 1) {
+				const float max_error = get_max_lod_error(new_drawable, distance, projection_scale, lod_pixel_error);
+				new_drawable.lod = mesh->select_lod(max_error);
+			}
+		}
 	}
 }
 
@@ -30,7 +30,7 @@ void Scene::init(AssetManager *_asset_manager, const Inputs *inputs)
 		exo::serializer_helper::read_object(last_imported_scene.value().content(), this->entity_world);
 	}
 
-	entity_world.create_system<PrepareRenderWorld>();
+	entity_world.create_system<PrepareRenderWorld>(asset_manager);
 
 	Entity *camera_entity = nullptr;
 	for (auto *entity : entity_world.root_entities) {
@@ -251,38 +251,10 @@ void Scene::import_mesh(Mesh * /*mesh*/)
 	// import a mesh with identity transform
 }
 
-Entity *Scene::import_subscene_rec(const SubScene *subscene, u32 i_node)
-{
-	const auto &transform = subscene->transforms[i_node];
-	const auto &mesh_asset = subscene->meshes[i_node];
-	const auto &children = subscene->children[i_node];
-	const auto &name = subscene->names[i_node];
-
-	Entity *new_entity = entity_world.create_entity(name);
-
-	SpatialComponent *entity_root = nullptr;
-	if (mesh_asset.is_valid()) {
-		auto *mesh_component = new_entity->create_component<MeshComponent>().as<MeshComponent>();
-		mesh_component->mesh_asset = mesh_asset;
-		entity_root = static_cast<SpatialComponent *>(mesh_component);
-	} else {
-		entity_root = new_entity->create_component<SpatialComponent>().as<SpatialComponent>();
-	}
-
-	entity_root->set_local_transform(transform);
-	for (auto i_child : children) {
-		auto *child = import_subscene_rec(subscene, i_child);
-		entity_world.set_parent_entity(child, new_entity);
-	}
-
-	return new_entity;
-}
-
 void Scene::import_subscene(SubScene *subscene)
 {
-	for (auto i_root : subscene->roots) {
-		import_subscene_rec(subscene, i_root);
-	}
+	Vec<Entity *> new_entities;
+	entity_world.instantiate_subscene(*subscene, new_entities);
 
 	exo::serializer_helper::write_object_to_file(ASSET_PATH "/last_imported_scene.asset", this->entity_world);
 }
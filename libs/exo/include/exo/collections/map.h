@@ -8,6 +8,7 @@
 #include "exo/memory/dynamic_buffer.h"
 
 #include "exo/collections/span.h"
+#include <algorithm>
 #include <bit>
 
 namespace exo
@@ -35,7 +36,9 @@ inline constexpr u32 power_of_2_modulo(u32 a, u32 b)
 	return a & (b - 1);
 }
 
-inline u32 probe_by_hash(const Span<const MapSlot> slots, const u64 hash)
+// Different keys can have the same truncated hash, `is_match(i_slot)` compares the key stored in a slot
+template <typename IsMatch>
+inline u32 probe_by_hash(const Span<const MapSlot> slots, const u64 hash, IsMatch &&is_match)
 {
 	// A temporary slot is created to trunc the hash to the same size as regular slots
 	MapSlot slot_to_find;
@@ -52,7 +55,8 @@ inline u32 probe_by_hash(const Span<const MapSlot> slots, const u64 hash)
 			return u32_invalid;
 		}
 
-		if (slots[i_slot].bits.is_filled == 1 && slots[i_slot].bits.hash == slot_to_find.bits.hash) {
+		if (slots[i_slot].bits.is_filled == 1 && slots[i_slot].bits.hash == slot_to_find.bits.hash &&
+			is_match(i_slot)) {
 			return i_slot;
 		}
 	}
@@ -60,8 +64,11 @@ inline u32 probe_by_hash(const Span<const MapSlot> slots, const u64 hash)
 	return u32_invalid;
 }
 
-template <typename T>
-inline u32 insert_slot(Span<MapSlot> slots, Span<T> values, MapSlot &&slot, T &&value)
+// Different keys can have the same truncated hash, `is_same_key(stored, inserted)` compares the keys when the hashes
+// are equal. Inserting a key that is already present replaces its value and sets `is_replaced`.
+template <typename T, typename IsSameKey>
+inline u32 insert_slot(
+	Span<MapSlot> slots, Span<T> values, MapSlot &&slot, T &&value, IsSameKey &&is_same_key, bool &is_replaced)
 {
 	// We need to keep track of the slot and value to insert to be able to swap them when needed
 	MapSlot slot_to_insert  = std::move(slot);
@@ -87,8 +94,13 @@ inline u32 insert_slot(Span<MapSlot> slots, Span<T> values, MapSlot &&slot, T &&
 			break;
 		}
 
-		// Detect hash colisions
-		ASSERT(current_slot.bits.hash != slot_to_insert.bits.hash);
+		// The slots of a key come before any slot with a lower PSL, a present key is found before the first swap
+		if (i_original_key_slot == u32_invalid && current_slot.bits.hash == slot_to_insert.bits.hash &&
+			is_same_key(values[i_slot], value_to_insert)) {
+			values[i_slot] = std::move(value_to_insert);
+			is_replaced    = true;
+			return i_slot;
+		}
 
 		// Whenever the PSL of the key to insert becomes higher than the PSL of the probed key,
 		// Swap them, the new key to insert becomes the probed key
@@ -112,13 +124,23 @@ inline u32 insert_slot(Span<MapSlot> slots, Span<T> values, MapSlot &&slot, T &&
 		new (&values[i_slot]) T(std::move(value_to_insert));
 	}
 
+	is_replaced = false;
 	return i_original_key_slot;
 }
 
+// The inserted keys are known to be unique, when rehashing or deserializing
 template <typename T>
-inline void resize_and_rehash(DynamicBuffer &slots_buffer, DynamicBuffer &keyvalues_buffer, u32 &capacity)
+inline u32 insert_slot(Span<MapSlot> slots, Span<T> values, MapSlot &&slot, T &&value)
+{
+	bool is_replaced = false;
+	return insert_slot(
+		slots, values, std::move(slot), std::move(value), [](const T &, const T &) { return false; }, is_replaced);
+}
+
+template <typename T>
+inline void rehash(DynamicBuffer &slots_buffer, DynamicBuffer &keyvalues_buffer, u32 &capacity, u32 new_capacity)
 {
-	auto new_capacity = capacity == 0 ? 2 : 2u * capacity;
+	ASSERT(std::has_single_bit(new_capacity) && new_capacity > capacity);
 
 	// Create the new buffers to hold slots and values
 	DynamicBuffer new_slots_buffer     = {};
@@ -151,6 +173,19 @@ inline void resize_and_rehash(DynamicBuffer &slots_buffer, DynamicBuffer &keyval
 	old_slots_buffer.destroy();
 	old_keyvalues_buffer.destroy();
 }
+
+template <typename T>
+inline void resize_and_rehash(DynamicBuffer &slots_buffer, DynamicBuffer &keyvalues_buffer, u32 &capacity)
+{
+	rehash<T>(slots_buffer, keyvalues_buffer, capacity, capacity == 0 ? 2 : 2u * capacity);
+}
+
+// Smallest capacity holding `size` elements under the max load factor
+inline u32 get_capacity_for_size(u32 size, u32 max_load_factor_nom, u32 max_load_factor_denom)
+{
+	const u64 min_capacity = (u64(size) * max_load_factor_denom + max_load_factor_nom - 1) / max_load_factor_nom;
+	return u32(std::bit_ceil(std::max(min_capacity, u64(2))));
+}
 } // namespace details
 
 template <typename K, typename V>
@@ -171,6 +206,8 @@ struct Map
 		Value value;
 	};
 
+	static bool is_same_key(const KeyValue &lhs, const KeyValue &rhs) { return lhs.key == rhs.key; }
+
 	u32           capacity         = 0;
 	u32           size             = 0;
 	DynamicBuffer keyvalues_buffer = {};
@@ -213,8 +250,19 @@ struct Map
 
 	bool is_empty() const { return this->size > 0; }
 
+	// Grows the map to insert until `new_size` elements without rehashing
+	void reserve(u32 new_size)
+	{
+		const u32 new_capacity =
+			details::get_capacity_for_size(new_size, EXO_MAP_MAX_LOAD_FACTOR_NOM, EXO_MAP_MAX_LOAD_FACTOR_DENOM);
+		if (new_capacity > this->capacity) {
+			details::rehash<KeyValue>(this->slots_buffer, this->keyvalues_buffer, this->capacity, new_capacity);
+		}
+	}
+
 	// -- Modifiers
 
+	// Inserting a key that is already present replaces its value
 	Value *insert(Key key, Value &&value)
 	{
 		auto max_load_size = (this->capacity * EXO_MAP_MAX_LOAD_FACTOR_NOM) / EXO_MAP_MAX_LOAD_FACTOR_DENOM;
@@ -229,17 +277,20 @@ struct Map
 		slot_to_insert.bits.is_filled = 1;
 		slot_to_insert.bits.psl       = 0;
 		slot_to_insert.bits.hash      = u32(hash_value(key));
-		u32 i_slot = details::insert_slot(slots, keyvalues, std::move(slot_to_insert), KeyValue{key, std::move(value)});
+
+		bool is_replaced = false;
+		u32  i_slot      = details::insert_slot(
+			slots, keyvalues, std::move(slot_to_insert), KeyValue{key, std::move(value)}, is_same_key, is_replaced);
 
 		ASSERT(i_slot < this->capacity);
-		this->size += 1;
+		this->size += is_replaced ? 0 : 1;
 		return &keyvalues[i_slot].value;
 	}
 
 	Value *insert(Key key, const Value &value)
 	{
 		auto max_load_size = (this->capacity * EXO_MAP_MAX_LOAD_FACTOR_NOM) / EXO_MAP_MAX_LOAD_FACTOR_DENOM;
-		if (this->size == 0 || this->size + 1 > max_load_size) [[unlikely]] {
+		if (this->size + 1 > max_load_size) [[unlikely]] {
 			details::resize_and_rehash<KeyValue>(this->slots_buffer, this->keyvalues_buffer, this->capacity);
 		}
 
@@ -250,19 +301,23 @@ struct Map
 		slot_to_insert.bits.is_filled = 1;
 		slot_to_insert.bits.psl       = 0;
 		slot_to_insert.bits.hash      = u32(hash_value(key));
-		u32 i_slot = details::insert_slot(slots, keyvalues, std::move(slot_to_insert), KeyValue{key, value});
+
+		bool is_replaced = false;
+		u32  i_slot      = details::insert_slot(
+			slots, keyvalues, std::move(slot_to_insert), KeyValue{key, value}, is_same_key, is_replaced);
 
 		ASSERT(i_slot < this->capacity);
-		this->size += 1;
+		this->size += is_replaced ? 0 : 1;
 		return &keyvalues[i_slot].value;
 	}
 
 	void remove(const Key &key)
 	{
-		const auto slots = exo::reinterpret_span<details::MapSlot>(this->slots_buffer.content());
-		const auto hash  = hash_value(key);
+		const auto slots     = exo::reinterpret_span<details::MapSlot>(this->slots_buffer.content());
+		const auto keyvalues = exo::reinterpret_span<KeyValue>(this->keyvalues_buffer.content());
+		const auto hash      = hash_value(key);
 
-		const u32 i_slot = details::probe_by_hash(slots, hash);
+		const u32 i_slot = details::probe_by_hash(slots, hash, [&](u32 i) { return keyvalues[i].key == key; });
 
 		// Not found
 		if (i_slot == u32_invalid) {
@@ -270,8 +325,6 @@ struct Map
 			return;
 		}
 
-		const auto keyvalues = exo::reinterpret_span<KeyValue>(this->keyvalues_buffer.content());
-
 		// The key was found at slot i_slot, remove it and backward shift all values to fill the hole
 		u32 i = 0;
 		for (; i < this->capacity; ++i) {
@@ -318,10 +371,11 @@ struct Map
 			return nullptr;
 		}
 
-		const auto slots = exo::reinterpret_span<details::MapSlot>(this->slots_buffer.content());
-		const auto hash  = hash_value(key);
+		const auto slots     = exo::reinterpret_span<details::MapSlot>(this->slots_buffer.content());
+		const auto keyvalues = exo::reinterpret_span<KeyValue>(this->keyvalues_buffer.content());
+		const auto hash      = hash_value(key);
 
-		u32 i_slot = details::probe_by_hash(slots, hash);
+		u32 i_slot = details::probe_by_hash(slots, hash, [&](u32 i) { return keyvalues[i].key == key; });
 
 		// key not found
 		if (i_slot == u32_invalid) {
@@ -329,7 +383,6 @@ struct Map
 		}
 
 		ASSERT(slots[i_slot].bits.is_filled);
-		const auto keyvalues = exo::reinterpret_span<KeyValue>(this->keyvalues_buffer.content());
 		return &keyvalues[i_slot].value;
 	}
 
@@ -339,10 +392,11 @@ struct Map
 			return nullptr;
 		}
 
-		const auto slots = exo::reinterpret_span<details::MapSlot>(this->slots_buffer.content());
-		const auto hash  = hash_value(key);
+		const auto slots     = exo::reinterpret_span<details::MapSlot>(this->slots_buffer.content());
+		const auto keyvalues = exo::reinterpret_span<KeyValue>(this->keyvalues_buffer.content());
+		const auto hash      = hash_value(key);
 
-		u32 i_slot = details::probe_by_hash(slots, hash);
+		u32 i_slot = details::probe_by_hash(slots, hash, [&](u32 i) { return keyvalues[i].key == key; });
 
 		// key not found
 		if (i_slot == u32_invalid) {
@@ -350,7 +404,6 @@ struct Map
 		}
 
 		ASSERT(slots[i_slot].bits.is_filled);
-		const auto keyvalues = exo::reinterpret_span<KeyValue>(this->keyvalues_buffer.content());
 		return &keyvalues[i_slot].value;
 	}
 };
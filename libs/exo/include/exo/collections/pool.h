@@ -337,6 +337,10 @@ void Pool<T>::remove(Handle<T> handle)
 template <typename T>
 void Pool<T>::clear()
 {
+	if (this->capacity == 0) {
+		return;
+	}
+
 	this->size          = 0;
 	this->freelist_head = 0;
 
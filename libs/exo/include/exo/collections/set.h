@@ -24,6 +24,8 @@ struct Set
 	DynamicBuffer values_buffer = {};
 	DynamicBuffer slots_buffer  = {};
 
+	static bool is_same_value(const T &lhs, const T &rhs) { return lhs == rhs; }
+
 	static Set with_capacity(u32 new_capacity);
 	inline ~Set()
 	{
@@ -53,7 +55,11 @@ struct Set
 	SetConstIterator<T> begin() const { return SetConstIterator<T>(this); }
 	SetConstIterator<T> end() const { return SetConstIterator<T>(this, this->capacity); }
 
+	// Grows the set to insert until `new_size` elements without rehashing
+	void reserve(u32 new_size);
+
 	bool contains(const T &value);
+	// Inserting a value that is already present replaces it
 	T   *insert(T &&value);
 	T   *insert(const T &value);
 	void remove(const T &value);
@@ -71,6 +77,16 @@ Set<T> Set<T>::with_capacity(u32 new_capacity)
 	return set;
 }
 
+template <typename T>
+void Set<T>::reserve(u32 new_size)
+{
+	const u32 new_capacity =
+		details::get_capacity_for_size(new_size, EXO_SET_MAX_LOAD_FACTOR_NOM, EXO_SET_MAX_LOAD_FACTOR_DENOM);
+	if (new_capacity > this->capacity) {
+		details::rehash<T>(this->slots_buffer, this->values_buffer, this->capacity, new_capacity);
+	}
+}
+
 template <typename T>
 bool Set<T>::contains(const T &value)
 {
@@ -79,8 +95,9 @@ bool Set<T>::contains(const T &value)
 	}
 
 	const auto slots  = exo::reinterpret_span<details::MapSlot>(this->slots_buffer.content());
+	const auto values = exo::reinterpret_span<T>(this->values_buffer.content());
 	const auto hash   = u32(hash_value(value));
-	u32        i_slot = details::probe_by_hash(slots, hash);
+	u32        i_slot = details::probe_by_hash(slots, hash, [&](u32 i) { return values[i] == value; });
 
 	return i_slot != u32_invalid;
 }
@@ -100,11 +117,14 @@ T *Set<T>::insert(T &&value)
 	slot_to_insert.bits.is_filled = 1;
 	slot_to_insert.bits.psl       = 0;
 	slot_to_insert.bits.hash      = u32(hash_value(value));
-	u32 i_slot                    = details::insert_slot(slots, values, std::move(slot_to_insert), std::move(value));
+
+	bool is_replaced = false;
+	u32  i_slot      = details::insert_slot(
+		slots, values, std::move(slot_to_insert), std::move(value), is_same_value, is_replaced);
 
 	ASSERT(i_slot < this->capacity);
-	this->size += 1;
-	return &values[i_slot].value;
+	this->size += is_replaced ? 0 : 1;
+	return &values[i_slot];
 }
 
 template <typename T>
@@ -122,20 +142,24 @@ T *Set<T>::insert(const T &value)
 	slot_to_insert.bits.is_filled = 1;
 	slot_to_insert.bits.psl       = 0;
 	slot_to_insert.bits.hash      = u32(hash_value(value));
-	u32 i_slot                    = details::insert_slot(slots, values, std::move(slot_to_insert), T{value});
+
+	bool is_replaced = false;
+	u32  i_slot      = details::insert_slot(
+		slots, values, std::move(slot_to_insert), T{value}, is_same_value, is_replaced);
 
 	ASSERT(i_slot < this->capacity);
-	this->size += 1;
+	this->size += is_replaced ? 0 : 1;
 	return &values[i_slot];
 }
 
 template <typename T>
 void Set<T>::remove(const T &value)
 {
-	const auto slots = exo::reinterpret_span<details::MapSlot>(this->slots_buffer.content());
-	const auto hash  = u32(hash_value(value));
+	const auto slots  = exo::reinterpret_span<details::MapSlot>(this->slots_buffer.content());
+	const auto values = exo::reinterpret_span<T>(this->values_buffer.content());
+	const auto hash   = u32(hash_value(value));
 
-	const u32 i_slot = details::probe_by_hash(slots, hash);
+	const u32 i_slot = details::probe_by_hash(slots, hash, [&](u32 i) { return values[i] == value; });
 
 	// Not found
 	if (i_slot == u32_invalid) {
@@ -143,8 +167,6 @@ void Set<T>::remove(const T &value)
 		return;
 	}
 
-	const auto values = exo::reinterpret_span<T>(this->values_buffer.content());
-
 	// The key was found at slot i_slot, remove it and backward shift all values to fill the hole
 	for (u32 i = 0; i < this->capacity; ++i) {
 		const auto current_slot = details::power_of_2_modulo((i_slot + i), this->capacity);
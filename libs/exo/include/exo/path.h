@@ -14,6 +14,8 @@ struct Path
 	static Path from_string(exo::StringView path);
 	static Path from_owned_string(exo::String &&str);
 
+	bool operator==(const Path &other) const { return this->str == other.str; }
+
 	exo::StringView view() const { return exo::StringView{this->str}; }
 	exo::StringView extension() const;
 	exo::StringView filename() const;
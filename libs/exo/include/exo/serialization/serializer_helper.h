@@ -22,8 +22,9 @@ static void read_object(exo::Span<const u8> data, T &object)
 	serialize(serializer, object);
 }
 
+// Returns the size of the file
 template <typename T>
-static void write_object_to_file(exo::StringView output_path, T &object)
+static usize write_object_to_file(exo::StringView output_path, T &object)
 {
 	exo::ScopeStack scope      = exo::ScopeStack::with_allocator(&exo::tls_allocator);
 	exo::Serializer serializer = exo::Serializer::create(&scope);
@@ -42,5 +43,6 @@ static void write_object_to_file(exo::StringView output_path, T &object)
 
 	EXO_PROFILE_MFREE(serializer.buffer);
 	free(serializer.buffer);
+	return bwritten;
 }
 } // namespace exo::serializer_helper
@@ -138,3 +138,92 @@ TEST_CASE("exo::Map move constructor", "[map]")
 	REQUIRE(new_map.keyvalues_buffer.ptr != nullptr);
 	REQUIRE(new_map.slots_buffer.ptr != nullptr);
 }
+
+namespace
+{
+struct CollidingKey
+{
+	int  value = 0;
+	bool operator==(const CollidingKey &other) const = default;
+};
+
+[[nodiscard]] u64 hash_value(CollidingKey) { return 0xc0ffee; }
+} // namespace
+
+TEST_CASE("exo::Map keys with the same hash", "[map]")
+{
+	exo::Map<CollidingKey, int> map = {};
+	for (int i = 0; i < 8; ++i) {
+		map.insert(CollidingKey{i}, 10 * i);
+	}
+
+	REQUIRE(map.size == 8);
+	for (int i = 0; i < 8; ++i) {
+		REQUIRE(*map.at(CollidingKey{i}) == 10 * i);
+	}
+	REQUIRE(map.at(CollidingKey{8}) == nullptr);
+
+	map.remove(CollidingKey{3});
+	REQUIRE(map.at(CollidingKey{3}) == nullptr);
+	REQUIRE(*map.at(CollidingKey{4}) == 40);
+	REQUIRE(*map.at(CollidingKey{7}) == 70);
+	REQUIRE(map.size == 7);
+}
+
+TEST_CASE("exo::Map reserve", "[map]")
+{
+	exo::Map<int, int> map = {};
+	map.insert(1, 2);
+
+	map.reserve(1000);
+	const u32 capacity = map.capacity;
+	REQUIRE(capacity >= 1000);
+	REQUIRE(*map.at(1) == 2);
+
+	for (int i = 2; i < 1001; ++i) {
+		map.insert(i, i);
+	}
+	REQUIRE(map.capacity == capacity);
+	REQUIRE(*map.at(1000) == 1000);
+
+	// Reserving less than the capacity does nothing
+	map.reserve(10);
+	REQUIRE(map.capacity == capacity);
+}
+
+TEST_CASE("exo::Map insert an existing key", "[map]")
+{
+	SECTION("Distinct hashes")
+	{
+		exo::Map<int, int> map = {};
+		for (int i = 0; i < 8; ++i) {
+			map.insert(i, i);
+		}
+
+		REQUIRE(*map.insert(3, 30) == 30);
+		REQUIRE(map.size == 8);
+		REQUIRE(*map.at(3) == 30);
+
+		map.remove(3);
+		REQUIRE(map.at(3) == nullptr);
+		REQUIRE(map.size == 7);
+	}
+
+	SECTION("Same hash")
+	{
+		exo::Map<CollidingKey, int> map = {};
+		for (int i = 0; i < 8; ++i) {
+			map.insert(CollidingKey{i}, 10 * i);
+		}
+
+		// The key is found among the other keys with the same hash
+		REQUIRE(*map.insert(CollidingKey{5}, 55) == 55);
+		REQUIRE(map.size == 8);
+		REQUIRE(*map.at(CollidingKey{5}) == 55);
+		REQUIRE(*map.at(CollidingKey{6}) == 60);
+
+		map.remove(CollidingKey{5});
+		REQUIRE(map.at(CollidingKey{5}) == nullptr);
+		REQUIRE(map.size == 7);
+	}
+}
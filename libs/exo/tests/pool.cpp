@@ -20,3 +20,17 @@ TEST_CASE("exo::Pool insertion")
 	REQUIRE(v1 == 42);
 	REQUIRE(v2 == 38);
 }
+
+TEST_CASE("exo::Pool clear")
+{
+	exo::Pool<int> pool;
+	pool.clear();
+
+	auto h1 = pool.add(42);
+	REQUIRE(pool.get(h1) == 42);
+
+	pool.clear();
+	auto h2 = pool.add(38);
+	REQUIRE(h2.get_index() == 0);
+	REQUIRE(pool.get(h2) == 38);
+}
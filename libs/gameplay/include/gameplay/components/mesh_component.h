@@ -2,6 +2,7 @@
 
 #include "gameplay/component.h"
 #include "assets/asset_id.h"
+#include "assets/asset_manager.h"
 
 struct MeshComponent : SpatialComponent
 {
@@ -9,7 +10,8 @@ struct MeshComponent : SpatialComponent
 	using Super = SpatialComponent;
 	REFL_REGISTER_TYPE_WITH_SUPER("MeshComponent")
 
-	AssetId mesh_asset;
+	AssetId  mesh_asset;
+	AssetRef mesh_ref; // keeps the mesh loaded between `load` and `unload`
 
 	// --
 	void load(LoadingContext &) final;
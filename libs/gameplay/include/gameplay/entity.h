@@ -84,8 +84,14 @@ struct Entity
 	template <std::derived_from<BaseComponent> Component, typename... Args>
 	refl::BasePtr<BaseComponent> create_component(Args &&...args)
 	{
-		Component *new_component     = new Component(std::forward<Args>(args)...);
-		auto       new_component_ptr = refl::BasePtr<BaseComponent>(new_component);
+		return add_component(new Component(std::forward<Args>(args)...));
+	}
+
+	// Add a component constructed by the caller, its memory is owned by the caller
+	template <std::derived_from<BaseComponent> Component>
+	refl::BasePtr<BaseComponent> add_component(Component *new_component)
+	{
+		auto new_component_ptr = refl::BasePtr<BaseComponent>(new_component);
 		create_component_internal(new_component_ptr);
 
 		// If the component is the first spatial component, it's the entity's root
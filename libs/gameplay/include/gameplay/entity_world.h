@@ -12,6 +12,22 @@ struct Serializer;
 }
 struct AssetManager;
 struct Entity;
+struct MeshComponent;
+struct SpatialComponent;
+struct SubScene;
+
+// The entities and the components of an instantiated subscene share one allocation, it is freed with its last entity
+struct EntityBlock
+{
+	void *memory = nullptr;
+	Entity *entities = nullptr;
+	MeshComponent *mesh_components = nullptr;
+	SpatialComponent *spatial_components = nullptr;
+	u32 entity_count = 0; // constructed entities, the first ones of the block
+	u32 mesh_component_count = 0;
+	u32 spatial_component_count = 0;
+	u32 live_entity_count = 0;
+};
 
 struct EntityWorld
 {
@@ -19,6 +35,7 @@ struct EntityWorld
 	exo::Map<exo::UUID, Entity *> entities = {};
 	exo::Set<Entity *> root_entities = {};
 	SystemRegistry system_registry = {};
+	Vec<EntityBlock> entity_blocks = {};
 
 	exo::EnumArray<Vec<refl::BasePtr<GlobalSystem>>, UpdateStage> global_per_stage_update_list = {};
 
@@ -31,6 +48,11 @@ struct EntityWorld
 	void destroy_entity(Entity *entity);
 	void set_parent_entity(Entity *entity, Entity *parent);
 
+	// Creates the entities of all the nodes of a subscene at once, the entity of each node is appended to
+	// `out_entities` in the node order. Nodes are linked to their parent directly, without refreshing the attachments.
+	// The entities and their components are allocated in one block, the components must not be deleted.
+	void instantiate_subscene(const SubScene &subscene, Vec<Entity *> &out_entities);
+
 	void _attach_to_parent(Entity *entity);
 	void _dettach_to_parent(Entity *entity);
 	void _refresh_attachments(Entity *entity);
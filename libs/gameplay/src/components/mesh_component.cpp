@@ -7,13 +7,14 @@
 
 void MeshComponent::load(LoadingContext &ctx)
 {
+	this->mesh_ref = AssetRef(*ctx.asset_manager, this->mesh_asset);
 	ctx.asset_manager->load_asset_async(this->mesh_asset);
 	state = ComponentState::Loading;
 }
 
-void MeshComponent::unload(LoadingContext &ctx)
+void MeshComponent::unload(LoadingContext & /*ctx*/)
 {
-	ctx.asset_manager->unload_asset(this->mesh_asset);
+	this->mesh_ref.reset();
 	state = ComponentState::Unloaded;
 }
 
@@ -1,6 +1,7 @@
 #include "gameplay/entity_world.h"
 
 #include "gameplay/component.h"
+#include "gameplay/components/mesh_component.h"
 #include "gameplay/contexts.h"
 #include "gameplay/entity.h"
 #include "gameplay/system.h"
@@ -8,12 +9,17 @@
 #include "gameplay/update_stages.h"
 
 #include "assets/asset_manager.h"
+#include "assets/subscene.h"
 #include "exo/collections/vector.h"
+#include "exo/maths/pointer.h"
 #include "exo/profile.h"
 #include "exo/serialization/serializer.h"
 #include "exo/uuid.h"
 
 #include <algorithm> // for std::sort
+#include <cstddef>
+#include <cstdlib>
+#include <new>
 
 EntityWorld::EntityWorld() { this->str_repo = exo::StringRepository::create(); }
 
@@ -109,12 +115,141 @@ void EntityWorld::set_parent_entity(Entity *entity, Entity *parent)
 	}
 }
 
+void EntityWorld::instantiate_subscene(const SubScene &subscene, Vec<Entity *> &out_entities)
+{
+	EXO_PROFILE_SCOPE;
+
+	const usize node_count = subscene.transforms.len();
+	const usize first_entity = out_entities.len();
+	this->entities.reserve(this->entities.size + u32(node_count));
+	this->root_entities.reserve(this->root_entities.size + u32(subscene.roots.len()));
+	out_entities.resize(first_entity + node_count);
+	if (node_count == 0) {
+		return;
+	}
+
+	// One allocation for the entities and their root components, every node has either a mesh or a spatial component
+	usize mesh_node_count = 0;
+	for (const auto &mesh_asset : subscene.meshes) {
+		mesh_node_count += mesh_asset.is_valid() ? 1 : 0;
+	}
+	const usize mesh_components_offset =
+		exo::round_up_to_alignment(alignof(MeshComponent), node_count * sizeof(Entity));
+	const usize spatial_components_offset = exo::round_up_to_alignment(alignof(SpatialComponent),
+		mesh_components_offset + mesh_node_count * sizeof(MeshComponent));
+	const usize block_size = spatial_components_offset + (node_count - mesh_node_count) * sizeof(SpatialComponent);
+	static_assert(alignof(MeshComponent) <= alignof(std::max_align_t));
+	static_assert(alignof(SpatialComponent) <= alignof(std::max_align_t));
+
+	auto &block = this->entity_blocks.push();
+	block.memory = malloc(block_size);
+	EXO_PROFILE_MALLOC(block.memory, block_size);
+	block.entities = static_cast<Entity *>(block.memory);
+	block.mesh_components = reinterpret_cast<MeshComponent *>(static_cast<u8 *>(block.memory) + mesh_components_offset);
+	block.spatial_components =
+		reinterpret_cast<SpatialComponent *>(static_cast<u8 *>(block.memory) + spatial_components_offset);
+
+	// Parents are created before their children, the world transform of a node is computed from its parent's one
+	struct PendingNode
+	{
+		u32     i_node;
+		Entity *parent;
+	};
+	Vec<PendingNode> stack;
+	stack.reserve(node_count);
+	for (usize i = subscene.roots.len(); i > 0; i -= 1) {
+		stack.push(PendingNode{.i_node = subscene.roots[i - 1], .parent = nullptr});
+	}
+
+	while (!stack.is_empty()) {
+		const PendingNode node = stack.pop();
+
+		const auto &mesh_asset = subscene.meshes[node.i_node];
+		const auto &children = subscene.children[node.i_node];
+
+		auto *new_entity = new (&block.entities[block.entity_count]) Entity();
+		block.entity_count += 1;
+		block.live_entity_count += 1;
+		new_entity->name = this->str_repo.intern(subscene.names[node.i_node]);
+		new_entity->uuid = exo::UUID::create();
+		new_entity->attached_entities.reserve(children.len());
+
+		if (mesh_asset.is_valid()) {
+			auto *mesh_component = new (&block.mesh_components[block.mesh_component_count]) MeshComponent();
+			block.mesh_component_count += 1;
+			mesh_component->mesh_asset = mesh_asset;
+			new_entity->add_component(mesh_component);
+		} else {
+			auto *spatial_component = new (&block.spatial_components[block.spatial_component_count]) SpatialComponent();
+			block.spatial_component_count += 1;
+			new_entity->add_component(spatial_component);
+		}
+
+		auto entity_root = new_entity->root_component;
+		entity_root->local_transform = subscene.transforms[node.i_node];
+		entity_root->children.reserve(children.len());
+
+		if (node.parent) {
+			auto parent_root = node.parent->root_component;
+
+			new_entity->parent = node.parent->uuid;
+			node.parent->attached_entities.push(new_entity->uuid);
+			entity_root->parent = parent_root;
+			entity_root->world_transform = parent_root->world_transform * entity_root->local_transform;
+			parent_root->children.push(entity_root);
+			new_entity->is_attached_to_parent = true;
+		} else {
+			entity_root->world_transform = entity_root->local_transform;
+			this->root_entities.insert(new_entity);
+		}
+
+		this->entities.insert(new_entity->uuid, new_entity);
+		out_entities[first_entity + node.i_node] = new_entity;
+
+		for (usize i = children.len(); i > 0; i -= 1) {
+			stack.push(PendingNode{.i_node = children[i - 1], .parent = new_entity});
+		}
+	}
+
+	if (block.entity_count == 0) {
+		EXO_PROFILE_MFREE(block.memory);
+		free(block.memory);
+		this->entity_blocks.pop();
+	}
+}
+
 void EntityWorld::destroy_entity(Entity *entity)
 {
 	entities.remove(entity->uuid);
 	if (this->root_entities.contains(entity)) {
 		this->root_entities.remove(entity);
 	}
+
+	// Entities of an instantiated subscene are destroyed in place, the block is freed with its last entity
+	const auto entity_address = reinterpret_cast<usize>(entity);
+	for (usize i_block = 0; i_block < this->entity_blocks.len(); i_block += 1) {
+		auto &block = this->entity_blocks[i_block];
+		const auto first_address = reinterpret_cast<usize>(block.entities);
+		if (entity_address < first_address || entity_address >= first_address + block.entity_count * sizeof(Entity)) {
+			continue;
+		}
+
+		entity->~Entity();
+		block.live_entity_count -= 1;
+		if (block.live_entity_count == 0) {
+			for (u32 i_component = 0; i_component < block.mesh_component_count; i_component += 1) {
+				block.mesh_components[i_component].~MeshComponent();
+			}
+			for (u32 i_component = 0; i_component < block.spatial_component_count; i_component += 1) {
+				block.spatial_components[i_component].~SpatialComponent();
+			}
+			EXO_PROFILE_MFREE(block.memory);
+			free(block.memory);
+			this->entity_blocks.swap_remove(i_block);
+		}
+		return;
+	}
+
 	delete entity;
 }
 
@@ -0,0 +1,137 @@
+#include "assets/mesh.h"
+#include "assets/subscene.h"
+#include "gameplay/component.h"
+#include "gameplay/components/mesh_component.h"
+#include "gameplay/entity.h"
+#include "gameplay/entity_world.h"
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+
+namespace
+{
+// Two roots, the first one has a child with children of its own. Every other node has a mesh.
+void fill_subscene(SubScene &subscene)
+{
+	subscene.roots.push(0);
+	subscene.roots.push(5);
+	subscene.children.resize(6);
+	subscene.children[0].push(2);
+	subscene.children[0].push(1);
+	subscene.children[2].push(3);
+	subscene.children[2].push(4);
+
+	const auto mesh_asset = AssetId::create<Mesh>("entity_world_mesh");
+	for (u32 i_node = 0; i_node < 6; i_node += 1) {
+		auto transform     = float4x4::identity();
+		transform.at(0, 3) = float(i_node + 1);
+		transform.at(1, 1) = 2.0f;
+		transform.at(1, 3) = -0.5f * float(i_node);
+		transform.at(2, 0) = 0.25f;
+		subscene.transforms.push(transform);
+		subscene.meshes.push(i_node % 2 == 0 ? mesh_asset : AssetId{});
+		subscene.names.push("Node");
+	}
+}
+
+// The instantiation done by the scene before the bulk path
+Entity *instantiate_node(EntityWorld &world, const SubScene &subscene, u32 i_node, Vec<Entity *> &out_entities)
+{
+	Entity *new_entity = world.create_entity(subscene.names[i_node]);
+	out_entities[i_node] = new_entity;
+
+	SpatialComponent *entity_root = nullptr;
+	if (subscene.meshes[i_node].is_valid()) {
+		auto *mesh_component       = new_entity->create_component<MeshComponent>().as<MeshComponent>();
+		mesh_component->mesh_asset = subscene.meshes[i_node];
+		entity_root                = static_cast<SpatialComponent *>(mesh_component);
+	} else {
+		entity_root = new_entity->create_component<SpatialComponent>().as<SpatialComponent>();
+	}
+
+	entity_root->set_local_transform(subscene.transforms[i_node]);
+	for (auto i_child : subscene.children[i_node]) {
+		auto *child = instantiate_node(world, subscene, i_child, out_entities);
+		world.set_parent_entity(child, new_entity);
+	}
+
+	return new_entity;
+}
+
+u32 find_node(const EntityWorld &world, const Vec<Entity *> &entities, exo::UUID uuid)
+{
+	if (!uuid.is_valid()) {
+		return u32_invalid;
+	}
+	const Entity *entity = *world.entities.at(uuid);
+	for (u32 i_node = 0; i_node < entities.len(); i_node += 1) {
+		if (entities[i_node] == entity) {
+			return i_node;
+		}
+	}
+	return u32_invalid;
+}
+
+bool is_same_transform(const float4x4 &lhs, const float4x4 &rhs)
+{
+	for (u32 i_row = 0; i_row < 4; i_row += 1) {
+		for (u32 i_column = 0; i_column < 4; i_column += 1) {
+			if (std::abs(lhs.at(i_row, i_column) - rhs.at(i_row, i_column)) > 1e-4f) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+} // namespace
+
+TEST_CASE("Subscene instantiation", "[entity_world]")
+{
+	refl::details::call_all_registers();
+	SubScene subscene = {};
+	fill_subscene(subscene);
+
+	EntityWorld   per_entity_world;
+	Vec<Entity *> per_entity_entities;
+	per_entity_entities.resize(6);
+	for (auto i_root : subscene.roots) {
+		instantiate_node(per_entity_world, subscene, i_root, per_entity_entities);
+	}
+
+	EntityWorld   bulk_world;
+	Vec<Entity *> bulk_entities;
+	bulk_world.instantiate_subscene(subscene, bulk_entities);
+	REQUIRE(bulk_entities.len() == 6);
+	REQUIRE(bulk_world.entities.size == 6);
+	REQUIRE(bulk_world.root_entities.size == 2);
+	REQUIRE(bulk_world.entity_blocks.len() == 1);
+
+	// The bulk path links the entities like `set_parent_entity`
+	for (u32 i_node = 0; i_node < 6; i_node += 1) {
+		Entity *expected = per_entity_entities[i_node];
+		Entity *entity   = bulk_entities[i_node];
+
+		REQUIRE(find_node(bulk_world, bulk_entities, entity->parent) ==
+		        find_node(per_entity_world, per_entity_entities, expected->parent));
+		REQUIRE(entity->is_attached_to_parent == expected->is_attached_to_parent);
+		REQUIRE(bulk_world.root_entities.contains(entity) == per_entity_world.root_entities.contains(expected));
+
+		// The children are attached in the node order
+		REQUIRE(entity->attached_entities.len() == expected->attached_entities.len());
+		for (u32 i_attached = 0; i_attached < entity->attached_entities.len(); i_attached += 1) {
+			REQUIRE(find_node(bulk_world, bulk_entities, entity->attached_entities[i_attached]) ==
+			        find_node(per_entity_world, per_entity_entities, expected->attached_entities[i_attached]));
+		}
+
+		REQUIRE(is_same_transform(entity->root_component->get_local_transform(),
+			expected->root_component->get_local_transform()));
+		REQUIRE(is_same_transform(entity->root_component->get_world_transform(),
+			expected->root_component->get_world_transform()));
+		REQUIRE((entity->get_first_component<MeshComponent>() != nullptr) == subscene.meshes[i_node].is_valid());
+	}
+
+	// The block is freed with its last entity
+	for (auto *entity : bulk_entities) {
+		bulk_world.destroy_entity(entity);
+		REQUIRE(bulk_world.entity_blocks.len() == (bulk_world.entities.size > 0 ? 1 : 0));
+	}
+}
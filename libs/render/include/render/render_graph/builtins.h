@@ -16,7 +16,9 @@ struct SwapchainPass
 	vulkan::Surface surface;
 };
 Handle<TextureDesc> acquire_next_image(RenderGraph &graph, SwapchainPass &pass);
-void                present(RenderGraph &graph, SwapchainPass &pass, u64 signal_value);
+
+// The swapchain image is declared as read by the present pass, the passes writing it are kept
+void present(RenderGraph &graph, SwapchainPass &pass, Handle<TextureDesc> swapchain_output, u64 signal_value);
 
 void copy_image(RenderGraph &graph, Handle<TextureDesc> src, Handle<TextureDesc> dst);
 void blit_image(RenderGraph &graph, Handle<TextureDesc> src, Handle<TextureDesc> dst);
@@ -4,6 +4,7 @@
 
 #include "render/render_graph/resource_registry.h"
 #include "render/ring_buffer.h"
+#include "render/vulkan/image.h"
 
 #include <functional>
 
@@ -15,6 +16,8 @@ struct Device;
 struct GraphicsWork;
 struct ComputeWork;
 struct WorkPool;
+struct Buffer;
+enum struct BufferUsage : u8;
 } // namespace vulkan
 
 struct RenderGraph;
@@ -47,6 +50,21 @@ using RawCb = std::function<void(RenderGraph &, PassApi &, vulkan::ComputeWork &
 struct RawPass
 {};
 
+// Resources accessed by a pass, the graph orders the passes and issues their barriers from these declarations
+struct PassImageAccess
+{
+	Handle<TextureDesc> texture;
+	vulkan::ImageUsage  usage;
+	bool                is_write;
+};
+
+struct PassBufferAccess
+{
+	Handle<vulkan::Buffer> buffer;
+	vulkan::BufferUsage    usage;
+	bool                   is_write;
+};
+
 struct Pass
 {
 	PassType type;
@@ -57,13 +75,51 @@ struct Pass
 	} pass;
 	GraphicCb execute;
 
+	// A pass without declared accesses is never culled and is not reordered with the other passes. A pass reading a
+	// texture of the graph has to declare it, the passes writing it would be culled otherwise, and its memory is only
+	// reserved for the passes declaring it.
+	Vec<PassImageAccess>  image_accesses   = {};
+	Vec<PassBufferAccess> buffer_accesses  = {};
+	bool                  has_side_effects = false; // kept even if nothing reads its outputs
+	bool                  is_fence         = false; // executed after the previous passes and before the following ones
+
+	Pass &read(Handle<TextureDesc> texture, vulkan::ImageUsage usage)
+	{
+		this->image_accesses.push(PassImageAccess{.texture = texture, .usage = usage, .is_write = false});
+		return *this;
+	}
+
+	Pass &write(Handle<TextureDesc> texture, vulkan::ImageUsage usage)
+	{
+		this->image_accesses.push(PassImageAccess{.texture = texture, .usage = usage, .is_write = true});
+		return *this;
+	}
+
+	Pass &read(Handle<vulkan::Buffer> buffer, vulkan::BufferUsage usage)
+	{
+		this->buffer_accesses.push(PassBufferAccess{.buffer = buffer, .usage = usage, .is_write = false});
+		return *this;
+	}
+
+	Pass &write(Handle<vulkan::Buffer> buffer, vulkan::BufferUsage usage)
+	{
+		this->buffer_accesses.push(PassBufferAccess{.buffer = buffer, .usage = usage, .is_write = true});
+		return *this;
+	}
+
+	// The attachments are declared as written by the pass
 	static Pass graphic(Handle<TextureDesc> color_attachment, Handle<TextureDesc> depth_attachment, GraphicCb execute)
 	{
-		return Pass{
+		auto pass = Pass{
 			.type    = PassType::Graphic,
 			.pass    = {.graphic = {.color_attachment = color_attachment, .depth_attachment = depth_attachment}},
 			.execute = std::move(execute),
 		};
+		pass.write(color_attachment, vulkan::ImageUsage::ColorAttachment);
+		if (depth_attachment.is_valid()) {
+			pass.write(depth_attachment, vulkan::ImageUsage::DepthAttachment);
+		}
+		return pass;
 	}
 
 	static Pass raw(GraphicCb execute)
@@ -76,18 +132,57 @@ struct Pass
 	}
 };
 
+// Passes that are executed in a frame, in order
+struct CompiledBatch
+{
+	u32 first_pass;
+	u32 pass_count;
+	u32 first_image_barrier;
+	u32 image_barrier_count;
+	u32 first_buffer_barrier;
+	u32 buffer_barrier_count;
+};
+
+// Refers to an access of a pass, the handles are resolved again every frame
+struct CompiledBarrier
+{
+	u32 i_pass;
+	u32 i_access;
+};
+
+// Execution order of the passes of a graph. The passes of a batch do not depend on each other, their barriers are
+// issued together before the batch.
+struct CompiledGraph
+{
+	Vec<u64>              shape;
+	Vec<u32>              pass_order;
+	Vec<CompiledBatch>    batches;
+	Vec<CompiledBarrier>  image_barriers;
+	Vec<CompiledBarrier>  buffer_barriers;
+	// Batches accessing each texture, indexed by the index of their handle
+	Vec<ResourceLifetime> image_lifetimes;
+	u32                   culled_pass_count = 0;
+};
+
+// Identifies the passes and their accesses, the graphs of two frames with the same shape compile to the same result
+void          get_graph_shape(exo::Span<const Pass> passes, Vec<u64> &out_shape);
+// Culls the passes whose outputs are not read, orders the other ones by dependency level and derives their barriers
+CompiledGraph compile_graph(exo::Span<const Pass> passes);
+// Compiles the passes unless `compiled` was compiled from a graph with the same shape, returns true when it compiled
+bool          update_compiled_graph(CompiledGraph &compiled, exo::Span<const Pass> passes);
+
 struct RenderGraph
 {
 	ResourceRegistry resources;
 	Vec<Pass>        passes;
+	CompiledGraph    compiled;
 	u64              i_frame = 0;
 
-	void         execute(PassApi api, vulkan::WorkPool &work_pool);
+	void execute(PassApi api, vulkan::WorkPool &work_pool);
 	void end_frame();
 
-	GraphicPass &graphic_pass(
-		Handle<TextureDesc> color_attachment, Handle<TextureDesc> depth_buffer, GraphicCb execute);
-	RawPass &raw_pass(RawCb execute);
+	Pass &graphic_pass(Handle<TextureDesc> color_attachment, Handle<TextureDesc> depth_buffer, GraphicCb execute);
+	Pass &raw_pass(RawCb execute);
 
 	Handle<TextureDesc> output(TextureDesc desc);
 	int3                image_size(Handle<TextureDesc> desc_handle);
@@ -10,9 +10,11 @@
 #include "exo/string_view.h"
 #include <volk.h>
 
+#include "render/render_graph/transient_memory.h"
+#include "render/vulkan/image.h"
+
 namespace vulkan
 {
-struct Image;
 struct Framebuffer;
 struct Device;
 } // namespace vulkan
@@ -55,6 +57,7 @@ struct TextureDesc
 	TextureSize           size           = TextureSize::screen_relative(float2(1.0));
 	VkFormat              format         = VK_FORMAT_R8G8B8A8_UNORM;
 	VkImageType           image_type     = VK_IMAGE_TYPE_2D;
+	bool                  is_imported    = false; // its image is set by a pass, it does not get transient memory
 	Handle<vulkan::Image> resolved_image = {};
 };
 
@@ -69,6 +72,32 @@ struct FramebufferMetadata
 	u64 last_frame_used = 0;
 };
 
+// Textures accessed by the passes of the graph are transient, their images are placed in shared memory heaps
+struct TransientImage
+{
+	vulkan::ImageDescription desc;
+	ResourceLifetime         lifetime;
+	Handle<vulkan::Image>    image;
+};
+
+// Replaced when the description or the lifetime of a transient image changes
+struct TransientMemory
+{
+	Vec<TransientImage> images;
+	Vec<VmaAllocation>  heaps;
+	u64                 last_frame_used = 0;
+};
+
+struct TransientMemoryStats
+{
+	u64 requested_size = 0; // memory of the transient images without aliasing
+	u64 allocated_size = 0;
+	u32 image_count    = 0;
+	u32 heap_count     = 0;
+
+	u64 saved_size() const { return this->requested_size - this->allocated_size; }
+};
+
 struct ResourceRegistry
 {
 	exo::Pool<TextureDesc>                                 texture_descs;
@@ -79,15 +108,25 @@ struct ResourceRegistry
 	exo::Pool<FramebufferMetadata>                                     framebuffer_metadatas;
 	exo::Map<Handle<vulkan::Framebuffer>, Handle<FramebufferMetadata>> framebuffer_pool;
 
+	// Lifetimes of the textures of the compiled graph, set before its execution
+	exo::Span<const ResourceLifetime> image_lifetimes;
+	TransientMemory                   transient_memory;
+	Vec<TransientMemory>              retired_transient_memories;
+	Vec<u32>                          transient_image_indices; // transient image of each texture desc index
+	bool                              are_transient_images_resolved = false;
+	TransientMemoryStats              transient_stats;
+
 	float2 screen_size = float2(1.0);
 	u64    i_frame     = 0;
 
+	void destroy(vulkan::Device &device);
 	void begin_frame(vulkan::Device &device, u64 frame);
 	void end_frame();
 
 	void                  set_image(Handle<TextureDesc> desc_handle, Handle<vulkan::Image> image_handle);
 	void                  drop_image(Handle<vulkan::Image> image_handle);
 	Handle<vulkan::Image> resolve_image(vulkan::Device &device, Handle<TextureDesc> desc_handle);
+	bool                  is_transient(Handle<TextureDesc> desc_handle) const;
 
 	int2 texture_desc_handle_size(Handle<TextureDesc> desc_handle);
 
@@ -0,0 +1,54 @@
+#pragma once
+#include "exo/collections/span.h"
+#include "exo/collections/vector.h"
+#include "exo/maths/numerics.h"
+
+// Transient resources only live during a part of the frame, the resources whose lifetimes do not overlap are placed
+// in the same memory. The packing does not depend on the device, it is computed from the memory requirements.
+
+// Inclusive range of the batches of the compiled graph accessing a resource
+struct ResourceLifetime
+{
+	u32 first_batch = u32_invalid;
+	u32 last_batch  = 0;
+
+	bool operator==(const ResourceLifetime &other) const = default;
+	bool is_valid() const { return this->first_batch != u32_invalid; }
+	bool overlaps(const ResourceLifetime &other) const
+	{
+		return this->first_batch <= other.last_batch && other.first_batch <= this->last_batch;
+	}
+};
+
+struct TransientResource
+{
+	ResourceLifetime lifetime;
+	u64              size;
+	u64              alignment;
+	u32              memory_type_bits; // memory types the resource can be bound to
+};
+
+struct TransientPlacement
+{
+	u32 i_heap = u32_invalid;
+	u64 offset = 0;
+};
+
+struct TransientHeap
+{
+	u64 size;
+	u64 alignment;
+	u32 memory_type_bits;
+};
+
+struct TransientLayout
+{
+	Vec<TransientPlacement> placements; // one per resource
+	Vec<TransientHeap>      heaps;
+	u64                     requested_size = 0; // memory needed without aliasing
+	u64                     allocated_size = 0;
+};
+
+// Interval coloring: the largest resources are placed first, each at the lowest offset that does not overlap the
+// resources of the heap alive at the same time. Heaps are only shared by resources with a common memory type.
+TransientLayout pack_transient_resources(exo::Span<const TransientResource> resources);
@@ -79,6 +79,8 @@ struct Work
 	void clear_barrier(Handle<Image> image, ImageUsage usage_destination);
 	void barriers(exo::Span<std::pair<Handle<Image>, ImageUsage>> images,
 		exo::Span<std::pair<Handle<Buffer>, BufferUsage>>         buffers);
+	// The images reuse memory written by other images, their content is discarded after every previous access
+	void aliasing_barriers(exo::Span<std::pair<Handle<Image>, ImageUsage>> images);
 
 	// queries
 	void reset_query_pool(QueryPool &query_pool, u32 first_query, u32 count);
@@ -97,6 +99,7 @@ struct TransferWork : Work
 		Handle<Buffer> src, Handle<Buffer> dst, exo::Span<const std::tuple<usize, usize, usize>> offsets_src_dst_size);
 	void copy_buffer(Handle<Buffer> src, Handle<Buffer> dst);
 	void copy_image(Handle<Image> src, Handle<Image> dst);
+	void copy_image(Handle<Image> src, Handle<Image> dst, exo::Span<const VkImageCopy> regions);
 	void blit_image(Handle<Image> src, Handle<Image> dst);
 	void copy_buffer_to_image(Handle<Buffer> src, Handle<Image> dst, exo::Span<VkBufferImageCopy> regions);
 	void fill_buffer(Handle<Buffer> buffer_handle, u32 data);
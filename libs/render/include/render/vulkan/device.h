@@ -3,6 +3,7 @@
 
 #include "render/vulkan/commands.h"
 #include "render/vulkan/descriptor_set.h"
+#include "render/vulkan/memory.h"
 #include "render/vulkan/physical_device.h"
 #include "render/vulkan/synchronization.h"
 
@@ -138,6 +139,12 @@ struct Device
 	int3          get_image_size(Handle<Image> image_handle);
 	void          unbind_image(Handle<Image> image_handle);
 
+	// Memory shared by aliased images, an aliased image does not free its memory
+	VmaAllocation        allocate_memory(const VkMemoryRequirements &requirements, exo::StringView name);
+	void                 free_memory(VmaAllocation allocation);
+	VkMemoryRequirements get_image_memory_requirements(const ImageDescription &image_desc);
+	Handle<Image>        create_aliased_image(const ImageDescription &image_desc, VmaAllocation memory, u64 offset);
+
 	Handle<Buffer> create_buffer(const BufferDescription &buffer_desc);
 	void           destroy_buffer(Handle<Buffer> buffer_handle);
 	u32            get_buffer_storage_index(Handle<Buffer> buffer_handle);
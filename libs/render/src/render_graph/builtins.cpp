@@ -11,8 +11,9 @@ Handle<TextureDesc> acquire_next_image(RenderGraph &graph, SwapchainPass &pass)
 {
 	SwapchainPass *self   = &pass;
 	auto           output = graph.output(TextureDesc{
-				  .name = "swapchain desc",
-				  .size = TextureSize::screen_relative(float2(1.0, 1.0)),
+				  .name        = "swapchain desc",
+				  .size        = TextureSize::screen_relative(float2(1.0, 1.0)),
+				  .is_imported = true,
     });
 
 	graph.raw_pass([self, output](RenderGraph &graph, PassApi &api, vulkan::ComputeWork &cmd) {
@@ -34,43 +35,42 @@ Handle<TextureDesc> acquire_next_image(RenderGraph &graph, SwapchainPass &pass)
 	return output;
 }
 
-void present(RenderGraph &graph, SwapchainPass &pass, u64 signal_value)
+void present(RenderGraph &graph, SwapchainPass &pass, Handle<TextureDesc> swapchain_output, u64 signal_value)
 {
 	SwapchainPass *self = &pass;
-	graph.raw_pass([self, signal_value](RenderGraph & /*graph*/, PassApi &api, vulkan::ComputeWork &cmd) {
-		cmd.barrier(self->surface.images[self->surface.current_image], vulkan::ImageUsage::Present);
-		cmd.end();
-		cmd.prepare_present(self->surface);
+	auto          &present_pass =
+		graph.raw_pass([self, signal_value](RenderGraph & /*graph*/, PassApi &api, vulkan::ComputeWork &cmd) {
+			cmd.end();
+			cmd.prepare_present(self->surface);
 
-		api.device.submit(cmd, exo::Span{&self->fence, 1}, exo::Span{&signal_value, 1});
-		self->i_frame += 1;
-		api.device.present(self->surface, cmd);
-	});
+			api.device.submit(cmd, exo::Span{&self->fence, 1}, exo::Span{&signal_value, 1});
+			self->i_frame += 1;
+			api.device.present(self->surface, cmd);
+		});
+	present_pass.read(swapchain_output, vulkan::ImageUsage::Present);
+	// The command buffer is ended, no other pass can be recorded after this one
+	present_pass.is_fence = true;
 }
 
 void copy_image(RenderGraph &graph, Handle<TextureDesc> src, Handle<TextureDesc> dst)
 {
 	ASSERT(src != dst);
-	graph.raw_pass([src, dst](RenderGraph &graph, PassApi &api, vulkan::ComputeWork &cmd) {
+	auto &pass = graph.raw_pass([src, dst](RenderGraph &graph, PassApi &api, vulkan::ComputeWork &cmd) {
 		auto src_image = graph.resources.resolve_image(api.device, src);
 		auto dst_image = graph.resources.resolve_image(api.device, dst);
-
-		cmd.barrier(src_image, vulkan::ImageUsage::TransferSrc);
-		cmd.barrier(dst_image, vulkan::ImageUsage::TransferDst);
 		cmd.copy_image(src_image, dst_image);
 	});
+	pass.read(src, vulkan::ImageUsage::TransferSrc).write(dst, vulkan::ImageUsage::TransferDst);
 }
 
 void blit_image(RenderGraph &graph, Handle<TextureDesc> src, Handle<TextureDesc> dst)
 {
 	ASSERT(src != dst);
-	graph.raw_pass([src, dst](RenderGraph &graph, PassApi &api, vulkan::ComputeWork &cmd) {
+	auto &pass = graph.raw_pass([src, dst](RenderGraph &graph, PassApi &api, vulkan::ComputeWork &cmd) {
 		auto src_image = graph.resources.resolve_image(api.device, src);
 		auto dst_image = graph.resources.resolve_image(api.device, dst);
-
-		cmd.barrier(src_image, vulkan::ImageUsage::TransferSrc);
-		cmd.barrier(dst_image, vulkan::ImageUsage::TransferDst);
 		cmd.blit_image(src_image, dst_image);
 	});
+	pass.read(src, vulkan::ImageUsage::TransferSrc).write(dst, vulkan::ImageUsage::TransferDst);
 }
 } // namespace builtins
@@ -0,0 +1,354 @@
+#include "render/render_graph/graph.h"
+
+#include "exo/macros/assert.h"
+#include "exo/profile.h"
+
+#include <algorithm>
+
+// Graphic passes that do not clear their color attachment load its content
+static bool is_image_read(const Pass &pass, const PassImageAccess &access)
+{
+	if (!access.is_write) {
+		return true;
+	}
+	return pass.type == PassType::Graphic && !pass.pass.graphic.clear &&
+	       access.texture == pass.pass.graphic.color_attachment;
+}
+
+static bool is_opaque(const Pass &pass) { return pass.image_accesses.is_empty() && pass.buffer_accesses.is_empty(); }
+
+// Passes that write nothing are only executed for their side effects
+static bool has_side_effects(const Pass &pass)
+{
+	if (pass.has_side_effects || is_opaque(pass)) {
+		return true;
+	}
+	for (const auto &access : pass.image_accesses) {
+		if (access.is_write) {
+			return false;
+		}
+	}
+	for (const auto &access : pass.buffer_accesses) {
+		if (access.is_write) {
+			return false;
+		}
+	}
+	return true;
+}
+
+template <typename T>
+static T &get_resource_state(Vec<T> &states, u32 index)
+{
+	ASSERT(index != u32_invalid);
+	if (index >= states.len()) {
+		states.resize(index + 1);
+	}
+	return states[index];
+}
+
+void get_graph_shape(exo::Span<const Pass> passes, Vec<u64> &out_shape)
+{
+	out_shape.clear();
+	for (const auto &pass : passes) {
+		const bool clear = pass.type == PassType::Graphic && pass.pass.graphic.clear;
+		out_shape.push(u64(pass.type) | u64(clear) << 8 | u64(pass.has_side_effects) << 9 | u64(pass.is_fence) << 10 |
+		               u64(pass.image_accesses.len()) << 16 | u64(pass.buffer_accesses.len()) << 40);
+		for (const auto &access : pass.image_accesses) {
+			out_shape.push(u64(access.texture.get_index()) | u64(access.usage) << 32 | u64(access.is_write) << 40);
+		}
+		for (const auto &access : pass.buffer_accesses) {
+			out_shape.push(u64(access.buffer.get_index()) | u64(access.usage) << 32 | u64(access.is_write) << 40);
+		}
+	}
+}
+
+// -- Culling
+// A pass is alive when it has side effects or when a live pass executed after it reads one of its writes
+
+struct ResourceLiveness
+{
+	Vec<bool> images;
+	Vec<bool> buffers;
+};
+
+static bool is_pass_alive(ResourceLiveness &needed, const Pass &pass)
+{
+	if (has_side_effects(pass)) {
+		return true;
+	}
+	for (const auto &access : pass.image_accesses) {
+		if (access.is_write && get_resource_state(needed.images, access.texture.get_index())) {
+			return true;
+		}
+	}
+	for (const auto &access : pass.buffer_accesses) {
+		if (access.is_write && get_resource_state(needed.buffers, access.buffer.get_index())) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static Vec<bool> cull_passes(exo::Span<const Pass> passes)
+{
+	auto             alive  = Vec<bool>::with_values(passes.len(), false);
+	ResourceLiveness needed = {};
+	for (usize i_pass = passes.len(); i_pass > 0; --i_pass) {
+		const auto &pass = passes[i_pass - 1];
+		if (!is_pass_alive(needed, pass)) {
+			continue;
+		}
+		alive[i_pass - 1] = true;
+
+		// The writes of the previous passes are overwritten, unless this pass reads them as well
+		for (const auto &access : pass.image_accesses) {
+			if (access.is_write) {
+				get_resource_state(needed.images, access.texture.get_index()) = false;
+			}
+		}
+		for (const auto &access : pass.buffer_accesses) {
+			if (access.is_write) {
+				get_resource_state(needed.buffers, access.buffer.get_index()) = false;
+			}
+		}
+		for (const auto &access : pass.image_accesses) {
+			if (is_image_read(pass, access)) {
+				get_resource_state(needed.images, access.texture.get_index()) = true;
+			}
+		}
+		for (const auto &access : pass.buffer_accesses) {
+			if (!access.is_write) {
+				get_resource_state(needed.buffers, access.buffer.get_index()) = true;
+			}
+		}
+	}
+	return alive;
+}
+
+// -- Ordering
+// The level of a pass is one more than the level of the passes it depends on. Reads depend on the last write, writes
+// depend on the last write and the reads since then, and reads with a different usage are serialized because the
+// resource can only be in one state.
+
+struct ResourceLevels
+{
+	u32 min_read_level  = 0;
+	u32 min_write_level = 0;
+	u32 read_level      = 0; // last level of the reads with `read_usage`
+	u32 read_usage      = u32_invalid;
+};
+
+struct PassLevelAccess
+{
+	ResourceLevels *levels;
+	u32             usage;
+	bool            is_read;
+	bool            is_write;
+};
+
+static u32 get_min_level(const PassLevelAccess &access)
+{
+	const auto &levels = *access.levels;
+	u32         level  = 0;
+	if (access.is_read) {
+		level = std::max(level, levels.min_read_level);
+		if (levels.read_usage != u32_invalid && levels.read_usage != access.usage) {
+			level = std::max(level, levels.read_level + 1);
+		}
+	}
+	if (access.is_write) {
+		level = std::max(level, levels.min_write_level);
+	}
+	return level;
+}
+
+static void add_access_level(const PassLevelAccess &access, u32 level)
+{
+	auto &levels = *access.levels;
+	if (access.is_write) {
+		levels.min_read_level  = level + 1;
+		levels.min_write_level = level + 1;
+		levels.read_usage      = u32_invalid;
+	} else {
+		levels.read_level      = levels.read_usage == access.usage ? std::max(levels.read_level, level) : level;
+		levels.read_usage      = access.usage;
+		levels.min_write_level = std::max(levels.min_write_level, level + 1);
+	}
+}
+
+static Vec<u32> compute_pass_levels(exo::Span<const Pass> passes, exo::Span<const bool> alive)
+{
+	auto                 pass_levels = Vec<u32>::with_values(passes.len(), 0);
+	Vec<ResourceLevels>  image_levels;
+	Vec<ResourceLevels>  buffer_levels;
+	Vec<PassLevelAccess> accesses;
+	u32                  fence_level = 0; // passes without declared accesses are executed after the previous passes
+	u32                  next_level  = 0;
+
+	for (u32 i_pass = 0; i_pass < passes.len(); ++i_pass) {
+		const auto &pass = passes[i_pass];
+		if (!alive[i_pass]) {
+			continue;
+		}
+
+		if (is_opaque(pass)) {
+			pass_levels[i_pass] = next_level;
+			fence_level         = next_level + 1;
+			next_level          = fence_level;
+			continue;
+		}
+
+		// The levels are looked up after the resize of the state arrays
+		accesses.clear();
+		for (const auto &access : pass.image_accesses) {
+			get_resource_state(image_levels, access.texture.get_index());
+		}
+		for (const auto &access : pass.buffer_accesses) {
+			get_resource_state(buffer_levels, access.buffer.get_index());
+		}
+		for (const auto &access : pass.image_accesses) {
+			accesses.push(PassLevelAccess{
+				.levels   = &image_levels[access.texture.get_index()],
+				.usage    = u32(access.usage),
+				.is_read  = is_image_read(pass, access),
+				.is_write = access.is_write,
+			});
+		}
+		for (const auto &access : pass.buffer_accesses) {
+			accesses.push(PassLevelAccess{
+				.levels   = &buffer_levels[access.buffer.get_index()],
+				.usage    = u32(access.usage),
+				.is_read  = !access.is_write,
+				.is_write = access.is_write,
+			});
+		}
+
+		u32 level = pass.is_fence ? next_level : fence_level;
+		for (const auto &access : accesses) {
+			level = std::max(level, get_min_level(access));
+		}
+		// The reads are added before the writes, a pass reading and writing a resource resets its reads
+		for (const auto &access : accesses) {
+			if (!access.is_write) {
+				add_access_level(access, level);
+			}
+		}
+		for (const auto &access : accesses) {
+			if (access.is_write) {
+				add_access_level(access, level);
+			}
+		}
+
+		pass_levels[i_pass] = level;
+		next_level          = std::max(next_level, level + 1);
+		if (pass.is_fence) {
+			fence_level = next_level;
+		}
+	}
+
+	return pass_levels;
+}
+
+// -- Barriers
+// Consecutive reads with the same usage do not need a barrier. The first access of a frame always has one, the state
+// of the resource is only known by the device.
+
+struct ResourceBarrierState
+{
+	u32  usage    = u32_invalid;
+	u32  i_batch  = u32_invalid;
+	bool is_write = false;
+};
+
+static bool needs_barrier(ResourceBarrierState &state, u32 usage, bool is_write, u32 i_batch)
+{
+	// Accesses in the same batch are independent reads, or the accesses of a single pass
+	if (state.i_batch == i_batch) {
+		ASSERT(state.usage == usage);
+		state.is_write = state.is_write || is_write;
+		return false;
+	}
+
+	const bool needs_barrier = state.usage != usage || state.is_write || is_write;
+	state.usage              = usage;
+	state.i_batch            = i_batch;
+	state.is_write           = is_write;
+	return needs_barrier;
+}
+
+CompiledGraph compile_graph(exo::Span<const Pass> passes)
+{
+	EXO_PROFILE_SCOPE;
+	CompiledGraph compiled = {};
+	get_graph_shape(passes, compiled.shape);
+
+	const auto alive       = cull_passes(passes);
+	const auto pass_levels = compute_pass_levels(passes, alive);
+
+	for (u32 i_pass = 0; i_pass < passes.len(); ++i_pass) {
+		if (alive[i_pass]) {
+			compiled.pass_order.push(i_pass);
+		} else {
+			compiled.culled_pass_count += 1;
+		}
+	}
+	std::stable_sort(compiled.pass_order.begin(), compiled.pass_order.end(), [&](u32 lhs, u32 rhs) {
+		return pass_levels[lhs] < pass_levels[rhs];
+	});
+
+	Vec<ResourceBarrierState> image_states;
+	Vec<ResourceBarrierState> buffer_states;
+	for (u32 i_order = 0; i_order < compiled.pass_order.len(); ++i_order) {
+		const u32 i_pass = compiled.pass_order[i_order];
+		if (compiled.batches.is_empty() || pass_levels[compiled.pass_order[i_order - 1]] != pass_levels[i_pass]) {
+			compiled.batches.push(CompiledBatch{
+				.first_pass           = i_order,
+				.pass_count           = 0,
+				.first_image_barrier  = u32(compiled.image_barriers.len()),
+				.image_barrier_count  = 0,
+				.first_buffer_barrier = u32(compiled.buffer_barriers.len()),
+				.buffer_barrier_count = 0,
+			});
+		}
+		auto     &batch   = compiled.batches.last();
+		const u32 i_batch = u32(compiled.batches.len() - 1);
+		batch.pass_count += 1;
+
+		const auto &pass = passes[i_pass];
+		for (u32 i_access = 0; i_access < pass.image_accesses.len(); ++i_access) {
+			const auto &access = pass.image_accesses[i_access];
+			auto       &state  = get_resource_state(image_states, access.texture.get_index());
+
+			auto &lifetime       = get_resource_state(compiled.image_lifetimes, access.texture.get_index());
+			lifetime.first_batch = std::min(lifetime.first_batch, i_batch);
+			lifetime.last_batch  = i_batch;
+
+			if (needs_barrier(state, u32(access.usage), access.is_write, i_batch)) {
+				compiled.image_barriers.push(CompiledBarrier{.i_pass = i_pass, .i_access = i_access});
+				batch.image_barrier_count += 1;
+			}
+		}
+		for (u32 i_access = 0; i_access < pass.buffer_accesses.len(); ++i_access) {
+			const auto &access = pass.buffer_accesses[i_access];
+			auto       &state  = get_resource_state(buffer_states, access.buffer.get_index());
+			if (needs_barrier(state, u32(access.usage), access.is_write, i_batch)) {
+				compiled.buffer_barriers.push(CompiledBarrier{.i_pass = i_pass, .i_access = i_access});
+				batch.buffer_barrier_count += 1;
+			}
+		}
+	}
+
+	return compiled;
+}
+
+bool update_compiled_graph(CompiledGraph &compiled, exo::Span<const Pass> passes)
+{
+	Vec<u64> shape;
+	get_graph_shape(passes, shape);
+	if (shape.len() == compiled.shape.len() && std::equal(shape.begin(), shape.end(), compiled.shape.begin())) {
+		return false;
+	}
+
+	compiled = compile_graph(passes);
+	return true;
+}
@@ -6,56 +6,98 @@
 
 #include "exo/profile.h"
 
-void RenderGraph::execute(PassApi api, vulkan::WorkPool &work_pool)
+static void execute_pass(RenderGraph &graph, Pass &pass, PassApi &api, vulkan::GraphicsWork &ctx)
 {
-	EXO_PROFILE_SCOPE;
-
-	this->resources.begin_frame(api.device, this->i_frame);
-
-	auto ctx = api.device.get_graphics_work(work_pool);
-	ctx.begin();
+	EXO_PROFILE_SCOPE_NAMED("render graph pass");
+	switch (pass.type) {
+	case PassType::Graphic: {
+		auto &graphic_pass = pass.pass.graphic;
+		auto  output_size  = graph.resources.texture_desc_handle_size(graphic_pass.color_attachment);
+		graph.resources.resolve_image(api.device, graphic_pass.color_attachment);
+
+		auto framebuffer = graph.resources.resolve_framebuffer(api.device,
+			exo::Span{&graphic_pass.color_attachment, 1},
+			graphic_pass.depth_attachment);
+
+		exo::DynamicArray<vulkan::LoadOp, vulkan::MAX_ATTACHMENTS> load_ops;
+		if (graphic_pass.clear) {
+			load_ops.push(vulkan::LoadOp::clear({.color = {.float32 = {0.0f, 0.0f, 0.0f, 1.0f}}}));
+		} else {
+			load_ops.push(vulkan::LoadOp::ignore());
+		}
+		if (graphic_pass.depth_attachment.is_valid()) {
+			load_ops.push(vulkan::LoadOp::clear({.color = {.float32 = {0.0f, 0.0f, 0.0f, 1.0f}}}));
+		}
+		ctx.begin_pass(framebuffer, load_ops);
 
-	for (auto &pass : this->passes) {
-		EXO_PROFILE_SCOPE_NAMED("render graph pass");
-		switch (pass.type) {
-		case PassType::Graphic: {
-			auto &graphic_pass = pass.pass.graphic;
-			auto  output_size  = this->resources.texture_desc_handle_size(graphic_pass.color_attachment);
-			auto  output_image = this->resources.resolve_image(api.device, graphic_pass.color_attachment);
+		ctx.set_viewport(
 
-			auto framebuffer = this->resources.resolve_framebuffer(api.device,
-				exo::Span{&graphic_pass.color_attachment, 1},
-				graphic_pass.depth_attachment);
+			{.width = (float)output_size.x, .height = (float)output_size.y, .minDepth = 0.0f, .maxDepth = 1.0f});
 
-			ctx.barrier(output_image, vulkan::ImageUsage::ColorAttachment);
+		ctx.set_scissor({.extent = {.width = (u32)output_size.x, .height = (u32)output_size.y}});
 
-			exo::DynamicArray<vulkan::LoadOp, vulkan::MAX_ATTACHMENTS> load_ops;
-			if (graphic_pass.clear) {
-				load_ops.push(vulkan::LoadOp::clear({.color = {.float32 = {0.0f, 0.0f, 0.0f, 1.0f}}}));
-			} else {
-				load_ops.push(vulkan::LoadOp::ignore());
-			}
-			if (graphic_pass.depth_attachment.is_valid()) {
-				load_ops.push(vulkan::LoadOp::clear({.color = {.float32 = {0.0f, 0.0f, 0.0f, 1.0f}}}));
-			}
-			ctx.begin_pass(framebuffer, load_ops);
+		pass.execute(graph, api, ctx);
 
-			ctx.set_viewport(
+		ctx.end_pass();
 
-				{.width = (float)output_size.x, .height = (float)output_size.y, .minDepth = 0.0f, .maxDepth = 1.0f});
+		break;
+	}
+	case PassType::Raw: {
+		pass.execute(graph, api, ctx);
+		break;
+	}
+	}
+}
 
-			ctx.set_scissor({.extent = {.width = (u32)output_size.x, .height = (u32)output_size.y}});
+void RenderGraph::execute(PassApi api, vulkan::WorkPool &work_pool)
+{
+	EXO_PROFILE_SCOPE;
 
-			pass.execute(*this, api, ctx);
+	this->resources.begin_frame(api.device, this->i_frame);
+	update_compiled_graph(this->compiled, this->passes);
+	this->resources.image_lifetimes = this->compiled.image_lifetimes;
+	EXO_PROFILE_PLOT_VALUE("Graph: culled passes", i64(this->compiled.culled_pass_count));
 
-			ctx.end_pass();
+	auto ctx = api.device.get_graphics_work(work_pool);
+	ctx.begin();
 
-			break;
+	Vec<std::pair<Handle<vulkan::Image>, vulkan::ImageUsage>>   image_barriers;
+	Vec<std::pair<Handle<vulkan::Image>, vulkan::ImageUsage>>   aliasing_barriers;
+	Vec<std::pair<Handle<vulkan::Buffer>, vulkan::BufferUsage>> buffer_barriers;
+	for (u32 i_batch = 0; i_batch < this->compiled.batches.len(); ++i_batch) {
+		const auto &batch = this->compiled.batches[i_batch];
+
+		// The images are resolved before the batch, the passes before it may have set them
+		image_barriers.clear();
+		aliasing_barriers.clear();
+		buffer_barriers.clear();
+		for (u32 i_barrier = 0; i_barrier < batch.image_barrier_count; ++i_barrier) {
+			const auto &barrier = this->compiled.image_barriers[batch.first_image_barrier + i_barrier];
+			const auto &access  = this->passes[barrier.i_pass].image_accesses[barrier.i_access];
+			const auto  image   = this->resources.resolve_image(api.device, access.texture);
+
+			// The memory of a transient image was used by other images before its first access
+			const auto &lifetime = this->compiled.image_lifetimes[access.texture.get_index()];
+			if (lifetime.first_batch == i_batch && this->resources.is_transient(access.texture)) {
+				aliasing_barriers.push(std::make_pair(image, access.usage));
+			} else {
+				image_barriers.push(std::make_pair(image, access.usage));
+			}
 		}
-		case PassType::Raw: {
-			pass.execute(*this, api, ctx);
-			break;
+		for (u32 i_barrier = 0; i_barrier < batch.buffer_barrier_count; ++i_barrier) {
+			const auto &barrier = this->compiled.buffer_barriers[batch.first_buffer_barrier + i_barrier];
+			const auto &access  = this->passes[barrier.i_pass].buffer_accesses[barrier.i_access];
+			buffer_barriers.push(std::make_pair(access.buffer, access.usage));
 		}
+		if (!aliasing_barriers.is_empty()) {
+			ctx.aliasing_barriers(aliasing_barriers);
+		}
+		if (!image_barriers.is_empty() || !buffer_barriers.is_empty()) {
+			ctx.barriers(image_barriers, buffer_barriers);
+		}
+
+		for (u32 i_pass = 0; i_pass < batch.pass_count; ++i_pass) {
+			execute_pass(*this, this->passes[this->compiled.pass_order[batch.first_pass + i_pass]], api, ctx);
 		}
 	}
 }
@@ -67,17 +109,15 @@ void RenderGraph::end_frame()
 	this->i_frame += 1;
 }
 
-GraphicPass &RenderGraph::graphic_pass(
+Pass &RenderGraph::graphic_pass(
 	Handle<TextureDesc> color_attachment, Handle<TextureDesc> depth_buffer, GraphicCb execute)
 {
-	passes.push(Pass::graphic(color_attachment, depth_buffer, std::move(execute)));
-	return passes.last().pass.graphic;
+	return passes.push(Pass::graphic(color_attachment, depth_buffer, std::move(execute)));
 }
 
-RawPass &RenderGraph::raw_pass(RawCb execute)
+Pass &RenderGraph::raw_pass(RawCb execute)
 {
-	passes.push(Pass::raw(std::move(execute)));
-	return passes.last().pass.raw;
+	return passes.push(Pass::raw(std::move(execute)));
 }
 
 Handle<TextureDesc> RenderGraph::output(TextureDesc desc) { return this->resources.texture_descs.add(std::move(desc)); }
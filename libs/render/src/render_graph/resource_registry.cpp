@@ -8,10 +8,42 @@
 #include "render/vulkan/image.h"
 #include "render/vulkan/utils.h"
 
+static void destroy_transient_memory(vulkan::Device &device, TransientMemory &memory)
+{
+	for (const auto &transient_image : memory.images) {
+		device.destroy_image(transient_image.image);
+	}
+	for (auto heap : memory.heaps) {
+		device.free_memory(heap);
+	}
+	memory.images.clear();
+	memory.heaps.clear();
+}
+
+void ResourceRegistry::destroy(vulkan::Device &device)
+{
+	destroy_transient_memory(device, this->transient_memory);
+	for (auto &memory : this->retired_transient_memories) {
+		destroy_transient_memory(device, memory);
+	}
+	this->retired_transient_memories.clear();
+}
+
 void ResourceRegistry::begin_frame(vulkan::Device &device, u64 frame)
 {
 	this->i_frame = frame;
 
+	// Destroy transient memory replaced 3 frames ago, the frames in flight may still use it
+	for (usize i_memory = 0; i_memory < this->retired_transient_memories.len();) {
+		auto &memory = this->retired_transient_memories[i_memory];
+		if (memory.last_frame_used + 3 < this->i_frame) {
+			destroy_transient_memory(device, memory);
+			this->retired_transient_memories.swap_remove(i_memory);
+		} else {
+			i_memory += 1;
+		}
+	}
+
 	Vec<Handle<vulkan::Image>> img_to_remove;
 	for (auto [image_handle, metadata_handle] : this->image_pool) {
 		const auto &metadata = this->image_metadatas.get(metadata_handle);
@@ -57,6 +89,10 @@ void ResourceRegistry::begin_frame(vulkan::Device &device, u64 frame)
 
 void ResourceRegistry::end_frame()
 {
+	this->image_lifetimes               = {};
+	this->are_transient_images_resolved = false;
+	this->transient_image_indices.clear();
+
 	this->texture_descs.clear();
 	for (auto [image, metadata_handle] : this->image_pool) {
 		this->image_metadatas.get(metadata_handle).resolved_desc = Handle<TextureDesc>::invalid();
@@ -79,6 +115,7 @@ static void update_image_metadata(ResourceRegistry &registry, Handle<vulkan::Ima
 
 void ResourceRegistry::set_image(Handle<TextureDesc> desc_handle, Handle<vulkan::Image> image_handle)
 {
+	ASSERT(!this->is_transient(desc_handle));
 	auto &desc          = this->texture_descs.get(desc_handle);
 	desc.resolved_image = image_handle;
 	update_image_metadata(*this, image_handle, desc_handle);
@@ -97,27 +134,142 @@ void ResourceRegistry::drop_image(Handle<vulkan::Image> image_handle)
 	}
 }
 
-Handle<vulkan::Image> ResourceRegistry::resolve_image(vulkan::Device &device, Handle<TextureDesc> desc_handle)
+static vulkan::ImageDescription get_image_description(ResourceRegistry &registry, Handle<TextureDesc> desc_handle)
 {
-	const auto &desc = this->texture_descs.get(desc_handle);
+	const auto &desc = registry.texture_descs.get(desc_handle);
 
-	Handle<vulkan::Image> resolved_image_handle = desc.resolved_image;
-	if (resolved_image_handle.is_valid() == false) {
+	VkImageUsageFlags usages = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+	                           VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+	                           VK_IMAGE_USAGE_STORAGE_BIT;
+	if (vulkan::is_depth_format(desc.format)) {
+		usages = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	}
 
-		VkImageUsageFlags usages = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
-		                           VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
-		                           VK_IMAGE_USAGE_STORAGE_BIT;
-		if (vulkan::is_depth_format(desc.format)) {
-			usages = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	return vulkan::ImageDescription{
+		.name   = desc.name,
+		.size   = int3(registry.texture_desc_handle_size(desc_handle), 1),
+		.type   = desc.image_type,
+		.format = desc.format,
+		.usages = usages,
+	};
+}
+
+static bool has_same_images(exo::Span<const TransientImage> lhs, exo::Span<const TransientImage> rhs)
+{
+	if (lhs.len() != rhs.len()) {
+		return false;
+	}
+	for (usize i_image = 0; i_image < lhs.len(); ++i_image) {
+		if (lhs[i_image].desc != rhs[i_image].desc || lhs[i_image].lifetime != rhs[i_image].lifetime) {
+			return false;
 		}
+	}
+	return true;
+}
 
-		auto desc_spec = vulkan::ImageDescription{
-			.name   = desc.name,
-			.size   = int3(this->texture_desc_handle_size(desc_handle), 1),
-			.type   = desc.image_type,
-			.format = desc.format,
-			.usages = usages,
+// Places the images of the textures accessed by the compiled graph in shared heaps. The memory of the previous frame
+// is reused when the images and their lifetimes did not change.
+static void resolve_transient_images(ResourceRegistry &registry, vulkan::Device &device)
+{
+	EXO_PROFILE_SCOPE;
+	registry.are_transient_images_resolved = true;
+
+	Vec<TransientImage> images;
+	Vec<u32>            desc_indices;
+	for (auto [desc_handle, desc] : registry.texture_descs) {
+		const u32 i_desc = desc_handle.get_index();
+		if (desc->is_imported || desc->resolved_image.is_valid() || i_desc >= registry.image_lifetimes.len() ||
+			!registry.image_lifetimes[i_desc].is_valid()) {
+			continue;
+		}
+		images.push(TransientImage{
+			.desc     = get_image_description(registry, desc_handle),
+			.lifetime = registry.image_lifetimes[i_desc],
+			.image    = {},
+		});
+		desc_indices.push(i_desc);
+	}
+
+	auto &memory = registry.transient_memory;
+	if (!has_same_images(images, memory.images)) {
+		if (!memory.images.is_empty()) {
+			registry.retired_transient_memories.push(std::move(memory));
+		}
+		memory = {};
+
+		Vec<TransientResource> resources;
+		for (const auto &transient_image : images) {
+			const auto requirements = device.get_image_memory_requirements(transient_image.desc);
+			resources.push(TransientResource{
+				.lifetime         = transient_image.lifetime,
+				.size             = requirements.size,
+				.alignment        = requirements.alignment,
+				.memory_type_bits = requirements.memoryTypeBits,
+			});
+		}
+
+		const auto layout = pack_transient_resources(resources);
+		for (const auto &heap : layout.heaps) {
+			const auto requirements = VkMemoryRequirements{
+				.size           = heap.size,
+				.alignment      = heap.alignment,
+				.memoryTypeBits = heap.memory_type_bits,
+			};
+			memory.heaps.push(device.allocate_memory(requirements, "transient heap"));
+		}
+		for (usize i_image = 0; i_image < images.len(); ++i_image) {
+			const auto &placement = layout.placements[i_image];
+			images[i_image].image =
+				device.create_aliased_image(images[i_image].desc, memory.heaps[placement.i_heap], placement.offset);
+		}
+		memory.images = std::move(images);
+		device.update_globals();
+
+		registry.transient_stats = TransientMemoryStats{
+			.requested_size = layout.requested_size,
+			.allocated_size = layout.allocated_size,
+			.image_count    = u32(layout.placements.len()),
+			.heap_count     = u32(layout.heaps.len()),
 		};
+	}
+	memory.last_frame_used = registry.i_frame;
+
+	for (u32 i_image = 0; i_image < desc_indices.len(); ++i_image) {
+		const u32 i_desc = desc_indices[i_image];
+		if (i_desc >= registry.transient_image_indices.len()) {
+			registry.transient_image_indices.resize(i_desc + 1, u32_invalid);
+		}
+		registry.transient_image_indices[i_desc] = i_image;
+	}
+
+	EXO_PROFILE_PLOT_VALUE("Graph: transient memory allocated", i64(registry.transient_stats.allocated_size));
+	EXO_PROFILE_PLOT_VALUE("Graph: transient memory saved", i64(registry.transient_stats.saved_size()));
+}
+
+bool ResourceRegistry::is_transient(Handle<TextureDesc> desc_handle) const
+{
+	const u32 i_desc = desc_handle.get_index();
+	return i_desc < this->transient_image_indices.len() && this->transient_image_indices[i_desc] != u32_invalid;
+}
+
+Handle<vulkan::Image> ResourceRegistry::resolve_image(vulkan::Device &device, Handle<TextureDesc> desc_handle)
+{
+	const auto &desc = this->texture_descs.get(desc_handle);
+	if (!desc.resolved_image.is_valid() && !this->are_transient_images_resolved) {
+		resolve_transient_images(*this, device);
+	}
+
+	// Transient images belong to the transient memory, they are never reused for other textures
+	if (this->is_transient(desc_handle)) {
+		const u32  i_image = this->transient_image_indices[desc_handle.get_index()];
+		const auto image   = this->transient_memory.images[i_image].image;
+		this->texture_descs.get(desc_handle).resolved_image = image;
+		return image;
+	}
+
+	Handle<vulkan::Image> resolved_image_handle = desc.resolved_image;
+	if (resolved_image_handle.is_valid() == false) {
+		const auto desc_spec = get_image_description(*this, desc_handle);
 
 		for (auto [image_handle, metadata_handle] : this->image_pool) {
 			const auto &metadata = this->image_metadatas.get(metadata_handle);
@@ -0,0 +1,105 @@
+#include "render/render_graph/transient_memory.h"
+
+#include "exo/macros/assert.h"
+#include "exo/maths/pointer.h"
+#include "exo/profile.h"
+
+#include <algorithm>
+
+struct HeapPacking
+{
+	Vec<u32> resources; // placed in the heap, sorted by offset
+};
+
+// Lowest offset in the heap where the resource does not overlap the placed resources alive at the same time
+static u64 find_heap_offset(exo::Span<const TransientResource> resources,
+	const TransientLayout                                      &layout,
+	const HeapPacking                                          &packing,
+	const TransientResource                                    &resource)
+{
+	u64 offset = 0;
+	for (const u32 i_placed : packing.resources) {
+		const auto &placed = resources[i_placed];
+		if (!placed.lifetime.overlaps(resource.lifetime)) {
+			continue;
+		}
+
+		const u64 placed_offset = layout.placements[i_placed].offset;
+		const u64 aligned       = exo::round_up_to_alignment(resource.alignment, offset);
+		if (aligned + resource.size <= placed_offset) {
+			break;
+		}
+		offset = std::max(offset, placed_offset + placed.size);
+	}
+	return exo::round_up_to_alignment(resource.alignment, offset);
+}
+
+TransientLayout pack_transient_resources(exo::Span<const TransientResource> resources)
+{
+	EXO_PROFILE_SCOPE;
+	TransientLayout layout = {};
+	layout.placements.resize(resources.len());
+
+	auto order = Vec<u32>::with_capacity(resources.len());
+	for (u32 i_resource = 0; i_resource < resources.len(); ++i_resource) {
+		ASSERT(resources[i_resource].lifetime.is_valid());
+		ASSERT(resources[i_resource].memory_type_bits != 0);
+		order.push(i_resource);
+		layout.requested_size += resources[i_resource].size;
+	}
+	std::stable_sort(order.begin(), order.end(), [&](u32 lhs, u32 rhs) {
+		return resources[lhs].size > resources[rhs].size;
+	});
+
+	Vec<HeapPacking> packings;
+	for (const u32 i_resource : order) {
+		const auto &resource = resources[i_resource];
+
+		// The heap growing the least, a new heap is only created when no heap has a compatible memory type
+		u32 i_best_heap = u32_invalid;
+		u64 best_offset = 0;
+		u64 best_growth = u64_invalid;
+		for (u32 i_heap = 0; i_heap < layout.heaps.len(); ++i_heap) {
+			const auto &heap = layout.heaps[i_heap];
+			if ((heap.memory_type_bits & resource.memory_type_bits) == 0) {
+				continue;
+			}
+			const u64 offset = find_heap_offset(resources, layout, packings[i_heap], resource);
+			const u64 end    = offset + resource.size;
+			const u64 growth = end > heap.size ? end - heap.size : 0;
+			if (growth < best_growth) {
+				i_best_heap = i_heap;
+				best_offset = offset;
+				best_growth = growth;
+			}
+		}
+
+		if (i_best_heap == u32_invalid) {
+			i_best_heap = u32(layout.heaps.len());
+			layout.heaps.push(TransientHeap{
+				.size             = 0,
+				.alignment        = 1,
+				.memory_type_bits = resource.memory_type_bits,
+			});
+			packings.push();
+		}
+
+		auto &heap            = layout.heaps[i_best_heap];
+		heap.size             = std::max(heap.size, best_offset + resource.size);
+		heap.alignment        = std::max(heap.alignment, resource.alignment);
+		heap.memory_type_bits = heap.memory_type_bits & resource.memory_type_bits;
+
+		layout.placements[i_resource] = TransientPlacement{.i_heap = i_best_heap, .offset = best_offset};
+
+		auto &placed = packings[i_best_heap].resources;
+		placed.push(i_resource);
+		std::stable_sort(placed.begin(), placed.end(), [&](u32 lhs, u32 rhs) {
+			return layout.placements[lhs].offset < layout.placements[rhs].offset;
+		});
+	}
+
+	for (const auto &heap : layout.heaps) {
+		layout.allocated_size += heap.size;
+	}
+	return layout;
+}
@@ -90,6 +90,7 @@ void SimpleRenderer::destroy()
 		device.destroy_work_pool(workpool);
 	}
 
+	this->render_graph.resources.destroy(this->device);
 	this->swapchain_node.surface.destroy(this->context, this->device);
 	this->device.destroy(this->context);
 	this->context.destroy();
@@ -126,7 +127,7 @@ void SimpleRenderer::render(Handle<TextureDesc> output, float dt)
 	auto swapchain_output = builtins::acquire_next_image(this->render_graph, this->swapchain_node);
 
 	builtins::blit_image(this->render_graph, output, swapchain_output);
-	builtins::present(this->render_graph, this->swapchain_node, i_frame + FRAME_QUEUE_LENGTH);
+	builtins::present(this->render_graph, this->swapchain_node, swapchain_output, i_frame + FRAME_QUEUE_LENGTH);
 
 	auto  current_frame = i_frame % FRAME_QUEUE_LENGTH;
 	auto &workpool      = this->workpools[current_frame];
@@ -163,8 +163,8 @@ void Work::barriers(exo::Span<std::pair<Handle<Image>, ImageUsage>> images,
 	exo::Span<std::pair<Handle<Buffer>, BufferUsage>>               buffers)
 {
 	EXO_PROFILE_SCOPE;
-	exo::DynamicArray<VkImageMemoryBarrier, 8>  image_barriers  = {};
-	exo::DynamicArray<VkBufferMemoryBarrier, 8> buffer_barriers = {};
+	exo::DynamicArray<VkImageMemoryBarrier, 32>  image_barriers  = {};
+	exo::DynamicArray<VkBufferMemoryBarrier, 32> buffer_barriers = {};
 
 	VkPipelineStageFlags src_stage = 0;
 	VkPipelineStageFlags dst_stage = 0;
@@ -203,6 +203,37 @@ void Work::barriers(exo::Span<std::pair<Handle<Image>, ImageUsage>> images,
 		image_barriers.data());
 }
 
+void Work::aliasing_barriers(exo::Span<std::pair<Handle<Image>, ImageUsage>> images)
+{
+	EXO_PROFILE_SCOPE;
+	exo::DynamicArray<VkImageMemoryBarrier, 32> image_barriers = {};
+
+	VkPipelineStageFlags dst_stage = 0;
+	for (auto &[image_handle, usage_dst] : images) {
+		auto &image = device->images.get(image_handle);
+
+		auto src_access   = get_src_image_access(ImageUsage::None);
+		src_access.stage  = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+		src_access.access = VK_ACCESS_MEMORY_WRITE_BIT;
+		auto dst_access   = get_dst_image_access(usage_dst);
+		image_barriers.push(get_image_barrier(image.vkhandle, src_access, dst_access, image.full_view.range));
+		dst_stage |= dst_access.stage;
+
+		image.usage = usage_dst;
+	}
+
+	vkCmdPipelineBarrier(command_buffer,
+		VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+		dst_stage,
+		0,
+		0,
+		nullptr,
+		0,
+		nullptr,
+		static_cast<u32>(image_barriers.len()),
+		image_barriers.data());
+}
+
 // Queries
 void Work::reset_query_pool(QueryPool &query_pool, u32 first_query, u32 count)
 {
@@ -312,6 +343,21 @@ void TransferWork::copy_image(Handle<Image> src, Handle<Image> dst)
 		&copy);
 }
 
+void TransferWork::copy_image(Handle<Image> src, Handle<Image> dst, exo::Span<const VkImageCopy> regions)
+{
+	EXO_PROFILE_SCOPE;
+	auto &src_image = device->images.get(src);
+	auto &dst_image = device->images.get(dst);
+
+	vkCmdCopyImage(command_buffer,
+		src_image.vkhandle,
+		VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		dst_image.vkhandle,
+		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		static_cast<u32>(regions.len()),
+		regions.data());
+}
+
 void TransferWork::blit_image(Handle<Image> src, Handle<Image> dst)
 {
 	EXO_PROFILE_SCOPE;
@@ -205,7 +205,7 @@ Device Device::create(const Context &context, const DeviceDescription &desc)
 	sampler_info.compareOp           = VK_COMPARE_OP_NEVER;
 	sampler_info.borderColor         = VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK;
 	sampler_info.minLod              = 0;
-	sampler_info.maxLod              = 7;
+	sampler_info.maxLod              = VK_LOD_CLAMP_NONE;
 	sampler_info.maxAnisotropy       = 8.0f;
 	sampler_info.anisotropyEnable    = true;
 	vk_check(vkCreateSampler(device.device, &sampler_info, nullptr, &device.samplers[BuiltinSampler::Default]));
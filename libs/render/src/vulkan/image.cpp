@@ -49,12 +49,8 @@ static ImageView create_image_view(Device &device,
 	return view;
 }
 
-Handle<Image> Device::create_image(const ImageDescription &image_desc, Option<VkImage> proxy)
+static VkImageCreateInfo get_image_create_info(const ImageDescription &image_desc)
 {
-	const bool is_sampled = image_desc.usages & VK_IMAGE_USAGE_SAMPLED_BIT;
-	const bool is_storage = image_desc.usages & VK_IMAGE_USAGE_STORAGE_BIT;
-	const bool is_depth   = is_depth_format(image_desc.format);
-
 	ASSERT(image_desc.size.x > 0);
 	ASSERT(image_desc.size.y > 0);
 	ASSERT(image_desc.size.z > 0);
@@ -74,68 +70,124 @@ Handle<Image> Device::create_image(const ImageDescription &image_desc, Option<Vk
 	image_info.pQueueFamilyIndices   = nullptr;
 	image_info.sharingMode           = VK_SHARING_MODE_EXCLUSIVE;
 	image_info.tiling                = VK_IMAGE_TILING_OPTIMAL;
+	return image_info;
+}
 
-	VkImage       vkhandle   = VK_NULL_HANDLE;
-	VmaAllocation allocation = VK_NULL_HANDLE;
-
-	if (proxy) {
-		vkhandle = *proxy;
-	} else {
-		VmaAllocationCreateInfo alloc_info{};
-		alloc_info.flags     = VMA_ALLOCATION_CREATE_USER_DATA_COPY_STRING_BIT;
-		alloc_info.usage     = VmaMemoryUsage(image_desc.memory_usage);
-		alloc_info.pUserData = const_cast<void *>(reinterpret_cast<const void *>(image_desc.name.c_str()));
-
-		vk_check(vmaCreateImage(allocator, &image_info, &alloc_info, &vkhandle, &allocation, nullptr));
-	}
+// Names the image, creates its view and binds it to the bindless set
+static Handle<Image> add_image(
+	Device &device, const ImageDescription &image_desc, VkImage vkhandle, VmaAllocation allocation, bool is_proxy)
+{
+	const bool is_sampled = image_desc.usages & VK_IMAGE_USAGE_SAMPLED_BIT;
+	const bool is_storage = image_desc.usages & VK_IMAGE_USAGE_STORAGE_BIT;
+	const bool is_depth   = is_depth_format(image_desc.format);
 
 	if (vkSetDebugUtilsObjectNameEXT) {
 		VkDebugUtilsObjectNameInfoEXT ni = {.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT};
 		ni.objectHandle                  = reinterpret_cast<u64>(vkhandle);
 		ni.objectType                    = VK_OBJECT_TYPE_IMAGE;
 		ni.pObjectName                   = image_desc.name.c_str();
-		vk_check(vkSetDebugUtilsObjectNameEXT(device, &ni));
+		vk_check(vkSetDebugUtilsObjectNameEXT(device.device, &ni));
 	}
 
 	VkImageSubresourceRange full_range = {};
 	full_range.aspectMask              = is_depth ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
 	full_range.baseMipLevel            = 0;
-	full_range.levelCount              = image_info.mipLevels;
+	full_range.levelCount              = image_desc.mip_levels;
 	full_range.baseArrayLayer          = 0;
-	full_range.layerCount              = image_info.arrayLayers;
+	full_range.layerCount              = 1;
 	const VkFormat format              = image_desc.format;
 
 	exo::ScopeStack scope;
-	const ImageView full_view = create_image_view(*this,
+	const ImageView full_view = create_image_view(device,
 		vkhandle,
 		exo::formatf(scope, "%.*s full view", image_desc.name.len(), image_desc.name.data()),
 		full_range,
 		format,
 		view_type_from_image(image_desc.type));
 
-	auto handle = images.add({
+	auto handle = device.images.add({
 		.desc       = image_desc,
 		.vkhandle   = vkhandle,
 		.allocation = allocation,
 		.usage      = ImageUsage::None,
-		.is_proxy   = proxy.has_value(),
+		.is_proxy   = is_proxy,
 		.full_view  = full_view,
 	});
 
 	// Bindless (bind everything)
 	if (is_sampled) {
-		auto &image                 = images.get(handle);
-		image.full_view.sampled_idx = bind_sampler_image(global_sets.bindless, handle);
+		auto &image                 = device.images.get(handle);
+		image.full_view.sampled_idx = bind_sampler_image(device.global_sets.bindless, handle);
 	}
 
 	if (is_storage) {
-		auto &image                 = images.get(handle);
-		image.full_view.storage_idx = bind_storage_image(global_sets.bindless, handle);
+		auto &image                 = device.images.get(handle);
+		image.full_view.storage_idx = bind_storage_image(device.global_sets.bindless, handle);
 	}
 
 	return handle;
 }
 
+Handle<Image> Device::create_image(const ImageDescription &image_desc, Option<VkImage> proxy)
+{
+	const VkImageCreateInfo image_info = get_image_create_info(image_desc);
+
+	VkImage       vkhandle   = VK_NULL_HANDLE;
+	VmaAllocation allocation = VK_NULL_HANDLE;
+
+	if (proxy) {
+		vkhandle = *proxy;
+	} else {
+		VmaAllocationCreateInfo alloc_info{};
+		alloc_info.flags     = VMA_ALLOCATION_CREATE_USER_DATA_COPY_STRING_BIT;
+		alloc_info.usage     = VmaMemoryUsage(image_desc.memory_usage);
+		alloc_info.pUserData = const_cast<void *>(reinterpret_cast<const void *>(image_desc.name.c_str()));
+
+		vk_check(vmaCreateImage(allocator, &image_info, &alloc_info, &vkhandle, &allocation, nullptr));
+	}
+
+	return add_image(*this, image_desc, vkhandle, allocation, proxy.has_value());
+}
+
+// The image does not own its memory, destroying it leaves the allocation untouched
+Handle<Image> Device::create_aliased_image(const ImageDescription &image_desc, VmaAllocation memory, u64 offset)
+{
+	const VkImageCreateInfo image_info = get_image_create_info(image_desc);
+
+	VkImage vkhandle = VK_NULL_HANDLE;
+	vk_check(vmaCreateAliasingImage2(allocator, memory, offset, &image_info, &vkhandle));
+
+	return add_image(*this, image_desc, vkhandle, VK_NULL_HANDLE, false);
+}
+
+VkMemoryRequirements Device::get_image_memory_requirements(const ImageDescription &image_desc)
+{
+	const VkImageCreateInfo image_info = get_image_create_info(image_desc);
+
+	VkImage vkhandle = VK_NULL_HANDLE;
+	vk_check(vkCreateImage(device, &image_info, nullptr, &vkhandle));
+	VkMemoryRequirements requirements = {};
+	vkGetImageMemoryRequirements(device, vkhandle, &requirements);
+	vkDestroyImage(device, vkhandle, nullptr);
+	return requirements;
+}
+
+VmaAllocation Device::allocate_memory(const VkMemoryRequirements &requirements, exo::StringView name)
+{
+	exo::ScopeStack scope;
+
+	VmaAllocationCreateInfo alloc_info{};
+	alloc_info.flags          = VMA_ALLOCATION_CREATE_USER_DATA_COPY_STRING_BIT;
+	alloc_info.preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+	alloc_info.pUserData      = const_cast<char *>(exo::formatf(scope, "%.*s", name.len(), name.data()).data());
+
+	VmaAllocation allocation = VK_NULL_HANDLE;
+	vk_check(vmaAllocateMemory(allocator, &requirements, &alloc_info, &allocation, nullptr));
+	return allocation;
+}
+
+void Device::free_memory(VmaAllocation allocation) { vmaFreeMemory(allocator, allocation); }
+
 void Device::destroy_image(Handle<Image> image_handle)
 {
 	auto &image = images.get(image_handle);
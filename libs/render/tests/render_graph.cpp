@@ -0,0 +1,232 @@
+#include "render/render_graph/graph.h"
+#include "render/vulkan/buffer.h"
+#include "render/vulkan/image.h"
+#include <catch2/catch_test_macros.hpp>
+
+// The compilation only reads the declarations of the passes, no device is created
+namespace
+{
+void empty_pass(RenderGraph &, PassApi &, vulkan::GraphicsWork &) {}
+
+Pass &raw_pass(Vec<Pass> &passes) { return passes.push(Pass::raw(empty_pass)); }
+
+Pass &graphic_pass(Vec<Pass> &passes, Handle<TextureDesc> color)
+{
+	return passes.push(Pass::graphic(color, Handle<TextureDesc>::invalid(), empty_pass));
+}
+
+// Passes in execution order
+Vec<u32> get_executed_passes(const CompiledGraph &compiled)
+{
+	Vec<u32> executed;
+	for (const auto &batch : compiled.batches) {
+		for (u32 i_pass = 0; i_pass < batch.pass_count; ++i_pass) {
+			executed.push(compiled.pass_order[batch.first_pass + i_pass]);
+		}
+	}
+	return executed;
+}
+
+u32 count_image_barriers(const CompiledGraph &compiled, u32 i_pass)
+{
+	u32 count = 0;
+	for (const auto &barrier : compiled.image_barriers) {
+		count += barrier.i_pass == i_pass ? 1 : 0;
+	}
+	return count;
+}
+
+u32 find_batch(const CompiledGraph &compiled, u32 i_pass)
+{
+	for (u32 i_batch = 0; i_batch < compiled.batches.len(); ++i_batch) {
+		const auto &batch = compiled.batches[i_batch];
+		for (u32 i_order = batch.first_pass; i_order < batch.first_pass + batch.pass_count; ++i_order) {
+			if (compiled.pass_order[i_order] == i_pass) {
+				return i_batch;
+			}
+		}
+	}
+	return u32_invalid;
+}
+} // namespace
+
+TEST_CASE("Render graph culling", "[render_graph]")
+{
+	exo::Pool<TextureDesc> textures;
+	Vec<Pass>              passes;
+	const auto             gbuffer  = textures.add(TextureDesc{.name = "gbuffer"});
+	const auto             unused   = textures.add(TextureDesc{.name = "unused"});
+	const auto             lighting = textures.add(TextureDesc{.name = "lighting"});
+	const auto             output   = textures.add(TextureDesc{.name = "output"});
+
+	raw_pass(passes).write(gbuffer, vulkan::ImageUsage::ComputeShaderReadWrite);
+	raw_pass(passes).write(unused, vulkan::ImageUsage::ComputeShaderReadWrite);
+	raw_pass(passes)
+		.read(gbuffer, vulkan::ImageUsage::ComputeShaderRead)
+		.write(lighting, vulkan::ImageUsage::ComputeShaderReadWrite);
+	// Overwritten before being read
+	raw_pass(passes).write(output, vulkan::ImageUsage::TransferDst);
+	raw_pass(passes)
+		.read(lighting, vulkan::ImageUsage::TransferSrc)
+		.write(output, vulkan::ImageUsage::TransferDst);
+	raw_pass(passes).read(output, vulkan::ImageUsage::Present);
+
+	const auto compiled = compile_graph(passes);
+	REQUIRE(compiled.culled_pass_count == 2);
+
+	const auto executed = get_executed_passes(compiled);
+	REQUIRE(executed.len() == 4);
+	REQUIRE(executed[0] == 0);
+	REQUIRE(executed[1] == 2);
+	REQUIRE(executed[2] == 4);
+	REQUIRE(executed[3] == 5);
+
+	SECTION("Passes without declarations are kept")
+	{
+		raw_pass(passes);
+		passes.last().has_side_effects = false;
+		raw_pass(passes).write(unused, vulkan::ImageUsage::TransferDst).has_side_effects = true;
+
+		const auto with_side_effects = compile_graph(passes);
+		REQUIRE(with_side_effects.culled_pass_count == 2);
+		REQUIRE(find_batch(with_side_effects, 6) != u32_invalid);
+		REQUIRE(find_batch(with_side_effects, 7) != u32_invalid);
+	}
+}
+
+TEST_CASE("Render graph ordering and barriers", "[render_graph]")
+{
+	exo::Pool<TextureDesc> textures;
+	Vec<Pass>              passes;
+	const auto             shadows = textures.add(TextureDesc{.name = "shadows"});
+	const auto             ao      = textures.add(TextureDesc{.name = "ao"});
+	const auto             color   = textures.add(TextureDesc{.name = "color"});
+	const auto             screen  = textures.add(TextureDesc{.name = "screen"});
+
+	exo::Pool<vulkan::Buffer> buffers;
+	const auto                culled_instances = buffers.add(vulkan::Buffer{});
+
+	// 0, 1, 2
+	raw_pass(passes).write(shadows, vulkan::ImageUsage::ComputeShaderReadWrite);
+	raw_pass(passes).write(ao, vulkan::ImageUsage::ComputeShaderReadWrite);
+	raw_pass(passes).write(culled_instances, vulkan::BufferUsage::ComputeShaderReadWrite);
+	// 3, 4
+	graphic_pass(passes, color)
+		.read(shadows, vulkan::ImageUsage::GraphicsShaderRead)
+		.read(ao, vulkan::ImageUsage::GraphicsShaderRead)
+		.read(culled_instances, vulkan::BufferUsage::GraphicsShaderRead);
+	raw_pass(passes).read(ao, vulkan::ImageUsage::GraphicsShaderRead).has_side_effects = true;
+	// 5, 6
+	raw_pass(passes)
+		.read(color, vulkan::ImageUsage::ComputeShaderRead)
+		.write(screen, vulkan::ImageUsage::ComputeShaderReadWrite);
+	raw_pass(passes).read(screen, vulkan::ImageUsage::Present);
+
+	const auto compiled = compile_graph(passes);
+	REQUIRE(compiled.culled_pass_count == 0);
+
+	// The independent passes are batched, their barriers are issued together
+	REQUIRE(compiled.batches.len() == 4);
+	REQUIRE(find_batch(compiled, 0) == 0);
+	REQUIRE(find_batch(compiled, 1) == 0);
+	REQUIRE(find_batch(compiled, 2) == 0);
+	REQUIRE(find_batch(compiled, 3) == 1);
+	REQUIRE(find_batch(compiled, 4) == 1);
+	REQUIRE(find_batch(compiled, 5) == 2);
+	REQUIRE(find_batch(compiled, 6) == 3);
+	REQUIRE(compiled.batches[0].image_barrier_count == 2);
+	REQUIRE(compiled.batches[0].buffer_barrier_count == 1);
+
+	// `ao` is read with the same usage by two passes of a batch, it only needs one barrier
+	REQUIRE(compiled.batches[1].image_barrier_count == 3);
+	REQUIRE(compiled.batches[1].buffer_barrier_count == 1);
+	REQUIRE(count_image_barriers(compiled, 3) + count_image_barriers(compiled, 4) == 3);
+
+	REQUIRE(count_image_barriers(compiled, 5) == 2);
+	REQUIRE(count_image_barriers(compiled, 6) == 1);
+
+	// Transient memory is reserved for the batches accessing the textures
+	const auto &lifetimes = compiled.image_lifetimes;
+	REQUIRE(lifetimes[shadows.get_index()] == ResourceLifetime{.first_batch = 0, .last_batch = 1});
+	REQUIRE(lifetimes[ao.get_index()] == ResourceLifetime{.first_batch = 0, .last_batch = 1});
+	REQUIRE(lifetimes[color.get_index()] == ResourceLifetime{.first_batch = 1, .last_batch = 2});
+	REQUIRE(lifetimes[screen.get_index()] == ResourceLifetime{.first_batch = 2, .last_batch = 3});
+
+	SECTION("Reads with different usages are serialized")
+	{
+		raw_pass(passes).read(shadows, vulkan::ImageUsage::ComputeShaderRead).has_side_effects = true;
+
+		const auto serialized = compile_graph(passes);
+		REQUIRE(find_batch(serialized, 7) > find_batch(serialized, 3));
+		REQUIRE(count_image_barriers(serialized, 7) == 1);
+	}
+
+	SECTION("Passes without declarations are not reordered")
+	{
+		passes.clear();
+		raw_pass(passes).write(shadows, vulkan::ImageUsage::ComputeShaderReadWrite).has_side_effects = true;
+		raw_pass(passes);
+		raw_pass(passes).write(ao, vulkan::ImageUsage::ComputeShaderReadWrite).has_side_effects = true;
+
+		const auto fenced = compile_graph(passes);
+		REQUIRE(fenced.batches.len() == 3);
+		REQUIRE(find_batch(fenced, 0) == 0);
+		REQUIRE(find_batch(fenced, 1) == 1);
+		REQUIRE(find_batch(fenced, 2) == 2);
+	}
+
+	SECTION("Fences are executed after every previous pass")
+	{
+		// Like `present`, the fence only reads the screen, the other passes have higher levels
+		passes.clear();
+		raw_pass(passes).write(screen, vulkan::ImageUsage::ComputeShaderReadWrite);
+		raw_pass(passes).write(shadows, vulkan::ImageUsage::ComputeShaderReadWrite);
+		raw_pass(passes)
+			.read(shadows, vulkan::ImageUsage::ComputeShaderRead)
+			.write(ao, vulkan::ImageUsage::ComputeShaderReadWrite);
+		raw_pass(passes).read(ao, vulkan::ImageUsage::ComputeShaderRead).has_side_effects = true;
+		raw_pass(passes).read(screen, vulkan::ImageUsage::Present).is_fence = true;
+		raw_pass(passes).write(color, vulkan::ImageUsage::ComputeShaderReadWrite).has_side_effects = true;
+
+		const auto fenced = compile_graph(passes);
+		REQUIRE(fenced.culled_pass_count == 0);
+		REQUIRE(fenced.pass_order[4] == 4);
+		REQUIRE(fenced.pass_order[5] == 5);
+		REQUIRE(find_batch(fenced, 4) == find_batch(fenced, 3) + 1);
+		REQUIRE(find_batch(fenced, 5) == find_batch(fenced, 4) + 1);
+	}
+}
+
+TEST_CASE("Render graph compilation cache", "[render_graph]")
+{
+	exo::Pool<TextureDesc> textures;
+	Vec<Pass>              passes;
+	auto                   build_frame = [&](bool with_blur) {
+		passes.clear();
+		textures.clear();
+		const auto color  = textures.add(TextureDesc{.name = "color"});
+		const auto screen = textures.add(TextureDesc{.name = "screen"});
+		graphic_pass(passes, color);
+		if (with_blur) {
+			raw_pass(passes).read(color, vulkan::ImageUsage::ComputeShaderRead).has_side_effects = true;
+		}
+		raw_pass(passes).read(color, vulkan::ImageUsage::TransferSrc).write(screen, vulkan::ImageUsage::TransferDst);
+		raw_pass(passes).read(screen, vulkan::ImageUsage::Present);
+	};
+
+	CompiledGraph compiled = {};
+	build_frame(false);
+	REQUIRE(update_compiled_graph(compiled, passes));
+	REQUIRE(compiled.pass_order.len() == 3);
+
+	// The texture descs are created again every frame, the graph keeps the same shape
+	build_frame(false);
+	REQUIRE(!update_compiled_graph(compiled, passes));
+
+	build_frame(true);
+	REQUIRE(update_compiled_graph(compiled, passes));
+	REQUIRE(compiled.pass_order.len() == 4);
+
+	passes[0].pass.graphic.clear = false;
+	REQUIRE(update_compiled_graph(compiled, passes));
+}
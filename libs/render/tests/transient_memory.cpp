@@ -0,0 +1,124 @@
+#include "render/render_graph/transient_memory.h"
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+TransientResource make_resource(u32 first_batch, u32 last_batch, u64 size, u64 alignment = 256, u32 memory_types = 0b1)
+{
+	return TransientResource{
+		.lifetime         = {.first_batch = first_batch, .last_batch = last_batch},
+		.size             = size,
+		.alignment        = alignment,
+		.memory_type_bits = memory_types,
+	};
+}
+
+// Resources alive at the same time in the same heap never share memory
+bool is_layout_valid(exo::Span<const TransientResource> resources, const TransientLayout &layout)
+{
+	for (usize i_resource = 0; i_resource < resources.len(); ++i_resource) {
+		const auto &resource  = resources[i_resource];
+		const auto &placement = layout.placements[i_resource];
+		const auto &heap      = layout.heaps[placement.i_heap];
+		if (placement.offset % resource.alignment != 0 || placement.offset + resource.size > heap.size ||
+			(heap.memory_type_bits & resource.memory_type_bits) != heap.memory_type_bits) {
+			return false;
+		}
+
+		for (usize i_other = i_resource + 1; i_other < resources.len(); ++i_other) {
+			const auto &other           = resources[i_other];
+			const auto &other_placement = layout.placements[i_other];
+			if (other_placement.i_heap != placement.i_heap || !resource.lifetime.overlaps(other.lifetime)) {
+				continue;
+			}
+			if (placement.offset < other_placement.offset + other.size &&
+				other_placement.offset < placement.offset + resource.size) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+} // namespace
+
+TEST_CASE("Transient memory aliasing", "[render_graph]")
+{
+	SECTION("Resources with disjoint lifetimes share memory")
+	{
+		const Vec<TransientResource> resources = {
+			make_resource(0, 1, 4096),
+			make_resource(2, 3, 4096),
+			make_resource(4, 4, 1024),
+		};
+		const auto layout = pack_transient_resources(resources);
+		REQUIRE(is_layout_valid(resources, layout));
+		REQUIRE(layout.heaps.len() == 1);
+		REQUIRE(layout.placements[0].offset == 0);
+		REQUIRE(layout.placements[1].offset == 0);
+		REQUIRE(layout.placements[2].offset == 0);
+		REQUIRE(layout.requested_size == 9216);
+		REQUIRE(layout.allocated_size == 4096);
+	}
+
+	SECTION("Resources alive in the same batch do not overlap")
+	{
+		const Vec<TransientResource> resources = {
+			make_resource(0, 2, 4096),
+			make_resource(2, 3, 2048),
+			make_resource(1, 1, 1024),
+			make_resource(3, 5, 4096),
+		};
+		const auto layout = pack_transient_resources(resources);
+		REQUIRE(is_layout_valid(resources, layout));
+		REQUIRE(layout.heaps.len() == 1);
+		// The last resource reuses the memory of the first one
+		REQUIRE(layout.placements[3].offset == layout.placements[0].offset);
+		REQUIRE(layout.allocated_size == 4096 + 2048);
+	}
+
+	SECTION("Offsets respect the alignment of the resources")
+	{
+		const Vec<TransientResource> resources = {
+			make_resource(0, 1, 1000, 8),
+			make_resource(0, 1, 4096, 4096),
+			make_resource(0, 1, 100, 512),
+		};
+		const auto layout = pack_transient_resources(resources);
+		REQUIRE(is_layout_valid(resources, layout));
+		REQUIRE(layout.heaps[0].alignment == 4096);
+		REQUIRE(layout.allocated_size == layout.requested_size + 24);
+	}
+
+	SECTION("Heaps are only shared by resources with a common memory type")
+	{
+		const Vec<TransientResource> resources = {
+			make_resource(0, 0, 4096, 256, 0b011),
+			make_resource(1, 1, 4096, 256, 0b100),
+			make_resource(2, 2, 4096, 256, 0b010),
+		};
+		const auto layout = pack_transient_resources(resources);
+		REQUIRE(is_layout_valid(resources, layout));
+		REQUIRE(layout.heaps.len() == 2);
+		REQUIRE(layout.placements[0].i_heap == layout.placements[2].i_heap);
+		REQUIRE(layout.heaps[layout.placements[0].i_heap].memory_type_bits == 0b010);
+		REQUIRE(layout.allocated_size == 2 * 4096);
+	}
+
+	SECTION("Packing many resources")
+	{
+		Vec<TransientResource> resources;
+		u32                    state = 0x9E3779B9;
+		for (u32 i_resource = 0; i_resource < 64; ++i_resource) {
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			const u32 first_batch = state % 16;
+			const u32 last_batch  = first_batch + (state >> 8) % 4;
+			resources.push(make_resource(first_batch, last_batch, 256 * (1 + (state >> 16) % 64)));
+		}
+		const auto layout = pack_transient_resources(resources);
+		REQUIRE(is_layout_valid(resources, layout));
+		REQUIRE(layout.heaps.len() == 1);
+		REQUIRE(layout.allocated_size < layout.requested_size);
+	}
+}
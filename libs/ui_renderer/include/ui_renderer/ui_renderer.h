@@ -11,7 +11,7 @@ struct Device;
 struct RenderGraph;
 struct TextureDesc;
 struct Painter;
-struct GraphicPass;
+struct Pass;
 
 struct UiRenderer
 {
@@ -21,4 +21,4 @@ struct UiRenderer
 	static UiRenderer create(vulkan::Device &device, int2 atlas_resolution);
 };
 
-GraphicPass &register_graph(RenderGraph &graph, UiRenderer &renderer, Painter *painter, Handle<TextureDesc> output);
+Pass &register_graph(RenderGraph &graph, UiRenderer &renderer, Painter *painter, Handle<TextureDesc> output);
@@ -28,7 +28,7 @@ UiRenderer UiRenderer::create(vulkan::Device &device, int2 atlas_resolution)
 	return renderer;
 }
 
-GraphicPass &register_graph(RenderGraph &graph, UiRenderer &renderer, Painter *painter, Handle<TextureDesc> output)
+Pass &register_graph(RenderGraph &graph, UiRenderer &renderer, Painter *painter, Handle<TextureDesc> output)
 {
 	auto glyph_atlas = renderer.glyph_atlas;
 